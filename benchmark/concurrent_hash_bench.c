@@ -0,0 +1,283 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+#include "warnings.h"
+
+#include <zix/attributes.h>
+#include <zix/concurrent_hash.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/sem.h>
+#include <zix/status.h>
+#include <zix/thread.h>
+
+ZIX_DISABLE_GLIB_WARNINGS
+#include <glib.h>
+ZIX_RESTORE_WARNINGS
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+  Measures read throughput with 1 to N reader threads, while a single writer
+  thread constantly churns the table by removing the oldest record and
+  inserting a new one.  This compares a ZixHash protected by a lock (a
+  semaphore, which is the only portable primitive Zix has for this) with a
+  ZixConcurrentHash, where readers never block.
+*/
+
+#define MAX_N_THREADS 64U
+
+typedef struct {
+  ZixHash*           hash;       ///< Locked table, or null
+  ZixConcurrentHash* concurrent; ///< Concurrent table, or null
+  ZixSem             lock;       ///< Lock for hash
+  ZixSem             done;       ///< Posted when the readers are finished
+  size_t             n_elems;    ///< Number of records in the table
+  size_t             n_lookups;  ///< Number of lookups done by each reader
+} Context;
+
+typedef struct {
+  Context* context;
+  size_t   seed;
+  size_t   n_found;
+} Reader;
+
+/// Linear Congruential Generator for making random 64-bit integers
+static inline uint64_t
+lcg64(const uint64_t i)
+{
+  static const uint64_t a = 6364136223846793005ULL;
+  static const uint64_t c = 1ULL;
+
+  return (a * i) + c;
+}
+
+ZIX_CONST_FUNC static const void*
+identity(const void* record)
+{
+  return record;
+}
+
+static size_t
+int_hash(const void* const key)
+{
+  const uintptr_t i = (uintptr_t)key;
+
+  return zix_digest(0U, &i, sizeof(i));
+}
+
+ZIX_CONST_FUNC static bool
+int_equal(const void* a, const void* b)
+{
+  return a == b;
+}
+
+/// Record for an integer key, which is never zero (null)
+static void*
+int_record(const size_t i)
+{
+  return (void*)(uintptr_t)(i + 1U);
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+read_locked(void* const arg)
+{
+  Reader* const  reader  = (Reader*)arg;
+  Context* const context = reader->context;
+
+  uint64_t r = reader->seed;
+  for (size_t i = 0U; i < context->n_lookups; ++i) {
+    r = lcg64(r);
+
+    const void* const key = int_record((size_t)(r % (2U * context->n_elems)));
+
+    zix_sem_wait(&context->lock);
+    reader->n_found += !!zix_hash_find_record(context->hash, key);
+    zix_sem_post(&context->lock);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+read_concurrent(void* const arg)
+{
+  Reader* const            reader  = (Reader*)arg;
+  Context* const           context = reader->context;
+  ZixConcurrentHash* const hash    = context->concurrent;
+
+  uint64_t r = reader->seed;
+  for (size_t i = 0U; i < context->n_lookups; ++i) {
+    r = lcg64(r);
+
+    const void* const key = int_record((size_t)(r % (2U * context->n_elems)));
+
+    const unsigned token = zix_concurrent_hash_begin_read(hash);
+    reader->n_found += !!zix_concurrent_hash_find(hash, key);
+    zix_concurrent_hash_end_read(hash, token);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+/// Churn the table by sliding a window of keys along until readers are done
+static ZixThreadResult ZIX_THREAD_FUNC
+churn(void* const arg)
+{
+  Context* const context = (Context*)arg;
+
+  ZixStatus st    = ZIX_STATUS_SUCCESS;
+  size_t    first = 0U;
+  for (size_t last = context->n_elems; zix_sem_try_wait(&context->done);
+       ++first, ++last) {
+    void* removed = NULL;
+    if (context->hash) {
+      zix_sem_wait(&context->lock);
+      st = zix_hash_remove(context->hash, int_record(first), &removed);
+      st = st ? st : zix_hash_insert(context->hash, int_record(last));
+      zix_sem_post(&context->lock);
+    } else {
+      st = zix_concurrent_hash_remove(
+        context->concurrent, int_record(first), &removed);
+      st = st ? st
+              : zix_concurrent_hash_insert(context->concurrent,
+                                           int_record(last));
+    }
+
+    assert(!st);
+    (void)st;
+  }
+
+  fprintf(stderr, "  Writer churned %zu records\n", first);
+  return ZIX_THREAD_RESULT;
+}
+
+/// Run readers concurrently with a writer and return the elapsed time
+static double
+run_threads(Context* const      context,
+            const unsigned      n_readers,
+            const ZixThreadFunc reader_func)
+{
+  Reader    readers[MAX_N_THREADS];
+  ZixThread reader_threads[MAX_N_THREADS];
+  ZixThread writer_thread; // NOLINT(cppcoreguidelines-init-variables)
+
+  zix_sem_init(&context->done, 0U);
+  ZixStatus st = zix_thread_create(&writer_thread, 1U << 16U, churn, context);
+  assert(!st);
+
+  BenchmarkTime start = bench_start();
+  for (unsigned t = 0U; t < n_readers; ++t) {
+    readers[t].context = context;
+    readers[t].seed    = t;
+    readers[t].n_found = 0U;
+
+    st = zix_thread_create(
+      &reader_threads[t], 1U << 16U, reader_func, &readers[t]);
+    assert(!st);
+  }
+
+  for (unsigned t = 0U; t < n_readers; ++t) {
+    st = zix_thread_join(reader_threads[t]);
+    assert(!st);
+  }
+
+  const double elapsed = bench_end(&start);
+
+  zix_sem_post(&context->done);
+  st = zix_thread_join(writer_thread);
+  assert(!st);
+  (void)st;
+
+  zix_sem_destroy(&context->done);
+  return elapsed;
+}
+
+static double
+bench_locked(const size_t n_elems, const size_t n_lookups, const unsigned n)
+{
+  Context context;
+  context.hash       = zix_hash_new(NULL, identity, int_hash, int_equal);
+  context.concurrent = NULL;
+  context.n_elems    = n_elems;
+  context.n_lookups  = n_lookups;
+  assert(context.hash);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const ZixStatus st = zix_hash_insert(context.hash, int_record(i));
+    assert(!st);
+    (void)st;
+  }
+
+  zix_sem_init(&context.lock, 1U);
+
+  const double elapsed = run_threads(&context, n, read_locked);
+
+  zix_sem_destroy(&context.lock);
+  zix_hash_free(context.hash);
+  return elapsed;
+}
+
+static double
+bench_concurrent(const size_t n_elems, const size_t n_lookups, const unsigned n)
+{
+  Context context;
+  context.hash = NULL;
+  context.concurrent =
+    zix_concurrent_hash_new(NULL, identity, int_hash, int_equal);
+  context.n_elems   = n_elems;
+  context.n_lookups = n_lookups;
+  assert(context.concurrent);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const ZixStatus st =
+      zix_concurrent_hash_insert(context.concurrent, int_record(i));
+    assert(!st);
+    (void)st;
+  }
+
+  const double elapsed = run_threads(&context, n, read_concurrent);
+
+  zix_concurrent_hash_free(context.concurrent);
+  return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc > 4) {
+    fprintf(stderr, "Usage: %s [N_ELEMS] [N_LOOKUPS] [MAX_THREADS]\n", argv[0]);
+    return 1;
+  }
+
+  const size_t n_elems   = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1U << 16U;
+  const size_t n_lookups = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1U << 20U;
+  const unsigned max_n_threads =
+    (argc > 3) ? (unsigned)strtoul(argv[3], NULL, 10) : 8U;
+
+  if (!n_elems || !max_n_threads || max_n_threads > MAX_N_THREADS) {
+    fprintf(stderr, "error: Invalid arguments\n");
+    return 1;
+  }
+
+  FILE* const dat = fopen("concurrent_hash.txt", "w");
+  assert(dat);
+
+  fprintf(dat, "# threads\tZixHashLocked\tZixConcurrentHash\n");
+  for (unsigned n = 1U; n <= max_n_threads; ++n) {
+    fprintf(stderr, "Benchmarking %u readers\n", n);
+
+    const double locked     = bench_locked(n_elems, n_lookups, n);
+    const double concurrent = bench_concurrent(n_elems, n_lookups, n);
+
+    fprintf(dat, "%u\t%lf\t%lf\n", n, locked, concurrent);
+  }
+
+  fclose(dat);
+
+  fprintf(stderr, "Wrote concurrent_hash.txt\n");
+  return 0;
+}
@@ -1,4 +1,4 @@
-// Copyright 2011-2023 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #include "bench.h"
@@ -12,8 +12,10 @@ typedef struct {
 #define ZIX_HASH_KEY_TYPE ZixChunk
 #define ZIX_HASH_RECORD_TYPE ZixChunk
 
+#include <zix/allocator.h>
 #include <zix/attributes.h>
 #include <zix/digest.h>
+#include <zix/flat_hash.h>
 #include <zix/hash.h>
 #include <zix/status.h>
 
@@ -34,6 +36,19 @@ typedef struct {
   char*     buf;
 } Inputs;
 
+/// Allocator that counts the number of bytes currently allocated
+typedef struct {
+  ZixAllocator base;
+  size_t       n_bytes;
+} CountingAllocator;
+
+/// Header before every allocation, large enough to preserve alignment
+typedef union {
+  size_t      size;
+  long double ld;
+  void*       ptr;
+} AllocationHeader;
+
 /// Linear Congruential Generator for making random 64-bit integers
 static inline uint64_t
 lcg64(const uint64_t i)
@@ -64,6 +79,99 @@ zix_chunk_equal(const ZixChunk* a, const ZixChunk* b)
 
 static const unsigned seed = 1;
 
+static void*
+counting_malloc(ZixAllocator* const allocator, const size_t size)
+{
+  CountingAllocator* const state = (CountingAllocator*)allocator;
+  AllocationHeader* const  header =
+    (AllocationHeader*)malloc(sizeof(AllocationHeader) + size);
+
+  if (!header) {
+    return NULL;
+  }
+
+  header->size = size;
+  state->n_bytes += size;
+  return header + 1;
+}
+
+static void*
+counting_calloc(ZixAllocator* const allocator,
+                const size_t        nmemb,
+                const size_t        size)
+{
+  void* const ptr = counting_malloc(allocator, nmemb * size);
+  if (ptr) {
+    memset(ptr, 0, nmemb * size);
+  }
+
+  return ptr;
+}
+
+static void
+counting_free(ZixAllocator* const allocator, void* const ptr)
+{
+  if (ptr) {
+    CountingAllocator* const state  = (CountingAllocator*)allocator;
+    AllocationHeader* const  header = (AllocationHeader*)ptr - 1;
+
+    state->n_bytes -= header->size;
+    free(header);
+  }
+}
+
+static void*
+counting_realloc(ZixAllocator* const allocator,
+                 void* const         ptr,
+                 const size_t        size)
+{
+  void* const new_ptr = counting_malloc(allocator, size);
+  if (new_ptr && ptr) {
+    const AllocationHeader* const header = (const AllocationHeader*)ptr - 1;
+
+    memcpy(new_ptr, ptr, header->size < size ? header->size : size);
+    counting_free(allocator, ptr);
+  }
+
+  return new_ptr;
+}
+
+static void*
+counting_aligned_alloc(ZixAllocator* const allocator,
+                       const size_t        alignment,
+                       const size_t        size)
+{
+  (void)allocator;
+  (void)alignment;
+  (void)size;
+  return NULL; // Unused by hash tables
+}
+
+static void
+counting_aligned_free(ZixAllocator* const allocator, void* const ptr)
+{
+  (void)allocator;
+  (void)ptr;
+}
+
+static CountingAllocator
+counting_allocator(void)
+{
+  CountingAllocator allocator = {
+    {
+      counting_malloc,
+      counting_calloc,
+      counting_realloc,
+      counting_free,
+      counting_aligned_alloc,
+      counting_aligned_free,
+    },
+    0U,
+  };
+
+  return allocator;
+}
+
 static Inputs
 read_inputs(FILE* const fd)
 {
@@ -119,6 +227,148 @@ read_inputs(FILE* const fd)
   return inputs;
 }
 
+static void
+bench_zix_hash(const Inputs* const inputs,
+               const size_t        n,
+               const ZixHashLayout layout,
+               FILE* const         insert_dat,
+               FILE* const         search_dat,
+               FILE* const         batch_dat,
+               FILE* const         iterate_dat,
+               FILE* const         memory_dat)
+{
+  static const size_t batch_size = 256U;
+
+  CountingAllocator allocator = counting_allocator();
+
+  ZixHash* zhash = zix_hash_new_with_layout(&allocator.base,
+                                            layout,
+                                            identity,
+                                            (ZixHashFunc)zix_chunk_hash,
+                                            (ZixKeyEqualFunc)zix_chunk_equal);
+
+  // Benchmark insertion
+  BenchmarkTime insert_start = bench_start();
+  for (size_t i = 0; i < n; ++i) {
+    ZixStatus st = zix_hash_insert(zhash, &inputs->chunks[i]);
+    assert(!st || st == ZIX_STATUS_EXISTS);
+    (void)st;
+  }
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+
+  // Measure memory, including records which are stored outside the table
+  if (memory_dat) {
+    const size_t n_bytes = allocator.n_bytes + (n * sizeof(ZixChunk));
+    fprintf(memory_dat, "\t%lf", (double)n_bytes / (double)n);
+  }
+
+  // Benchmark search
+  BenchmarkTime search_start = bench_start();
+  for (size_t i = 0; i < n; ++i) {
+    const size_t index = (size_t)(lcg64(seed + i) % n);
+    const ZixChunk* volatile match =
+      (const ZixChunk*)zix_hash_find_record(zhash, &inputs->chunks[index]);
+
+#ifndef NDEBUG
+    const ZixChunk* const m = match;
+    assert(m);
+    assert(!strcmp(m->buf, inputs->chunks[index].buf));
+#endif
+
+    (void)match;
+  }
+  fprintf(search_dat, "\t%lf", bench_end(&search_start));
+
+  // Benchmark batched search for the same keys
+  const ZixChunk** const keys =
+    (const ZixChunk**)calloc(n, sizeof(const ZixChunk*));
+  ZixChunk** const records = (ZixChunk**)calloc(batch_size, sizeof(ZixChunk*));
+  assert(keys);
+  assert(records);
+  for (size_t i = 0; i < n; ++i) {
+    keys[i] = &inputs->chunks[(size_t)(lcg64(seed + i) % n)];
+  }
+
+  BenchmarkTime batch_start = bench_start();
+  for (size_t i = 0; i < n; i += batch_size) {
+    const size_t n_keys  = (n - i < batch_size) ? (n - i) : batch_size;
+    const size_t n_found = zix_hash_find_batch(
+      zhash, n_keys, keys + i, NULL, (ZixHashRecord**)records);
+
+    assert(n_found == n_keys);
+    (void)n_found;
+  }
+  fprintf(batch_dat, "\t%lf", bench_end(&batch_start));
+
+  // Benchmark iteration over every record
+  BenchmarkTime iterate_start = bench_start();
+  size_t        n_visited     = 0U;
+  for (ZixHashIter i = zix_hash_begin(zhash); i != zix_hash_end(zhash);
+       i             = zix_hash_next(zhash, i)) {
+    const ZixChunk* volatile record = zix_hash_get(zhash, i);
+    (void)record;
+    ++n_visited;
+  }
+  fprintf(iterate_dat, "\t%lf", bench_end(&iterate_start));
+  assert(n_visited == zix_hash_size(zhash));
+  (void)n_visited;
+
+  free(records);
+  free(keys);
+  zix_hash_free(zhash);
+}
+
+static void
+bench_zix_flat_hash(const Inputs* const inputs,
+                    const size_t        n,
+                    FILE* const         insert_dat,
+                    FILE* const         search_dat,
+                    FILE* const         memory_dat)
+{
+  CountingAllocator allocator = counting_allocator();
+
+  ZixFlatHash* const hash =
+    zix_flat_hash_new(&allocator.base,
+                      sizeof(ZixChunk),
+                      sizeof(void*),
+                      (ZixKeyFunc)identity,
+                      (ZixHashFunc)zix_chunk_hash,
+                      (ZixKeyEqualFunc)zix_chunk_equal);
+
+  assert(hash);
+
+  // Benchmark insertion of copies of each record
+  BenchmarkTime insert_start = bench_start();
+  for (size_t i = 0; i < n; ++i) {
+    ZixStatus st = zix_flat_hash_insert(hash, &inputs->chunks[i], NULL);
+    assert(!st || st == ZIX_STATUS_EXISTS);
+    (void)st;
+  }
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+
+  // Measure memory, where records are stored in the table
+  fprintf(memory_dat, "\t%lf", (double)allocator.n_bytes / (double)n);
+
+  // Benchmark search
+  BenchmarkTime search_start = bench_start();
+  for (size_t i = 0; i < n; ++i) {
+    const size_t index = (size_t)(lcg64(seed + i) % n);
+    const ZixChunk* volatile match =
+      (const ZixChunk*)zix_flat_hash_find_record(hash, &inputs->chunks[index]);
+
+#ifndef NDEBUG
+    const ZixChunk* const m = match;
+    assert(m);
+    assert(!strcmp(m->buf, inputs->chunks[index].buf));
+#endif
+
+    (void)match;
+  }
+  fprintf(search_dat, "\t%lf", bench_end(&search_start));
+
+  zix_flat_hash_free(hash);
+}
+
 static int
 run(FILE* const fd)
 {
@@ -128,22 +378,33 @@ run(FILE* const fd)
 
   FILE* insert_dat = fopen("dict_insert.txt", "w");
   FILE* search_dat = fopen("dict_search.txt", "w");
+  FILE* batch_dat   = fopen("dict_search_batch.txt", "w");
+  FILE* iterate_dat = fopen("dict_iterate.txt", "w");
+  FILE* memory_dat  = fopen("dict_memory.txt", "w");
   assert(insert_dat);
   assert(search_dat);
-  fprintf(insert_dat, "# n\tGHashTable\tZixHash\n");
-  fprintf(search_dat, "# n\tGHashTable\tZixHash\n");
+  assert(batch_dat);
+  assert(iterate_dat);
+  assert(memory_dat);
+  fprintf(insert_dat,
+          "# n\tGHashTable\tZixHash\tZixHashGrouped\tZixHashCompact"
+          "\tZixFlatHash\n");
+  fprintf(search_dat,
+          "# n\tGHashTable\tZixHash\tZixHashGrouped\tZixHashCompact"
+          "\tZixFlatHash\n");
+  fprintf(batch_dat, "# n\tZixHash\tZixHashGrouped\tZixHashCompact\n");
+  fprintf(iterate_dat, "# n\tZixHash\tZixHashGrouped\tZixHashCompact\n");
+  fprintf(memory_dat, "# n\tZixHash\tZixHashCompact\tZixFlatHash\n");
 
   for (size_t n = inputs.n_chunks / 16; n <= inputs.n_chunks; n *= 2) {
     printf("Benchmarking n = %zu\n", n);
     GHashTable* hash = g_hash_table_new(g_str_hash, g_str_equal);
 
-    ZixHash* zhash = zix_hash_new(NULL,
-                                  identity,
-                                  (ZixHashFunc)zix_chunk_hash,
-                                  (ZixKeyEqualFunc)zix_chunk_equal);
-
     fprintf(insert_dat, "%zu", n);
     fprintf(search_dat, "%zu", n);
+    fprintf(batch_dat, "%zu", n);
+    fprintf(iterate_dat, "%zu", n);
+    fprintf(memory_dat, "%zu", n);
 
     // Benchmark insertion
 
@@ -154,15 +415,6 @@ run(FILE* const fd)
     }
     fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
 
-    // ZixHash
-    insert_start = bench_start();
-    for (size_t i = 0; i < n; ++i) {
-      ZixStatus st = zix_hash_insert(zhash, &inputs.chunks[i]);
-      assert(!st || st == ZIX_STATUS_EXISTS);
-      (void)st;
-    }
-    fprintf(insert_dat, "\t%lf\n", bench_end(&insert_start));
-
     // Benchmark search
 
     // GHashTable
@@ -181,29 +433,49 @@ run(FILE* const fd)
     }
     fprintf(search_dat, "\t%lf", bench_end(&search_start));
 
-    // ZixHash
-    search_start = bench_start();
-    for (size_t i = 0; i < n; ++i) {
-      const size_t index = (size_t)(lcg64(seed + i) % n);
-      const ZixChunk* volatile match =
-        (const ZixChunk*)zix_hash_find_record(zhash, &inputs.chunks[index]);
-
-#ifndef NDEBUG
-      const ZixChunk* const m = match;
-      assert(m);
-      assert(!strcmp(m->buf, inputs.chunks[index].buf));
-#endif
-
-      (void)match;
-    }
-    fprintf(search_dat, "\t%lf\n", bench_end(&search_start));
-
-    zix_hash_free(zhash);
     g_hash_table_unref(hash);
+
+    // ZixHash with each layout
+    bench_zix_hash(&inputs,
+                   n,
+                   ZIX_HASH_LINEAR,
+                   insert_dat,
+                   search_dat,
+                   batch_dat,
+                   iterate_dat,
+                   memory_dat);
+    bench_zix_hash(&inputs,
+                   n,
+                   ZIX_HASH_GROUPED,
+                   insert_dat,
+                   search_dat,
+                   batch_dat,
+                   iterate_dat,
+                   NULL);
+    bench_zix_hash(&inputs,
+                   n,
+                   ZIX_HASH_COMPACT,
+                   insert_dat,
+                   search_dat,
+                   batch_dat,
+                   iterate_dat,
+                   memory_dat);
+
+    // ZixFlatHash with a copy of each record
+    bench_zix_flat_hash(&inputs, n, insert_dat, search_dat, memory_dat);
+
+    fprintf(insert_dat, "\n");
+    fprintf(search_dat, "\n");
+    fprintf(batch_dat, "\n");
+    fprintf(iterate_dat, "\n");
+    fprintf(memory_dat, "\n");
   }
 
   fclose(insert_dat);
   fclose(search_dat);
+  fclose(batch_dat);
+  fclose(iterate_dat);
+  fclose(memory_dat);
 
   for (size_t i = 0; i < inputs.n_chunks; ++i) {
     free(inputs.chunks[i].buf);
@@ -212,7 +484,9 @@ run(FILE* const fd)
   free(inputs.chunks);
   free(inputs.buf);
 
-  fprintf(stderr, "Wrote dict_insert.txt dict_search.txt\n");
+  fprintf(stderr,
+          "Wrote dict_insert.txt dict_search.txt dict_search_batch.txt "
+          "dict_iterate.txt dict_memory.txt\n");
   return 0;
 }
 
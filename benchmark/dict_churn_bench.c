@@ -0,0 +1,181 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+#include "warnings.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+ZIX_DISABLE_GLIB_WARNINGS
+#include <glib.h>
+ZIX_RESTORE_WARNINGS
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+  Measures probe lengths while a table is repeatedly churned, that is, the
+  oldest records are removed and new ones inserted so the size stays constant.
+  With tombstones, probe lengths (particularly for misses) grow until the
+  table is next rehashed, whereas with backward-shift deletion they stay put.
+  The compact layout's dense entries fill up with holes, so it is rebuilt
+  periodically, which clears its deleted slots.
+*/
+
+#define N_LAYOUTS 4U
+
+static const ZixHashLayout layouts[N_LAYOUTS] = {
+  ZIX_HASH_LINEAR,
+  ZIX_HASH_GROUPED,
+  ZIX_HASH_ROBIN_HOOD,
+  ZIX_HASH_COMPACT,
+};
+
+ZIX_CONST_FUNC static const void*
+identity(const void* record)
+{
+  return record;
+}
+
+static size_t
+int_hash(const void* const key)
+{
+  const uintptr_t i = (uintptr_t)key;
+
+  return zix_digest(0U, &i, sizeof(i));
+}
+
+ZIX_CONST_FUNC static bool
+int_equal(const void* a, const void* b)
+{
+  return a == b;
+}
+
+/// Record for an integer key, which is never zero (null)
+static void*
+int_record(const size_t i)
+{
+  return (void*)(uintptr_t)(i + 1U);
+}
+
+static void
+write_stats(ZixHash* const* const hashes,
+            FILE* const           mean_dat,
+            FILE* const           max_dat)
+{
+  for (unsigned l = 0U; l < N_LAYOUTS; ++l) {
+    const ZixHashStats stats = zix_hash_stats(hashes[l]);
+
+    fprintf(mean_dat,
+            "\t%lf\t%lf",
+            stats.mean_probe_length,
+            stats.mean_miss_length);
+
+    fprintf(
+      max_dat, "\t%zu\t%zu", stats.max_probe_length, stats.max_miss_length);
+  }
+
+  fprintf(mean_dat, "\n");
+  fprintf(max_dat, "\n");
+}
+
+static int
+run(const size_t n_elems, const size_t n_rounds)
+{
+  ZixHash* hashes[N_LAYOUTS] = {NULL, NULL, NULL, NULL};
+  for (unsigned l = 0U; l < N_LAYOUTS; ++l) {
+    hashes[l] =
+      zix_hash_new_with_layout(NULL, layouts[l], identity, int_hash, int_equal);
+    assert(hashes[l]);
+  }
+
+  FILE* mean_dat = fopen("dict_churn_mean.txt", "w");
+  FILE* max_dat  = fopen("dict_churn_max.txt", "w");
+  assert(mean_dat);
+  assert(max_dat);
+
+#define HEADER                                                        \
+  "# ops\tLinearHit\tLinearMiss\tGroupedHit\tGroupedMiss\tRobinHoodHit" \
+  "\tRobinHoodMiss\tCompactHit\tCompactMiss\n"
+
+  fprintf(mean_dat, HEADER);
+  fprintf(max_dat, HEADER);
+
+#undef HEADER
+
+  // Fill the tables with the initial window of keys [first, last)
+  size_t first = 0U;
+  size_t last  = 0U;
+  for (; last < n_elems; ++last) {
+    for (unsigned l = 0U; l < N_LAYOUTS; ++l) {
+      const ZixStatus st = zix_hash_insert(hashes[l], int_record(last));
+      assert(!st);
+      (void)st;
+    }
+  }
+
+  fprintf(mean_dat, "0");
+  fprintf(max_dat, "0");
+  write_stats(hashes, mean_dat, max_dat);
+
+  // Slide the window along, removing the oldest key for every new one
+  const size_t  round_size   = (n_elems + 7U) / 8U;
+  BenchmarkTime churn_start  = bench_start();
+  size_t        n_operations = 0U;
+  for (size_t r = 0U; r < n_rounds; ++r) {
+    for (size_t i = 0U; i < round_size; ++i, ++first, ++last) {
+      for (unsigned l = 0U; l < N_LAYOUTS; ++l) {
+        void*     removed = NULL;
+        ZixStatus st = zix_hash_remove(hashes[l], int_record(first), &removed);
+        assert(!st);
+        assert(removed == int_record(first));
+
+        st = zix_hash_insert(hashes[l], int_record(last));
+        assert(!st);
+        (void)st;
+      }
+    }
+
+    n_operations += 2U * round_size;
+    fprintf(mean_dat, "%zu", n_operations);
+    fprintf(max_dat, "%zu", n_operations);
+    write_stats(hashes, mean_dat, max_dat);
+  }
+
+  fprintf(stderr, "Churned in %lf seconds\n", bench_end(&churn_start));
+
+  fclose(mean_dat);
+  fclose(max_dat);
+
+  for (unsigned l = 0U; l < N_LAYOUTS; ++l) {
+    zix_hash_free(hashes[l]);
+  }
+
+  fprintf(stderr, "Wrote dict_churn_mean.txt dict_churn_max.txt\n");
+  return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc > 3) {
+    fprintf(stderr, "Usage: %s [N_ELEMS] [N_ROUNDS]\n", argv[0]);
+    return 1;
+  }
+
+  const size_t n_elems  = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1U << 16U;
+  const size_t n_rounds = (argc > 2) ? strtoul(argv[2], NULL, 10) : 64U;
+
+  fprintf(stderr,
+          "Churning %zu elements for %zu rounds\n",
+          n_elems,
+          n_rounds);
+
+  return run(n_elems, n_rounds);
+}
@@ -0,0 +1,143 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+#include "warnings.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+ZIX_DISABLE_GLIB_WARNINGS
+#include <glib.h>
+ZIX_RESTORE_WARNINGS
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+  Measures the worst-case latency of a single insertion, which is dominated by
+  resizing.  For every power of two n, this reports the maximum time taken by
+  any insertion into a table with between n/2 and n records.
+*/
+
+#define N_LAYOUTS 3U
+#define MAX_N_BUCKETS 32U
+
+static const ZixHashLayout layouts[N_LAYOUTS] = {
+  ZIX_HASH_LINEAR,
+  ZIX_HASH_GROUPED,
+  ZIX_HASH_ROBIN_HOOD,
+};
+
+ZIX_CONST_FUNC static const void*
+identity(const void* record)
+{
+  return record;
+}
+
+static size_t
+int_hash(const void* const key)
+{
+  const uintptr_t i = (uintptr_t)key;
+
+  return zix_digest(0U, &i, sizeof(i));
+}
+
+ZIX_CONST_FUNC static bool
+int_equal(const void* a, const void* b)
+{
+  return a == b;
+}
+
+/// Return the bucket for inserting into a table of size `n`, in [n/2, n)
+static unsigned
+bucket_index(size_t n)
+{
+  unsigned b = 0U;
+  while (n) {
+    n >>= 1U;
+    ++b;
+  }
+
+  return b;
+}
+
+static void
+bench_insert(const ZixHashLayout layout,
+             const bool          incremental,
+             const size_t        n_elems,
+             double* const       max_latencies)
+{
+  ZixHash* const hash =
+    zix_hash_new_with_layout(NULL, layout, identity, int_hash, int_equal);
+
+  assert(hash);
+  zix_hash_set_incremental(hash, incremental);
+
+  for (size_t i = 0U; i < n_elems; ++i) {
+    void* const record = (void*)(uintptr_t)(i + 1U);
+
+    BenchmarkTime   insert_start = bench_start();
+    const ZixStatus st           = zix_hash_insert(hash, record);
+    const double    latency      = bench_end(&insert_start);
+    const unsigned  b            = bucket_index(i);
+
+    assert(!st);
+    (void)st;
+
+    if (latency > max_latencies[b]) {
+      max_latencies[b] = latency;
+    }
+  }
+
+  zix_hash_free(hash);
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc > 2) {
+    fprintf(stderr, "Usage: %s [N_ELEMS]\n", argv[0]);
+    return 1;
+  }
+
+  const size_t n_elems = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1U << 20U;
+  if (n_elems < 2U || bucket_index(n_elems - 1U) >= MAX_N_BUCKETS) {
+    fprintf(stderr, "error: Invalid number of elements\n");
+    return 1;
+  }
+
+  fprintf(stderr, "Benchmarking %zu insertions\n", n_elems);
+
+  double max_latencies[N_LAYOUTS * 2U][MAX_N_BUCKETS] = {{0.0}};
+  for (unsigned l = 0U; l < N_LAYOUTS; ++l) {
+    bench_insert(layouts[l], false, n_elems, max_latencies[2U * l]);
+    bench_insert(layouts[l], true, n_elems, max_latencies[(2U * l) + 1U]);
+  }
+
+  FILE* const latency_dat = fopen("dict_latency.txt", "w");
+  assert(latency_dat);
+
+  fprintf(latency_dat,
+          "# n\tLinear\tLinearIncremental\tGrouped\tGroupedIncremental"
+          "\tRobinHood\tRobinHoodIncremental\n");
+
+  for (unsigned b = 1U; b <= bucket_index(n_elems - 1U); ++b) {
+    fprintf(latency_dat, "%zu", (size_t)1U << b);
+    for (unsigned t = 0U; t < N_LAYOUTS * 2U; ++t) {
+      fprintf(latency_dat, "\t%lf", max_latencies[t][b]);
+    }
+
+    fprintf(latency_dat, "\n");
+  }
+
+  fclose(latency_dat);
+
+  fprintf(stderr, "Wrote dict_latency.txt\n");
+  return 0;
+}
@@ -0,0 +1,211 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  Measures insertion and search times for ZixHash with normal and adversarial
+  keys, hashed with zix_digest64() and a fixed seed, or with
+  zix_digest_keyed64() and a random per-table seed.
+
+  The adversarial keys are crafted to all have the same zix_digest64() hash,
+  which is easy since every step of that function can be inverted.  This
+  degrades the unkeyed table to a linear scan, but makes no difference to the
+  keyed one.
+*/
+
+typedef struct {
+  uint64_t words[2];
+} Key;
+
+static const uint64_t digest_m = 0x880355F21E6D1965ULL;
+static const uint64_t mix_c    = 0x2127599BF4325C37ULL;
+
+/// Linear Congruential Generator for making random 64-bit integers
+static inline uint64_t
+lcg64(const uint64_t i)
+{
+  static const uint64_t a = 6364136223846793005ULL;
+  static const uint64_t c = 1ULL;
+
+  return (a * i) + c;
+}
+
+/// Return the multiplicative inverse of an odd number modulo 2^64
+static uint64_t
+inverse64(const uint64_t x)
+{
+  uint64_t inv = x;
+  for (unsigned i = 0U; i < 5U; ++i) {
+    inv *= 2U - (x * inv);
+  }
+
+  return inv;
+}
+
+/// The mixing function of zix_digest64()
+static uint64_t
+mix64(uint64_t h)
+{
+  h ^= h >> 23U;
+  h *= mix_c;
+  h ^= h >> 47U;
+  return h;
+}
+
+/// The inverse of mix64()
+static uint64_t
+unmix64(uint64_t h)
+{
+  h ^= h >> 47U;
+  h *= inverse64(mix_c);
+  h ^= (h >> 23U) ^ (h >> 46U);
+  return h;
+}
+
+/// Return a key with a given first word and zix_digest64(0, key, 16) == code
+static Key
+colliding_key(const uint64_t first, const uint64_t code)
+{
+  const uint64_t h0  = (uint64_t)sizeof(Key) * digest_m;
+  const uint64_t h1  = (h0 ^ mix64(first)) * digest_m;
+  const uint64_t h2  = unmix64(code);
+  const Key      key = {{first, unmix64((h2 * inverse64(digest_m)) ^ h1)}};
+
+  return key;
+}
+
+ZIX_CONST_FUNC static const void*
+identity(const void* const record)
+{
+  return record;
+}
+
+ZIX_PURE_FUNC static size_t
+digest_hash(const void* const key)
+{
+  return (size_t)zix_digest64(0U, key, sizeof(Key));
+}
+
+ZIX_PURE_FUNC static size_t
+keyed_hash(const void* const key, const ZixDigestKey* const seed)
+{
+  return (size_t)zix_digest_keyed64(seed, key, sizeof(Key));
+}
+
+ZIX_PURE_FUNC static bool
+key_equal(const void* const a, const void* const b)
+{
+  return !memcmp(a, b, sizeof(Key));
+}
+
+static void
+bench(ZixHash* const hash,
+      Key* const     keys,
+      const size_t   n,
+      FILE* const    insert_dat,
+      FILE* const    search_dat)
+{
+  assert(hash);
+
+  BenchmarkTime insert_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const ZixStatus st = zix_hash_insert(hash, &keys[i]);
+    assert(!st);
+    (void)st;
+  }
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+
+  BenchmarkTime search_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const void* volatile match =
+      zix_hash_find_record(hash, &keys[lcg64(i) % n]);
+    assert(match);
+    (void)match;
+  }
+  fprintf(search_dat, "\t%lf", bench_end(&search_start));
+
+  zix_hash_free(hash);
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc > 2) {
+    fprintf(stderr, "Usage: %s [MAX_N_ELEMS]\n", argv[0]);
+    return 1;
+  }
+
+  const size_t max_n_elems =
+    (argc > 1) ? strtoul(argv[1], NULL, 10) : 1U << 14U;
+
+  // Make distinct random keys, and distinct keys that all collide
+  Key* const keys   = (Key*)calloc(max_n_elems, sizeof(Key));
+  Key* const attack = (Key*)calloc(max_n_elems, sizeof(Key));
+  assert(keys);
+  assert(attack);
+  for (size_t i = 0U; i < max_n_elems; ++i) {
+    const Key key = {{lcg64(i), lcg64(lcg64(i))}};
+
+    keys[i]   = key;
+    attack[i] = colliding_key(lcg64(i), 42U);
+    assert(digest_hash(&attack[i]) == (size_t)42U);
+  }
+
+  FILE* const insert_dat = fopen("hash_attack_insert.txt", "w");
+  FILE* const search_dat = fopen("hash_attack_search.txt", "w");
+  assert(insert_dat);
+  assert(search_dat);
+
+  static const char* const header =
+    "# n\tDigest\tDigest (attack)\tKeyed\tKeyed (attack)\n";
+
+  fprintf(insert_dat, "%s", header);
+  fprintf(search_dat, "%s", header);
+  for (size_t n = max_n_elems / 16U; n && n <= max_n_elems; n *= 2U) {
+    fprintf(stderr, "Benchmarking n = %zu\n", n);
+    fprintf(insert_dat, "%zu", n);
+    fprintf(search_dat, "%zu", n);
+
+    Key* const sets[] = {keys, attack};
+    for (unsigned s = 0U; s < 2U; ++s) {
+      bench(zix_hash_new(NULL, identity, digest_hash, key_equal),
+            sets[s],
+            n,
+            insert_dat,
+            search_dat);
+    }
+
+    for (unsigned s = 0U; s < 2U; ++s) {
+      bench(zix_hash_new_seeded(
+              NULL, ZIX_HASH_LINEAR, identity, keyed_hash, key_equal),
+            sets[s],
+            n,
+            insert_dat,
+            search_dat);
+    }
+
+    fprintf(insert_dat, "\n");
+    fprintf(search_dat, "\n");
+  }
+
+  fclose(search_dat);
+  fclose(insert_dat);
+  free(attack);
+  free(keys);
+
+  fprintf(stderr, "Wrote hash_attack_insert.txt hash_attack_search.txt\n");
+  return 0;
+}
@@ -0,0 +1,122 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+  Measures the time taken to load an array of n records into an empty
+  ZixHash, by inserting them one at a time, or with zix_hash_build() using
+  one thread and then the given maximum number of threads.
+*/
+
+ZIX_CONST_FUNC static const void*
+identity(const void* record)
+{
+  return record;
+}
+
+static size_t
+int_hash(const void* const key)
+{
+  const uintptr_t i = (uintptr_t)key;
+
+  return zix_digest(0U, &i, sizeof(i));
+}
+
+ZIX_CONST_FUNC static bool
+int_equal(const void* a, const void* b)
+{
+  return a == b;
+}
+
+static double
+bench_insert(void* const* const records, const size_t n)
+{
+  ZixHash* const hash = zix_hash_new(NULL, identity, int_hash, int_equal);
+  assert(hash);
+
+  BenchmarkTime start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const ZixStatus st = zix_hash_insert(hash, records[i]);
+    assert(!st);
+    (void)st;
+  }
+
+  const double elapsed = bench_end(&start);
+
+  assert(zix_hash_size(hash) == n);
+  zix_hash_free(hash);
+  return elapsed;
+}
+
+static double
+bench_build(void* const* const records,
+            const size_t       n,
+            const unsigned     n_threads)
+{
+  ZixHash* const hash = zix_hash_new(NULL, identity, int_hash, int_equal);
+  assert(hash);
+
+  BenchmarkTime   start   = bench_start();
+  const ZixStatus st      = zix_hash_build(hash, n, records, n_threads);
+  const double    elapsed = bench_end(&start);
+  assert(!st);
+  (void)st;
+
+  assert(zix_hash_size(hash) == n);
+  zix_hash_free(hash);
+  return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc > 3) {
+    fprintf(stderr, "Usage: %s [MAX_N_ELEMS] [N_THREADS]\n", argv[0]);
+    return 1;
+  }
+
+  const size_t max_n_elems =
+    (argc > 1) ? strtoul(argv[1], NULL, 10) : 1U << 22U;
+  const unsigned n_threads =
+    (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 8U;
+
+  // Make records for integer keys, which are never zero (null)
+  void** const records = (void**)calloc(max_n_elems, sizeof(void*));
+  assert(records);
+  for (size_t i = 0U; i < max_n_elems; ++i) {
+    records[i] = (void*)(uintptr_t)(i + 1U);
+  }
+
+  FILE* const dat = fopen("hash_build.txt", "w");
+  assert(dat);
+
+  fprintf(
+    dat, "# n\tInsert\tBuild (1 thread)\tBuild (%u threads)\n", n_threads);
+  for (size_t n = max_n_elems / 16U; n && n <= max_n_elems; n *= 2U) {
+    fprintf(stderr, "Benchmarking n = %zu\n", n);
+
+    const double insert   = bench_insert(records, n);
+    const double serial   = bench_build(records, n, 1U);
+    const double parallel = bench_build(records, n, n_threads);
+
+    fprintf(dat, "%zu\t%lf\t%lf\t%lf\n", n, insert, serial, parallel);
+  }
+
+  fclose(dat);
+  free(records);
+
+  fprintf(stderr, "Wrote hash_build.txt\n");
+  return 0;
+}
@@ -0,0 +1,210 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+
+#include <zix/hash.h>
+#include <zix/hash_define.h>
+#include <zix/hash_map.hpp>
+#include <zix/status.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/*
+  A variant of dict_bench that compares ZixHash, which calls the key, hash,
+  and equality functions through pointers, with zix::HashMap, which uses the
+  same algorithm but can inline them, and a table defined by ZIX_HASH_DEFINE,
+  which also stores keys inline.  Records are integers, so the functions are
+  trivial and the overhead of calling them is significant.
+*/
+
+namespace {
+
+/// Linear Congruential Generator for making random 64-bit integers
+inline uint64_t
+lcg64(const uint64_t i)
+{
+  static const uint64_t a = 6364136223846793005ULL;
+  static const uint64_t c = 1ULL;
+
+  return (a * i) + c;
+}
+
+/// Cheap integer hash (the murmur3 finalizer)
+inline size_t
+mix_hash(const size_t key)
+{
+  uint64_t h = key;
+
+  h ^= h >> 33U;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33U;
+  return static_cast<size_t>(h);
+}
+
+const void*
+identity(const void* const record)
+{
+  return record;
+}
+
+size_t
+int_hash(const void* const key)
+{
+  return mix_hash(*static_cast<const size_t*>(key));
+}
+
+bool
+int_equal(const void* const a, const void* const b)
+{
+  return *static_cast<const size_t*>(a) == *static_cast<const size_t*>(b);
+}
+
+struct IntKey {
+  size_t operator()(const size_t& record) const noexcept { return record; }
+};
+
+struct IntHash {
+  size_t operator()(const size_t key) const noexcept { return mix_hash(key); }
+};
+
+using IntMap = zix::HashMap<size_t, const size_t, IntKey, IntHash>;
+
+#define INT_EQUAL(a, b) ((a) == (b))
+
+ZIX_HASH_DEFINE(IntTable, size_t, char, mix_hash, INT_EQUAL)
+
+void
+bench_zix_hash(const std::vector<size_t>& records,
+               const size_t               n,
+               FILE* const                insert_dat,
+               FILE* const                search_dat)
+{
+  ZixHash* const hash = zix_hash_new(nullptr, identity, int_hash, int_equal);
+  assert(hash);
+
+  BenchmarkTime insert_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    auto* const     record = const_cast<size_t*>(&records[i]);
+    const ZixStatus st     = zix_hash_insert(hash, record);
+    assert(!st);
+    (void)st;
+  }
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+
+  BenchmarkTime search_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const size_t         key   = records[lcg64(i) % n];
+    const void* volatile match = zix_hash_find_record(hash, &key);
+    assert(match);
+    (void)match;
+  }
+  fprintf(search_dat, "\t%lf", bench_end(&search_start));
+
+  zix_hash_free(hash);
+}
+
+void
+bench_hash_map(const std::vector<size_t>& records,
+               const size_t               n,
+               FILE* const                insert_dat,
+               FILE* const                search_dat)
+{
+  IntMap map{};
+
+  BenchmarkTime insert_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const ZixStatus st = map.insert(&records[i]);
+    assert(!st);
+    (void)st;
+  }
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+
+  BenchmarkTime search_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const size_t* volatile match = map.find_record(records[lcg64(i) % n]);
+    assert(match);
+    (void)match;
+  }
+  fprintf(search_dat, "\t%lf", bench_end(&search_start));
+}
+
+void
+bench_hash_define(const std::vector<size_t>& records,
+                  const size_t               n,
+                  FILE* const                insert_dat,
+                  FILE* const                search_dat)
+{
+  IntTable* const table = IntTable_new(nullptr);
+  assert(table);
+
+  BenchmarkTime insert_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const ZixStatus st = IntTable_insert(table, records[i], '\0');
+    assert(!st);
+    (void)st;
+  }
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+
+  BenchmarkTime search_start = bench_start();
+  for (size_t i = 0U; i < n; ++i) {
+    const char* volatile match =
+      IntTable_find_record(table, records[lcg64(i) % n]);
+    assert(match);
+    (void)match;
+  }
+  fprintf(search_dat, "\t%lf", bench_end(&search_start));
+
+  IntTable_free(table);
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  if (argc > 2) {
+    fprintf(stderr, "Usage: %s [MAX_N_ELEMS]\n", argv[0]);
+    return 1;
+  }
+
+  const size_t max_n_elems =
+    (argc > 1) ? strtoul(argv[1], nullptr, 10) : 1U << 22U;
+
+  // Make distinct integer records
+  std::vector<size_t> records(max_n_elems);
+  for (size_t i = 0U; i < max_n_elems; ++i) {
+    records[i] = static_cast<size_t>(lcg64(i));
+  }
+
+  FILE* const insert_dat = fopen("hash_map_insert.txt", "w");
+  FILE* const search_dat = fopen("hash_map_search.txt", "w");
+  assert(insert_dat);
+  assert(search_dat);
+
+  fprintf(insert_dat, "# n\tZixHash\tzix::HashMap\tZIX_HASH_DEFINE\n");
+  fprintf(search_dat, "# n\tZixHash\tzix::HashMap\tZIX_HASH_DEFINE\n");
+  for (size_t n = max_n_elems / 16U; n && n <= max_n_elems; n *= 2U) {
+    fprintf(stderr, "Benchmarking n = %zu\n", n);
+    fprintf(insert_dat, "%zu", n);
+    fprintf(search_dat, "%zu", n);
+
+    bench_zix_hash(records, n, insert_dat, search_dat);
+    bench_hash_map(records, n, insert_dat, search_dat);
+    bench_hash_define(records, n, insert_dat, search_dat);
+
+    fprintf(insert_dat, "\n");
+    fprintf(search_dat, "\n");
+  }
+
+  fclose(insert_dat);
+  fclose(search_dat);
+
+  fprintf(stderr, "Wrote hash_map_insert.txt hash_map_search.txt\n");
+  return 0;
+}
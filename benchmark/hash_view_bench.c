@@ -0,0 +1,190 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/filesystem.h>
+#include <zix/hash.h>
+#include <zix/hash_view.h>
+#include <zix/status.h>
+#include <zix/string_view.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  Measures the "cold start" time to get a usable table of n strings, either
+  by reading a text file and inserting every line into a ZixHash, or by
+  opening a snapshot of that table with ZixHashView.  The time to search for
+  every string afterwards is also measured, since a view's pages are only
+  loaded on demand when it is first used.
+*/
+
+static const char* const snapshot_path = "hash_view.snapshot";
+
+typedef struct {
+  char**   strings;
+  size_t   n_strings;
+  ZixHash* hash;
+} Table;
+
+ZIX_CONST_FUNC static const void*
+identity(const void* const record)
+{
+  return record;
+}
+
+static size_t
+string_hash(const void* const key)
+{
+  const char* const str = (const char*)key;
+
+  return zix_digest(0U, str, strlen(str));
+}
+
+static bool
+string_equal(const void* const a, const void* const b)
+{
+  return !strcmp((const char*)a, (const char*)b);
+}
+
+static ZixHashViewEntry
+string_entry(const void* const record, void* const user_data)
+{
+  (void)user_data;
+
+  const ZixHashViewEntry entry = {zix_string((const char*)record),
+                                  zix_empty_string()};
+  return entry;
+}
+
+/// Read up to `n` lines from a text file and insert them into a new table
+static Table
+load_text(const char* const path, const size_t n)
+{
+  Table table = {(char**)calloc(n, sizeof(char*)),
+                 0U,
+                 zix_hash_new(NULL, identity, string_hash, string_equal)};
+
+  FILE* const fd = fopen(path, "r");
+  assert(fd);
+  assert(table.strings);
+  assert(table.hash);
+
+  char line[4096];
+  while (table.n_strings < n && fgets(line, sizeof(line), fd)) {
+    const size_t len = strcspn(line, "\n");
+    if (len) {
+      char* const str = (char*)malloc(len + 1U);
+      assert(str);
+      memcpy(str, line, len);
+      str[len] = '\0';
+
+      if (zix_hash_insert(table.hash, str)) {
+        free(str); // Duplicate
+      } else {
+        table.strings[table.n_strings++] = str;
+      }
+    }
+  }
+
+  fclose(fd);
+  return table;
+}
+
+static void
+free_table(Table* const table)
+{
+  zix_hash_free(table->hash);
+  for (size_t i = 0U; i < table->n_strings; ++i) {
+    free(table->strings[i]);
+  }
+
+  free(table->strings);
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s INPUT_FILE\n", argv[0]);
+    return 1;
+  }
+
+  const char* const input_path = argv[1];
+
+  // Count the lines in the input to choose sizes
+  size_t      n_lines = 0U;
+  FILE* const fd      = fopen(input_path, "r");
+  if (!fd) {
+    fprintf(stderr, "error: Failed to open file %s\n", input_path);
+    return 1;
+  }
+
+  for (int c = 0; (c = fgetc(fd)) != EOF;) {
+    n_lines += (c == '\n');
+  }
+  fclose(fd);
+
+  FILE* const load_dat   = fopen("hash_view_load.txt", "w");
+  FILE* const search_dat = fopen("hash_view_search.txt", "w");
+  assert(load_dat);
+  assert(search_dat);
+  fprintf(load_dat, "# n\tZixHash\tZixHashView\n");
+  fprintf(search_dat, "# n\tZixHash\tZixHashView\n");
+
+  for (size_t n = n_lines / 16U; n && n <= n_lines; n *= 2U) {
+    fprintf(stderr, "Benchmarking n = %zu\n", n);
+
+    // Rebuild a table from text, and write a snapshot of it
+    BenchmarkTime load_start = bench_start();
+    Table         table      = load_text(input_path, n);
+    fprintf(load_dat, "%zu\t%lf", n, bench_end(&load_start));
+
+    ZixStatus st =
+      zix_hash_view_write(NULL, table.hash, string_entry, NULL, snapshot_path);
+    assert(!st);
+
+    // Open the snapshot
+    BenchmarkTime      open_start = bench_start();
+    ZixHashView* const view       = zix_hash_view_open(NULL, snapshot_path);
+    fprintf(load_dat, "\t%lf\n", bench_end(&open_start));
+    assert(view);
+
+    // Search for every string in the table
+    BenchmarkTime search_start = bench_start();
+    for (size_t i = 0U; i < table.n_strings; ++i) {
+      const char* volatile match =
+        (const char*)zix_hash_find_record(table.hash, table.strings[i]);
+
+      assert(match);
+      (void)match;
+    }
+    fprintf(search_dat, "%zu\t%lf", n, bench_end(&search_start));
+
+    // Search for every string in the view
+    BenchmarkTime view_start = bench_start();
+    for (size_t i = 0U; i < table.n_strings; ++i) {
+      ZixStringView value = zix_empty_string();
+      st = zix_hash_view_find(view, zix_string(table.strings[i]), &value);
+      assert(!st);
+    }
+    fprintf(search_dat, "\t%lf\n", bench_end(&view_start));
+    (void)st;
+
+    zix_hash_view_free(view);
+    free_table(&table);
+  }
+
+  fclose(search_dat);
+  fclose(load_dat);
+  zix_remove(snapshot_path);
+
+  fprintf(stderr, "Wrote hash_view_load.txt hash_view_search.txt\n");
+  return 0;
+}
@@ -0,0 +1,190 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/perfect_hash.h>
+#include <zix/status.h>
+#include <zix/string_view.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+  Measures the time to build a table of n unique strings, and to search for
+  every string in a random order, with a ZixHash and a ZixPerfectHash built
+  from it.  The perfect hash build time doesn't include building the
+  ZixHash it's made from.
+*/
+
+typedef struct {
+  char** strings;
+  size_t n_strings;
+} Inputs;
+
+ZIX_CONST_FUNC static const void*
+identity(const void* const record)
+{
+  return record;
+}
+
+static size_t
+string_hash(const void* const key)
+{
+  const char* const str = (const char*)key;
+
+  return zix_digest(0U, str, strlen(str));
+}
+
+static bool
+string_equal(const void* const a, const void* const b)
+{
+  return !strcmp((const char*)a, (const char*)b);
+}
+
+static ZixStringView
+string_key(const void* const record, void* const user_data)
+{
+  (void)user_data;
+
+  return zix_string((const char*)record);
+}
+
+/// Linear Congruential Generator for making random 64-bit integers
+static inline uint64_t
+lcg64(const uint64_t i)
+{
+  static const uint64_t a = 6364136223846793005ULL;
+  static const uint64_t c = 1ULL;
+
+  return (a * i) + c;
+}
+
+/// Read every unique line from a text file
+static Inputs
+read_inputs(FILE* const fd)
+{
+  Inputs   inputs      = {NULL, 0U};
+  size_t   n_allocated = 0U;
+  ZixHash* unique = zix_hash_new(NULL, identity, string_hash, string_equal);
+  assert(unique);
+
+  char line[4096];
+  while (fgets(line, sizeof(line), fd)) {
+    const size_t len = strcspn(line, "\n");
+    line[len]        = '\0';
+    if (!len || zix_hash_find_record(unique, line)) {
+      continue;
+    }
+
+    if (inputs.n_strings == n_allocated) {
+      n_allocated = n_allocated ? n_allocated * 2U : 1024U;
+      inputs.strings =
+        (char**)realloc(inputs.strings, n_allocated * sizeof(char*));
+      assert(inputs.strings);
+    }
+
+    char* const str = (char*)malloc(len + 1U);
+    assert(str);
+    memcpy(str, line, len + 1U);
+    inputs.strings[inputs.n_strings++] = str;
+    zix_hash_insert(unique, str);
+  }
+
+  zix_hash_free(unique);
+  return inputs;
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s INPUT_FILE\n", argv[0]);
+    return 1;
+  }
+
+  FILE* const fd = fopen(argv[1], "r");
+  if (!fd) {
+    fprintf(stderr, "error: Failed to open file %s\n", argv[1]);
+    return 1;
+  }
+
+  const Inputs inputs = read_inputs(fd);
+  fclose(fd);
+
+  FILE* const build_dat  = fopen("perfect_hash_build.txt", "w");
+  FILE* const search_dat = fopen("perfect_hash_search.txt", "w");
+  assert(build_dat);
+  assert(search_dat);
+  fprintf(build_dat, "# n\tZixHash\tZixPerfectHash\n");
+  fprintf(search_dat, "# n\tZixHash\tZixPerfectHash\n");
+
+  for (size_t n = inputs.n_strings / 16U; n && n <= inputs.n_strings;
+       n *= 2U) {
+    fprintf(stderr, "Benchmarking n = %zu\n", n);
+
+    // Build a hash table
+    BenchmarkTime  hash_start = bench_start();
+    ZixHash* const hash =
+      zix_hash_new(NULL, identity, string_hash, string_equal);
+    for (size_t i = 0U; i < n; ++i) {
+      const ZixStatus st = zix_hash_insert(hash, inputs.strings[i]);
+      assert(!st);
+      (void)st;
+    }
+    fprintf(build_dat, "%zu\t%lf", n, bench_end(&hash_start));
+
+    // Build a perfect hash from it
+    BenchmarkTime         perfect_start = bench_start();
+    ZixPerfectHash* const perfect =
+      zix_perfect_hash_new_from_hash(NULL, hash, string_key, NULL);
+    fprintf(build_dat, "\t%lf\n", bench_end(&perfect_start));
+    assert(perfect);
+
+    // Search the hash table
+    BenchmarkTime search_start = bench_start();
+    for (size_t i = 0U; i < n; ++i) {
+      const char* const key = inputs.strings[lcg64(i) % n];
+      const char* volatile match =
+        (const char*)zix_hash_find_record(hash, key);
+
+      assert(match == key);
+      (void)match;
+    }
+    fprintf(search_dat, "%zu\t%lf", n, bench_end(&search_start));
+
+    // Search the perfect hash
+    BenchmarkTime perfect_search_start = bench_start();
+    for (size_t i = 0U; i < n; ++i) {
+      const char* const key = inputs.strings[lcg64(i) % n];
+      const char* volatile match =
+        (const char*)zix_perfect_hash_find_record(perfect, zix_string(key));
+
+      assert(match == key);
+      (void)match;
+    }
+    fprintf(search_dat, "\t%lf\n", bench_end(&perfect_search_start));
+
+    zix_perfect_hash_free(perfect);
+    zix_hash_free(hash);
+  }
+
+  fclose(search_dat);
+  fclose(build_dat);
+
+  for (size_t i = 0U; i < inputs.n_strings; ++i) {
+    free(inputs.strings[i]);
+  }
+
+  free(inputs.strings);
+
+  fprintf(stderr, "Wrote perfect_hash_build.txt perfect_hash_search.txt\n");
+  return 0;
+}
@@ -0,0 +1,212 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "bench.h"
+#include "warnings.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/sem.h>
+#include <zix/sharded_hash.h>
+#include <zix/status.h>
+#include <zix/thread.h>
+
+ZIX_DISABLE_GLIB_WARNINGS
+#include <glib.h>
+ZIX_RESTORE_WARNINGS
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+  Measures the time taken to insert a fixed number of records with 1 to N
+  writer threads, which each insert an equal share of the records.  This
+  compares a single ZixHash protected by a lock (a semaphore, which is the
+  only portable primitive Zix has for this) with a ZixShardedHash.
+*/
+
+#define MAX_N_THREADS 64U
+
+typedef struct {
+  ZixHash*        hash;    ///< Locked table, or null
+  ZixShardedHash* sharded; ///< Sharded table, or null
+  ZixSem          lock;    ///< Lock for hash
+} Context;
+
+typedef struct {
+  Context* context;
+  size_t   first;
+  size_t   last;
+} Writer;
+
+ZIX_CONST_FUNC static const void*
+identity(const void* record)
+{
+  return record;
+}
+
+static size_t
+int_hash(const void* const key)
+{
+  const uintptr_t i = (uintptr_t)key;
+
+  return zix_digest(0U, &i, sizeof(i));
+}
+
+ZIX_CONST_FUNC static bool
+int_equal(const void* a, const void* b)
+{
+  return a == b;
+}
+
+/// Record for an integer key, which is never zero (null)
+static void*
+int_record(const size_t i)
+{
+  return (void*)(uintptr_t)(i + 1U);
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+insert_locked(void* const arg)
+{
+  Writer* const  writer  = (Writer*)arg;
+  Context* const context = writer->context;
+
+  for (size_t i = writer->first; i < writer->last; ++i) {
+    zix_sem_wait(&context->lock);
+    const ZixStatus st = zix_hash_insert(context->hash, int_record(i));
+    zix_sem_post(&context->lock);
+
+    assert(!st);
+    (void)st;
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+insert_sharded(void* const arg)
+{
+  Writer* const  writer  = (Writer*)arg;
+  Context* const context = writer->context;
+
+  for (size_t i = writer->first; i < writer->last; ++i) {
+    const ZixStatus st =
+      zix_sharded_hash_insert(context->sharded, int_record(i));
+
+    assert(!st);
+    (void)st;
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+/// Run writers that insert `n_elems` records in total and return the time
+static double
+run_threads(Context* const      context,
+            const size_t        n_elems,
+            const unsigned      n_writers,
+            const ZixThreadFunc writer_func)
+{
+  Writer    writers[MAX_N_THREADS];
+  ZixThread threads[MAX_N_THREADS];
+
+  BenchmarkTime start = bench_start();
+  for (unsigned t = 0U; t < n_writers; ++t) {
+    writers[t].context = context;
+    writers[t].first   = n_elems * t / n_writers;
+    writers[t].last    = n_elems * (t + 1U) / n_writers;
+
+    const ZixStatus st =
+      zix_thread_create(&threads[t], 1U << 16U, writer_func, &writers[t]);
+    assert(!st);
+    (void)st;
+  }
+
+  for (unsigned t = 0U; t < n_writers; ++t) {
+    const ZixStatus st = zix_thread_join(threads[t]);
+    assert(!st);
+    (void)st;
+  }
+
+  return bench_end(&start);
+}
+
+static double
+bench_locked(const size_t n_elems, const unsigned n_threads)
+{
+  Context context;
+  context.hash    = zix_hash_new(NULL, identity, int_hash, int_equal);
+  context.sharded = NULL;
+  assert(context.hash);
+  zix_sem_init(&context.lock, 1U);
+
+  const double elapsed =
+    run_threads(&context, n_elems, n_threads, insert_locked);
+
+  assert(zix_hash_size(context.hash) == n_elems);
+  zix_sem_destroy(&context.lock);
+  zix_hash_free(context.hash);
+  return elapsed;
+}
+
+static double
+bench_sharded(const size_t   n_elems,
+              const unsigned n_threads,
+              const unsigned n_shards)
+{
+  Context context;
+  context.hash = NULL;
+  context.sharded =
+    zix_sharded_hash_new(NULL, n_shards, identity, int_hash, int_equal);
+  assert(context.sharded);
+
+  const double elapsed =
+    run_threads(&context, n_elems, n_threads, insert_sharded);
+
+  assert(zix_sharded_hash_size(context.sharded) == n_elems);
+  zix_sharded_hash_free(context.sharded);
+  return elapsed;
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc > 4) {
+    fprintf(stderr, "Usage: %s [N_ELEMS] [MAX_THREADS] [N_SHARDS]\n", argv[0]);
+    return 1;
+  }
+
+  const size_t   n_elems = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1U << 20U;
+  const unsigned max_n_threads =
+    (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 8U;
+  const unsigned n_shards =
+    (argc > 3) ? (unsigned)strtoul(argv[3], NULL, 10) : 64U;
+
+  if (!max_n_threads || max_n_threads > MAX_N_THREADS) {
+    fprintf(stderr, "error: Invalid number of threads\n");
+    return 1;
+  }
+
+  FILE* const dat = fopen("sharded_hash.txt", "w");
+  assert(dat);
+
+  fprintf(dat, "# threads\tZixHashLocked\tZixShardedHash\n");
+  for (unsigned n = 1U; n <= max_n_threads; ++n) {
+    fprintf(stderr, "Benchmarking %u writers\n", n);
+
+    const double locked  = bench_locked(n_elems, n);
+    const double sharded = bench_sharded(n_elems, n, n_shards);
+
+    fprintf(dat, "%u\t%lf\t%lf\n", n, locked, sharded);
+  }
+
+  fclose(dat);
+
+  fprintf(stderr, "Wrote sharded_hash.txt\n");
+  return 0;
+}
@@ -1,4 +1,4 @@
-// Copyright 2011-2020 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #include "../test/test_data.h"
@@ -47,6 +47,12 @@ int_cmp(const void* a, const void* b, const void* ZIX_UNUSED(user_data))
   return 1;
 }
 
+static int
+sort_cmp(const void* a, const void* b)
+{
+  return int_cmp(*(void* const*)a, *(void* const*)b, NULL);
+}
+
 static int
 g_int_cmp(const void* a, const void* b, void* user_data)
 {
@@ -72,6 +78,7 @@ bench_zix_tree(size_t n_elems,
                FILE*  insert_dat,
                FILE*  search_dat,
                FILE*  iter_dat,
+               FILE*  rev_dat,
                FILE*  del_dat)
 {
   start_test("ZixTree");
@@ -114,6 +121,15 @@ bench_zix_tree(size_t n_elems,
   }
   fprintf(iter_dat, "\t%lf", bench_end(&iter_start));
 
+  // Iterate over all elements in reverse
+  BenchmarkTime rev_start = bench_start();
+  for (ZixTreeIter* iter = zix_tree_rbegin(t); !zix_tree_iter_is_rend(iter);
+       iter              = zix_tree_iter_prev(iter)) {
+    volatile void* const value = zix_tree_get(iter);
+    (void)value;
+  }
+  fprintf(rev_dat, "\t%lf", bench_end(&rev_start));
+
   // Delete all elements
   BenchmarkTime del_start = bench_start();
   for (size_t i = 0; i < n_elems; i++) {
@@ -134,30 +150,17 @@ bench_zix_tree(size_t n_elems,
   return EXIT_SUCCESS;
 }
 
+/// Search for, iterate over, then delete all elements in a tree
 static int
-bench_zix_btree(size_t n_elems,
-                FILE*  insert_dat,
-                FILE*  search_dat,
-                FILE*  iter_dat,
-                FILE*  del_dat)
+bench_zix_btree_queries(ZixBTree* t,
+                        size_t    n_elems,
+                        FILE*     search_dat,
+                        FILE*     iter_dat,
+                        FILE*     rev_dat,
+                        FILE*     del_dat)
 {
-  start_test("ZixBTree");
-
   uintptr_t    r  = 0U;
   ZixBTreeIter ti = zix_btree_end_iter;
-  ZixBTree*    t  = zix_btree_new(NULL, int_cmp, NULL);
-
-  // Insert n_elems elements
-  BenchmarkTime insert_start = bench_start();
-  for (size_t i = 0; i < n_elems; i++) {
-    r = unique_rand(i);
-
-    ZixStatus status = zix_btree_insert(t, (void*)r);
-    if (status) {
-      return test_fail("Failed to insert", r);
-    }
-  }
-  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
 
   // Search for all elements
   BenchmarkTime search_start = bench_start();
@@ -181,6 +184,15 @@ bench_zix_btree(size_t n_elems,
   }
   fprintf(iter_dat, "\t%lf", bench_end(&iter_start));
 
+  // Iterate over all elements in reverse
+  BenchmarkTime rev_start = bench_start();
+  ZixBTreeIter  rev       = zix_btree_rbegin(t);
+  for (; !zix_btree_iter_is_end(rev); zix_btree_iter_decrement(&rev)) {
+    volatile void* const value = zix_btree_get(rev);
+    (void)value;
+  }
+  fprintf(rev_dat, "\t%lf", bench_end(&rev_start));
+
   // Delete all elements
   BenchmarkTime del_start = bench_start();
   for (size_t i = 0; i < n_elems; i++) {
@@ -199,11 +211,76 @@ bench_zix_btree(size_t n_elems,
   return EXIT_SUCCESS;
 }
 
+static int
+bench_zix_btree(const char*         name,
+                ZixBTreeCompareFunc cmp,
+                size_t              n_elems,
+                FILE*               insert_dat,
+                FILE*               search_dat,
+                FILE*               iter_dat,
+                FILE*               rev_dat,
+                FILE*               del_dat)
+{
+  start_test(name);
+
+  uintptr_t r = 0U;
+  ZixBTree* t = zix_btree_new(NULL, cmp, NULL);
+
+  // Insert n_elems elements
+  BenchmarkTime insert_start = bench_start();
+  for (size_t i = 0; i < n_elems; i++) {
+    r = unique_rand(i);
+
+    ZixStatus status = zix_btree_insert(t, (void*)r);
+    if (status) {
+      return test_fail("Failed to insert", r);
+    }
+  }
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+
+  return bench_zix_btree_queries(
+    t, n_elems, search_dat, iter_dat, rev_dat, del_dat);
+}
+
+static int
+bench_zix_btree_bulk(size_t n_elems,
+                     FILE*  insert_dat,
+                     FILE*  search_dat,
+                     FILE*  iter_dat,
+                     FILE*  rev_dat,
+                     FILE*  del_dat)
+{
+  start_test("ZixBTree (bulk)");
+
+  // Sort elements (not timed, since they might be sorted already)
+  void** const values = (void**)calloc(n_elems, sizeof(void*));
+  assert(values);
+  for (size_t i = 0; i < n_elems; ++i) {
+    values[i] = (void*)unique_rand(i);
+  }
+
+  qsort(values, n_elems, sizeof(void*), sort_cmp);
+
+  // Load all elements at once
+  ZixBTree*     t            = zix_btree_new(NULL, int_cmp, NULL);
+  BenchmarkTime insert_start = bench_start();
+  ZixStatus     status       = zix_btree_bulk_load(t, n_elems, values, 100U);
+  fprintf(insert_dat, "\t%lf", bench_end(&insert_start));
+  free(values);
+  if (status) {
+    return test_fail("Failed to load", n_elems);
+  }
+
+  return bench_zix_btree_queries(
+    t, n_elems, search_dat, iter_dat, rev_dat, del_dat);
+}
+
 static int
 bench_glib(size_t n_elems,
            FILE*  insert_dat,
            FILE*  search_dat,
            FILE*  iter_dat,
+           FILE*  rev_dat,
            FILE*  del_dat)
 {
   start_test("GSequence");
@@ -244,6 +321,15 @@ bench_glib(size_t n_elems,
   }
   fprintf(iter_dat, "\t%lf", bench_end(&iter_start));
 
+  // Iterate over all elements in reverse
+  BenchmarkTime        rev_start = bench_start();
+  GSequenceIter* const begin     = g_sequence_get_begin_iter(t);
+  for (GSequenceIter* iter = g_sequence_get_end_iter(t); iter != begin;) {
+    iter = g_sequence_iter_prev(iter);
+    g_sequence_get(iter);
+  }
+  fprintf(rev_dat, "\t%lf", bench_end(&rev_start));
+
   // Delete all elements
   BenchmarkTime del_start = bench_start();
   for (size_t i = 0; i < n_elems; ++i) {
@@ -274,43 +360,66 @@ main(int argc, char** argv)
 
   fprintf(stderr, "Benchmarking %zu .. %zu elements\n", min_n, max_n);
 
-#define HEADER "# n\tZixTree\tZixBTree\tGSequence\n"
+#define HEADER \
+  "# n\tZixTree\tZixBTree\tZixBTree (integer)\tZixBTree (bulk)\tGSequence\n"
 
   FILE* insert_dat = fopen("tree_insert.txt", "w");
   FILE* search_dat = fopen("tree_search.txt", "w");
   FILE* iter_dat   = fopen("tree_iterate.txt", "w");
+  FILE* rev_dat    = fopen("tree_reverse.txt", "w");
   FILE* del_dat    = fopen("tree_delete.txt", "w");
   assert(insert_dat);
   assert(search_dat);
   assert(iter_dat);
+  assert(rev_dat);
   assert(del_dat);
 
   fprintf(insert_dat, HEADER);
   fprintf(search_dat, HEADER);
   fprintf(iter_dat, HEADER);
+  fprintf(rev_dat, HEADER);
   fprintf(del_dat, HEADER);
   for (size_t n = min_n; n <= max_n; n *= 2) {
     fprintf(stderr, "n = %zu\n", n);
     fprintf(insert_dat, "%zu", n);
     fprintf(search_dat, "%zu", n);
     fprintf(iter_dat, "%zu", n);
+    fprintf(rev_dat, "%zu", n);
     fprintf(del_dat, "%zu", n);
-    bench_zix_tree(n, insert_dat, search_dat, iter_dat, del_dat);
-    bench_zix_btree(n, insert_dat, search_dat, iter_dat, del_dat);
-    bench_glib(n, insert_dat, search_dat, iter_dat, del_dat);
+    bench_zix_tree(n, insert_dat, search_dat, iter_dat, rev_dat, del_dat);
+    bench_zix_btree("ZixBTree",
+                    int_cmp,
+                    n,
+                    insert_dat,
+                    search_dat,
+                    iter_dat,
+                    rev_dat,
+                    del_dat);
+    bench_zix_btree("ZixBTree (integer)",
+                    NULL,
+                    n,
+                    insert_dat,
+                    search_dat,
+                    iter_dat,
+                    rev_dat,
+                    del_dat);
+    bench_zix_btree_bulk(n, insert_dat, search_dat, iter_dat, rev_dat, del_dat);
+    bench_glib(n, insert_dat, search_dat, iter_dat, rev_dat, del_dat);
     fprintf(insert_dat, "\n");
     fprintf(search_dat, "\n");
     fprintf(iter_dat, "\n");
+    fprintf(rev_dat, "\n");
     fprintf(del_dat, "\n");
   }
   fclose(insert_dat);
   fclose(search_dat);
   fclose(iter_dat);
+  fclose(rev_dat);
   fclose(del_dat);
 
-  fprintf(
-    stderr,
-    "Wrote tree_insert.txt tree_search.txt tree_iterate.txt tree_del.txt\n");
+  fprintf(stderr,
+          "Wrote tree_insert.txt tree_search.txt tree_iterate.txt "
+          "tree_reverse.txt tree_del.txt\n");
 
   return EXIT_SUCCESS;
 }
@@ -1,4 +1,4 @@
-// Copyright 2011-2022 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #ifndef ZIX_BTREE_H
@@ -50,19 +50,58 @@ typedef int (*ZixBTreeCompareFunc)(const void* ZIX_UNSPECIFIED a,
 typedef void (*ZixBTreeDestroyFunc)(void* ZIX_UNSPECIFIED       ptr,
                                     const void* ZIX_UNSPECIFIED user_data);
 
+/**
+   Function to get the key prefix of a B-Tree element.
+
+   A prefix is an integer that orders elements consistently with the
+   comparator: if the prefix of `a` is less than the prefix of `b`, then `a`
+   must be less than `b`.  For example, this can be the first 8 bytes of a
+   string key, loaded as a big-endian integer.
+*/
+typedef uint64_t (*ZixBTreePrefixFunc)(const void* ZIX_UNSPECIFIED value);
+
 /**
    Create a new (empty) B-Tree.
 
    The given comparator must be a total ordering and is used to internally
    organize the tree and look for values exactly.
 
+   If the comparator is null, then elements are integers (`uintptr_t` values
+   cast to pointers) which are compared directly.  This is faster, since nodes
+   are searched without calling any functions, and with SIMD instructions
+   where available.
+
    Searching can be done with a custom comparator that supports wildcards, see
    zix_btree_lower_bound() for details.
 */
 ZIX_API ZIX_NODISCARD ZixBTree* ZIX_ALLOCATED
-zix_btree_new(ZixAllocator* ZIX_NULLABLE      allocator,
-              ZixBTreeCompareFunc ZIX_NONNULL cmp,
-              const void* ZIX_UNSPECIFIED     cmp_data);
+zix_btree_new(ZixAllocator* ZIX_NULLABLE       allocator,
+              ZixBTreeCompareFunc ZIX_NULLABLE cmp,
+              const void* ZIX_UNSPECIFIED      cmp_data);
+
+/**
+   Create a new (empty) B-Tree that caches a key prefix for every element.
+
+   This is like zix_btree_new(), but if the library was built with
+   `ZIX_BTREE_PREFIXES` defined (the `btree_prefixes` build option), then the
+   prefix of every element is stored in the tree alongside it.  Searching
+   compares these prefixes first, and only calls the comparator when they are
+   equal, which avoids dereferencing most elements when the keys are large or
+   far apart in memory.  Otherwise, `prefix` isn't used at all.
+
+   The prefix function is also ignored if `cmp` is null.
+
+   Besides elements being added to the tree, the prefix function is called on
+   the search keys given to zix_btree_find(), zix_btree_remove(),
+   zix_btree_rank(), zix_btree_count_range(), zix_btree_split(),
+   zix_btree_erase_range(), and zix_btree_lower_bound() without a custom
+   comparator, so these keys must be valid elements as well.
+*/
+ZIX_API ZIX_NODISCARD ZixBTree* ZIX_ALLOCATED
+zix_btree_new_prefixed(ZixAllocator* ZIX_NULLABLE       allocator,
+                       ZixBTreeCompareFunc ZIX_NULLABLE cmp,
+                       const void* ZIX_UNSPECIFIED      cmp_data,
+                       ZixBTreePrefixFunc ZIX_NULLABLE  prefix);
 
 /**
    Free `t` and all the nodes it contains.
@@ -141,6 +180,19 @@ zix_btree_begin(const ZixBTree* ZIX_NONNULL t);
 ZIX_CONST_API ZixBTreeIter
 zix_btree_end(const ZixBTree* ZIX_NULLABLE t);
 
+/// Return an iterator to the last (largest) element in `t`
+ZIX_PURE_API ZixBTreeIter
+zix_btree_rbegin(const ZixBTree* ZIX_NONNULL t);
+
+/**
+   Return an iterator to the end of `t` in reverse (one before the first).
+
+   This is equal to zix_btree_end(), since decrementing an iterator past the
+   first element moves it to the end.
+*/
+ZIX_CONST_API ZixBTreeIter
+zix_btree_rend(const ZixBTree* ZIX_NULLABLE t);
+
 /// Return true iff `lhs` is equal to `rhs`
 ZIX_CONST_API bool
 zix_btree_iter_equals(ZixBTreeIter lhs, ZixBTreeIter rhs);
@@ -160,6 +212,14 @@ zix_btree_iter_increment(ZixBTreeIter* ZIX_NONNULL i);
 ZIX_API ZIX_NODISCARD ZixBTreeIter
 zix_btree_iter_next(ZixBTreeIter iter);
 
+/// Decrement `i` to point to the previous element in the tree
+ZIX_API ZixStatus
+zix_btree_iter_decrement(ZixBTreeIter* ZIX_NONNULL i);
+
+/// Return an iterator one before `iter`
+ZIX_API ZIX_NODISCARD ZixBTreeIter
+zix_btree_iter_prev(ZixBTreeIter iter);
+
 /**
    @}
    @defgroup zix_btree_modification Modification
@@ -175,6 +235,176 @@ zix_btree_iter_next(ZixBTreeIter iter);
 ZIX_API ZixStatus
 zix_btree_insert(ZixBTree* ZIX_NONNULL t, void* ZIX_UNSPECIFIED e);
 
+/**
+   Insert the element `e` into `t`, starting near `hint`.
+
+   This is like zix_btree_insert(), but first tries to insert into the leaf
+   that `hint` points into.  If `e` belongs there, then it is inserted without
+   searching down from the root.  Otherwise, this falls back to a normal
+   insertion, so any valid iterator (including the end) is a correct hint,
+   but a good one makes insertion take constant time.
+
+   Note that zix_btree_insert() also remembers the last leaf it inserted into
+   and tries that first, so runs of nearby values, like appends of increasing
+   values, are fast without a hint.
+
+   @param t Tree to insert into.
+   @param hint Iterator to an element near where `e` belongs.
+   @param e Element to insert.
+
+   @return #ZIX_STATUS_SUCCESS on success, #ZIX_STATUS_EXISTS, or
+   #ZIX_STATUS_NO_MEM.
+*/
+ZIX_API ZixStatus
+zix_btree_insert_hint(ZixBTree* ZIX_NONNULL t,
+                      ZixBTreeIter          hint,
+                      void* ZIX_UNSPECIFIED e);
+
+/**
+   Function for creating a new element to insert into a tree.
+
+   @param data Opaque user data passed to zix_btree_find_or_insert().
+   @param key Search key that the new element must be equal to.
+   @param element Set to the new element.
+   @return #ZIX_STATUS_SUCCESS, or an error to return from the insertion.
+*/
+typedef ZixStatus (*ZixBTreeCreateFunc)(
+  void* ZIX_UNSPECIFIED             data,
+  const void* ZIX_UNSPECIFIED       key,
+  void* ZIX_UNSPECIFIED* ZIX_NONNULL element);
+
+/**
+   Find an element equal to `key` in `t`, or create and insert one.
+
+   This searches for `key` and, if it isn't found, calls `create` to make a
+   new element and inserts it at the position found by the same search.  This
+   avoids searching twice to insert a missing element, and the element is only
+   created if it's needed, which is useful for things like interning.
+
+   @param t Tree to search in, and insert into.
+   @param key Search key, which is compared like an element.
+   @param create Function to create a new element equal to `key`.
+   @param create_data Opaque user data passed to `create`.
+   @param ti Set to the existing or inserted element, or the end on error.
+
+   @return #ZIX_STATUS_SUCCESS if a new element was inserted,
+   #ZIX_STATUS_EXISTS if an equal element was already in the tree,
+   #ZIX_STATUS_NO_MEM, or an error returned by `create`.
+*/
+ZIX_API ZixStatus
+zix_btree_find_or_insert(ZixBTree* ZIX_NONNULL          t,
+                         const void* ZIX_UNSPECIFIED    key,
+                         ZixBTreeCreateFunc ZIX_NONNULL create,
+                         void* ZIX_UNSPECIFIED          create_data,
+                         ZixBTreeIter* ZIX_NONNULL      ti);
+
+/**
+   Function for getting the next value to load into a tree.
+
+   @param data Opaque user data passed to zix_btree_bulk_load_from().
+   @param value Set to the next value.
+   @return True if `value` was set, or false if there are no more values.
+*/
+typedef bool (*ZixBTreePullFunc)(void* ZIX_UNSPECIFIED             data,
+                                 void* ZIX_UNSPECIFIED* ZIX_NONNULL value);
+
+/**
+   Load an array of sorted values into an empty tree.
+
+   This builds the tree bottom-up in linear time, which is much faster than
+   inserting each value.  Nodes are filled to `fill` percent of their
+   capacity, from 50 to 100.  Full nodes make the smallest tree which is
+   fastest to search, but any insertion will split a node, so a lower fill
+   may be better if the tree will be modified later.
+
+   @param t Empty tree to load values into.
+   @param n_values Number of values in `values`.
+   @param values Values in strictly increasing order according to the tree's
+   comparator.
+   @param fill Percentage of each node to fill, clamped to [50, 100].
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, #ZIX_STATUS_OVERFLOW if
+   there are too many values for the maximum tree height, or
+   #ZIX_STATUS_BAD_ARG if the tree isn't empty or the values aren't strictly
+   increasing.  On error, the tree is left empty.
+*/
+ZIX_API ZixStatus
+zix_btree_bulk_load(ZixBTree* ZIX_NONNULL                     t,
+                    size_t                                    n_values,
+                    void* ZIX_UNSPECIFIED const* ZIX_NULLABLE values,
+                    unsigned                                  fill);
+
+/**
+   Load sorted values from a function into an empty tree.
+
+   This is like zix_btree_bulk_load(), but gets values from `pull` until it
+   returns false, so the number of values doesn't need to be known in advance.
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, #ZIX_STATUS_OVERFLOW if
+   there are too many values for the maximum tree height, or
+   #ZIX_STATUS_BAD_ARG if the tree isn't empty or the values aren't strictly
+   increasing.  On error, the tree is left empty.
+*/
+ZIX_API ZixStatus
+zix_btree_bulk_load_from(ZixBTree* ZIX_NONNULL        t,
+                         ZixBTreePullFunc ZIX_NONNULL pull,
+                         void* ZIX_UNSPECIFIED        pull_data,
+                         unsigned                     fill);
+
+/**
+   Load every element that is in `a` or `b` into an empty tree.
+
+   This walks both trees in order and loads the result like
+   zix_btree_bulk_load(), so it takes time proportional to the size of both
+   trees.  Elements aren't copied, so the result shares them with `a` and
+   `b`, and where both have an equal element, the one from `a` is used.
+
+   @param t Empty tree to load elements into, which must use the same
+   comparator and prefix function as `a` and `b`.
+   @param a First tree to merge.
+   @param b Second tree to merge.
+   @param fill Percentage of each node to fill, clamped to [50, 100].
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, #ZIX_STATUS_OVERFLOW if
+   there are too many elements for the maximum tree height, or
+   #ZIX_STATUS_BAD_ARG if `t` isn't empty, is `a` or `b`, or orders elements
+   differently.  On error, `t` is left empty.
+*/
+ZIX_API ZixStatus
+zix_btree_union(ZixBTree* ZIX_NONNULL       t,
+                const ZixBTree* ZIX_NONNULL a,
+                const ZixBTree* ZIX_NONNULL b,
+                unsigned                    fill);
+
+/**
+   Load every element of `a` that is also in `b` into an empty tree.
+
+   This is like zix_btree_union(), but only keeps elements in both trees.
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, #ZIX_STATUS_OVERFLOW, or
+   #ZIX_STATUS_BAD_ARG, as for zix_btree_union().
+*/
+ZIX_API ZixStatus
+zix_btree_intersection(ZixBTree* ZIX_NONNULL       t,
+                       const ZixBTree* ZIX_NONNULL a,
+                       const ZixBTree* ZIX_NONNULL b,
+                       unsigned                    fill);
+
+/**
+   Load every element of `a` that isn't in `b` into an empty tree.
+
+   This is like zix_btree_union(), but only keeps elements that are only in
+   `a`.
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, #ZIX_STATUS_OVERFLOW, or
+   #ZIX_STATUS_BAD_ARG, as for zix_btree_union().
+*/
+ZIX_API ZixStatus
+zix_btree_difference(ZixBTree* ZIX_NONNULL       t,
+                     const ZixBTree* ZIX_NONNULL a,
+                     const ZixBTree* ZIX_NONNULL b,
+                     unsigned                    fill);
+
 /**
    Remove the element `e` from `t`.
 
@@ -195,6 +425,59 @@ zix_btree_remove(ZixBTree* ZIX_NONNULL              t,
                  void* ZIX_UNSPECIFIED* ZIX_NONNULL out,
                  ZixBTreeIter* ZIX_NONNULL          next);
 
+/**
+   Remove every element in `t` that is not less than `lo` and less than `hi`.
+
+   This cuts whole subtrees out of the tree, so it takes time proportional to
+   the height of the tree and the number of nodes freed, rather than removing
+   each element in turn.
+
+   @param t Tree to erase elements from.
+   @param lo Search key for the first element to remove.
+   @param hi Search key for the first element after `lo` to keep.
+   @param destroy Function to call on every removed element, or null.
+   @param destroy_user_data Opaque user data passed to `destroy`.
+
+   @return #ZIX_STATUS_SUCCESS, or #ZIX_STATUS_NO_MEM.
+*/
+ZIX_API ZixStatus
+zix_btree_erase_range(ZixBTree* ZIX_NONNULL            t,
+                      const void* ZIX_UNSPECIFIED      lo,
+                      const void* ZIX_UNSPECIFIED      hi,
+                      ZixBTreeDestroyFunc ZIX_NULLABLE destroy,
+                      const void* ZIX_NULLABLE         destroy_user_data);
+
+/**
+   Move every element in `t` that is not less than `key` to `rhs`.
+
+   Both trees must have been created with the same allocator, comparator, and
+   prefix function, and `rhs` must be empty.  This moves whole subtrees, so
+   it takes time proportional to the height of the tree.  If the library was
+   built without `ZIX_BTREE_COUNTS` defined (the `btree_counts` build
+   option), then it also takes time to count the elements moved to `rhs`.
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, or #ZIX_STATUS_BAD_ARG if
+   the trees aren't compatible or `rhs` isn't empty.
+*/
+ZIX_API ZixStatus
+zix_btree_split(ZixBTree* ZIX_NONNULL       t,
+                const void* ZIX_UNSPECIFIED key,
+                ZixBTree* ZIX_NONNULL       rhs);
+
+/**
+   Move every element in `rhs` to the end of `lhs`.
+
+   Both trees must have been created with the same allocator, comparator, and
+   prefix function, and every element in `lhs` must be less than every
+   element in `rhs`.  The shorter tree is attached to the taller one as a
+   subtree, so this takes time proportional to the height of the trees.
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, or #ZIX_STATUS_BAD_ARG if
+   the trees aren't compatible or the elements aren't in order.
+*/
+ZIX_API ZixStatus
+zix_btree_join(ZixBTree* ZIX_NONNULL lhs, ZixBTree* ZIX_NONNULL rhs);
+
 /**
    @}
    @defgroup zix_btree_searching Searching
@@ -225,7 +508,8 @@ zix_btree_find(const ZixBTree* ZIX_NONNULL t,
    will be set to the least such element.
 
    The comparator is always called with an actual value in the tree as the
-   first argument, and `key` as the second argument.
+   first argument, and `key` as the second argument.  If it is null, then the
+   tree's own ordering is used.
 
    @return #ZIX_STATUS_SUCCESS.
 */
@@ -236,6 +520,44 @@ zix_btree_lower_bound(const ZixBTree* ZIX_NONNULL      t,
                       const void* ZIX_UNSPECIFIED      key,
                       ZixBTreeIter* ZIX_NONNULL        ti);
 
+/**
+   Return the number of elements in `t` that are less than `e`.
+
+   If `e` is in the tree, this is its position in order, starting from zero.
+
+   This takes logarithmic time if the library was built with
+   `ZIX_BTREE_COUNTS` defined (the `btree_counts` build option), which stores
+   the size of every subtree in its parent, otherwise it takes linear time.
+*/
+ZIX_API size_t
+zix_btree_rank(const ZixBTree* ZIX_NONNULL t, const void* ZIX_UNSPECIFIED e);
+
+/**
+   Set `ti` to the element at position `index` in `t`, counting from zero.
+
+   Like zix_btree_rank(), this only takes logarithmic time if the library was
+   built with `ZIX_BTREE_COUNTS` defined.
+
+   @return #ZIX_STATUS_SUCCESS, or #ZIX_STATUS_NOT_FOUND if `index` isn't less
+   than the size of the tree, in which case `ti` is set to the end.
+*/
+ZIX_API ZixStatus
+zix_btree_select(const ZixBTree* ZIX_NONNULL t,
+                 size_t                      index,
+                 ZixBTreeIter* ZIX_NONNULL   ti);
+
+/**
+   Return the number of elements in `t` from `first` up to (but not including)
+   `last`.
+
+   This is equivalent to the difference between their ranks, or zero if
+   `last` isn't greater than `first`.
+*/
+ZIX_API size_t
+zix_btree_count_range(const ZixBTree* ZIX_NONNULL t,
+                      const void* ZIX_UNSPECIFIED first,
+                      const void* ZIX_UNSPECIFIED last);
+
 /**
    @}
    @}
@@ -0,0 +1,199 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_CONCURRENT_HASH_H
+#define ZIX_CONCURRENT_HASH_H
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <stddef.h>
+
+ZIX_BEGIN_DECLS
+
+/**
+   @defgroup zix_concurrent_hash Concurrent Hash
+   @ingroup zix_data_structures
+   @{
+*/
+
+/**
+   @defgroup zix_concurrent_hash_setup Setup
+   @{
+*/
+
+/**
+   A hash table that can be searched by many threads while one modifies it.
+
+   This is an open addressing hash table like #ZixHash, with the same records,
+   keys, and user functions, but which is thread-safe for a single writer and
+   any number of readers.  Readers never take locks or block, so searching is
+   lock-free.  Entering and leaving a read section writes to a counter, but
+   readers on different threads usually use counters on different cache lines,
+   so they rarely contend with each other.
+
+   Every search must happen within a read section, which is delimited by
+   zix_concurrent_hash_begin_read() and zix_concurrent_hash_end_read().  When
+   the table is resized, the writer publishes the new array atomically, then
+   waits for all read sections that may still be using the old one to end
+   before freeing it.  Read sections should therefore be short.  The writer
+   may search without entering a read section, but must never modify the
+   table from within one, since it would wait for itself forever.
+
+   The same mechanism is available to the user via
+   zix_concurrent_hash_synchronize(), which can be used to safely destroy
+   records after they have been removed from the table.
+
+   Removal leaves a tombstone in place of the record, which is cleared the
+   next time the table is rehashed.  Modification is therefore slower than
+   with #ZixHash, and reading is only guaranteed to be consistent for a
+   single record: a concurrent search will either find a record, or not, but
+   never see a partially inserted one.
+*/
+typedef struct ZixConcurrentHashImpl ZixConcurrentHash;
+
+/**
+   Create a new concurrent hash table.
+
+   This function is not thread-safe.
+
+   @param allocator Allocator used for the table and its arrays.
+   @param key_func A function to retrieve the key from a record.
+   @param hash_func The key hashing function.
+   @param equal_func A function to test keys for equality.
+*/
+ZIX_API ZIX_NODISCARD ZixConcurrentHash* ZIX_ALLOCATED
+zix_concurrent_hash_new(ZixAllocator* ZIX_NULLABLE  allocator,
+                        ZixKeyFunc ZIX_NONNULL      key_func,
+                        ZixHashFunc ZIX_NONNULL     hash_func,
+                        ZixKeyEqualFunc ZIX_NONNULL equal_func);
+
+/**
+   Free a concurrent hash table.
+
+   This function is not thread-safe, no reader may be using the table.
+*/
+ZIX_API void
+zix_concurrent_hash_free(ZixConcurrentHash* ZIX_NULLABLE hash);
+
+/**
+   Return the number of elements in a concurrent hash table.
+
+   This may be called by any thread, but the result may be out of date by the
+   time it is returned if the writer is concurrently modifying the table.
+*/
+ZIX_API size_t
+zix_concurrent_hash_size(const ZixConcurrentHash* ZIX_NONNULL hash);
+
+/**
+   @}
+   @defgroup zix_concurrent_hash_reading Reading
+   @{
+*/
+
+/**
+   Begin a read section.
+
+   Searches may only be made within a read section, and any records found may
+   only be accessed until the section ends.  This is lock-free and wait-free,
+   so is realtime-safe, but it does increment a counter which may be shared
+   with readers on other threads.
+
+   @return A token which must be passed to zix_concurrent_hash_end_read().
+*/
+ZIX_API unsigned
+zix_concurrent_hash_begin_read(ZixConcurrentHash* ZIX_NONNULL hash);
+
+/**
+   End a read section.
+
+   @param hash The hash table.
+   @param token The token returned by the matching call to
+   zix_concurrent_hash_begin_read().
+*/
+ZIX_API void
+zix_concurrent_hash_end_read(ZixConcurrentHash* ZIX_NONNULL hash,
+                             unsigned                       token);
+
+/**
+   Find a record with a given key.
+
+   This may be called by any thread, but only within a read section.
+
+   @param hash The hash table to search.
+   @param key The key of the desired record.
+   @return A pointer to the matching record, or null if no such record exists.
+*/
+ZIX_API ZixHashRecord* ZIX_NULLABLE
+zix_concurrent_hash_find(const ZixConcurrentHash* ZIX_NONNULL hash,
+                         const ZixHashKey* ZIX_NONNULL        key);
+
+/**
+   @}
+   @defgroup zix_concurrent_hash_writing Writing
+   @{
+*/
+
+/**
+   Insert a record.
+
+   This may only be called by the writer, and may block until all readers of
+   the previous array have finished if the table needs to be resized.
+
+   @param hash The hash table.
+   @param record The record to insert, which must not change while in the
+   table.
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_EXISTS if a record already exists
+   at this key, or #ZIX_STATUS_NO_MEM if growing the table failed.
+*/
+ZIX_API ZixStatus
+zix_concurrent_hash_insert(ZixConcurrentHash* ZIX_NONNULL hash,
+                           ZixHashRecord* ZIX_NONNULL     record);
+
+/**
+   Remove a record.
+
+   This may only be called by the writer, and may block until all readers of
+   the previous array have finished if the table needs to be shrunk.  Readers
+   may still be accessing the removed record, so it must not be destroyed
+   until after a call to zix_concurrent_hash_synchronize().
+
+   @param hash The hash table.
+   @param key The key of the record to remove.
+   @param removed Set to the removed record, or null.
+   @return #ZIX_STATUS_SUCCESS or #ZIX_STATUS_NOT_FOUND.
+*/
+ZIX_API ZixStatus
+zix_concurrent_hash_remove(ZixConcurrentHash* ZIX_NONNULL           hash,
+                           const ZixHashKey* ZIX_NONNULL            key,
+                           ZixHashRecord* ZIX_NULLABLE* ZIX_NONNULL removed);
+
+/**
+   Wait until all current read sections have ended.
+
+   This may only be called by the writer.  When it returns, no reader can be
+   accessing a record that was removed before the call, so it is safe to
+   destroy them.  This is not realtime-safe, since it spins until readers have
+   left their read section, but it doesn't prevent readers from entering new
+   ones.
+
+   Note that the writer may spin for as long as a reader stays inside a read
+   section, including while that reader is preempted.  In particular, if a
+   realtime reader shares a CPU with the writer, a read section that's
+   interrupted by the writer at a higher priority will never end.  Read
+   sections should be short, and the writer should not have a higher priority
+   than any reader that can run on the same CPU.
+*/
+ZIX_API void
+zix_concurrent_hash_synchronize(ZixConcurrentHash* ZIX_NONNULL hash);
+
+/**
+   @}
+   @}
+*/
+
+ZIX_END_DECLS
+
+#endif /* ZIX_CONCURRENT_HASH_H */
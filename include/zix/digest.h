@@ -1,4 +1,4 @@
-// Copyright 2012-2022 David Robillard <d@drobilla.net>
+// Copyright 2012-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #ifndef ZIX_DIGEST_H
@@ -19,7 +19,9 @@ ZIX_BEGIN_DECLS
 
    These are good general-purpose hash functions for indexing arbitrary data,
    but are not necessarily stable across platforms and should never be used for
-   cryptographic purposes.
+   cryptographic purposes.  The unkeyed functions are fast, but collisions can
+   be deliberately generated for them regardless of the seed, so
+   zix_digest_keyed64() should be used to hash keys from untrusted sources.
 
    @{
 */
@@ -58,6 +60,29 @@ zix_digest64(uint64_t seed, const void* ZIX_NONNULL buf, size_t len);
 ZIX_PURE_API uint64_t
 zix_digest64_aligned(uint64_t seed, const void* ZIX_NONNULL buf, size_t len);
 
+/// A secret 128-bit key for zix_digest_keyed64()
+typedef struct {
+  uint64_t k0; ///< First 64 bits of the key
+  uint64_t k1; ///< Second 64 bits of the key
+} ZixDigestKey;
+
+/**
+   Return a keyed 64-bit hash of a buffer.
+
+   This is SipHash-2-4, a pseudorandom function of the key and buffer.  As
+   long as the key is random and kept secret, it's not practical to find
+   inputs that collide, so this can be used to index data that may be crafted
+   by an attacker to degrade a hash table's performance.  It is, however,
+   several times slower than zix_digest64().
+
+   This can be used for any size or alignment, and returns the same value on
+   all platforms.
+*/
+ZIX_PURE_API uint64_t
+zix_digest_keyed64(const ZixDigestKey* ZIX_NONNULL key,
+                   const void* ZIX_NONNULL         buf,
+                   size_t                          len);
+
 /**
    Return a pointer-sized hash of a buffer.
 
@@ -0,0 +1,173 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_FLAT_HASH_H
+#define ZIX_FLAT_HASH_H
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <stddef.h>
+
+ZIX_BEGIN_DECLS
+
+/**
+   @defgroup zix_flat_hash Flat Hash
+   @ingroup zix_data_structures
+   @{
+*/
+
+/**
+   @defgroup zix_flat_hash_setup Setup
+   @{
+*/
+
+/**
+   A hash table that stores fixed-size records directly in its array.
+
+   This is like #ZixHash, but instead of storing pointers to records, each
+   entry contains a copy of a record of a size given when the table is
+   created.  This avoids allocating every record separately, and following a
+   pointer to compare keys while searching, so it is more efficient for small
+   records like integers or small structures.
+
+   Each entry also has a 1-byte tag with 7 bits of the hash code, so keys are
+   rarely compared unless they match.  Hash codes are not stored, so they
+   are recalculated when the table is resized.
+
+   Since records are stored in the table, any modification may move them, so
+   pointers to records are only valid until the table is next modified.
+*/
+typedef struct ZixFlatHashImpl ZixFlatHash;
+
+/// An iterator to an entry in a flat hash table
+typedef size_t ZixFlatHashIter;
+
+/**
+   Create a new flat hash table.
+
+   @param allocator Allocator used for the table and its array.
+   @param record_size The size of a record in bytes.
+   @param record_align The alignment of a record in bytes, which must be a
+   power of 2 that is no larger than the alignment of any built-in type.
+   @param key_func A function to retrieve the key from a record.
+   @param hash_func The key hashing function.
+   @param equal_func A function to test keys for equality.
+   @return A new hash table, or null on allocation failure or if the record
+   size or alignment is invalid.
+*/
+ZIX_API ZIX_NODISCARD ZixFlatHash* ZIX_ALLOCATED
+zix_flat_hash_new(ZixAllocator* ZIX_NULLABLE  allocator,
+                  size_t                      record_size,
+                  size_t                      record_align,
+                  ZixKeyFunc ZIX_NONNULL      key_func,
+                  ZixHashFunc ZIX_NONNULL     hash_func,
+                  ZixKeyEqualFunc ZIX_NONNULL equal_func);
+
+/// Free a flat hash table
+ZIX_API void
+zix_flat_hash_free(ZixFlatHash* ZIX_NULLABLE hash);
+
+/// Return the number of elements in a flat hash table
+ZIX_PURE_API size_t
+zix_flat_hash_size(const ZixFlatHash* ZIX_NONNULL hash);
+
+/**
+   @}
+   @defgroup zix_flat_hash_iteration Iteration
+   @{
+*/
+
+/// Return an iterator to the first record in a flat hash table
+ZIX_PURE_API ZixFlatHashIter
+zix_flat_hash_begin(const ZixFlatHash* ZIX_NONNULL hash);
+
+/// Return an iterator one past the last possible record in a flat hash table
+ZIX_PURE_API ZixFlatHashIter
+zix_flat_hash_end(const ZixFlatHash* ZIX_NONNULL hash);
+
+/// Return the record pointed to by an iterator
+ZIX_PURE_API ZixHashRecord* ZIX_NULLABLE
+zix_flat_hash_get(const ZixFlatHash* ZIX_NONNULL hash, ZixFlatHashIter i);
+
+/// Return an iterator that has been advanced to the next record
+ZIX_PURE_API ZixFlatHashIter
+zix_flat_hash_next(const ZixFlatHash* ZIX_NONNULL hash, ZixFlatHashIter i);
+
+/**
+   @}
+   @defgroup zix_flat_hash_modification Modification
+   @{
+*/
+
+/**
+   Insert a copy of a record.
+
+   @param hash The hash table.
+   @param record The record to copy into the table.
+   @param inserted If not null, set to the record in the table, which is the
+   existing one if a record with an equal key is already present.
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_EXISTS if a record already exists
+   at this key, or #ZIX_STATUS_NO_MEM if growing the table failed.
+*/
+ZIX_API ZixStatus
+zix_flat_hash_insert(ZixFlatHash* ZIX_NONNULL                  hash,
+                     const ZixHashRecord* ZIX_NONNULL          record,
+                     ZixHashRecord* ZIX_NULLABLE* ZIX_NULLABLE inserted);
+
+/**
+   Erase the record pointed to by an iterator.
+
+   This may shrink the table, which invalidates all iterators.
+
+   @return #ZIX_STATUS_SUCCESS, or #ZIX_STATUS_BAD_ARG if `i` does not point
+   at a record.
+*/
+ZIX_API ZixStatus
+zix_flat_hash_erase(ZixFlatHash* ZIX_NONNULL hash, ZixFlatHashIter i);
+
+/**
+   Remove the record with a given key.
+
+   @return #ZIX_STATUS_SUCCESS or #ZIX_STATUS_NOT_FOUND.
+*/
+ZIX_API ZixStatus
+zix_flat_hash_remove(ZixFlatHash* ZIX_NONNULL      hash,
+                     const ZixHashKey* ZIX_NONNULL key);
+
+/**
+   @}
+   @defgroup zix_flat_hash_searching Searching
+   @{
+*/
+
+/**
+   Find the entry for a given key.
+
+   @return An iterator to the matching record, or zix_flat_hash_end() if no
+   such record exists.
+*/
+ZIX_API ZixFlatHashIter
+zix_flat_hash_find(const ZixFlatHash* ZIX_NONNULL hash,
+                   const ZixHashKey* ZIX_NONNULL  key);
+
+/**
+   Find a record with a given key.
+
+   @return A pointer to the matching record in the table, or null if no such
+   record exists.
+*/
+ZIX_API ZixHashRecord* ZIX_NULLABLE
+zix_flat_hash_find_record(const ZixFlatHash* ZIX_NONNULL hash,
+                          const ZixHashKey* ZIX_NONNULL  key);
+
+/**
+   @}
+   @}
+*/
+
+ZIX_END_DECLS
+
+#endif /* ZIX_FLAT_HASH_H */
@@ -1,4 +1,4 @@
-// Copyright 2011-2022 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #ifndef ZIX_HASH_H
@@ -6,6 +6,7 @@
 
 #include <zix/allocator.h>
 #include <zix/attributes.h>
+#include <zix/digest.h>
 #include <zix/status.h>
 
 #include <stdbool.h>
@@ -71,9 +72,70 @@ typedef void ZixHashSearchData; ///< User data for key comparison function
    reduction may be a better choice there, at the cost of requiring 128-bit
    arithmetic on 64-bit platforms, and indexing operations being slightly more
    expensive.
+
+   Several internal layouts are available, see #ZixHashLayout.  These only
+   affect performance, the API and behaviour are otherwise identical.
 */
 typedef struct ZixHashImpl ZixHash;
 
+/**
+   The internal layout of a hash table.
+
+   The layout determines how entries are stored and searched, which can have a
+   significant impact on performance, particularly for large tables where
+   lookups are dominated by cache misses.
+*/
+typedef enum {
+  /**
+     Probe entries one at a time.
+
+     This is the simplest layout, which stores only an array of entries, each
+     of which contains the full hash code and a pointer to the record.  It is a
+     good choice for small tables.
+  */
+  ZIX_HASH_LINEAR,
+
+  /**
+     Probe groups of 1-byte tags.
+
+     This layout stores an additional array with a 1-byte tag for every entry,
+     which contains 7 bits of the hash code.  Searching checks the tags for a
+     whole group of 16 entries at once (with SIMD instructions where
+     available), and only accesses entries with a matching tag.  This reduces
+     the number of cache misses for large tables, at the cost of an extra byte
+     per entry and a minimum table size of 16 entries.
+  */
+  ZIX_HASH_GROUPED,
+
+  /**
+     Probe entries one at a time, keeping them ordered by displacement.
+
+     This layout stores the same array of entries as #ZIX_HASH_LINEAR, but
+     insertion uses "Robin Hood" hashing: a new entry takes the place of any
+     entry that is closer to its ideal position, which is then shifted along.
+     This bounds the variance of probe lengths, and allows failed searches to
+     stop early.  Erasing a record shifts the following entries back instead
+     of leaving a tombstone, so probe lengths don't grow with repeated
+     insertion and removal.  Note that this moves other records, so erasing
+     invalidates all iterators.
+  */
+  ZIX_HASH_ROBIN_HOOD,
+
+  /**
+     Probe small indices into a dense array of entries in insertion order.
+
+     This layout stores entries in an array in the order they were inserted,
+     and probes a separate array of indices into it, which are 1, 2, 4, or 8
+     bytes wide depending on the table size.  The entry array is only as large
+     as the maximum load, so this uses less memory than the other layouts,
+     and iteration visits records in insertion order without scanning empty
+     entries.  Erasing a record leaves a hole in the entry array until the
+     table is next resized, which compacts it.  Resizing is never incremental
+     with this layout.
+  */
+  ZIX_HASH_COMPACT,
+} ZixHashLayout;
+
 /// A full hash code for a key which is not folded down to the table size
 typedef size_t ZixHashCode;
 
@@ -90,6 +152,10 @@ typedef const ZixHashKey* ZIX_NONNULL (*ZixKeyFunc)(
 /// User function for computing the hash of a key
 typedef ZixHashCode (*ZixHashFunc)(const ZixHashKey* ZIX_NONNULL key);
 
+/// User function for computing the hash of a key with a secret seed
+typedef ZixHashCode (*ZixSeededHashFunc)(const ZixHashKey* ZIX_NONNULL   key,
+                                         const ZixDigestKey* ZIX_NONNULL seed);
+
 /// User function for determining if two keys are truly equal
 typedef bool (*ZixKeyEqualFunc)(const ZixHashKey* ZIX_NONNULL a,
                                 const ZixHashKey* ZIX_NONNULL b);
@@ -108,6 +174,118 @@ zix_hash_new(ZixAllocator* ZIX_NULLABLE  allocator,
              ZixHashFunc ZIX_NONNULL     hash_func,
              ZixKeyEqualFunc ZIX_NONNULL equal_func);
 
+/**
+   Create a new hash table with a specific internal layout.
+
+   This is the same as zix_hash_new(), which uses #ZIX_HASH_LINEAR, but allows
+   a different layout to be used.
+
+   @param allocator Allocator used for the internal array.
+   @param layout The internal layout of the table.
+   @param key_func A function to retrieve the key from a record.
+   @param hash_func The key hashing function.
+   @param equal_func A function to test keys for equality.
+*/
+ZIX_API ZIX_NODISCARD ZixHash* ZIX_ALLOCATED
+zix_hash_new_with_layout(ZixAllocator* ZIX_NULLABLE  allocator,
+                         ZixHashLayout               layout,
+                         ZixKeyFunc ZIX_NONNULL      key_func,
+                         ZixHashFunc ZIX_NONNULL     hash_func,
+                         ZixKeyEqualFunc ZIX_NONNULL equal_func);
+
+/**
+   Create a new hash table that hashes keys with a random secret seed.
+
+   This is the same as zix_hash_new_with_layout(), except every table gets a
+   seed from the system's secure random source, which is passed to the hash
+   function along with the key.  With a keyed hash function like
+   zix_digest_keyed64(), this makes it impractical for an attacker who can
+   choose keys to make them collide, which would otherwise degrade searches
+   to a linear scan of the table.
+
+   @param allocator Allocator used for the internal array.
+   @param layout The internal layout of the table.
+   @param key_func A function to retrieve the key from a record.
+   @param hash_func The key hashing function, which takes the seed.
+   @param equal_func A function to test keys for equality.
+   @return A new table, or null if memory or a random seed couldn't be
+   allocated.
+*/
+ZIX_API ZIX_NODISCARD ZixHash* ZIX_ALLOCATED
+zix_hash_new_seeded(ZixAllocator* ZIX_NULLABLE    allocator,
+                    ZixHashLayout                 layout,
+                    ZixKeyFunc ZIX_NONNULL        key_func,
+                    ZixSeededHashFunc ZIX_NONNULL hash_func,
+                    ZixKeyEqualFunc ZIX_NONNULL   equal_func);
+
+/**
+   Return the seed that a table passes to its hash function.
+
+   This can be used to calculate hash codes for
+   zix_hash_plan_insert_prehashed() or zix_hash_find_batch().
+
+   @return The seed of a table created with zix_hash_new_seeded(), or null.
+*/
+ZIX_PURE_API const ZixDigestKey* ZIX_NULLABLE
+zix_hash_seed(const ZixHash* ZIX_NONNULL hash);
+
+/**
+   Set whether a hash table is resized incrementally.
+
+   By default, when a table grows or shrinks, every record is moved to a new
+   array in a single operation, which can take a long time for large tables.
+   In incremental mode, the old array is kept after resizing, and a small
+   number of entries are moved from it to the new one on every insertion or
+   removal.  This bounds the time taken by any single modification, at the
+   cost of higher peak memory consumption, and slightly slower searches while
+   both arrays must be searched.
+
+   Disabling incremental mode finishes any ongoing resize immediately.  This
+   has no effect with the #ZIX_HASH_COMPACT layout, which always resizes in a
+   single operation.
+*/
+ZIX_API void
+zix_hash_set_incremental(ZixHash* ZIX_NONNULL hash, bool incremental);
+
+/**
+   Set how empty a hash table must be to automatically shrink.
+
+   When a removal leaves fewer than `n_entries / divisor` records, the table
+   is shrunk to half its size.  The default divisor is 4, the minimum, which
+   keeps the table reasonably compact but may resize repeatedly if the number
+   of records oscillates around a threshold.  A larger divisor widens the
+   range of sizes that don't cause a resize, and zero disables automatic
+   shrinking entirely (see zix_hash_shrink_to_fit()).
+
+   @return #ZIX_STATUS_SUCCESS, or #ZIX_STATUS_BAD_ARG if `divisor` is
+   non-zero and less than 4.
+*/
+ZIX_API ZixStatus
+zix_hash_set_shrink_divisor(ZixHash* ZIX_NONNULL hash, unsigned divisor);
+
+/**
+   Reserve space for a number of records.
+
+   This grows the table if necessary, so that at least `n_records` can be
+   stored without resizing again.  It is useful before inserting many records
+   at once, to avoid growing repeatedly as they are inserted.
+
+   @return #ZIX_STATUS_SUCCESS, or #ZIX_STATUS_NO_MEM if allocation failed.
+*/
+ZIX_API ZixStatus
+zix_hash_reserve(ZixHash* ZIX_NONNULL hash, size_t n_records);
+
+/**
+   Shrink a hash table to the smallest size that fits its records.
+
+   This also finishes any ongoing incremental resize, so that only one
+   internal array is allocated.
+
+   @return #ZIX_STATUS_SUCCESS, or #ZIX_STATUS_NO_MEM if allocation failed.
+*/
+ZIX_API ZixStatus
+zix_hash_shrink_to_fit(ZixHash* ZIX_NONNULL hash);
+
 /// Free `hash`
 ZIX_API void
 zix_hash_free(ZixHash* ZIX_NULLABLE hash);
@@ -260,6 +438,45 @@ zix_hash_insert_at(ZixHash* ZIX_NONNULL       hash,
 ZIX_API ZixStatus
 zix_hash_insert(ZixHash* ZIX_NONNULL hash, ZixHashRecord* ZIX_NONNULL record);
 
+/**
+   Insert many records at once.
+
+   This is equivalent to calling zix_hash_insert() for every record, but much
+   faster for large arrays, since the table is only resized once.  If the
+   table is empty, then the work is split between several threads (if the
+   library was built with thread support): records are hashed in parallel,
+   then divided by their position in the table so that separate ranges can be
+   filled concurrently.  This means that the key, hash, and equality functions
+   may be called from several threads at once.
+
+   A table with the #ZIX_HASH_COMPACT layout is always built in the calling
+   thread, since records are stored in insertion order, so `n_threads` is
+   ignored.
+
+   If several records have equal keys, then only the first one is inserted,
+   as with zix_hash_insert().
+
+   @param hash The hash table.
+
+   @param n_records The number of records to insert.
+
+   @param records Array of `n_records` records to insert which, on success,
+   can now be considered owned by the hash table.
+
+   @param n_threads The maximum number of threads to use, including the
+   calling thread.  Zero or one builds the table in the calling thread only.
+   This is ignored for the #ZIX_HASH_COMPACT layout.
+
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_EXISTS if any records weren't
+   inserted because their keys were already present, or #ZIX_STATUS_NO_MEM
+   (in which case the table is unchanged).
+*/
+ZIX_API ZixStatus
+zix_hash_build(ZixHash* ZIX_NONNULL                           hash,
+               size_t                                         n_records,
+               ZixHashRecord* ZIX_NONNULL const* ZIX_NULLABLE records,
+               unsigned                                       n_threads);
+
 /**
    Erase a record at a specific position.
 
@@ -312,6 +529,23 @@ ZIX_API ZixHashIter
 zix_hash_find(const ZixHash* ZIX_NONNULL    hash,
               const ZixHashKey* ZIX_NONNULL key);
 
+/**
+   Find the position of a record with a custom search.
+
+   This is like zix_hash_find(), but takes a precalculated hash code and a
+   custom search predicate, which must be compatible with the hash table as
+   described for zix_hash_plan_insert_prehashed().  The returned iterator can
+   be used with zix_hash_erase().
+
+   @return An iterator to the matching record, or the end iterator if no such
+   record exists.
+*/
+ZIX_API ZixHashIter
+zix_hash_find_prehashed(const ZixHash* ZIX_NONNULL            hash,
+                        ZixHashCode                           code,
+                        ZixKeyMatchFunc ZIX_NONNULL           predicate,
+                        const ZixHashSearchData* ZIX_NULLABLE user_data);
+
 /**
    Find a record with a given key.
 
@@ -328,6 +562,95 @@ ZIX_API ZixHashRecord* ZIX_NULLABLE
 zix_hash_find_record(const ZixHash* ZIX_NONNULL    hash,
                      const ZixHashKey* ZIX_NONNULL key);
 
+/**
+   Find the records for many keys at once.
+
+   This is equivalent to calling zix_hash_find_record() for every key, but
+   faster for large tables, since the table is accessed in a way that allows
+   several cache misses to be resolved at once.
+
+   @param hash The hash table to search.
+
+   @param n_keys The number of keys to search for.
+
+   @param keys Array of `n_keys` keys of the desired records.
+
+   @param codes Optional array of `n_keys` precomputed hash codes of `keys`.
+   If this is null, then codes are computed with the hash function.
+
+   @param records Array of `n_keys` pointers which will be set to the matching
+   record for each key, or null if no such record exists.
+
+   @return The number of records that were found.
+*/
+ZIX_API size_t
+zix_hash_find_batch(const ZixHash* ZIX_NONNULL                        hash,
+                    size_t                                            n_keys,
+                    const ZixHashKey* ZIX_NONNULL const* ZIX_NULLABLE keys,
+                    const ZixHashCode* ZIX_NULLABLE                   codes,
+                    ZixHashRecord* ZIX_NULLABLE* ZIX_NULLABLE         records);
+
+/**
+   @}
+   @defgroup zix_hash_statistics Statistics
+   @{
+*/
+
+/// The number of probe lengths counted in ZixHashStats::probe_lengths
+#define ZIX_HASH_N_PROBE_LENGTHS 16U
+
+/**
+   Statistics about the internal state of a hash table.
+
+   Probe lengths are measured in the number of steps taken by a search, where
+   a step examines one entry, or one group of entries with the
+   #ZIX_HASH_GROUPED layout.  Displacements are measured in entries from the
+   position a record's hash code maps to.  During an incremental resize,
+   entries in both arrays are included, but miss lengths are only for the new
+   array.
+
+   The lookup counters are only maintained if the library was built with
+   `ZIX_HASH_COUNTERS` defined (the `hash_counters` build option), otherwise
+   they are always zero.  They count every search for a key since the table
+   was created, and aren't updated atomically, so may be inaccurate if the
+   table is searched from several threads at once.
+*/
+typedef struct {
+  size_t n_entries;         ///< Total number of entries in the table
+  size_t n_tombstones;      ///< Number of entries with removed records
+  double mean_probe_length; ///< Mean probe length to find a present record
+  size_t max_probe_length;  ///< Maximum probe length to find a present record
+  double mean_miss_length;  ///< Mean probe length for a missing record
+  size_t max_miss_length;   ///< Maximum probe length for a missing record
+  double mean_displacement; ///< Mean displacement of a present record
+  size_t max_displacement;  ///< Maximum displacement of a present record
+  double load_factor;       ///< Ratio of records to entries
+  size_t n_resizes;         ///< Number of times the table has been resized
+  size_t n_bytes;           ///< Total size of allocated memory in bytes
+  size_t n_lookups;         ///< Number of searches for a key
+  size_t n_hits;            ///< Number of searches that found a record
+  size_t n_misses;          ///< Number of searches that found nothing
+
+  /**
+     Histogram of probe lengths to find every present record.
+
+     Element `i` is the number of records with a probe length of `i + 1`,
+     except the last, which counts all longer probe lengths as well.
+  */
+  size_t probe_lengths[ZIX_HASH_N_PROBE_LENGTHS];
+} ZixHashStats;
+
+/**
+   Calculate statistics about the internal state of a hash table.
+
+   This scans the whole table, so takes linear time.  It is intended for
+   diagnostics and tuning, not for use in performance-critical code.  The
+   probe length histogram and displacements can reveal a poor hash function,
+   which causes records to cluster together, as long probe sequences.
+*/
+ZIX_PURE_API ZixHashStats
+zix_hash_stats(const ZixHash* ZIX_NONNULL hash);
+
 /**
    @}
    @}
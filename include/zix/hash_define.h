@@ -0,0 +1,344 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_HASH_DEFINE_H
+#define ZIX_HASH_DEFINE_H
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+   @defgroup zix_hash_define Type-Specialized Hash
+   @ingroup zix_hash
+   @{
+*/
+
+/// Hash code of an entry that has never been used
+#define ZIX_HASH_DEFINE_EMPTY 0U
+
+/// Hash code of an entry whose record has been removed
+#define ZIX_HASH_DEFINE_DELETED 1U
+
+/// Bit set in the hash code of every entry that contains a record
+#define ZIX_HASH_DEFINE_FULL (~(SIZE_MAX >> 1U))
+
+/// Minimum number of entries in a table that has been allocated
+#define ZIX_HASH_DEFINE_MIN_N_ENTRIES 4U
+
+/**
+   Return the number of records that makes a table of a given size grow.
+
+   This is the same load factor that the other hash tables use internally.
+*/
+ZIX_CONST_FUNC static inline size_t
+zix_hash_define_max_load(const size_t n_entries)
+{
+  return (n_entries / 2U) + (n_entries / 8U);
+}
+
+/// Return the smallest table size that can hold some number of records
+ZIX_CONST_FUNC static inline size_t
+zix_hash_define_fit(const size_t n_records)
+{
+  size_t n_entries = ZIX_HASH_DEFINE_MIN_N_ENTRIES;
+  while (zix_hash_define_max_load(n_entries) <= n_records) {
+    n_entries <<= 1U;
+  }
+
+  return n_entries;
+}
+
+/**
+   Define a hash table specialized for particular key and record types.
+
+   This expands to a type called `name`, and a set of static inline functions
+   prefixed with `name`, that implement the same algorithm as ZixHash with the
+   default #ZIX_HASH_LINEAR layout.  Unlike ZixHash, keys and records are
+   stored inline in the table rather than accessed through a pointer, and the
+   hash and equality functions are called directly, so the compiler can inline
+   everything into the probing loop.  This is intended for small keys like
+   integers and pointers, where calling functions through pointers and
+   chasing a pointer to every record dominates the cost of a lookup.
+
+   The table is allocated on the first insertion.  Entry indices, like
+   ZixHashIter, are invalidated by any insertion or removal, as is any record
+   pointer returned by `name_get()` or `name_find_record()`.
+
+   The defined functions are:
+
+   - `name* name_new(ZixAllocator* allocator)`
+   - `void name_free(name* table)`
+   - `size_t name_size(const name* table)`
+   - `ZixHashIter name_begin(const name* table)`
+   - `ZixHashIter name_end(const name* table)`
+   - `ZixHashIter name_next(const name* table, ZixHashIter i)`
+   - `const key_type* name_key(const name* table, ZixHashIter i)`
+   - `record_type* name_get(const name* table, ZixHashIter i)`
+   - `ZixHashIter name_find(const name* table, key_type key)`
+   - `record_type* name_find_record(const name* table, key_type key)`
+   - `ZixStatus name_reserve(name* table, size_t n_records)`
+   - `ZixStatus name_insert(name* table, key_type key, record_type record)`
+   - `ZixStatus name_erase(name* table, ZixHashIter i)`
+   - `ZixStatus name_remove(name* table, key_type key, record_type* removed)`
+
+   These behave like the ZixHash functions of the same name, except
+   `name_insert()` takes a key and record by value and returns
+   #ZIX_STATUS_EXISTS without modifying the table if the key is already
+   present, and `name_remove()` copies the removed record to `removed` if it
+   is not null.
+
+   @param name Name of the table type, and prefix for its functions.
+   Since parameters and return types are declared like `const key_type`, the
+   key and record types must be single type names, so pointer types need a
+   typedef.
+
+   @param key_type Type of keys, which must be cheap to copy.
+   @param record_type Type of records, which are stored by value.
+   @param hash_fn Function or macro to hash a key to a ZixHashCode.
+   @param equal_fn Function or macro to test two keys for equality.
+*/
+#define ZIX_HASH_DEFINE(name, key_type, record_type, hash_fn, equal_fn)        \
+  typedef struct {                                                             \
+    ZixHashCode code;                                                          \
+    key_type    key;                                                           \
+    record_type record;                                                        \
+  } name##Entry;                                                               \
+                                                                               \
+  typedef struct {                                                             \
+    ZixAllocator* allocator;                                                   \
+    name##Entry*  entries;                                                     \
+    size_t        mask;                                                        \
+    size_t        n_entries;                                                   \
+    size_t        count;                                                       \
+  } name;                                                                      \
+                                                                               \
+  static inline name* name##_new(ZixAllocator* const allocator)                \
+  {                                                                            \
+    name* const table = (name*)zix_malloc(allocator, sizeof(name));            \
+    if (table) {                                                               \
+      table->allocator = allocator;                                            \
+      table->entries   = NULL;                                                 \
+      table->mask      = 0U;                                                   \
+      table->n_entries = 0U;                                                   \
+      table->count     = 0U;                                                   \
+    }                                                                          \
+                                                                               \
+    return table;                                                              \
+  }                                                                            \
+                                                                               \
+  static inline void name##_free(name* const table)                            \
+  {                                                                            \
+    if (table) {                                                               \
+      zix_free(table->allocator, table->entries);                              \
+      zix_free(table->allocator, table);                                       \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  static inline size_t name##_size(const name* const table)                    \
+  {                                                                            \
+    return table->count;                                                       \
+  }                                                                            \
+                                                                               \
+  static inline ZixHashIter name##_scan(const name* const table, size_t i)     \
+  {                                                                            \
+    while (i < table->n_entries &&                                             \
+           !(table->entries[i].code & ZIX_HASH_DEFINE_FULL)) {                 \
+      ++i;                                                                     \
+    }                                                                          \
+                                                                               \
+    return i;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline ZixHashIter name##_begin(const name* const table)              \
+  {                                                                            \
+    return name##_scan(table, 0U);                                             \
+  }                                                                            \
+                                                                               \
+  static inline ZixHashIter name##_end(const name* const table)                \
+  {                                                                            \
+    return table->n_entries;                                                   \
+  }                                                                            \
+                                                                               \
+  static inline ZixHashIter name##_next(const name* const table,               \
+                                        const ZixHashIter i)                   \
+  {                                                                            \
+    return name##_scan(table, i + 1U);                                         \
+  }                                                                            \
+                                                                               \
+  static inline const key_type* name##_key(const name* const table,            \
+                                           const ZixHashIter i)                \
+  {                                                                            \
+    return &table->entries[i].key;                                             \
+  }                                                                            \
+                                                                               \
+  static inline record_type* name##_get(const name* const table,               \
+                                        const ZixHashIter i)                   \
+  {                                                                            \
+    return &table->entries[i].record;                                          \
+  }                                                                            \
+                                                                               \
+  static inline ZixHashIter name##_find(const name* const table,               \
+                                        const key_type    key)                 \
+  {                                                                            \
+    if (!table->entries) {                                                     \
+      return table->n_entries;                                                 \
+    }                                                                          \
+                                                                               \
+    const ZixHashCode code  = hash_fn(key) | ZIX_HASH_DEFINE_FULL;             \
+    const size_t      start = code & table->mask;                              \
+    size_t            i     = start;                                           \
+    while (table->entries[i].code != ZIX_HASH_DEFINE_EMPTY) {                  \
+      if (table->entries[i].code == code &&                                    \
+          equal_fn(table->entries[i].key, key)) {                              \
+        return i;                                                              \
+      }                                                                        \
+                                                                               \
+      if ((i = (i + 1U) & table->mask) == start) {                             \
+        break;                                                                 \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    return table->n_entries;                                                   \
+  }                                                                            \
+                                                                               \
+  static inline record_type* name##_find_record(const name* const table,       \
+                                                const key_type    key)         \
+  {                                                                            \
+    const ZixHashIter i = name##_find(table, key);                             \
+                                                                               \
+    return (i < table->n_entries) ? &table->entries[i].record : NULL;          \
+  }                                                                            \
+                                                                               \
+  static inline ZixStatus name##_resize(name* const table,                     \
+                                        const size_t n_entries)                \
+  {                                                                            \
+    name##Entry* const entries = (name##Entry*)zix_calloc(                     \
+      table->allocator, n_entries, sizeof(name##Entry));                       \
+    if (!entries) {                                                            \
+      return ZIX_STATUS_NO_MEM;                                                \
+    }                                                                          \
+                                                                               \
+    const size_t mask = n_entries - 1U;                                        \
+    for (size_t i = 0U; i < table->n_entries; ++i) {                           \
+      if (table->entries[i].code & ZIX_HASH_DEFINE_FULL) {                     \
+        size_t j = table->entries[i].code & mask;                              \
+        while (entries[j].code != ZIX_HASH_DEFINE_EMPTY) {                     \
+          j = (j + 1U) & mask;                                                 \
+        }                                                                      \
+                                                                               \
+        entries[j] = table->entries[i];                                        \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    zix_free(table->allocator, table->entries);                                \
+    table->entries   = entries;                                                \
+    table->mask      = mask;                                                   \
+    table->n_entries = n_entries;                                              \
+    return ZIX_STATUS_SUCCESS;                                                 \
+  }                                                                            \
+                                                                               \
+  static inline ZixStatus name##_reserve(name* const  table,                   \
+                                         const size_t n_records)               \
+  {                                                                            \
+    if (n_records > SIZE_MAX / (8U * sizeof(name##Entry))) {                   \
+      return ZIX_STATUS_NO_MEM;                                                \
+    }                                                                          \
+                                                                               \
+    const size_t n_entries = zix_hash_define_fit(n_records);                   \
+                                                                               \
+    return (n_entries > table->n_entries) ? name##_resize(table, n_entries)    \
+                                          : ZIX_STATUS_SUCCESS;                \
+  }                                                                            \
+                                                                               \
+  static inline ZixStatus name##_insert(name* const       table,               \
+                                        const key_type    key,                 \
+                                        const record_type record)              \
+  {                                                                            \
+    if (!table->entries) {                                                     \
+      const ZixStatus st =                                                     \
+        name##_resize(table, ZIX_HASH_DEFINE_MIN_N_ENTRIES);                   \
+      if (st) {                                                                \
+        return st;                                                             \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    const ZixHashCode code      = hash_fn(key) | ZIX_HASH_DEFINE_FULL;         \
+    const size_t      start     = code & table->mask;                          \
+    size_t            i         = start;                                       \
+    size_t            tombstone = table->n_entries;                            \
+    while (table->entries[i].code != ZIX_HASH_DEFINE_EMPTY) {                  \
+      if (table->entries[i].code == code &&                                    \
+          equal_fn(table->entries[i].key, key)) {                              \
+        return ZIX_STATUS_EXISTS;                                              \
+      }                                                                        \
+                                                                               \
+      if (tombstone == table->n_entries &&                                     \
+          table->entries[i].code == ZIX_HASH_DEFINE_DELETED) {                 \
+        tombstone = i;                                                         \
+      }                                                                        \
+                                                                               \
+      if ((i = (i + 1U) & table->mask) == start) {                             \
+        break;                                                                 \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    if (tombstone < table->n_entries) {                                        \
+      i = tombstone;                                                           \
+    }                                                                          \
+                                                                               \
+    name##Entry* const entry      = &table->entries[i];                        \
+    const name##Entry  orig_entry = *entry;                                    \
+                                                                               \
+    entry->code   = code;                                                      \
+    entry->key    = key;                                                       \
+    entry->record = record;                                                    \
+                                                                               \
+    const size_t new_count = table->count + 1U;                                \
+    if (new_count >= zix_hash_define_max_load(table->n_entries)) {             \
+      const ZixStatus st = name##_resize(table, table->n_entries << 1U);       \
+      if (st) {                                                                \
+        *entry = orig_entry;                                                   \
+        return st;                                                             \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    table->count = new_count;                                                  \
+    return ZIX_STATUS_SUCCESS;                                                 \
+  }                                                                            \
+                                                                               \
+  static inline ZixStatus name##_erase(name* const table, const ZixHashIter i) \
+  {                                                                            \
+    table->entries[i].code = ZIX_HASH_DEFINE_DELETED;                          \
+    if (--table->count < table->n_entries / 4U &&                              \
+        table->n_entries > ZIX_HASH_DEFINE_MIN_N_ENTRIES) {                    \
+      return name##_resize(table, table->n_entries >> 1U);                     \
+    }                                                                          \
+                                                                               \
+    return ZIX_STATUS_SUCCESS;                                                 \
+  }                                                                            \
+                                                                               \
+  static inline ZixStatus name##_remove(                                       \
+    name* const table, const key_type key, record_type* const removed)         \
+  {                                                                            \
+    const ZixHashIter i = name##_find(table, key);                             \
+    if (i == table->n_entries) {                                               \
+      return ZIX_STATUS_NOT_FOUND;                                             \
+    }                                                                          \
+                                                                               \
+    if (removed) {                                                             \
+      *removed = table->entries[i].record;                                     \
+    }                                                                          \
+                                                                               \
+    return name##_erase(table, i);                                             \
+  }
+
+/**
+   @}
+*/
+
+#endif /* ZIX_HASH_DEFINE_H */
@@ -0,0 +1,439 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_HASH_MAP_HPP
+#define ZIX_HASH_MAP_HPP
+
+#include <zix/allocator.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+namespace zix {
+
+/**
+   @defgroup zix_hash_map HashMap
+   @ingroup zix_hash
+   @{
+*/
+
+/**
+   Default hash function object for HashMap.
+
+   This digests the result of `std::hash`, which is the identity for integers
+   in common standard libraries, so that all of its bits affect the low bits
+   of the hash code.
+*/
+template<class Key>
+struct DigestHash {
+  ZixHashCode operator()(const Key& key) const
+  {
+    const size_t code = std::hash<Key>{}(key);
+    return zix_digest_aligned(0U, &code, sizeof(code));
+  }
+};
+
+/**
+   A hash table specialized for particular record and key types at compile
+   time.
+
+   This is a header-only C++ template version of ZixHash with the default
+   #ZIX_HASH_LINEAR layout, which uses the same probing algorithm, growth
+   policy, and shrink policy.  Since the key accessor, hash function, and
+   equality comparison are function objects rather than function pointers,
+   they can be inlined into the probing loop, which makes a significant
+   difference for trivial functions like those for integer keys.
+
+   Like ZixHash, this stores pointers to records owned by the user, and a key
+   is accessed from a record with a function object `KeyOf`, which is called
+   with a reference to the record and returns a key or a reference to one.
+   Keys are hashed with `Hash`, which returns a ZixHashCode like a
+   ZixHashFunc, and compared with `Eq`.  Only the low bits of hash codes are
+   used to find entries, so `Hash` must mix all of the key into them.  The
+   table is allocated on the first insertion, so construction never fails,
+   and failures are reported with a ZixStatus rather than exceptions.
+
+   @tparam Key The type of a key within a record.
+   @tparam Record The type of a record, which the table stores pointers to.
+   @tparam KeyOf Function object type to get the key of a record.
+   @tparam Hash Function object type to hash a key to a ZixHashCode.
+   @tparam Eq Function object type to test keys for equality.
+*/
+template<class Key,
+         class Record,
+         class KeyOf,
+         class Hash = DigestHash<Key>,
+         class Eq   = std::equal_to<Key>>
+class HashMap
+{
+  struct Entry {
+    ZixHashCode hash;  ///< Non-folded hash value
+    Record*     value; ///< Pointer to user-owned record
+  };
+
+public:
+  /// A forward iterator over the records in a table
+  class Iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Record*;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = Record* const*;
+    using reference         = Record* const&;
+
+    Iterator() noexcept = default;
+
+    reference operator*() const noexcept
+    {
+      assert(_index < _map->_n_entries);
+      return _map->_entries[_index].value;
+    }
+
+    pointer operator->() const noexcept { return &**this; }
+
+    Iterator& operator++() noexcept
+    {
+      _index = _map->next_index(_index);
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept
+    {
+      const Iterator result{*this};
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const Iterator& rhs) const noexcept
+    {
+      return _index == rhs._index;
+    }
+
+    bool operator!=(const Iterator& rhs) const noexcept
+    {
+      return _index != rhs._index;
+    }
+
+  private:
+    friend class HashMap;
+
+    Iterator(const HashMap* const map, const size_t index) noexcept
+      : _map{map}
+      , _index{index}
+    {}
+
+    const HashMap* _map{nullptr};
+    size_t         _index{0U};
+  };
+
+  using iterator       = Iterator;
+  using const_iterator = Iterator;
+
+  /**
+     Create a new empty hash table.
+
+     @param allocator Allocator used for the internal array.
+     @param key_of Function object to get the key of a record.
+     @param hash Function object to hash a key.
+     @param equal Function object to test keys for equality.
+  */
+  explicit HashMap(ZixAllocator* const allocator = nullptr,
+                   KeyOf               key_of    = KeyOf{},
+                   Hash                hash      = Hash{},
+                   Eq                  equal     = Eq{}) noexcept
+    : _allocator{allocator}
+    , _key_of{std::move(key_of)}
+    , _hash{std::move(hash)}
+    , _equal{std::move(equal)}
+  {}
+
+  HashMap(const HashMap&)            = delete;
+  HashMap& operator=(const HashMap&) = delete;
+
+  HashMap(HashMap&& other) noexcept
+    : _allocator{other._allocator}
+    , _key_of{std::move(other._key_of)}
+    , _hash{std::move(other._hash)}
+    , _equal{std::move(other._equal)}
+    , _entries{std::exchange(other._entries, nullptr)}
+    , _mask{std::exchange(other._mask, 0U)}
+    , _n_entries{std::exchange(other._n_entries, 0U)}
+    , _count{std::exchange(other._count, 0U)}
+  {}
+
+  HashMap& operator=(HashMap&& other) noexcept
+  {
+    if (this != &other) {
+      zix_free(_allocator, _entries);
+      _allocator = other._allocator;
+      _key_of    = std::move(other._key_of);
+      _hash      = std::move(other._hash);
+      _equal     = std::move(other._equal);
+      _entries   = std::exchange(other._entries, nullptr);
+      _mask      = std::exchange(other._mask, 0U);
+      _n_entries = std::exchange(other._n_entries, 0U);
+      _count     = std::exchange(other._count, 0U);
+    }
+
+    return *this;
+  }
+
+  ~HashMap() noexcept { zix_free(_allocator, _entries); }
+
+  /// Return the number of records in the table
+  size_t size() const noexcept { return _count; }
+
+  /// Return true if the table contains no records
+  bool empty() const noexcept { return !_count; }
+
+  /// Return an iterator to the first record, or the end if it is empty
+  Iterator begin() const noexcept
+  {
+    if (!_n_entries) {
+      return end();
+    }
+
+    return Iterator{this, _entries[0].value ? 0U : next_index(0U)};
+  }
+
+  /// Return an iterator one past the last possible record
+  Iterator end() const noexcept { return Iterator{this, _n_entries}; }
+
+  /// Find the record with the given key, or return the end
+  Iterator find(const Key& key) const
+  {
+    return Iterator{this, find_index(_hash(key), key)};
+  }
+
+  /// Find the record with the given key, or return null
+  Record* find_record(const Key& key) const
+  {
+    const size_t i = find_index(_hash(key), key);
+
+    return (i < _n_entries) ? _entries[i].value : nullptr;
+  }
+
+  /**
+     Insert a record.
+
+     @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_EXISTS if a record already
+     exists with the same key, or #ZIX_STATUS_NO_MEM if growing the table
+     failed, in which case the table is unchanged.
+  */
+  ZixStatus insert(Record* const record)
+  {
+    assert(record);
+
+    if (!_entries) {
+      const ZixStatus st = resize(min_n_entries);
+      if (st) {
+        return st;
+      }
+    }
+
+    // Search for a matching record, or the first free entry
+    const Key&        key             = _key_of(*record);
+    const ZixHashCode code            = _hash(key);
+    const size_t      start           = code & _mask;
+    size_t            i               = start;
+    size_t            first_tombstone = 0U;
+    bool              found_tombstone = false;
+    while (!is_empty(_entries[i])) {
+      if (is_match(_entries[i], code, key)) {
+        return ZIX_STATUS_EXISTS;
+      }
+
+      if (!found_tombstone && !_entries[i].value) {
+        first_tombstone = i;
+        found_tombstone = true;
+      }
+
+      if ((i = (i + 1U) & _mask) == start) {
+        break; // Rare edge case: entire table is full of entries/tombstones
+      }
+    }
+
+    if (found_tombstone) {
+      i = first_tombstone;
+    }
+
+    // Set the entry, then grow if we exceeded the maximum load
+    const Entry orig_entry = _entries[i];
+    _entries[i]            = Entry{code, record};
+
+    const size_t new_count = _count + 1U;
+    if (new_count >= max_load(_n_entries)) {
+      const ZixStatus st = resize(_n_entries << 1U);
+      if (st) {
+        _entries[i] = orig_entry;
+        return st;
+      }
+    }
+
+    _count = new_count;
+    return ZIX_STATUS_SUCCESS;
+  }
+
+  /**
+     Erase the record at an iterator.
+
+     @param i Iterator to the record to remove.
+     @param removed Set to the removed record.
+     @return #ZIX_STATUS_SUCCESS, or #ZIX_STATUS_NO_MEM if shrinking the
+     table failed, in which case the record is still removed.
+  */
+  ZixStatus erase(const Iterator i, Record** const removed)
+  {
+    assert(i._index < _n_entries);
+    assert(removed);
+
+    *removed                 = _entries[i._index].value;
+    _entries[i._index].hash  = tombstone;
+    _entries[i._index].value = nullptr;
+
+    --_count;
+    if (_count < _n_entries / shrink_div && _n_entries > min_n_entries) {
+      return resize(_n_entries >> 1U);
+    }
+
+    return ZIX_STATUS_SUCCESS;
+  }
+
+  /**
+     Remove the record with the given key.
+
+     @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NOT_FOUND, or
+     #ZIX_STATUS_NO_MEM if shrinking the table failed.
+  */
+  ZixStatus remove(const Key& key, Record** const removed)
+  {
+    const Iterator i = find(key);
+
+    return (i == end()) ? ZIX_STATUS_NOT_FOUND : erase(i, removed);
+  }
+
+  /// Grow the table if necessary so that it can hold some number of records
+  ZixStatus reserve(const size_t n_records)
+  {
+    if (n_records > SIZE_MAX / (8U * sizeof(Entry))) {
+      return ZIX_STATUS_NO_MEM;
+    }
+
+    size_t n_entries = min_n_entries;
+    while (max_load(n_entries) <= n_records) {
+      n_entries <<= 1U;
+    }
+
+    return (n_entries > _n_entries) ? resize(n_entries) : ZIX_STATUS_SUCCESS;
+  }
+
+private:
+  static constexpr size_t      min_n_entries = 4U;
+  static constexpr size_t      shrink_div    = 4U;
+  static constexpr ZixHashCode tombstone     = 0xDEADU;
+
+  /// Return the number of records that makes a table of a given size grow
+  static constexpr size_t max_load(const size_t n_entries) noexcept
+  {
+    return (n_entries / 2U) + (n_entries / 8U);
+  }
+
+  static bool is_empty(const Entry& entry) noexcept
+  {
+    return !entry.value && !entry.hash;
+  }
+
+  bool is_match(const Entry&      entry,
+                const ZixHashCode code,
+                const Key&        key) const
+  {
+    return entry.value && entry.hash == code &&
+           _equal(_key_of(*entry.value), key);
+  }
+
+  /// Return the index of the next record after `i`, or the end
+  size_t next_index(size_t i) const noexcept
+  {
+    do {
+      ++i;
+    } while (i < _n_entries && !_entries[i].value);
+
+    return i;
+  }
+
+  /// Return the index of a matching record, or the end
+  size_t find_index(const ZixHashCode code, const Key& key) const
+  {
+    if (!_entries) {
+      return 0U;
+    }
+
+    const size_t start = code & _mask;
+    size_t       i     = start;
+    while (!is_empty(_entries[i])) {
+      if (is_match(_entries[i], code, key)) {
+        return i;
+      }
+
+      if ((i = (i + 1U) & _mask) == start) {
+        break; // Rare edge case: entire table is full of entries/tombstones
+      }
+    }
+
+    return _n_entries;
+  }
+
+  /// Replace the array with a new one of the given size
+  ZixStatus resize(const size_t n_entries)
+  {
+    auto* const entries =
+      static_cast<Entry*>(zix_calloc(_allocator, n_entries, sizeof(Entry)));
+
+    if (!entries) {
+      return ZIX_STATUS_NO_MEM;
+    }
+
+    const size_t mask = n_entries - 1U;
+    for (size_t i = 0U; i < _n_entries; ++i) {
+      if (_entries[i].value) {
+        size_t j = _entries[i].hash & mask;
+        while (entries[j].value) {
+          j = (j + 1U) & mask;
+        }
+
+        entries[j] = _entries[i];
+      }
+    }
+
+    zix_free(_allocator, _entries);
+    _entries   = entries;
+    _mask      = mask;
+    _n_entries = n_entries;
+    return ZIX_STATUS_SUCCESS;
+  }
+
+  ZixAllocator* _allocator{nullptr}; ///< User allocator
+  KeyOf         _key_of;             ///< User key accessor
+  Hash          _hash;               ///< User hashing function
+  Eq            _equal;              ///< User equality comparison function
+  Entry*        _entries{nullptr};   ///< Array of entries, or null
+  size_t        _mask{0U};           ///< Bit mask for fast modulo
+  size_t        _n_entries{0U};      ///< Power of two table size, or zero
+  size_t        _count{0U};          ///< Number of records in the table
+};
+
+/**
+   @}
+*/
+
+} // namespace zix
+
+#endif // ZIX_HASH_MAP_HPP
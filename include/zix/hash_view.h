@@ -0,0 +1,160 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_HASH_VIEW_H
+#define ZIX_HASH_VIEW_H
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+#include <zix/string_view.h>
+
+#include <stddef.h>
+
+ZIX_BEGIN_DECLS
+
+/**
+   @defgroup zix_hash_view Hash View
+   @ingroup zix_data_structures
+   @{
+*/
+
+/**
+   @defgroup zix_hash_view_writing Writing
+   @{
+*/
+
+/**
+   An entry in a hash table snapshot.
+
+   Snapshots store records as a pair of byte strings, which are copied from
+   the records of a #ZixHash when it is written.
+*/
+typedef struct {
+  ZixStringView key;   ///< Key used for searching
+  ZixStringView value; ///< Value returned when the key is found
+} ZixHashViewEntry;
+
+/**
+   Function to get the snapshot entry for a hash table record.
+
+   This may be called more than once for each record, and must return the
+   same entry every time.  The returned strings only need to remain valid
+   until the next call.
+*/
+typedef ZixHashViewEntry (*ZixHashViewEntryFunc)(
+  const ZixHashRecord* ZIX_NONNULL record,
+  void* ZIX_UNSPECIFIED            user_data);
+
+/**
+   Write a snapshot of a hash table to a file.
+
+   This writes an immutable hash table in a format that can be used directly
+   from memory, so it can be quickly loaded with zix_hash_view_open().  The
+   snapshot is made of a header, an array of entry offsets indexed by the low
+   bits of the zix_digest64() of the key, and a blob of entries with the key
+   and value strings.  It uses the native byte order and is meant for caching
+   on the same machine, not for exchange.
+
+   The file is overwritten in place, which isn't safe if it is currently open
+   as a view, so it's best to write a temporary file then rename it.
+
+   @param allocator Allocator used for temporary memory.
+   @param hash The hash table to write.
+   @param entry_func Function to get the entry for each record.  Keys must be
+   unique, and are usually a serialized form of the hash table's keys.
+   @param user_data Pointer passed to `entry_func`.
+   @param path Path of the file to write.
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_NO_MEM, or an error if writing
+   failed.
+*/
+ZIX_API ZixStatus
+zix_hash_view_write(ZixAllocator* ZIX_NULLABLE       allocator,
+                    const ZixHash* ZIX_NONNULL       hash,
+                    ZixHashViewEntryFunc ZIX_NONNULL entry_func,
+                    void* ZIX_UNSPECIFIED            user_data,
+                    const char* ZIX_NONNULL          path);
+
+/**
+   @}
+   @defgroup zix_hash_view_setup Setup
+   @{
+*/
+
+/**
+   A read-only view of a hash table snapshot.
+
+   This is an immutable hash table of strings that is used directly from a
+   snapshot in memory, typically a memory-mapped file, so opening one doesn't
+   need to parse or insert each record.  Searching never allocates.
+*/
+typedef struct ZixHashViewImpl ZixHashView;
+
+/**
+   Create a hash view of a snapshot in memory.
+
+   This only checks the header, the snapshot itself isn't copied and must
+   remain valid and unchanged until the view is freed.
+
+   @param allocator Allocator used for the view itself.
+   @param data Pointer to the start of a snapshot, aligned to 8 bytes.
+   @param size Size of the snapshot in bytes.
+   @return A new view, or null on allocation failure or if the snapshot is
+   invalid.
+*/
+ZIX_API ZIX_NODISCARD ZixHashView* ZIX_ALLOCATED
+zix_hash_view_new(ZixAllocator* ZIX_NULLABLE allocator,
+                  const void* ZIX_NULLABLE   data,
+                  size_t                     size);
+
+/**
+   Open a hash view of a snapshot file.
+
+   The file is mapped into memory (where supported) and unmapped when the
+   view is freed.
+
+   @param allocator Allocator used for the view itself.
+   @param path Path of a file written by zix_hash_view_write().
+   @return A new view, or null if the file couldn't be mapped or is invalid.
+*/
+ZIX_API ZIX_NODISCARD ZixHashView* ZIX_ALLOCATED
+zix_hash_view_open(ZixAllocator* ZIX_NULLABLE allocator,
+                   const char* ZIX_NONNULL    path);
+
+/// Free a hash view, and unmap its file if it was opened from one
+ZIX_API void
+zix_hash_view_free(ZixHashView* ZIX_NULLABLE view);
+
+/// Return the number of entries in a hash view
+ZIX_PURE_API size_t
+zix_hash_view_size(const ZixHashView* ZIX_NONNULL view);
+
+/**
+   @}
+   @defgroup zix_hash_view_searching Searching
+   @{
+*/
+
+/**
+   Find the value for a key.
+
+   @param view The hash view.
+   @param key The key to search for.
+   @param value Set to the value (which points into the snapshot and is
+   null-terminated) if the key is found.
+   @return #ZIX_STATUS_SUCCESS or #ZIX_STATUS_NOT_FOUND.
+*/
+ZIX_API ZixStatus
+zix_hash_view_find(const ZixHashView* ZIX_NONNULL view,
+                   ZixStringView                  key,
+                   ZixStringView* ZIX_NONNULL     value);
+
+/**
+   @}
+   @}
+*/
+
+ZIX_END_DECLS
+
+#endif /* ZIX_HASH_VIEW_H */
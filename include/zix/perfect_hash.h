@@ -0,0 +1,138 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_PERFECT_HASH_H
+#define ZIX_PERFECT_HASH_H
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/hash.h>
+#include <zix/string_view.h>
+
+#include <stddef.h>
+
+ZIX_BEGIN_DECLS
+
+/**
+   @defgroup zix_perfect_hash Perfect Hash
+   @ingroup zix_data_structures
+   @{
+*/
+
+/**
+   @defgroup zix_perfect_hash_setup Setup
+   @{
+*/
+
+/**
+   A minimal perfect hash function for a static set of keys.
+
+   This maps each of a fixed set of n string keys to a unique index from 0 to
+   n - 1, so records can be stored in a simple array and found with a single
+   probe.  Keys are hashed with zix_digest64(), each key's bucket has a 16-bit
+   "pilot" which was chosen when building so that the keys in the bucket go to
+   free slots, and the few slots past n are remapped to unused indices
+   (in the style of CHD and PTHash).  This takes about 3.5 bits per key, plus
+   the records if the perfect hash was built from a hash table.
+
+   Keys that aren't in the set are mapped to an arbitrary index, so
+   zix_perfect_hash_find_record() (or the caller) must check the key of the
+   record at that index.
+*/
+typedef struct ZixPerfectHashImpl ZixPerfectHash;
+
+/// Function to get the key of a record as a string
+typedef ZixStringView (*ZixPerfectHashKeyFunc)(
+  const ZixHashRecord* ZIX_NONNULL record,
+  void* ZIX_UNSPECIFIED            user_data);
+
+/**
+   Build a minimal perfect hash for an array of keys.
+
+   The keys are only used while building, and don't need to remain valid
+   afterwards.
+
+   @param allocator Allocator used for the perfect hash and temporary memory.
+   @param n_keys Number of keys, which must be less than 2^31.
+   @param keys Array of unique keys.
+   @return A new perfect hash, or null on allocation failure or if the keys
+   aren't unique.
+*/
+ZIX_API ZIX_NODISCARD ZixPerfectHash* ZIX_ALLOCATED
+zix_perfect_hash_new(ZixAllocator* ZIX_NULLABLE       allocator,
+                     size_t                           n_keys,
+                     const ZixStringView* ZIX_NULLABLE keys);
+
+/**
+   Build a minimal perfect hash for the records in a hash table.
+
+   The perfect hash stores a pointer to each record, so it can be searched
+   with zix_perfect_hash_find_record().  The records must remain valid, and
+   their keys unchanged, for the lifetime of the perfect hash, but the hash
+   table itself can be freed.
+
+   @param allocator Allocator used for the perfect hash and temporary memory.
+   @param hash The hash table to get records from.
+   @param key_func Function to get the key of a record as a string, which
+   must return the same string every time it is called for a record.
+   @param user_data Pointer passed to `key_func`.
+   @return A new perfect hash, or null on allocation failure or if the keys
+   aren't unique.
+*/
+ZIX_API ZIX_NODISCARD ZixPerfectHash* ZIX_ALLOCATED
+zix_perfect_hash_new_from_hash(ZixAllocator* ZIX_NULLABLE        allocator,
+                               const ZixHash* ZIX_NONNULL        hash,
+                               ZixPerfectHashKeyFunc ZIX_NONNULL key_func,
+                               void* ZIX_UNSPECIFIED             user_data);
+
+/// Free a perfect hash
+ZIX_API void
+zix_perfect_hash_free(ZixPerfectHash* ZIX_NULLABLE hash);
+
+/// Return the number of keys in a perfect hash
+ZIX_PURE_API size_t
+zix_perfect_hash_size(const ZixPerfectHash* ZIX_NONNULL hash);
+
+/**
+   @}
+   @defgroup zix_perfect_hash_searching Searching
+   @{
+*/
+
+/**
+   Return the index of a key.
+
+   @return A unique index less than the number of keys if the key is in the
+   set, otherwise an arbitrary index (or zero if the set is empty).
+*/
+ZIX_PURE_API size_t
+zix_perfect_hash_index(const ZixPerfectHash* ZIX_NONNULL hash,
+                       ZixStringView                     key);
+
+/**
+   Return the record at an index.
+
+   @return The record with the key that maps to `index`, or null if the
+   perfect hash wasn't built from a hash table or the index is out of range.
+*/
+ZIX_PURE_API ZixHashRecord* ZIX_NULLABLE
+zix_perfect_hash_get(const ZixPerfectHash* ZIX_NONNULL hash, size_t index);
+
+/**
+   Find the record with a given key.
+
+   @return The matching record, or null if no such record exists or the
+   perfect hash wasn't built from a hash table.
+*/
+ZIX_API ZixHashRecord* ZIX_NULLABLE
+zix_perfect_hash_find_record(const ZixPerfectHash* ZIX_NONNULL hash,
+                             ZixStringView                     key);
+
+/**
+   @}
+   @}
+*/
+
+ZIX_END_DECLS
+
+#endif /* ZIX_PERFECT_HASH_H */
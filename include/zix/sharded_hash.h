@@ -0,0 +1,168 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_SHARDED_HASH_H
+#define ZIX_SHARDED_HASH_H
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <stddef.h>
+
+ZIX_BEGIN_DECLS
+
+/**
+   @defgroup zix_sharded_hash Sharded Hash
+   @ingroup zix_data_structures
+   @{
+*/
+
+/**
+   @defgroup zix_sharded_hash_setup Setup
+   @{
+*/
+
+/**
+   A hash table split into independently locked shards.
+
+   This is a thread-safe hash table for any number of readers and writers,
+   made of several #ZixHash tables ("shards") that each have their own lock.
+   The shard for a record is chosen by the high bits of its hash code (after
+   multiplying by a large odd constant, so any reasonable hash function will
+   work), so threads that access records in different shards don't contend
+   with each other.  This makes it a good choice for concurrently ingesting
+   many records from several threads.
+
+   Simple operations lock the appropriate shard internally.  For anything
+   else, including the two-phase insertion protocol of zix_hash_plan_insert()
+   and zix_hash_insert_at(), a shard can be locked and used directly as a
+   #ZixHash.  Functions of the sharded table itself must not be called while
+   holding a shard lock, and records must not be destroyed while another
+   thread may be accessing them.
+
+   This is only available if Zix is built with thread support.
+*/
+typedef struct ZixShardedHashImpl ZixShardedHash;
+
+/**
+   Create a new sharded hash table.
+
+   @param allocator Allocator used for the table, shards, and their arrays.
+   @param n_shards Minimum number of shards, which is rounded up to a power of
+   2 (up to 65536).  This should be at least a few times the number of
+   concurrent threads.
+   @param key_func A function to retrieve the key from a record.
+   @param hash_func The key hashing function.
+   @param equal_func A function to test keys for equality.
+*/
+ZIX_API ZIX_NODISCARD ZixShardedHash* ZIX_ALLOCATED
+zix_sharded_hash_new(ZixAllocator* ZIX_NULLABLE  allocator,
+                     unsigned                    n_shards,
+                     ZixKeyFunc ZIX_NONNULL      key_func,
+                     ZixHashFunc ZIX_NONNULL     hash_func,
+                     ZixKeyEqualFunc ZIX_NONNULL equal_func);
+
+/**
+   Free a sharded hash table.
+
+   This function is not thread-safe, no other thread may be using the table.
+*/
+ZIX_API void
+zix_sharded_hash_free(ZixShardedHash* ZIX_NULLABLE hash);
+
+/// Return the number of shards in a sharded hash table
+ZIX_PURE_API unsigned
+zix_sharded_hash_n_shards(const ZixShardedHash* ZIX_NONNULL hash);
+
+/**
+   Return the number of elements in a sharded hash table.
+
+   This locks every shard in turn, so the result may be out of date by the
+   time it is returned if other threads are modifying the table.
+*/
+ZIX_API size_t
+zix_sharded_hash_size(ZixShardedHash* ZIX_NONNULL hash);
+
+/**
+   @}
+   @defgroup zix_sharded_hash_shards Shards
+   @{
+*/
+
+/**
+   Lock and return the shard for a hash code.
+
+   The returned shard may be used as a normal #ZixHash until it is unlocked
+   with zix_sharded_hash_unlock_shard(), but only records with hash codes that
+   map to this shard may be inserted into it.  Locking a shard that is already
+   locked by this thread will deadlock.
+
+   @param hash The sharded hash table.
+   @param code The hash code of a key, as returned by the hash function.
+*/
+ZIX_API ZixHash* ZIX_NONNULL
+zix_sharded_hash_lock_shard(ZixShardedHash* ZIX_NONNULL hash, ZixHashCode code);
+
+/**
+   Unlock the shard for a hash code.
+
+   @param hash The sharded hash table.
+   @param code The hash code given to zix_sharded_hash_lock_shard().
+*/
+ZIX_API void
+zix_sharded_hash_unlock_shard(ZixShardedHash* ZIX_NONNULL hash,
+                              ZixHashCode                 code);
+
+/**
+   @}
+   @defgroup zix_sharded_hash_operations Operations
+   @{
+*/
+
+/**
+   Insert a record.
+
+   @param hash The sharded hash table.
+   @param record The record to insert, which must not change while in the
+   table.
+   @return #ZIX_STATUS_SUCCESS, #ZIX_STATUS_EXISTS if a record already exists
+   at this key, or #ZIX_STATUS_NO_MEM if growing the shard failed.
+*/
+ZIX_API ZixStatus
+zix_sharded_hash_insert(ZixShardedHash* ZIX_NONNULL hash,
+                        ZixHashRecord* ZIX_NONNULL  record);
+
+/**
+   Remove a record.
+
+   @param hash The sharded hash table.
+   @param key The key of the record to remove.
+   @param removed Set to the removed record, or null.
+   @return #ZIX_STATUS_SUCCESS or #ZIX_STATUS_NOT_FOUND.
+*/
+ZIX_API ZixStatus
+zix_sharded_hash_remove(ZixShardedHash* ZIX_NONNULL              hash,
+                        const ZixHashKey* ZIX_NONNULL            key,
+                        ZixHashRecord* ZIX_NULLABLE* ZIX_NONNULL removed);
+
+/**
+   Find a record with a given key.
+
+   @param hash The sharded hash table.
+   @param key The key of the desired record.
+   @return A pointer to the matching record, or null if no such record exists.
+*/
+ZIX_API ZixHashRecord* ZIX_NULLABLE
+zix_sharded_hash_find_record(ZixShardedHash* ZIX_NONNULL   hash,
+                             const ZixHashKey* ZIX_NONNULL key);
+
+/**
+   @}
+   @}
+*/
+
+ZIX_END_DECLS
+
+#endif /* ZIX_SHARDED_HASH_H */
@@ -44,8 +44,14 @@
 */
 
 #include <zix/btree.h>
+#include <zix/concurrent_hash.h>
+#include <zix/flat_hash.h>
 #include <zix/hash.h>
+#include <zix/hash_define.h>
+#include <zix/hash_view.h>
+#include <zix/perfect_hash.h>
 #include <zix/ring.h>
+#include <zix/sharded_hash.h>
 #include <zix/tree.h>
 
 /**
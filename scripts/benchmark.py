@@ -22,6 +22,7 @@ subprocess.call(
         "tree_insert.txt",
         "tree_search.txt",
         "tree_iterate.txt",
+        "tree_reverse.txt",
         "tree_delete.txt",
     ]
 )
@@ -71,5 +72,63 @@ subprocess.call(
         "dict_bench.svg",
         "dict_insert.txt",
         "dict_search.txt",
+        "dict_search_batch.txt",
+        "dict_iterate.txt",
     ]
 )
+
+subprocess.call(["benchmark/dict_churn_bench", "65536", "64"])
+
+subprocess.call(["benchmark/hash_map_bench", "4194304"])
+subprocess.call(
+    [
+        "../scripts/plot.py",
+        "hash_map.svg",
+        "hash_map_insert.txt",
+        "hash_map_search.txt",
+    ]
+)
+
+subprocess.call(["benchmark/hash_attack_bench", "16384"])
+subprocess.call(
+    [
+        "../scripts/plot.py",
+        "hash_attack.svg",
+        "hash_attack_insert.txt",
+        "hash_attack_search.txt",
+    ]
+)
+
+subprocess.call(["benchmark/hash_build_bench", "4194304", "8"])
+subprocess.call(["../scripts/plot.py", "hash_build.svg", "hash_build.txt"])
+
+subprocess.call(["benchmark/perfect_hash_bench", "gibberish.txt"])
+subprocess.call(
+    [
+        "../scripts/plot.py",
+        "perfect_hash.svg",
+        "perfect_hash_build.txt",
+        "perfect_hash_search.txt",
+    ]
+)
+
+subprocess.call(["benchmark/hash_view_bench", "gibberish.txt"])
+subprocess.call(
+    [
+        "../scripts/plot.py",
+        "hash_view.svg",
+        "hash_view_load.txt",
+        "hash_view_search.txt",
+    ]
+)
+
+subprocess.call(["benchmark/dict_latency_bench", "1048576"])
+subprocess.call(["../scripts/plot.py", "dict_latency.svg", "dict_latency.txt"])
+
+subprocess.call(["benchmark/concurrent_hash_bench", "65536", "1048576", "8"])
+subprocess.call(
+    ["../scripts/plot.py", "concurrent_hash.svg", "concurrent_hash.txt"]
+)
+
+subprocess.call(["benchmark/sharded_hash_bench", "1048576", "8", "64"])
+subprocess.call(["../scripts/plot.py", "sharded_hash.svg", "sharded_hash.txt"])
@@ -1,4 +1,4 @@
-// Copyright 2011-2024 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #include <zix/btree.h>
@@ -7,7 +7,18 @@
 #include <zix/attributes.h>
 #include <zix/status.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define ZIX_BTREE_SSE2 1
+#  include <emmintrin.h>
+#elif (defined(__aarch64__) && defined(__ARM_NEON)) || defined(_M_ARM64)
+#  define ZIX_BTREE_NEON 1
+#  include <arm_neon.h>
+#endif
+
 #include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -24,16 +35,42 @@ typedef uint16_t ZixShort;
 #  define ZIX_BTREE_PAGE_SIZE 4096U
 #endif
 
+/*
+  If ZIX_BTREE_COUNTS is defined, internal nodes also store the number of
+  values in each child's subtree, so positions can be found in logarithmic
+  time.  This makes room for fewer values in internal nodes.
+*/
+#ifdef ZIX_BTREE_COUNTS
+#  define ZIX_BTREE_CHILD_SIZE (sizeof(ZixBTreeNode*) + sizeof(size_t))
+#else
+#  define ZIX_BTREE_CHILD_SIZE sizeof(ZixBTreeNode*)
+#endif
+
+/*
+  If ZIX_BTREE_PREFIXES is defined, nodes also store a key prefix for every
+  value, so most comparisons while searching don't need to dereference values
+  at all.  This makes room for fewer values in all nodes.
+*/
+#ifdef ZIX_BTREE_PREFIXES
+#  define ZIX_BTREE_VAL_SIZE (sizeof(void*) + sizeof(uint64_t))
+#else
+#  define ZIX_BTREE_VAL_SIZE sizeof(void*)
+#endif
+
 #define ZIX_BTREE_NODE_SPACE (ZIX_BTREE_PAGE_SIZE - 2U * sizeof(ZixShort))
-#define ZIX_BTREE_LEAF_VALS ((ZIX_BTREE_NODE_SPACE / sizeof(void*)) - 1U)
-#define ZIX_BTREE_INODE_VALS (ZIX_BTREE_LEAF_VALS / 2U)
+#define ZIX_BTREE_LEAF_VALS ((ZIX_BTREE_NODE_SPACE / ZIX_BTREE_VAL_SIZE) - 1U)
+#define ZIX_BTREE_INODE_VALS                       \
+  ((ZIX_BTREE_NODE_SPACE - ZIX_BTREE_CHILD_SIZE) / \
+   (ZIX_BTREE_VAL_SIZE + ZIX_BTREE_CHILD_SIZE))
 
 struct ZixBTreeImpl {
   ZixAllocator*       allocator;
   ZixBTreeNode*       root;
   ZixBTreeCompareFunc cmp;
   const void*         cmp_data;
+  ZixBTreePrefixFunc  prefix;
   size_t              size;
+  ZixBTreeIter        finger; ///< Path to the leaf last inserted into
 };
 
 struct ZixBTreeNodeImpl {
@@ -43,11 +80,20 @@ struct ZixBTreeNodeImpl {
   union {
     struct {
       void* vals[ZIX_BTREE_LEAF_VALS];
+#ifdef ZIX_BTREE_PREFIXES
+      uint64_t prefixes[ZIX_BTREE_LEAF_VALS]; ///< Key prefix of each value
+#endif
     } leaf;
 
     struct {
       void*         vals[ZIX_BTREE_INODE_VALS];
       ZixBTreeNode* children[ZIX_BTREE_INODE_VALS + 1U];
+#ifdef ZIX_BTREE_COUNTS
+      size_t counts[ZIX_BTREE_INODE_VALS + 1U]; ///< Size of child subtrees
+#endif
+#ifdef ZIX_BTREE_PREFIXES
+      uint64_t prefixes[ZIX_BTREE_INODE_VALS]; ///< Key prefix of each value
+#endif
     } inode;
   } data;
 };
@@ -94,14 +140,21 @@ ZixBTree*
 zix_btree_new(ZixAllocator* const       allocator,
               const ZixBTreeCompareFunc cmp,
               const void* const         cmp_data)
+{
+  return zix_btree_new_prefixed(allocator, cmp, cmp_data, NULL);
+}
+
+ZixBTree*
+zix_btree_new_prefixed(ZixAllocator* const       allocator,
+                       const ZixBTreeCompareFunc cmp,
+                       const void* const         cmp_data,
+                       const ZixBTreePrefixFunc  prefix)
 {
 #if !((defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L) || \
       (defined(__cplusplus) && __cplusplus >= 201103L))
   assert(sizeof(ZixBTree) <= ZIX_BTREE_PAGE_SIZE);
 #endif
 
-  assert(cmp);
-
   ZixBTree* const t = (ZixBTree*)zix_aligned_alloc(
     allocator, ZIX_BTREE_PAGE_SIZE, ZIX_BTREE_PAGE_SIZE);
 
@@ -117,7 +170,9 @@ zix_btree_new(ZixAllocator* const       allocator,
   t->allocator = allocator;
   t->cmp       = cmp;
   t->cmp_data  = cmp_data;
+  t->prefix    = cmp ? prefix : NULL;
   t->size      = 0U;
+  t->finger    = zix_btree_end_iter;
 
   return t;
 }
@@ -171,6 +226,7 @@ zix_btree_clear(ZixBTree* const     t,
   memset(t->root, 0U, sizeof(ZixBTreeNode));
   t->root->is_leaf = true;
   t->size          = 0U;
+  t->finger        = zix_btree_end_iter;
 }
 
 size_t
@@ -192,6 +248,30 @@ zix_btree_min_vals(const ZixBTreeNode* const node)
   return (ZixShort)(((zix_btree_max_vals(node) + 1U) / 2U) - 1U);
 }
 
+/// Compare two values with the tree comparator, or as integers
+static int
+zix_btree_compare(const ZixBTree* const t,
+                  const void* const     a,
+                  const void* const     b)
+{
+  if (t->cmp) {
+    return t->cmp(a, b, t->cmp_data);
+  }
+
+  const uintptr_t ia = (uintptr_t)a;
+  const uintptr_t ib = (uintptr_t)b;
+
+  return ia < ib ? -1 : ia > ib ? 1 : 0;
+}
+
+/// Return true if `a` and `b` order values in the same way
+ZIX_PURE_FUNC static bool
+zix_btree_same_order(const ZixBTree* const a, const ZixBTree* const b)
+{
+  return a->cmp == b->cmp && a->cmp_data == b->cmp_data &&
+         a->prefix == b->prefix;
+}
+
 /// Shift pointers in `array` of length `n` right starting at `i`
 static void
 zix_btree_ainsert(void** const   array,
@@ -212,55 +292,295 @@ zix_btree_aerase(void** const array, const unsigned n, const unsigned i)
   return ret;
 }
 
-/// Split lhs, the i'th child of `n`, into two nodes
-static ZixBTreeNode*
-zix_btree_split_child(ZixAllocator* const allocator,
-                      ZixBTreeNode* const n,
+ZIX_PURE_FUNC static void**
+zix_btree_vals(ZixBTreeNode* const node)
+{
+  return node->is_leaf ? node->data.leaf.vals : node->data.inode.vals;
+}
+
+#ifdef ZIX_BTREE_PREFIXES
+
+ZIX_PURE_FUNC static uint64_t*
+zix_btree_prefixes(ZixBTreeNode* const node)
+{
+  return node->is_leaf ? node->data.leaf.prefixes : node->data.inode.prefixes;
+}
+
+#endif
+
+/// A value to search for, with its key prefix if prefixes are enabled
+typedef struct {
+  const void* value;
+#ifdef ZIX_BTREE_PREFIXES
+  uint64_t prefix;
+#endif
+} ZixBTreeKey;
+
+/// Return the search key for the value `e`
+static inline ZixBTreeKey
+zix_btree_key(const ZixBTree* const t, const void* const e)
+{
+#ifdef ZIX_BTREE_PREFIXES
+  const ZixBTreeKey key = {e, t->prefix ? t->prefix(e) : 0U};
+#else
+  const ZixBTreeKey key = {e};
+  (void)t;
+#endif
+  return key;
+}
+
+/// Return the search key for a pattern, which isn't a value and has no prefix
+static inline ZixBTreeKey
+zix_btree_pattern_key(const void* const pattern)
+{
+#ifdef ZIX_BTREE_PREFIXES
+  const ZixBTreeKey key = {pattern, 0U};
+#else
+  const ZixBTreeKey key = {pattern};
+#endif
+  return key;
+}
+
+/// Set the ith value in `n` to `e`, where `key` is the key for `e`
+static inline void
+zix_btree_set_val(ZixBTreeNode* const      n,
+                  const unsigned           i,
+                  void* const              e,
+                  const ZixBTreeKey* const key)
+{
+  assert(key->value == e);
+
+  zix_btree_vals(n)[i] = e;
+#ifdef ZIX_BTREE_PREFIXES
+  zix_btree_prefixes(n)[i] = key->prefix;
+#else
+  (void)key;
+#endif
+}
+
+/// Move `count` values (with any prefixes) from `src` at `s` to `dst` at `d`
+static inline void
+zix_btree_move_vals(ZixBTreeNode* const dst,
+                    const unsigned      d,
+                    ZixBTreeNode* const src,
+                    const unsigned      s,
+                    const unsigned      count)
+{
+  memmove(zix_btree_vals(dst) + d,
+          zix_btree_vals(src) + s,
+          count * sizeof(void*));
+#ifdef ZIX_BTREE_PREFIXES
+  memmove(zix_btree_prefixes(dst) + d,
+          zix_btree_prefixes(src) + s,
+          count * sizeof(uint64_t));
+#endif
+}
+
+/// Insert the sth value of `src` at `d` in `dst` which has `n` values
+static inline void
+zix_btree_insert_val(ZixBTreeNode* const dst,
+                     const unsigned      n,
+                     const unsigned      d,
+                     ZixBTreeNode* const src,
+                     const unsigned      s)
+{
+  assert(dst != src);
+  zix_btree_move_vals(dst, d + 1U, dst, d, n - d);
+  zix_btree_move_vals(dst, d, src, s, 1U);
+}
+
+/// Erase the ith value in `node` which has `n` values after erasing
+static inline void
+zix_btree_erase_val(ZixBTreeNode* const node,
+                    const unsigned      n,
+                    const unsigned      i)
+{
+  zix_btree_move_vals(node, i, node, i + 1U, n - i);
+}
+
+#ifdef ZIX_BTREE_COUNTS
+
+/// Shift counts in `array` of length `n` right starting at `i`
+static void
+zix_btree_counts_insert(size_t* const  array,
+                        const unsigned n,
+                        const unsigned i,
+                        const size_t   count)
+{
+  memmove(array + i + 1U, array + i, ((size_t)n - i) * sizeof(count));
+  array[i] = count;
+}
+
+/// Erase count `i` in `array` of length `n` and return erased count
+static size_t
+zix_btree_counts_erase(size_t* const array, const unsigned n, const unsigned i)
+{
+  const size_t ret = array[i];
+  memmove(array + i, array + i + 1U, ((size_t)n - i) * sizeof(ret));
+  return ret;
+}
+
+/// Return the number of values in the subtree rooted at `n`
+ZIX_PURE_FUNC static size_t
+zix_btree_node_size(const ZixBTreeNode* const n)
+{
+  size_t size = n->n_vals;
+  if (!n->is_leaf) {
+    for (unsigned i = 0U; i <= n->n_vals; ++i) {
+      size += n->data.inode.counts[i];
+    }
+  }
+
+  return size;
+}
+
+/// Set all counts in the subtree rooted at `n` and return its size
+static size_t
+zix_btree_recount(ZixBTreeNode* const n)
+{
+  size_t size = n->n_vals;
+  if (!n->is_leaf) {
+    for (unsigned i = 0U; i <= n->n_vals; ++i) {
+      n->data.inode.counts[i] = zix_btree_recount(n->data.inode.children[i]);
+      size += n->data.inode.counts[i];
+    }
+  }
+
+  return size;
+}
+
+#else
+
+/// Return the number of values in the subtree rooted at `n` by counting them
+ZIX_PURE_FUNC static size_t
+zix_btree_node_size(const ZixBTreeNode* const n)
+{
+  size_t size = n->n_vals;
+  if (!n->is_leaf) {
+    for (unsigned i = 0U; i <= n->n_vals; ++i) {
+      size += zix_btree_node_size(n->data.inode.children[i]);
+    }
+  }
+
+  return size;
+}
+
+#endif
+
+static void
+zix_btree_iter_set_frame(ZixBTreeIter* const ti,
+                         ZixBTreeNode* const n,
+                         const ZixShort      i)
+{
+  ti->nodes[ti->level]   = n;
+  ti->indexes[ti->level] = (uint16_t)i;
+}
+
+static void
+zix_btree_iter_push(ZixBTreeIter* const ti,
+                    ZixBTreeNode* const n,
+                    const ZixShort      i)
+{
+  assert(ti->level < ZIX_BTREE_MAX_HEIGHT - 1U);
+  ++ti->level;
+  ti->nodes[ti->level]   = n;
+  ti->indexes[ti->level] = (uint16_t)i;
+}
+
+static void
+zix_btree_iter_pop(ZixBTreeIter* const ti)
+{
+  assert(ti->level > 0U);
+  ti->nodes[ti->level]   = NULL;
+  ti->indexes[ti->level] = 0U;
+  --ti->level;
+}
+
+/// Add one to the count of every child in the first `path.level` frames
+static inline void
+zix_btree_path_increment(const ZixBTreeIter* const path)
+{
+#ifdef ZIX_BTREE_COUNTS
+  for (unsigned l = 0U; l < path->level; ++l) {
+    ++path->nodes[l]->data.inode.counts[path->indexes[l]];
+  }
+#else
+  (void)path;
+#endif
+}
+
+/// Subtract one from the count of every child in the first `path.level` frames
+static inline void
+zix_btree_path_decrement(const ZixBTreeIter* const path)
+{
+#ifdef ZIX_BTREE_COUNTS
+  for (unsigned l = 0U; l < path->level; ++l) {
+    --path->nodes[l]->data.inode.counts[path->indexes[l]];
+  }
+#else
+  (void)path;
+#endif
+}
+
+/// Subtract one from the count of the ith child of `n`
+static inline void
+zix_btree_child_decrement(ZixBTreeNode* const n, const unsigned i)
+{
+#ifdef ZIX_BTREE_COUNTS
+  --n->data.inode.counts[i];
+#else
+  (void)n;
+  (void)i;
+#endif
+}
+
+/// Split lhs, the i'th child of `n`, into itself and the new node `rhs`
+static void
+zix_btree_split_child(ZixBTreeNode* const n,
                       const unsigned      i,
-                      ZixBTreeNode* const lhs)
+                      ZixBTreeNode* const lhs,
+                      ZixBTreeNode* const rhs)
 {
   assert(lhs->n_vals == zix_btree_max_vals(lhs));
   assert(n->n_vals < ZIX_BTREE_INODE_VALS);
   assert(i < n->n_vals + 1U);
   assert(zix_btree_child(n, i) == lhs);
+  assert(rhs->is_leaf == lhs->is_leaf);
 
   const ZixShort max_n_vals = zix_btree_max_vals(lhs);
-  ZixBTreeNode*  rhs        = zix_btree_node_new(allocator, lhs->is_leaf);
-  if (!rhs) {
-    return NULL;
-  }
 
   // LHS and RHS get roughly half, less the middle value which moves up
   lhs->n_vals /= 2U;
   rhs->n_vals = (ZixShort)(max_n_vals - lhs->n_vals - 1U);
 
-  if (lhs->is_leaf) {
-    // Copy large half from LHS to new RHS node
-    memcpy(rhs->data.leaf.vals,
-           lhs->data.leaf.vals + lhs->n_vals + 1U,
-           rhs->n_vals * sizeof(void*));
+  // Copy large half from LHS to new RHS node
+  zix_btree_move_vals(rhs, 0U, lhs, lhs->n_vals + 1U, rhs->n_vals);
 
-    // Move middle value up to parent
-    zix_btree_ainsert(
-      n->data.inode.vals, n->n_vals, i, lhs->data.leaf.vals[lhs->n_vals]);
-  } else {
-    // Copy large half from LHS to new RHS node
-    memcpy(rhs->data.inode.vals,
-           lhs->data.inode.vals + lhs->n_vals + 1U,
-           rhs->n_vals * sizeof(void*));
+  // Move middle value up to parent
+  zix_btree_insert_val(n, n->n_vals, i, lhs, lhs->n_vals);
+
+  if (!lhs->is_leaf) {
+    // Copy children from LHS to new RHS node
     memcpy(rhs->data.inode.children,
            lhs->data.inode.children + lhs->n_vals + 1U,
            ((size_t)rhs->n_vals + 1U) * sizeof(ZixBTreeNode*));
-
-    // Move middle value up to parent
-    zix_btree_ainsert(
-      n->data.inode.vals, n->n_vals, i, lhs->data.inode.vals[lhs->n_vals]);
+#ifdef ZIX_BTREE_COUNTS
+    memcpy(rhs->data.inode.counts,
+           lhs->data.inode.counts + lhs->n_vals + 1U,
+           ((size_t)rhs->n_vals + 1U) * sizeof(size_t));
+#endif
   }
 
+#ifdef ZIX_BTREE_COUNTS
+  // Split the count of LHS between the two nodes
+  const size_t rhs_size = zix_btree_node_size(rhs);
+  n->data.inode.counts[i] -= rhs_size + 1U;
+  zix_btree_counts_insert(
+    n->data.inode.counts, n->n_vals + 1U, i + 1U, rhs_size);
+#endif
+
   // Insert new RHS node in parent at position i
   zix_btree_ainsert((void**)n->data.inode.children, ++n->n_vals, i + 1U, rhs);
-
-  return rhs;
 }
 
 #ifdef ZIX_BTREE_SORTED_CHECK
@@ -291,21 +611,35 @@ zix_btree_node_is_sorted_with_respect_to(const ZixCompareFunc compare,
 #endif
 
 static unsigned
-zix_btree_find_value(const ZixBTreeCompareFunc compare,
-                     const void* const         compare_user_data,
-                     void* const* const        values,
-                     const unsigned            n_values,
-                     const void* const         key,
+zix_btree_find_value(const ZixBTree* const     t,
+                     const ZixBTreeNode* const n,
+                     const ZixBTreeKey* const  key,
                      bool* const               equal)
 {
+  void* const* const values =
+    n->is_leaf ? n->data.leaf.vals : n->data.inode.vals;
+
+#ifdef ZIX_BTREE_PREFIXES
+  const uint64_t* const prefixes =
+    n->is_leaf ? n->data.leaf.prefixes : n->data.inode.prefixes;
+#endif
+
   unsigned first = 0U;
-  unsigned count = n_values;
+  unsigned count = n->n_vals;
 
   while (count > 0U) {
-    const unsigned half  = count >> 1U;
-    const unsigned i     = first + half;
-    void* const    value = values[i];
-    const int      cmp   = compare(value, key, compare_user_data);
+    const unsigned half = count >> 1U;
+    const unsigned i    = first + half;
+
+#ifdef ZIX_BTREE_PREFIXES
+    // Compare prefixes, and only dereference the value if they're equal
+    const uint64_t prefix = prefixes[i];
+    const int      cmp    = (prefix != key->prefix)
+                              ? ((prefix < key->prefix) ? -1 : 1)
+                              : t->cmp(values[i], key->value, t->cmp_data);
+#else
+    const int cmp = t->cmp(values[i], key->value, t->cmp_data);
+#endif
 
     if (!cmp) {
       *equal = true;
@@ -320,7 +654,8 @@ zix_btree_find_value(const ZixBTreeCompareFunc compare,
     }
   }
 
-  assert(first == n_values || compare(values[first], key, compare_user_data));
+  assert(first == n->n_vals ||
+         t->cmp(values[first], key->value, t->cmp_data));
   *equal = false;
   return first;
 }
@@ -371,30 +706,139 @@ zix_btree_find_pattern(const ZixBTreeCompareFunc compare_key,
   return first;
 }
 
+/*
+  Integer keys are searched for with a branchless binary search, which narrows
+  down the range to a small block that is then scanned linearly, with SIMD
+  instructions if possible.
+*/
+
+#define ZIX_BTREE_SCAN_SIZE 8U
+
+/// Return the number of the first `n_values` integers that are less than `key`
+ZIX_PURE_FUNC static inline unsigned
+zix_btree_count_less(void* const* const values,
+                     const unsigned     n_values,
+                     const uintptr_t    key)
+{
+  unsigned count = 0U;
+  unsigned i     = 0U;
+
+#if UINTPTR_MAX == UINT64_MAX && defined(ZIX_BTREE_SSE2)
+  // SSE2 has no 64-bit comparison, so combine 32-bit ones for each half
+  const __m128i flip = _mm_set1_epi32((int)0x80000000U);
+  const __m128i keys = _mm_xor_si128(_mm_set1_epi64x((long long)key), flip);
+  for (; i + 2U <= n_values; i += 2U) {
+    const __m128i vals = _mm_xor_si128(
+      _mm_loadu_si128((const __m128i*)(const void*)(values + i)), flip);
+
+    const __m128i gt = _mm_cmpgt_epi32(keys, vals);
+    const __m128i eq = _mm_cmpeq_epi32(keys, vals);
+    const __m128i lt = _mm_or_si128(
+      _mm_shuffle_epi32(gt, _MM_SHUFFLE(3, 3, 1, 1)),
+      _mm_and_si128(_mm_shuffle_epi32(eq, _MM_SHUFFLE(3, 3, 1, 1)),
+                    _mm_shuffle_epi32(gt, _MM_SHUFFLE(2, 2, 0, 0))));
+
+    const unsigned mask = (unsigned)_mm_movemask_pd(_mm_castsi128_pd(lt));
+    count += (mask & 1U) + (mask >> 1U);
+  }
+
+#elif UINTPTR_MAX == UINT64_MAX && defined(ZIX_BTREE_NEON)
+  const uint64x2_t keys = vdupq_n_u64(key);
+  for (; i + 2U <= n_values; i += 2U) {
+    const uint64x2_t vals =
+      vld1q_u64((const uint64_t*)(const void*)(values + i));
+
+    count += (unsigned)vaddvq_u64(vshrq_n_u64(vcltq_u64(vals, keys), 63));
+  }
+#endif
+
+  for (; i < n_values; ++i) {
+    count += (uintptr_t)values[i] < key;
+  }
+
+  return count;
+}
+
+/// Find the first integer not less than `key`, or the end
+static unsigned
+zix_btree_find_integer(void* const* const values,
+                       const unsigned     n_values,
+                       const uintptr_t    key,
+                       bool* const        equal)
+{
+  unsigned first = 0U;
+  unsigned count = n_values;
+
+  while (count > ZIX_BTREE_SCAN_SIZE) {
+    const unsigned half = count >> 1U;
+
+    first = ((uintptr_t)values[first + half] < key) ? first + half : first;
+    count -= half;
+  }
+
+  const unsigned i = first + zix_btree_count_less(values + first, count, key);
+
+  *equal = i < n_values && (uintptr_t)values[i] == key;
+  return i;
+}
+
+/// Find the first value in a node that isn't less than a search key
+static unsigned
+zix_btree_find_bound(const ZixBTree* const     t,
+                     const ZixBTreeCompareFunc compare_key,
+                     const void* const         compare_key_user_data,
+                     const ZixBTreeNode* const n,
+                     const ZixBTreeKey* const  key,
+                     bool* const               equal)
+{
+  void* const* const values =
+    n->is_leaf ? n->data.leaf.vals : n->data.inode.vals;
+
+  if (compare_key) {
+    return zix_btree_find_pattern(
+      compare_key, compare_key_user_data, values, n->n_vals, key->value, equal);
+  }
+
+  if (t->cmp) {
+    return zix_btree_find_value(t, n, key, equal);
+  }
+
+  return zix_btree_find_integer(
+    values, n->n_vals, (uintptr_t)key->value, equal);
+}
+
 /// Convenience wrapper to find a value in an internal node
 static unsigned
 zix_btree_inode_find(const ZixBTree* const     t,
                      const ZixBTreeNode* const n,
-                     const void* const         e,
+                     const ZixBTreeKey* const  key,
                      bool* const               equal)
 {
   assert(!n->is_leaf);
 
-  return zix_btree_find_value(
-    t->cmp, t->cmp_data, n->data.inode.vals, n->n_vals, e, equal);
+  if (!t->cmp) {
+    return zix_btree_find_integer(
+      n->data.inode.vals, n->n_vals, (uintptr_t)key->value, equal);
+  }
+
+  return zix_btree_find_value(t, n, key, equal);
 }
 
 /// Convenience wrapper to find a value in a leaf node
 static unsigned
 zix_btree_leaf_find(const ZixBTree* const     t,
                     const ZixBTreeNode* const n,
-                    const void* const         e,
+                    const ZixBTreeKey* const  key,
                     bool* const               equal)
 {
   assert(n->is_leaf);
 
-  return zix_btree_find_value(
-    t->cmp, t->cmp_data, n->data.leaf.vals, n->n_vals, e, equal);
+  if (!t->cmp) {
+    return zix_btree_find_integer(
+      n->data.leaf.vals, n->n_vals, (uintptr_t)key->value, equal);
+  }
+
+  return zix_btree_find_value(t, n, key, equal);
 }
 
 ZIX_PURE_FUNC static inline bool
@@ -411,112 +855,717 @@ zix_btree_is_full(const ZixBTreeNode* const n)
   return n->n_vals == zix_btree_max_vals(n);
 }
 
-static ZixStatus
-zix_btree_grow_up(ZixBTree* const t)
+/// Add `new_root` above the full root, and split the old root into it and `rhs`
+static void
+zix_btree_grow_up(ZixBTree* const     t,
+                  ZixBTreeNode* const new_root,
+                  ZixBTreeNode* const rhs)
 {
-  ZixBTreeNode* const new_root = zix_btree_node_new(t->allocator, false);
-  if (!new_root) {
-    return ZIX_STATUS_NO_MEM;
-  }
-
   // Set old root as the only child of the new root
   new_root->data.inode.children[0U] = t->root;
+#ifdef ZIX_BTREE_COUNTS
+  new_root->data.inode.counts[0U] = zix_btree_node_size(t->root);
+#endif
 
   // Split the old root to get two balanced siblings
-  zix_btree_split_child(t->allocator, new_root, 0U, t->root);
+  zix_btree_split_child(new_root, 0U, t->root, rhs);
   t->root = new_root;
+}
 
-  return ZIX_STATUS_SUCCESS;
+/// Insert `e` into the leaf at the bottom of `path`, at the index there
+static void
+zix_btree_leaf_insert(ZixBTree* const           t,
+                      const ZixBTreeIter* const path,
+                      void* const               e,
+                      const ZixBTreeKey* const  key)
+{
+  ZixBTreeNode* const leaf = path->nodes[path->level];
+  const unsigned      i    = path->indexes[path->level];
+
+  zix_btree_move_vals(leaf, i + 1U, leaf, i, leaf->n_vals - i);
+  zix_btree_set_val(leaf, i, e, key);
+  ++leaf->n_vals;
+  zix_btree_path_increment(path);
+  ++t->size;
+
+  // Remember this leaf so that the next nearby insertion can start here
+  t->finger = *path;
 }
 
-ZixStatus
-zix_btree_insert(ZixBTree* const t, void* const e)
+/// Return true if `key` is within the range of the leaf at the bottom of `path`
+static bool
+zix_btree_leaf_covers(const ZixBTree* const     t,
+                      const ZixBTreeIter* const path,
+                      const ZixBTreeKey* const  key)
 {
-  assert(t);
+  const ZixBTreeNode* const leaf = path->nodes[path->level];
+  if (!leaf->n_vals) {
+    return !path->level; // Empty root
+  }
+
+  void* const* const vals  = leaf->data.leaf.vals;
+  const void* const  value = key->value;
 
-  ZixStatus st = ZIX_STATUS_SUCCESS;
+  if (zix_btree_compare(t, vals[0U], value) > 0) {
+    // Before this leaf, check the separator to the left if there is one
+    for (unsigned l = path->level; l > 0U; --l) {
+      const ZixBTreeNode* const parent = path->nodes[l - 1U];
+      const uint16_t            i      = path->indexes[l - 1U];
+      if (i > 0U) {
+        return zix_btree_compare(t, parent->data.inode.vals[i - 1U], value) < 0;
+      }
+    }
+
+  } else if (zix_btree_compare(t, vals[leaf->n_vals - 1U], value) < 0) {
+    // After this leaf, check the separator to the right if there is one
+    for (unsigned l = path->level; l > 0U; --l) {
+      const ZixBTreeNode* const parent = path->nodes[l - 1U];
+      const uint16_t            i      = path->indexes[l - 1U];
+      if (i < parent->n_vals) {
+        return zix_btree_compare(t, parent->data.inode.vals[i], value) > 0;
+      }
+    }
+  }
+
+  return true;
+}
+
+/*
+  Insertion first locates the position of a key, which either finds an equal
+  element and returns ZIX_STATUS_EXISTS, or returns success with `path`
+  pointing to where the new element should be inserted in a leaf that isn't
+  full.  Only then is the element inserted, so it can be created lazily.
+*/
+
+/// Locate `key` in the leaf at the bottom of `path` if it belongs there
+static ZixStatus
+zix_btree_locate_near(const ZixBTree* const    t,
+                      ZixBTreeIter* const      path,
+                      const ZixBTreeKey* const key)
+{
+  const ZixBTreeNode* const leaf = path->nodes[path->level];
+
+  assert(leaf->is_leaf);
+  if (zix_btree_is_full(leaf) || !zix_btree_leaf_covers(t, path, key)) {
+    return ZIX_STATUS_NOT_FOUND;
+  }
+
+  bool           equal = false;
+  const unsigned i     = zix_btree_leaf_find(t, leaf, key, &equal);
+
+  path->indexes[path->level] = (uint16_t)i;
+  return equal ? ZIX_STATUS_EXISTS : ZIX_STATUS_SUCCESS;
+}
+
+/// Locate `key` by walking down from the root, splitting full nodes
+static ZixStatus
+zix_btree_locate_from_root(ZixBTree* const          t,
+                           ZixBTreeIter* const      path,
+                           const ZixBTreeKey* const key)
+{
+  // Nodes may be split along the way, so forget the last leaf
+  t->finger = zix_btree_end_iter;
 
   // Grow up if necessary to ensure the root is not full
   if (zix_btree_is_full(t->root)) {
-    if ((st = zix_btree_grow_up(t))) {
-      return st;
+    ZixAllocator* const allocator = t->allocator;
+    ZixBTreeNode* const new_root  = zix_btree_node_new(allocator, false);
+    ZixBTreeNode* const rhs =
+      new_root ? zix_btree_node_new(allocator, t->root->is_leaf) : NULL;
+
+    if (!rhs) {
+      zix_aligned_free(allocator, new_root);
+      return ZIX_STATUS_NO_MEM;
     }
+
+    zix_btree_grow_up(t, new_root, rhs);
   }
 
   // Walk down from the root until we reach a suitable leaf
   ZixBTreeNode* node = t->root;
+  *path              = zix_btree_end_iter;
   while (!node->is_leaf) {
     // Search for the value in this node
     bool           equal = false;
-    const unsigned i     = zix_btree_inode_find(t, node, e, &equal);
+    const unsigned i     = zix_btree_inode_find(t, node, key, &equal);
     if (equal) {
+      zix_btree_iter_set_frame(path, node, (ZixShort)i);
       return ZIX_STATUS_EXISTS;
     }
 
     // Value not in this node, but may be in the ith child
+    unsigned      c     = i;
     ZixBTreeNode* child = node->data.inode.children[i];
     if (zix_btree_is_full(child)) {
       // The child is full, split it before continuing
       ZixBTreeNode* const rhs =
-        zix_btree_split_child(t->allocator, node, i, child);
+        zix_btree_node_new(t->allocator, child->is_leaf);
 
       if (!rhs) {
         return ZIX_STATUS_NO_MEM;
       }
 
+      zix_btree_split_child(node, i, child, rhs);
+
       // Compare with new split value to determine which side to use
-      const int cmp = t->cmp(node->data.inode.vals[i], e, t->cmp_data);
+      const int cmp =
+        zix_btree_compare(t, node->data.inode.vals[i], key->value);
       if (cmp < 0) {
+        c     = i + 1U;
         child = rhs; // Split value is less than the new value, move right
       } else if (cmp == 0) {
-        return ZIX_STATUS_EXISTS; // Split value is exactly the value to insert
+        // Split value is exactly the value to insert
+        zix_btree_iter_set_frame(path, node, (ZixShort)i);
+        return ZIX_STATUS_EXISTS;
       }
     }
 
     // Descend to child node and continue
+    zix_btree_iter_set_frame(path, node, (ZixShort)c);
+    ++path->level;
     node = child;
   }
 
   // Search for the value in the leaf
   bool           equal = false;
-  const unsigned i     = zix_btree_leaf_find(t, node, e, &equal);
-  if (equal) {
-    return ZIX_STATUS_EXISTS;
-  }
+  const unsigned i     = zix_btree_leaf_find(t, node, key, &equal);
 
-  // The value is not in the tree, insert into the leaf
-  zix_btree_ainsert(node->data.leaf.vals, node->n_vals++, i, e);
-  ++t->size;
-  return ZIX_STATUS_SUCCESS;
+  zix_btree_iter_set_frame(path, node, (ZixShort)i);
+  return equal ? ZIX_STATUS_EXISTS : ZIX_STATUS_SUCCESS;
 }
 
-static void
-zix_btree_iter_set_frame(ZixBTreeIter* const ti,
-                         ZixBTreeNode* const n,
-                         const ZixShort      i)
+/// Locate `key` in the leaf last inserted into if possible, or from the root
+static ZixStatus
+zix_btree_locate(ZixBTree* const          t,
+                 ZixBTreeIter* const      path,
+                 const ZixBTreeKey* const key)
 {
-  ti->nodes[ti->level]   = n;
-  ti->indexes[ti->level] = (uint16_t)i;
+  // Try the last leaf first, which is usually right for runs of values
+  if (!zix_btree_iter_is_end(t->finger)) {
+    *path = t->finger;
+
+    const ZixStatus st = zix_btree_locate_near(t, path, key);
+    if (st != ZIX_STATUS_NOT_FOUND) {
+      return st;
+    }
+  }
+
+  return zix_btree_locate_from_root(t, path, key);
+}
+
+ZixStatus
+zix_btree_insert(ZixBTree* const t, void* const e)
+{
+  assert(t);
+
+  const ZixBTreeKey key  = zix_btree_key(t, e);
+  ZixBTreeIter      path = zix_btree_end_iter;
+  const ZixStatus   st   = zix_btree_locate(t, &path, &key);
+  if (!st) {
+    zix_btree_leaf_insert(t, &path, e, &key);
+  }
+
+  return st;
+}
+
+ZixStatus
+zix_btree_insert_hint(ZixBTree* const    t,
+                      const ZixBTreeIter hint,
+                      void* const        e)
+{
+  assert(t);
+
+  const ZixBTreeKey key  = zix_btree_key(t, e);
+  ZixBTreeIter      path = hint;
+  ZixStatus         st   = ZIX_STATUS_NOT_FOUND;
+
+  // Try the leaf of the hint first, if it points into one
+  if (!zix_btree_iter_is_end(hint) && hint.nodes[hint.level]->is_leaf) {
+    st = zix_btree_locate_near(t, &path, &key);
+  }
+
+  if (st == ZIX_STATUS_NOT_FOUND) {
+    st = zix_btree_locate(t, &path, &key);
+  }
+
+  if (!st) {
+    zix_btree_leaf_insert(t, &path, e, &key);
+  }
+
+  return st;
+}
+
+ZixStatus
+zix_btree_find_or_insert(ZixBTree* const          t,
+                         const void* const        key,
+                         const ZixBTreeCreateFunc create,
+                         void* const              create_data,
+                         ZixBTreeIter* const      ti)
+{
+  assert(t);
+  assert(create);
+  assert(ti);
+
+  ZixBTreeKey k  = zix_btree_key(t, key);
+  ZixStatus   st = zix_btree_locate(t, ti, &k);
+  if (st) {
+    if (st != ZIX_STATUS_EXISTS) {
+      *ti = zix_btree_end_iter;
+    }
+
+    return st;
+  }
+
+  // The key isn't in the tree, so create an element and insert it where it goes
+  void* e = NULL;
+  if ((st = create(create_data, key, &e))) {
+    *ti = zix_btree_end_iter;
+    return st;
+  }
+
+  assert(!zix_btree_compare(t, e, key));
+  k.value = e;
+  zix_btree_leaf_insert(t, ti, e, &k);
+  return ZIX_STATUS_SUCCESS;
+}
+
+/*
+  Bulk loading builds a tree bottom-up from sorted values, by filling a node at
+  each level from left to right.  When a node is filled, the next value
+  becomes a separator in the parent, and a new empty node is started to its
+  right.  The rightmost node at each level is always linked into its parent,
+  so the partial tree can be freed normally at any point.  When all values
+  have been loaded, nodes on the right edge of the tree may have too few
+  values, so they are fixed from the bottom up by shifting values from their
+  left sibling, or merging with it.
+*/
+
+typedef struct {
+  ZixBTree*     tree;                          ///< Tree being loaded
+  ZixBTreeNode* nodes[ZIX_BTREE_MAX_HEIGHT];   ///< Rightmost node per level
+  ZixBTreeNode* prevs[ZIX_BTREE_MAX_HEIGHT];   ///< Previous node per level
+  void*         last;                          ///< Last loaded value
+  unsigned      height;                        ///< Number of levels
+  ZixShort      leaf_fill;                     ///< Values per full leaf
+  ZixShort      inode_fill;                    ///< Values per full inode
+} ZixBTreeLoader;
+
+/// Return the number of values to fill a node with, at least the minimum
+static ZixShort
+zix_btree_fill_vals(const unsigned max_vals, const unsigned fill)
+{
+  const unsigned min_vals = ((max_vals + 1U) / 2U) - 1U;
+  const unsigned n_vals   = max_vals * fill / 100U;
+
+  return (ZixShort)(n_vals < min_vals ? min_vals : n_vals);
+}
+
+static ZixBTreeLoader
+zix_btree_loader(ZixBTree* const t, const unsigned fill)
+{
+  const unsigned percent = fill < 50U ? 50U : fill > 100U ? 100U : fill;
+
+  ZixBTreeLoader loader = {t,
+                           {t->root},
+                           {NULL},
+                           NULL,
+                           1U,
+                           zix_btree_fill_vals(ZIX_BTREE_LEAF_VALS, percent),
+                           zix_btree_fill_vals(ZIX_BTREE_INODE_VALS, percent)};
+
+  return loader;
+}
+
+/// Add a separator after the full node at `level - 1` and start a new one
+static ZixStatus
+zix_btree_load_separator(ZixBTreeLoader* const    loader,
+                         const unsigned           level,
+                         void* const              value,
+                         const ZixBTreeKey* const key)
+{
+  ZixAllocator* const allocator = loader->tree->allocator;
+  ZixBTreeNode* const child     = loader->nodes[level - 1U];
+  ZixBTreeNode* const next      = zix_btree_node_new(allocator, level == 1U);
+  if (!next) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  if (level == loader->height) {
+    // Grow up with a new root that has the child as its only child
+    ZixBTreeNode* const root = (level < ZIX_BTREE_MAX_HEIGHT)
+                                 ? zix_btree_node_new(allocator, false)
+                                 : NULL;
+    if (!root) {
+      zix_aligned_free(allocator, next);
+      return (level < ZIX_BTREE_MAX_HEIGHT) ? ZIX_STATUS_NO_MEM
+                                            : ZIX_STATUS_OVERFLOW;
+    }
+
+    root->data.inode.children[0U] = child;
+    loader->nodes[loader->height++] = root;
+  }
+
+  ZixBTreeNode* const parent = loader->nodes[level];
+  if (parent->n_vals < loader->inode_fill) {
+    // Add the value to the parent
+    zix_btree_set_val(parent, parent->n_vals++, value, key);
+  } else {
+    // The parent is full too, so the value moves up another level
+    const ZixStatus st =
+      zix_btree_load_separator(loader, level + 1U, value, key);
+    if (st) {
+      zix_aligned_free(allocator, next);
+      return st;
+    }
+  }
+
+  // Link the new node as the last child of the (possibly new) parent
+  ZixBTreeNode* const new_parent = loader->nodes[level];
+
+  new_parent->data.inode.children[new_parent->n_vals] = next;
+  loader->prevs[level - 1U]                           = child;
+  loader->nodes[level - 1U]                           = next;
+  return ZIX_STATUS_SUCCESS;
+}
+
+/// Load a value which is known to be greater than the last one
+static ZixStatus
+zix_btree_load_next(ZixBTreeLoader* const loader, void* const value)
+{
+  ZixBTree* const     t    = loader->tree;
+  const ZixBTreeKey   key  = zix_btree_key(t, value);
+  ZixBTreeNode* const leaf = loader->nodes[0U];
+  if (leaf->n_vals < loader->leaf_fill) {
+    zix_btree_set_val(leaf, leaf->n_vals++, value, &key);
+  } else {
+    const ZixStatus st = zix_btree_load_separator(loader, 1U, value, &key);
+    if (st) {
+      return st;
+    }
+  }
+
+  loader->last = value;
+  ++t->size;
+  return ZIX_STATUS_SUCCESS;
+}
+
+static ZixStatus
+zix_btree_load_value(ZixBTreeLoader* const loader, void* const value)
+{
+  ZixBTree* const t = loader->tree;
+  if (t->size && zix_btree_compare(t, loader->last, value) >= 0) {
+    return ZIX_STATUS_BAD_ARG; // Not strictly increasing
+  }
+
+  return zix_btree_load_next(loader, value);
 }
 
+/// Move `count` values from the end of `lhs` through `parent[s]` to `rhs`
 static void
-zix_btree_iter_push(ZixBTreeIter* const ti,
-                    ZixBTreeNode* const n,
-                    const ZixShort      i)
+zix_btree_shift_right(ZixBTreeNode* const lhs,
+                      ZixBTreeNode* const parent,
+                      const unsigned      s,
+                      ZixBTreeNode* const rhs,
+                      const unsigned      count)
 {
-  assert(ti->level < ZIX_BTREE_MAX_HEIGHT - 1U);
-  ++ti->level;
-  ti->nodes[ti->level]   = n;
-  ti->indexes[ti->level] = (uint16_t)i;
+  const unsigned start = lhs->n_vals - count;
+
+  zix_btree_move_vals(rhs, count, rhs, 0U, rhs->n_vals);
+  zix_btree_move_vals(rhs, 0U, lhs, start + 1U, count - 1U);
+  zix_btree_move_vals(rhs, count - 1U, parent, s, 1U);
+  zix_btree_move_vals(parent, s, lhs, start, 1U);
+
+#ifdef ZIX_BTREE_COUNTS
+  size_t moved = count;
+#endif
+
+  if (!lhs->is_leaf) {
+    ZixBTreeNode** const lhs_children = lhs->data.inode.children;
+    ZixBTreeNode** const rhs_children = rhs->data.inode.children;
+
+    memmove(rhs_children + count,
+            rhs_children,
+            ((size_t)rhs->n_vals + 1U) * sizeof(ZixBTreeNode*));
+    memcpy(
+      rhs_children, lhs_children + start + 1U, count * sizeof(ZixBTreeNode*));
+
+#ifdef ZIX_BTREE_COUNTS
+    size_t* const lhs_counts = lhs->data.inode.counts;
+    size_t* const rhs_counts = rhs->data.inode.counts;
+
+    memmove(rhs_counts + count,
+            rhs_counts,
+            ((size_t)rhs->n_vals + 1U) * sizeof(size_t));
+    memcpy(rhs_counts, lhs_counts + start + 1U, count * sizeof(size_t));
+    for (unsigned i = 0U; i < count; ++i) {
+      moved += rhs_counts[i];
+    }
+#endif
+  }
+
+#ifdef ZIX_BTREE_COUNTS
+  parent->data.inode.counts[s] -= moved;
+  parent->data.inode.counts[s + 1U] += moved;
+#endif
+
+  lhs->n_vals = (ZixShort)(lhs->n_vals - count);
+  rhs->n_vals = (ZixShort)(rhs->n_vals + count);
 }
 
+/// Move `count` values from the start of `rhs` through `parent[s]` to `lhs`
 static void
-zix_btree_iter_pop(ZixBTreeIter* const ti)
+zix_btree_shift_left(ZixBTreeNode* const lhs,
+                     ZixBTreeNode* const parent,
+                     const unsigned      s,
+                     ZixBTreeNode* const rhs,
+                     const unsigned      count)
 {
-  assert(ti->level > 0U);
-  ti->nodes[ti->level]   = NULL;
-  ti->indexes[ti->level] = 0U;
-  --ti->level;
+  const unsigned end = lhs->n_vals + 1U;
+
+  zix_btree_move_vals(lhs, lhs->n_vals, parent, s, 1U);
+  zix_btree_move_vals(lhs, end, rhs, 0U, count - 1U);
+  zix_btree_move_vals(parent, s, rhs, count - 1U, 1U);
+  zix_btree_move_vals(rhs, 0U, rhs, count, rhs->n_vals - count);
+
+#ifdef ZIX_BTREE_COUNTS
+  size_t moved = count;
+#endif
+
+  if (!lhs->is_leaf) {
+    ZixBTreeNode** const lhs_children = lhs->data.inode.children;
+    ZixBTreeNode** const rhs_children = rhs->data.inode.children;
+
+    memcpy(lhs_children + end, rhs_children, count * sizeof(ZixBTreeNode*));
+    memmove(rhs_children,
+            rhs_children + count,
+            ((size_t)rhs->n_vals + 1U - count) * sizeof(ZixBTreeNode*));
+
+#ifdef ZIX_BTREE_COUNTS
+    size_t* const lhs_counts = lhs->data.inode.counts;
+    size_t* const rhs_counts = rhs->data.inode.counts;
+
+    memcpy(lhs_counts + end, rhs_counts, count * sizeof(size_t));
+    memmove(rhs_counts,
+            rhs_counts + count,
+            ((size_t)rhs->n_vals + 1U - count) * sizeof(size_t));
+    for (unsigned i = 0U; i < count; ++i) {
+      moved += lhs_counts[end + i];
+    }
+#endif
+  }
+
+#ifdef ZIX_BTREE_COUNTS
+  parent->data.inode.counts[s] += moved;
+  parent->data.inode.counts[s + 1U] -= moved;
+#endif
+
+  lhs->n_vals = (ZixShort)(lhs->n_vals + count);
+  rhs->n_vals = (ZixShort)(rhs->n_vals - count);
+}
+
+/// Append `parent[s]` and everything in `rhs` to `lhs`
+static void
+zix_btree_append(ZixBTreeNode* const lhs,
+                 ZixBTreeNode* const parent,
+                 const unsigned      s,
+                 ZixBTreeNode* const rhs)
+{
+  zix_btree_move_vals(lhs, lhs->n_vals, parent, s, 1U);
+  zix_btree_move_vals(lhs, lhs->n_vals + 1U, rhs, 0U, rhs->n_vals);
+
+  if (!lhs->is_leaf) {
+    memcpy(lhs->data.inode.children + lhs->n_vals + 1U,
+           rhs->data.inode.children,
+           ((size_t)rhs->n_vals + 1U) * sizeof(ZixBTreeNode*));
+  }
+
+  lhs->n_vals = (ZixShort)(lhs->n_vals + 1U + rhs->n_vals);
+}
+
+/// Fix the right edge of a loaded tree and set its root, or clear it on error
+static ZixStatus
+zix_btree_load_finish(ZixBTreeLoader* const loader, const ZixStatus st)
+{
+  ZixBTree* const t = loader->tree;
+
+  t->root   = loader->nodes[loader->height - 1U];
+  t->finger = zix_btree_end_iter;
+  if (st) {
+    zix_btree_clear(t, NULL, NULL);
+    return st;
+  }
+
+  for (unsigned level = 0U; level + 1U < loader->height; ++level) {
+    ZixBTreeNode* const node     = loader->nodes[level];
+    const unsigned      min_vals = zix_btree_min_vals(node);
+    if (node->n_vals >= min_vals) {
+      continue;
+    }
+
+    // Find the separator between this node and its left sibling
+    unsigned sep_level = level + 1U;
+    while (!loader->nodes[sep_level]->n_vals) {
+      ++sep_level;
+    }
+
+    ZixBTreeNode* const parent = loader->nodes[sep_level];
+    ZixBTreeNode* const lhs    = loader->prevs[level];
+    const unsigned      sep    = parent->n_vals - 1U;
+
+    if (lhs->n_vals + node->n_vals >= 2U * min_vals) {
+      // Shift values from the left sibling so both have at least the minimum
+      zix_btree_shift_right(lhs, parent, sep, node, min_vals - node->n_vals);
+      continue;
+    }
+
+    // Merge into the left sibling, which replaces the right edge up to parent
+    zix_btree_append(lhs, parent, sep, node);
+    --parent->n_vals;
+    for (unsigned l = level; l < sep_level; ++l) {
+      zix_aligned_free(t->allocator, loader->nodes[l]);
+      loader->nodes[l] = loader->prevs[l];
+    }
+  }
+
+  // Replace the root with its only child until it has a value
+  while (loader->height > 1U && !loader->nodes[loader->height - 1U]->n_vals) {
+    zix_aligned_free(t->allocator, loader->nodes[--loader->height]);
+  }
+
+  t->root = loader->nodes[loader->height - 1U];
+#ifdef ZIX_BTREE_COUNTS
+  zix_btree_recount(t->root);
+#endif
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_btree_bulk_load(ZixBTree* const    t,
+                    const size_t       n_values,
+                    void* const* const values,
+                    const unsigned     fill)
+{
+  assert(t);
+  assert(!n_values || values);
+
+  if (t->size) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  ZixBTreeLoader loader = zix_btree_loader(t, fill);
+  ZixStatus      st     = ZIX_STATUS_SUCCESS;
+  for (size_t i = 0U; !st && i < n_values; ++i) {
+    st = zix_btree_load_value(&loader, values[i]);
+  }
+
+  return zix_btree_load_finish(&loader, st);
+}
+
+ZixStatus
+zix_btree_bulk_load_from(ZixBTree* const        t,
+                         const ZixBTreePullFunc pull,
+                         void* const            pull_data,
+                         const unsigned         fill)
+{
+  assert(t);
+  assert(pull);
+
+  if (t->size) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  ZixBTreeLoader loader = zix_btree_loader(t, fill);
+  ZixStatus      st     = ZIX_STATUS_SUCCESS;
+  void*          value  = NULL;
+  while (!st && pull(pull_data, &value)) {
+    st = zix_btree_load_value(&loader, value);
+  }
+
+  return zix_btree_load_finish(&loader, st);
+}
+
+/// Load the values that are only in `a`, in both, or only in `b` into `t`
+static ZixStatus
+zix_btree_load_merged(ZixBTree* const       t,
+                      const ZixBTree* const a,
+                      const ZixBTree* const b,
+                      const unsigned        fill,
+                      const bool            only_a,
+                      const bool            both,
+                      const bool            only_b)
+{
+  assert(t);
+  assert(a);
+  assert(b);
+
+  if (t->size || t == a || t == b || !zix_btree_same_order(t, a) ||
+      !zix_btree_same_order(t, b)) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  ZixBTreeLoader loader = zix_btree_loader(t, fill);
+  ZixStatus      st     = ZIX_STATUS_SUCCESS;
+  ZixBTreeIter   i      = zix_btree_begin(a);
+  ZixBTreeIter   j      = zix_btree_begin(b);
+
+  // Walk both trees in order while neither is exhausted
+  while (!st && !zix_btree_iter_is_end(i) && !zix_btree_iter_is_end(j)) {
+    void* const x   = zix_btree_get(i);
+    void* const y   = zix_btree_get(j);
+    const int   cmp = zix_btree_compare(t, x, y);
+
+    if (cmp < 0) {
+      st = only_a ? zix_btree_load_next(&loader, x) : ZIX_STATUS_SUCCESS;
+      zix_btree_iter_increment(&i);
+    } else if (cmp > 0) {
+      st = only_b ? zix_btree_load_next(&loader, y) : ZIX_STATUS_SUCCESS;
+      zix_btree_iter_increment(&j);
+    } else {
+      st = both ? zix_btree_load_next(&loader, x) : ZIX_STATUS_SUCCESS;
+      zix_btree_iter_increment(&i);
+      zix_btree_iter_increment(&j);
+    }
+  }
+
+  // Load the rest of whichever tree remains, if those values are wanted
+  for (; !st && only_a && !zix_btree_iter_is_end(i);
+       zix_btree_iter_increment(&i)) {
+    st = zix_btree_load_next(&loader, zix_btree_get(i));
+  }
+
+  for (; !st && only_b && !zix_btree_iter_is_end(j);
+       zix_btree_iter_increment(&j)) {
+    st = zix_btree_load_next(&loader, zix_btree_get(j));
+  }
+
+  return zix_btree_load_finish(&loader, st);
+}
+
+ZixStatus
+zix_btree_union(ZixBTree* const       t,
+                const ZixBTree* const a,
+                const ZixBTree* const b,
+                const unsigned        fill)
+{
+  return zix_btree_load_merged(t, a, b, fill, true, true, true);
+}
+
+ZixStatus
+zix_btree_intersection(ZixBTree* const       t,
+                       const ZixBTree* const a,
+                       const ZixBTree* const b,
+                       const unsigned        fill)
+{
+  return zix_btree_load_merged(t, a, b, fill, false, true, false);
+}
+
+ZixStatus
+zix_btree_difference(ZixBTree* const       t,
+                     const ZixBTree* const a,
+                     const ZixBTree* const b,
+                     const unsigned        fill)
+{
+  return zix_btree_load_merged(t, a, b, fill, true, false, false);
 }
 
 /// Enlarge left child by stealing a value from its right sibling
@@ -528,26 +1577,34 @@ zix_btree_rotate_left(ZixBTreeNode* const parent, const unsigned i)
 
   assert(lhs->is_leaf == rhs->is_leaf);
 
-  if (lhs->is_leaf) {
-    // Move parent value to end of LHS
-    lhs->data.leaf.vals[lhs->n_vals++] = parent->data.inode.vals[i];
-
-    // Move first value in RHS to parent
-    parent->data.inode.vals[i] =
-      zix_btree_aerase(rhs->data.leaf.vals, rhs->n_vals, 0U);
-  } else {
-    // Move parent value to end of LHS
-    lhs->data.inode.vals[lhs->n_vals++] = parent->data.inode.vals[i];
+  // Move parent value to end of LHS
+  zix_btree_move_vals(lhs, lhs->n_vals++, parent, i, 1U);
 
-    // Move first value in RHS to parent
-    parent->data.inode.vals[i] =
-      zix_btree_aerase(rhs->data.inode.vals, rhs->n_vals, 0U);
+  // Move first value in RHS to parent
+  zix_btree_move_vals(parent, i, rhs, 0U, 1U);
+  zix_btree_erase_val(rhs, rhs->n_vals - 1U, 0U);
 
+  if (!lhs->is_leaf) {
     // Move first child pointer from RHS to end of LHS
     lhs->data.inode.children[lhs->n_vals] = (ZixBTreeNode*)zix_btree_aerase(
       (void**)rhs->data.inode.children, rhs->n_vals, 0U);
+
+#ifdef ZIX_BTREE_COUNTS
+    // Move first count from RHS to end of LHS
+    const size_t moved =
+      zix_btree_counts_erase(rhs->data.inode.counts, rhs->n_vals, 0U);
+
+    lhs->data.inode.counts[lhs->n_vals] = moved;
+    parent->data.inode.counts[i] += moved;
+    parent->data.inode.counts[i + 1U] -= moved;
+#endif
   }
 
+#ifdef ZIX_BTREE_COUNTS
+  ++parent->data.inode.counts[i];
+  --parent->data.inode.counts[i + 1U];
+#endif
+
   --rhs->n_vals;
 
   return lhs;
@@ -562,28 +1619,34 @@ zix_btree_rotate_right(ZixBTreeNode* const parent, const unsigned i)
 
   assert(lhs->is_leaf == rhs->is_leaf);
 
-  if (lhs->is_leaf) {
-    // Prepend parent value to RHS
-    zix_btree_ainsert(
-      rhs->data.leaf.vals, rhs->n_vals++, 0U, parent->data.inode.vals[i - 1U]);
-
-    // Move last value from LHS to parent
-    parent->data.inode.vals[i - 1U] = lhs->data.leaf.vals[--lhs->n_vals];
-  } else {
-    // Prepend parent value to RHS
-    zix_btree_ainsert(
-      rhs->data.inode.vals, rhs->n_vals++, 0U, parent->data.inode.vals[i - 1U]);
+  // Prepend parent value to RHS
+  zix_btree_insert_val(rhs, rhs->n_vals++, 0U, parent, i - 1U);
 
+  if (!lhs->is_leaf) {
     // Move last child pointer from LHS and prepend to RHS
     zix_btree_ainsert((void**)rhs->data.inode.children,
                       rhs->n_vals,
                       0U,
                       lhs->data.inode.children[lhs->n_vals]);
 
-    // Move last value from LHS to parent
-    parent->data.inode.vals[i - 1U] = lhs->data.inode.vals[--lhs->n_vals];
+#ifdef ZIX_BTREE_COUNTS
+    // Move last count from LHS and prepend to RHS
+    const size_t moved = lhs->data.inode.counts[lhs->n_vals];
+
+    zix_btree_counts_insert(rhs->data.inode.counts, rhs->n_vals, 0U, moved);
+    parent->data.inode.counts[i - 1U] -= moved;
+    parent->data.inode.counts[i] += moved;
+#endif
   }
 
+  // Move last value from LHS to parent
+  zix_btree_move_vals(parent, i - 1U, lhs, --lhs->n_vals, 1U);
+
+#ifdef ZIX_BTREE_COUNTS
+  --parent->data.inode.counts[i - 1U];
+  ++parent->data.inode.counts[i];
+#endif
+
   return rhs;
 }
 
@@ -598,29 +1661,29 @@ zix_btree_merge(ZixBTree* const t, ZixBTreeNode* const n, const unsigned i)
   assert(lhs->n_vals + rhs->n_vals < zix_btree_max_vals(lhs));
 
   // Move parent value to end of LHS
-  if (lhs->is_leaf) {
-    lhs->data.leaf.vals[lhs->n_vals++] =
-      zix_btree_aerase(n->data.inode.vals, n->n_vals, i);
-  } else {
-    lhs->data.inode.vals[lhs->n_vals++] =
-      zix_btree_aerase(n->data.inode.vals, n->n_vals, i);
-  }
+  zix_btree_move_vals(lhs, lhs->n_vals++, n, i, 1U);
+  zix_btree_erase_val(n, n->n_vals - 1U, i);
 
   // Erase corresponding child pointer (to RHS) in parent
   zix_btree_aerase((void**)n->data.inode.children, n->n_vals, i + 1U);
 
+#ifdef ZIX_BTREE_COUNTS
+  // Add the parent value and RHS to the count of LHS
+  n->data.inode.counts[i] +=
+    1U + zix_btree_counts_erase(n->data.inode.counts, n->n_vals, i + 1U);
+#endif
+
   // Add everything from RHS to end of LHS
-  if (lhs->is_leaf) {
-    memcpy(lhs->data.leaf.vals + lhs->n_vals,
-           rhs->data.leaf.vals,
-           rhs->n_vals * sizeof(void*));
-  } else {
-    memcpy(lhs->data.inode.vals + lhs->n_vals,
-           rhs->data.inode.vals,
-           rhs->n_vals * sizeof(void*));
+  zix_btree_move_vals(lhs, lhs->n_vals, rhs, 0U, rhs->n_vals);
+  if (!lhs->is_leaf) {
     memcpy(lhs->data.inode.children + lhs->n_vals,
            rhs->data.inode.children,
            ((size_t)rhs->n_vals + 1U) * sizeof(void*));
+#ifdef ZIX_BTREE_COUNTS
+    memcpy(lhs->data.inode.counts + lhs->n_vals,
+           rhs->data.inode.counts,
+           ((size_t)rhs->n_vals + 1U) * sizeof(size_t));
+#endif
   }
 
   lhs->n_vals += rhs->n_vals;
@@ -635,26 +1698,37 @@ zix_btree_merge(ZixBTree* const t, ZixBTreeNode* const n, const unsigned i)
   return lhs;
 }
 
-/// Remove and return the min value from the subtree rooted at `n`
-static void*
-zix_btree_remove_min(ZixBTree* const t, ZixBTreeNode* n)
+/// Move the min value from the subtree rooted at `n` to the dth in `dst`
+static void
+zix_btree_remove_min(ZixBTree* const     t,
+                     ZixBTreeNode*       n,
+                     ZixBTreeNode* const dst,
+                     const unsigned      d)
 {
   assert(zix_btree_can_remove_from(n));
 
   while (!n->is_leaf) {
     ZixBTreeNode* const* const children = n->data.inode.children;
 
+    ZixBTreeNode* const parent = n;
+
     n = zix_btree_can_remove_from(children[0U])   ? children[0U]
         : zix_btree_can_remove_from(children[1U]) ? zix_btree_rotate_left(n, 0U)
                                                   : zix_btree_merge(t, n, 0U);
+
+    zix_btree_child_decrement(parent, 0U);
   }
 
-  return zix_btree_aerase(n->data.leaf.vals, --n->n_vals, 0U);
+  zix_btree_move_vals(dst, d, n, 0U, 1U);
+  zix_btree_erase_val(n, --n->n_vals, 0U);
 }
 
-/// Remove and return the max value from the subtree rooted at `n`
-static void*
-zix_btree_remove_max(ZixBTree* const t, ZixBTreeNode* n)
+/// Move the max value from the subtree rooted at `n` to the dth in `dst`
+static void
+zix_btree_remove_max(ZixBTree* const     t,
+                     ZixBTreeNode*       n,
+                     ZixBTreeNode* const dst,
+                     const unsigned      d)
 {
   assert(zix_btree_can_remove_from(n));
 
@@ -664,12 +1738,16 @@ zix_btree_remove_max(ZixBTree* const t, ZixBTreeNode* n)
     const unsigned y = n->n_vals - 1U;
     const unsigned z = n->n_vals;
 
+    ZixBTreeNode* const parent = n;
+
     n = zix_btree_can_remove_from(children[z])   ? children[z]
         : zix_btree_can_remove_from(children[y]) ? zix_btree_rotate_right(n, z)
                                                  : zix_btree_merge(t, n, y);
+
+    zix_btree_child_decrement(parent, parent->n_vals);
   }
 
-  return n->data.leaf.vals[--n->n_vals];
+  zix_btree_move_vals(dst, d, n, --n->n_vals, 1U);
 }
 
 static ZixBTreeNode*
@@ -717,16 +1795,23 @@ zix_btree_replace_value(ZixBTree* const     t,
   // Stash the value for the caller before it is replaced
   *out = n->data.inode.vals[i];
 
-  n->data.inode.vals[i] =
+  const bool from_lhs =
     // Left child has more values, steal its largest
-    (lhs->n_vals > rhs->n_vals) ? zix_btree_remove_max(t, lhs)
+    (lhs->n_vals > rhs->n_vals) ? true
 
     // Right child has more values, steal its smallest
-    : (rhs->n_vals > lhs->n_vals) ? zix_btree_remove_min(t, rhs)
+    : (rhs->n_vals > lhs->n_vals) ? false
 
     // Children are balanced, use index parity as a low-bias tie breaker
-    : (i & 1U) ? zix_btree_remove_max(t, lhs)
-               : zix_btree_remove_min(t, rhs);
+    : (i & 1U);
+
+  if (from_lhs) {
+    zix_btree_remove_max(t, lhs, n, i);
+    zix_btree_child_decrement(n, i);
+  } else {
+    zix_btree_remove_min(t, rhs, n, i);
+    zix_btree_child_decrement(n, i + 1U);
+  }
 
   return ZIX_STATUS_SUCCESS;
 }
@@ -740,11 +1825,14 @@ zix_btree_remove(ZixBTree* const     t,
   assert(t);
   assert(out);
 
+  const ZixBTreeKey key = zix_btree_key(t, e);
+
   ZixBTreeNode* n  = t->root;
   ZixBTreeIter* ti = next;
   ZixStatus     st = ZIX_STATUS_SUCCESS;
 
-  *ti = zix_btree_end_iter;
+  *ti       = zix_btree_end_iter;
+  t->finger = zix_btree_end_iter;
 
   /* To remove in a single walk down, the tree is adjusted along the way so
      that the current node always has at least one more value than the
@@ -763,7 +1851,7 @@ zix_btree_remove(ZixBTree* const     t,
 
     // Search for the value in the current node and update the iterator
     bool           equal = false;
-    const unsigned i     = zix_btree_inode_find(t, n, e, &equal);
+    const unsigned i     = zix_btree_inode_find(t, n, &key, &equal);
 
     zix_btree_iter_set_frame(ti, n, i);
 
@@ -771,6 +1859,7 @@ zix_btree_remove(ZixBTree* const     t,
       // Found in internal node
       if (!(st = zix_btree_replace_value(t, n, i, out))) {
         // Replaced hole with a value from a direct child
+        zix_btree_path_decrement(ti);
         --t->size;
         return st;
       }
@@ -790,7 +1879,7 @@ zix_btree_remove(ZixBTree* const     t,
 
   // We're at the leaf the value may be in, search for the value in it
   bool           equal = false;
-  const unsigned i     = zix_btree_leaf_find(t, n, e, &equal);
+  const unsigned i     = zix_btree_leaf_find(t, n, &key, &equal);
 
   if (!equal) { // Not found in tree
     *ti = zix_btree_end_iter;
@@ -798,7 +1887,9 @@ zix_btree_remove(ZixBTree* const     t,
   }
 
   // Erase from leaf node
-  *out = zix_btree_aerase(n->data.leaf.vals, --n->n_vals, i);
+  *out = n->data.leaf.vals[i];
+  zix_btree_erase_val(n, --n->n_vals, i);
+  zix_btree_path_decrement(ti);
 
   // Update next iterator
   if (n->n_vals == 0U) {
@@ -818,21 +1909,495 @@ zix_btree_remove(ZixBTree* const     t,
   return ZIX_STATUS_SUCCESS;
 }
 
-ZixStatus
-zix_btree_find(const ZixBTree* const t,
-               const void* const     e,
-               ZixBTreeIter* const   ti)
+/*
+  Splitting, joining, and erasing ranges work on whole subtrees.  A tree is
+  cut in two along the path to a key, which leaves nodes with too few values
+  on the inner edge of both halves.  These are fixed from the top down by
+  shifting values from their sibling or merging with it.  Two trees are
+  joined by taking a separator from the inner edge of the shorter one, and
+  attaching it and the shorter tree to the node at the matching height on
+  the edge of the taller one.  These operations move too much to be undone
+  part way through, so all the nodes they might need are allocated first.
+*/
+
+#define ZIX_BTREE_RESERVE_SIZE ((3U * ZIX_BTREE_MAX_HEIGHT) + 2U)
+
+/// Nodes allocated in advance for an operation that can't fail part way
+typedef struct {
+  ZixBTreeNode* nodes[ZIX_BTREE_RESERVE_SIZE]; ///< Unused nodes
+  unsigned      n_nodes;                       ///< Number of unused nodes
+} ZixBTreeReserve;
+
+/// Free any unused nodes in `reserve`
+static void
+zix_btree_release(ZixAllocator* const allocator, ZixBTreeReserve* const reserve)
 {
-  assert(t);
-  assert(ti);
+  while (reserve->n_nodes) {
+    zix_aligned_free(allocator, reserve->nodes[--reserve->n_nodes]);
+  }
+}
 
-  ZixBTreeNode* n = t->root;
+/// Allocate `n_nodes` nodes in `reserve`, or none at all
+static ZixStatus
+zix_btree_reserve(ZixAllocator* const    allocator,
+                  ZixBTreeReserve* const reserve,
+                  const unsigned         n_nodes)
+{
+  assert(n_nodes <= ZIX_BTREE_RESERVE_SIZE);
 
-  *ti = zix_btree_end_iter;
+  while (reserve->n_nodes < n_nodes) {
+    ZixBTreeNode* const node = zix_btree_node_new(allocator, true);
+    if (!node) {
+      zix_btree_release(allocator, reserve);
+      return ZIX_STATUS_NO_MEM;
+    }
 
-  while (!n->is_leaf) {
-    bool           equal = false;
-    const unsigned i     = zix_btree_inode_find(t, n, e, &equal);
+    reserve->nodes[reserve->n_nodes++] = node;
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+/// Take an empty node from `reserve`
+static ZixBTreeNode*
+zix_btree_take(ZixBTreeReserve* const reserve, const bool leaf)
+{
+  assert(reserve->n_nodes);
+
+  ZixBTreeNode* const node = reserve->nodes[--reserve->n_nodes];
+  node->is_leaf            = leaf;
+  node->n_vals             = 0U;
+  return node;
+}
+
+/// Return the number of levels in the subtree rooted at `n`
+ZIX_PURE_FUNC static unsigned
+zix_btree_height(const ZixBTreeNode* n)
+{
+  unsigned height = 1U;
+  for (; !n->is_leaf; n = n->data.inode.children[0U]) {
+    ++height;
+  }
+
+  return height;
+}
+
+/// Return true if `a` and `b` have the same ordering and allocator
+ZIX_PURE_FUNC static bool
+zix_btree_compatible(const ZixBTree* const a, const ZixBTree* const b)
+{
+  return a != b && a->allocator == b->allocator && zix_btree_same_order(a, b);
+}
+
+/// Fix the children of `n` around `n[i]` if either has too few values
+static void
+zix_btree_fix_pair(ZixBTree* const t, ZixBTreeNode* const n, const unsigned i)
+{
+  ZixBTreeNode* const lhs      = zix_btree_child(n, i);
+  ZixBTreeNode* const rhs      = zix_btree_child(n, i + 1U);
+  const unsigned      min_vals = zix_btree_min_vals(lhs);
+
+  if (lhs->n_vals + rhs->n_vals < zix_btree_max_vals(lhs)) {
+    if (lhs->n_vals < min_vals || rhs->n_vals < min_vals) {
+      zix_btree_merge(t, n, i);
+    }
+  } else if (lhs->n_vals < min_vals) {
+    zix_btree_shift_left(lhs, n, i, rhs, min_vals - lhs->n_vals);
+  } else if (rhs->n_vals < min_vals) {
+    zix_btree_shift_right(lhs, n, i, rhs, min_vals - rhs->n_vals);
+  }
+}
+
+/// Fix nodes with too few values on the left or right edge of `t`
+static void
+zix_btree_fix_edge(ZixBTree* const t, const bool right)
+{
+  // Replace the root with its only child until it has a value
+  while (!t->root->is_leaf && !t->root->n_vals) {
+    ZixBTreeNode* const root = t->root;
+
+    t->root = root->data.inode.children[0U];
+    zix_aligned_free(t->allocator, root);
+  }
+
+  /* Walk down the edge, giving each internal node more than the minimum
+     number of values, so that its children can always be merged. */
+
+  ZixBTreeNode* n = t->root;
+  while (!n->is_leaf) {
+    const unsigned      i       = right ? n->n_vals : 0U;
+    const unsigned      s       = right ? i - 1U : 0U;
+    ZixBTreeNode* const sibling = zix_btree_child(n, right ? s : 1U);
+    ZixBTreeNode*       child   = zix_btree_child(n, i);
+
+    const unsigned need =
+      zix_btree_min_vals(child) + (child->is_leaf ? 0U : 1U);
+
+    if (child->n_vals < need) {
+      if (child->n_vals + sibling->n_vals < zix_btree_max_vals(child)) {
+        child = zix_btree_merge(t, n, s);
+      } else if (right) {
+        zix_btree_shift_right(sibling, n, s, child, need - child->n_vals);
+      } else {
+        zix_btree_shift_left(child, n, s, sibling, need - child->n_vals);
+      }
+    }
+
+    n = child;
+  }
+}
+
+/// Remove and return the first or last value in `t`, which must not be empty
+static void*
+zix_btree_pop(ZixBTree* const t, const bool last)
+{
+  ZixBTreeNode* n = t->root;
+  while (!n->is_leaf) {
+    const unsigned i = last ? n->n_vals : 0U;
+
+    zix_btree_child_decrement(n, i);
+    n = zix_btree_child(n, i);
+  }
+
+  assert(n->n_vals);
+
+  void* const value = n->data.leaf.vals[last ? n->n_vals - 1U : 0U];
+  if (!last) {
+    zix_btree_erase_val(n, n->n_vals - 1U, 0U);
+  }
+
+  --n->n_vals;
+  zix_btree_fix_edge(t, last);
+  return value;
+}
+
+/// Move all values in `t` that aren't less than `key` into `rhs`
+static void
+zix_btree_cut(ZixBTree* const          t,
+              const ZixBTreeKey* const key,
+              ZixBTree* const          rhs,
+              ZixBTreeReserve* const   reserve)
+{
+  ZixBTreeNode* lnodes[ZIX_BTREE_MAX_HEIGHT] = {NULL}; // Right edge of `t`
+  ZixBTreeNode* rnodes[ZIX_BTREE_MAX_HEIGHT] = {NULL}; // Left edge of `rhs`
+
+  // Walk down to the key, moving everything after the path to new nodes
+  unsigned      depth = 0U;
+  ZixBTreeNode* n     = t->root;
+  for (;; ++depth) {
+    assert(depth < ZIX_BTREE_MAX_HEIGHT);
+
+    bool           equal = false;
+    const unsigned i     = zix_btree_find_bound(t, NULL, NULL, n, key, &equal);
+    const unsigned count = n->n_vals - i;
+
+    ZixBTreeNode* const r = zix_btree_take(reserve, n->is_leaf);
+    zix_btree_move_vals(r, 0U, n, i, count);
+    r->n_vals     = (ZixShort)count;
+    n->n_vals     = (ZixShort)i;
+    lnodes[depth] = n;
+    rnodes[depth] = r;
+    if (depth) {
+      rnodes[depth - 1U]->data.inode.children[0U] = r;
+    }
+
+    if (n->is_leaf) {
+      break;
+    }
+
+    // Move the children after the ith to the new node, after its first child
+    memcpy(r->data.inode.children + 1U,
+           n->data.inode.children + i + 1U,
+           count * sizeof(ZixBTreeNode*));
+#ifdef ZIX_BTREE_COUNTS
+    memcpy(r->data.inode.counts + 1U,
+           n->data.inode.counts + i + 1U,
+           count * sizeof(size_t));
+#endif
+
+    n = n->data.inode.children[i];
+  }
+
+#ifdef ZIX_BTREE_COUNTS
+  // Recount the children on both sides of the cut, from the bottom up
+  while (depth--) {
+    ZixBTreeNode* const l = lnodes[depth];
+    ZixBTreeNode* const r = rnodes[depth];
+
+    l->data.inode.counts[l->n_vals] = zix_btree_node_size(lnodes[depth + 1U]);
+    r->data.inode.counts[0U]        = zix_btree_node_size(rnodes[depth + 1U]);
+  }
+#else
+  (void)lnodes;
+#endif
+
+  rhs->root = rnodes[0U];
+  zix_btree_fix_edge(t, true);
+  zix_btree_fix_edge(rhs, false);
+}
+
+/// Attach `sep` and the shorter tree `s` to the left or right edge of `t`
+static void
+zix_btree_graft(ZixBTree* const        t,
+                ZixBTree* const        s,
+                void* const            sep,
+                const bool             right,
+                ZixBTreeReserve* const reserve)
+{
+  const ZixBTreeKey   key      = zix_btree_key(t, sep);
+  ZixBTreeNode* const sub      = s->root;
+  const bool          empty    = sub->is_leaf && !sub->n_vals;
+  const unsigned      s_height = empty ? 0U : zix_btree_height(sub);
+  unsigned            height   = zix_btree_height(t->root);
+
+  assert(s_height <= height);
+
+#ifdef ZIX_BTREE_COUNTS
+  const size_t s_size = empty ? 0U : zix_btree_node_size(sub);
+#endif
+
+  if (s_height == height) {
+    // Make a new root with both trees as children, which may be merged
+    ZixBTreeNode* const root = zix_btree_take(reserve, false);
+    ZixBTreeNode* const lhs  = right ? t->root : sub;
+    ZixBTreeNode* const rhs  = right ? sub : t->root;
+
+    zix_btree_set_val(root, 0U, sep, &key);
+    root->n_vals                  = 1U;
+    root->data.inode.children[0U] = lhs;
+    root->data.inode.children[1U] = rhs;
+#ifdef ZIX_BTREE_COUNTS
+    root->data.inode.counts[0U] = zix_btree_node_size(lhs);
+    root->data.inode.counts[1U] = zix_btree_node_size(rhs);
+#endif
+
+    t->root = root;
+    zix_btree_fix_pair(t, root, 0U);
+    return;
+  }
+
+  // Grow up if the root is full, so that its children can be split
+  if (zix_btree_is_full(t->root)) {
+    assert(height < ZIX_BTREE_MAX_HEIGHT);
+    ZixBTreeNode* const new_root = zix_btree_take(reserve, false);
+    ZixBTreeNode* const rhs      = zix_btree_take(reserve, t->root->is_leaf);
+
+    zix_btree_grow_up(t, new_root, rhs);
+    ++height;
+  }
+
+  // Walk down the edge to the level above `s`, splitting full nodes
+  ZixBTreeNode* n = t->root;
+  for (; height > s_height + 1U; --height) {
+    unsigned      i     = right ? n->n_vals : 0U;
+    ZixBTreeNode* child = zix_btree_child(n, i);
+    if (zix_btree_is_full(child)) {
+      ZixBTreeNode* const rhs = zix_btree_take(reserve, child->is_leaf);
+
+      zix_btree_split_child(n, i, child, rhs);
+      if (right) {
+        i     = n->n_vals;
+        child = rhs;
+      }
+    }
+
+#ifdef ZIX_BTREE_COUNTS
+    n->data.inode.counts[i] += 1U + s_size;
+#endif
+
+    n = child;
+  }
+
+  // Insert the separator, and `s` on the outer side of it
+  const unsigned i = right ? n->n_vals : 0U;
+  zix_btree_move_vals(n, i + 1U, n, i, n->n_vals - i);
+  zix_btree_set_val(n, i, sep, &key);
+  if (!n->is_leaf) {
+    const unsigned c = right ? i + 1U : 0U;
+
+    zix_btree_ainsert((void**)n->data.inode.children, n->n_vals + 1U, c, sub);
+#ifdef ZIX_BTREE_COUNTS
+    zix_btree_counts_insert(n->data.inode.counts, n->n_vals + 1U, c, s_size);
+#endif
+  }
+
+  ++n->n_vals;
+  if (!n->is_leaf) {
+    zix_btree_fix_pair(t, n, i);
+  }
+}
+
+/// Move everything in `rhs` to the end of `lhs`, where neither are empty
+static void
+zix_btree_concat(ZixBTree* const        lhs,
+                 ZixBTree* const        rhs,
+                 ZixBTreeReserve* const reserve)
+{
+  const bool right =
+    zix_btree_height(lhs->root) >= zix_btree_height(rhs->root);
+
+  ZixBTree* const tall = right ? lhs : rhs;
+  ZixBTree* const low  = right ? rhs : lhs;
+
+  // Take the separator from the inner edge of the shorter tree
+  void* const         sep      = zix_btree_pop(low, !right);
+  ZixBTreeNode* const low_root = low->root;
+  const bool          empty    = low_root->is_leaf && !low_root->n_vals;
+
+  zix_btree_graft(tall, low, sep, right, reserve);
+  lhs->root = tall->root;
+  rhs->root = empty ? low_root : zix_btree_take(reserve, true);
+}
+
+ZixStatus
+zix_btree_split(ZixBTree* const t, const void* const key, ZixBTree* const rhs)
+{
+  assert(t);
+  assert(rhs);
+
+  if (rhs->size || !zix_btree_compatible(t, rhs)) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  ZixBTreeReserve reserve = {{NULL}, 0U};
+  const ZixStatus st =
+    zix_btree_reserve(t->allocator, &reserve, zix_btree_height(t->root));
+
+  if (!st) {
+    const ZixBTreeKey k = zix_btree_key(t, key);
+
+    zix_aligned_free(rhs->allocator, rhs->root);
+    zix_btree_cut(t, &k, rhs, &reserve);
+    assert(!reserve.n_nodes);
+
+    rhs->size   = zix_btree_node_size(rhs->root);
+    t->size     = t->size - rhs->size;
+    t->finger   = zix_btree_end_iter;
+    rhs->finger = zix_btree_end_iter;
+  }
+
+  return st;
+}
+
+ZixStatus
+zix_btree_join(ZixBTree* const lhs, ZixBTree* const rhs)
+{
+  assert(lhs);
+  assert(rhs);
+
+  if (!zix_btree_compatible(lhs, rhs)) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  if (!rhs->size) {
+    return ZIX_STATUS_SUCCESS;
+  }
+
+  if (!lhs->size) {
+    // Simply swap roots, since `lhs` is empty
+    ZixBTreeNode* const root = lhs->root;
+    lhs->root                = rhs->root;
+    rhs->root                = root;
+  } else {
+    // Check that every value in `lhs` is less than every value in `rhs`
+    void* const last  = zix_btree_get(zix_btree_rbegin(lhs));
+    void* const first = zix_btree_get(zix_btree_begin(rhs));
+    if (zix_btree_compare(lhs, last, first) >= 0) {
+      return ZIX_STATUS_BAD_ARG;
+    }
+
+    const unsigned lhs_height = zix_btree_height(lhs->root);
+    const unsigned rhs_height = zix_btree_height(rhs->root);
+    const unsigned height = lhs_height > rhs_height ? lhs_height : rhs_height;
+
+    ZixBTreeReserve reserve = {{NULL}, 0U};
+    const ZixStatus st =
+      zix_btree_reserve(lhs->allocator, &reserve, height + 2U);
+    if (st) {
+      return st;
+    }
+
+    zix_btree_concat(lhs, rhs, &reserve);
+    zix_btree_release(lhs->allocator, &reserve);
+  }
+
+  lhs->size   = lhs->size + rhs->size;
+  rhs->size   = 0U;
+  lhs->finger = zix_btree_end_iter;
+  rhs->finger = zix_btree_end_iter;
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_btree_erase_range(ZixBTree* const           t,
+                      const void* const         lo,
+                      const void* const         hi,
+                      const ZixBTreeDestroyFunc destroy,
+                      const void* const         destroy_user_data)
+{
+  assert(t);
+
+  if (!t->size || zix_btree_compare(t, lo, hi) >= 0) {
+    return ZIX_STATUS_SUCCESS;
+  }
+
+  // Allocate enough nodes for two cuts and a join
+  const unsigned  height  = zix_btree_height(t->root);
+  ZixBTreeReserve reserve = {{NULL}, 0U};
+  const ZixStatus st =
+    zix_btree_reserve(t->allocator, &reserve, (3U * height) + 2U);
+  if (st) {
+    return st;
+  }
+
+  // Cut the tree into the values before, within, and after the range
+  const ZixBTreeKey lo_key = zix_btree_key(t, lo);
+  const ZixBTreeKey hi_key = zix_btree_key(t, hi);
+  ZixBTree          mid    = *t;
+  ZixBTree          after  = *t;
+  zix_btree_cut(t, &lo_key, &mid, &reserve);
+  zix_btree_cut(&mid, &hi_key, &after, &reserve);
+
+  // Destroy the values in the range and free their nodes
+  const size_t n_erased = zix_btree_node_size(mid.root);
+  zix_btree_free_children(&mid, mid.root, destroy, destroy_user_data);
+  zix_aligned_free(t->allocator, mid.root);
+
+  // Join the values before and after the range, leaving `after` empty
+  if (!t->root->is_leaf || t->root->n_vals) {
+    if (!after.root->is_leaf || after.root->n_vals) {
+      zix_btree_concat(t, &after, &reserve);
+    }
+  } else {
+    ZixBTreeNode* const root = t->root;
+    t->root                  = after.root;
+    after.root               = root;
+  }
+
+  zix_aligned_free(t->allocator, after.root);
+  zix_btree_release(t->allocator, &reserve);
+
+  t->size   = t->size - n_erased;
+  t->finger = zix_btree_end_iter;
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_btree_find(const ZixBTree* const t,
+               const void* const     e,
+               ZixBTreeIter* const   ti)
+{
+  assert(t);
+  assert(ti);
+
+  const ZixBTreeKey key = zix_btree_key(t, e);
+  ZixBTreeNode*     n   = t->root;
+
+  *ti = zix_btree_end_iter;
+
+  while (!n->is_leaf) {
+    bool           equal = false;
+    const unsigned i     = zix_btree_inode_find(t, n, &key, &equal);
 
     zix_btree_iter_set_frame(ti, n, i);
 
@@ -845,7 +2410,7 @@ zix_btree_find(const ZixBTree* const t,
   }
 
   bool           equal = false;
-  const unsigned i     = zix_btree_leaf_find(t, n, e, &equal);
+  const unsigned i     = zix_btree_leaf_find(t, n, &key, &equal);
   if (equal) {
     zix_btree_iter_set_frame(ti, n, i);
     return ZIX_STATUS_SUCCESS;
@@ -867,23 +2432,23 @@ zix_btree_lower_bound(const ZixBTree* const     t,
 
   *ti = zix_btree_end_iter;
 
+  const ZixBTreeKey search_key =
+    compare_key ? zix_btree_pattern_key(key) : zix_btree_key(t, key);
+
   ZixBTreeNode* n           = t->root; // Current node
-  uint16_t      found_level = 0U;      // Lowest level a match was found at
-  bool          found       = false;   // True if a match was ever found
+  uint16_t      found_level = 0U;      // Lowest level a candidate was found at
+  bool          found       = false;   // True if a candidate was ever found
 
   // Search down until we reach a leaf
   while (!n->is_leaf) {
     bool equal = false;
 
-    const unsigned i = zix_btree_find_pattern(compare_key,
-                                              compare_key_user_data,
-                                              n->data.inode.vals,
-                                              n->n_vals,
-                                              key,
-                                              &equal);
+    const unsigned i = zix_btree_find_bound(
+      t, compare_key, compare_key_user_data, n, &search_key, &equal);
 
     zix_btree_iter_set_frame(ti, n, i);
-    if (equal) {
+    if (i < n->n_vals) {
+      // This value is the least not less than the key so far
       found_level = ti->level;
       found       = true;
     }
@@ -894,12 +2459,8 @@ zix_btree_lower_bound(const ZixBTree* const     t,
 
   bool equal = false;
 
-  const unsigned i = zix_btree_find_pattern(compare_key,
-                                            compare_key_user_data,
-                                            n->data.leaf.vals,
-                                            n->n_vals,
-                                            key,
-                                            &equal);
+  const unsigned i = zix_btree_find_bound(
+    t, compare_key, compare_key_user_data, n, &search_key, &equal);
 
   zix_btree_iter_set_frame(ti, n, i);
   if (equal) {
@@ -919,6 +2480,108 @@ zix_btree_lower_bound(const ZixBTree* const     t,
   return ZIX_STATUS_SUCCESS;
 }
 
+size_t
+zix_btree_rank(const ZixBTree* const t, const void* const e)
+{
+  assert(t);
+
+  size_t rank = 0U;
+
+#ifdef ZIX_BTREE_COUNTS
+  // Walk down, adding everything to the left of the path
+  const ZixBTreeKey   key = zix_btree_key(t, e);
+  const ZixBTreeNode* n   = t->root;
+  while (!n->is_leaf) {
+    bool           equal = false;
+    const unsigned i     = zix_btree_inode_find(t, n, &key, &equal);
+    const unsigned end   = equal ? i + 1U : i;
+
+    rank += i;
+    for (unsigned j = 0U; j < end; ++j) {
+      rank += n->data.inode.counts[j];
+    }
+
+    if (equal) {
+      return rank;
+    }
+
+    n = zix_btree_child(n, i);
+  }
+
+  bool equal = false;
+  return rank + zix_btree_leaf_find(t, n, &key, &equal);
+
+#else
+  // Count every value before the first one that isn't less than e
+  for (ZixBTreeIter i = zix_btree_begin(t);
+       !zix_btree_iter_is_end(i) &&
+       zix_btree_compare(t, zix_btree_get(i), e) < 0;
+       zix_btree_iter_increment(&i)) {
+    ++rank;
+  }
+
+  return rank;
+#endif
+}
+
+ZixStatus
+zix_btree_select(const ZixBTree* const t,
+                 size_t                index,
+                 ZixBTreeIter* const   ti)
+{
+  assert(t);
+  assert(ti);
+
+  *ti = zix_btree_end_iter;
+  if (index >= t->size) {
+    return ZIX_STATUS_NOT_FOUND;
+  }
+
+#ifdef ZIX_BTREE_COUNTS
+  // Walk down, skipping over children and values before the index
+  ZixBTreeNode* n = t->root;
+  while (!n->is_leaf) {
+    unsigned i = 0U;
+    while (index > n->data.inode.counts[i]) {
+      index -= n->data.inode.counts[i] + 1U;
+      ++i;
+    }
+
+    zix_btree_iter_set_frame(ti, n, (ZixShort)i);
+    if (index == n->data.inode.counts[i]) {
+      return ZIX_STATUS_SUCCESS; // Value in this internal node
+    }
+
+    ++ti->level;
+    n = zix_btree_child(n, i);
+  }
+
+  zix_btree_iter_set_frame(ti, n, (ZixShort)index);
+
+#else
+  // Advance from the beginning
+  *ti = zix_btree_begin(t);
+  for (size_t i = 0U; i < index; ++i) {
+    zix_btree_iter_increment(ti);
+  }
+#endif
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+size_t
+zix_btree_count_range(const ZixBTree* const t,
+                      const void* const     first,
+                      const void* const     last)
+{
+  assert(t);
+
+  const size_t first_rank = zix_btree_rank(t, first);
+  const size_t last_rank  = zix_btree_rank(t, last);
+
+  return (last_rank > first_rank) ? (last_rank - first_rank) : 0U;
+}
+
 void*
 zix_btree_get(const ZixBTreeIter ti)
 {
@@ -960,6 +2623,35 @@ zix_btree_end(const ZixBTree* const t)
   return zix_btree_end_iter;
 }
 
+ZixBTreeIter
+zix_btree_rbegin(const ZixBTree* const t)
+{
+  assert(t);
+
+  ZixBTreeIter iter = zix_btree_end_iter;
+
+  if (t->size > 0U) {
+    ZixBTreeNode* n = t->root;
+    while (!n->is_leaf) {
+      zix_btree_iter_set_frame(&iter, n, n->n_vals);
+      ++iter.level;
+      n = zix_btree_child(n, n->n_vals);
+    }
+
+    zix_btree_iter_set_frame(&iter, n, (ZixShort)(n->n_vals - 1U));
+  }
+
+  return iter;
+}
+
+ZixBTreeIter
+zix_btree_rend(const ZixBTree* const t)
+{
+  (void)t;
+
+  return zix_btree_end_iter;
+}
+
 bool
 zix_btree_iter_equals(const ZixBTreeIter lhs, const ZixBTreeIter rhs)
 {
@@ -1016,3 +2708,54 @@ zix_btree_iter_next(const ZixBTreeIter iter)
 
   return next;
 }
+
+ZixStatus
+zix_btree_iter_decrement(ZixBTreeIter* const i)
+{
+  assert(i);
+  assert(!zix_btree_iter_is_end(*i));
+
+  const ZixBTreeNode* const node  = i->nodes[i->level];
+  const uint16_t            index = i->indexes[i->level];
+
+  if (node->is_leaf) {
+    // Leaf, move up if necessary until we're not at the start of the node
+    while (!i->indexes[i->level]) {
+      if (i->level == 0U) {
+        // Start of root, end of tree
+        i->nodes[0U] = NULL;
+        return ZIX_STATUS_REACHED_END;
+      }
+
+      // At start of internal node, move up
+      zix_btree_iter_pop(i);
+    }
+
+    // Move to the previous value in the current node
+    --i->indexes[i->level];
+
+  } else {
+    // Internal node, move down to the child before the current value
+    ZixBTreeNode* child = node->data.inode.children[index];
+
+    // Move down and right until we hit a leaf
+    while (!child->is_leaf) {
+      zix_btree_iter_push(i, child, child->n_vals);
+      child = child->data.inode.children[child->n_vals];
+    }
+
+    zix_btree_iter_push(i, child, (ZixShort)(child->n_vals - 1U));
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixBTreeIter
+zix_btree_iter_prev(const ZixBTreeIter iter)
+{
+  ZixBTreeIter prev = iter;
+
+  zix_btree_iter_decrement(&prev);
+
+  return prev;
+}
@@ -0,0 +1,480 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include <zix/concurrent_hash.h>
+
+#include "hash_sizing.h"
+
+#include <zix/allocator.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+/*
+  Note that for simplicity, only x86 and x64 are supported with MSVC, as in
+  ring.c.
+*/
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ZIX_CACHE_LINE_SIZE 64U
+#define ZIX_READ_SLOT_BITS 4U
+#define ZIX_N_READ_SLOTS (1U << ZIX_READ_SLOT_BITS)
+
+typedef struct {
+  ZixHashCode    hash;  ///< Non-folded hash value (only a search filter)
+  ZixHashRecord* value; ///< Record, null if empty, or the tombstone mark
+} ZixConcurrentHashEntry;
+
+typedef struct {
+  size_t                  mask;      ///< Bit mask for fast modulo
+  size_t                  n_entries; ///< Power of two table size
+  ZixConcurrentHashEntry* entries;   ///< Entries (allocated after this)
+} ZixConcurrentHashTable;
+
+typedef struct {
+  uint32_t readers[2]; ///< Number of readers that entered in each parity
+  char     pad[ZIX_CACHE_LINE_SIZE - (2U * sizeof(uint32_t))];
+} ZixConcurrentHashReadSlot;
+
+struct ZixConcurrentHashImpl {
+  ZixConcurrentHashReadSlot slots[ZIX_N_READ_SLOTS]; ///< Written by readers
+  ZixAllocator*             allocator;               ///< User allocator
+  ZixKeyFunc                key_func;                ///< User key accessor
+  ZixHashFunc               hash_func;               ///< User hashing function
+  ZixKeyEqualFunc           equal_func;              ///< User equality function
+  ZixConcurrentHashTable*   table;                   ///< Current table, shared
+  uint32_t                  epoch;                   ///< Grace period counter
+  char                      pad[ZIX_CACHE_LINE_SIZE - sizeof(uint32_t)];
+  size_t                    count;        ///< Number of records, shared
+  size_t                    n_tombstones; ///< Number of removed entries
+};
+
+/*
+  Readers only ever load an entry's value once, so an entry changes state with
+  a single atomic store: from empty (null) to a record, and from a record to a
+  tombstone (a pointer to a private static mark) and back.  The hash code is
+  written before the value is published, and is only used to skip entries, so
+  a stale code can make a reader compare keys needlessly, but never return a
+  wrong record.
+
+  The array itself is only ever replaced as a whole, by publishing a new table
+  and waiting for a grace period before freeing the old one.  Grace periods
+  work like "sleepable RCU": readers increment one of two counters (chosen by
+  the parity of the epoch) on entry and decrement it on exit, and the writer
+  flips the epoch and waits for the counters of the old parity to drain.  This
+  is done twice, so that readers that read the epoch just before a flip are
+  covered as well.
+
+  So that readers on different threads don't all write to the same cache
+  line, the counters are split into slots, each on its own line.  A reader
+  picks a slot from the address of its stack, which is different for every
+  thread, and returns it in the token so that it leaves the same slot.  The
+  writer waits for every slot in turn.  Threads may still share a slot, which
+  only costs some contention.
+*/
+
+static const size_t min_n_entries = 4U;
+
+#if SIZE_MAX > UINT32_MAX
+static const size_t slot_multiplier = (size_t)0x9E3779B97F4A7C15ULL;
+#else
+static const size_t slot_multiplier = (size_t)0x9E3779B9UL;
+#endif
+
+static char tombstone_mark = 0;
+
+#define ZIX_TOMBSTONE ((ZixHashRecord*)&tombstone_mark)
+
+static inline size_t
+zix_atomic_load_size(const size_t* const ptr)
+{
+#if defined(_MSC_VER)
+  const size_t val = *(const volatile size_t*)ptr;
+  _ReadBarrier();
+  return val;
+#else
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void
+zix_atomic_store_size(size_t* const ptr, const size_t val)
+{
+#if defined(_MSC_VER)
+  _WriteBarrier();
+  *(volatile size_t*)ptr = val;
+#else
+  __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline ZixHashRecord*
+zix_atomic_load_record(ZixHashRecord* const* const ptr)
+{
+#if defined(_MSC_VER)
+  ZixHashRecord* const val = *(ZixHashRecord* const volatile*)ptr;
+  _ReadBarrier();
+  return val;
+#else
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void
+zix_atomic_store_record(ZixHashRecord** const ptr, ZixHashRecord* const val)
+{
+#if defined(_MSC_VER)
+  _WriteBarrier();
+  *(ZixHashRecord* volatile*)ptr = val;
+#else
+  __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+#endif
+}
+
+/// Load the current table, sequentially consistent with entering a section
+static inline ZixConcurrentHashTable*
+zix_atomic_load_table(ZixConcurrentHashTable* const* const ptr)
+{
+#if defined(_MSC_VER)
+  ZixConcurrentHashTable* const val =
+    *(ZixConcurrentHashTable* const volatile*)ptr;
+  _ReadBarrier();
+  return val;
+#else
+  return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/// Publish a new table, sequentially consistent with waiting for readers
+static inline void
+zix_atomic_store_table(ZixConcurrentHashTable** const ptr,
+                       ZixConcurrentHashTable* const  val)
+{
+#if defined(_MSC_VER)
+  _InterlockedExchangePointer((void* volatile*)ptr, val);
+#else
+  __atomic_store_n(ptr, val, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline uint32_t
+zix_atomic_load_u32(const uint32_t* const ptr)
+{
+#if defined(_MSC_VER)
+  const uint32_t val = *(const volatile uint32_t*)ptr;
+  _ReadBarrier();
+  return val;
+#else
+  return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void
+zix_atomic_store_u32(uint32_t* const ptr, const uint32_t val)
+{
+#if defined(_MSC_VER)
+  _InterlockedExchange((volatile long*)ptr, (long)val);
+#else
+  __atomic_store_n(ptr, val, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void
+zix_atomic_increment(uint32_t* const ptr)
+{
+#if defined(_MSC_VER)
+  _InterlockedIncrement((volatile long*)ptr);
+#else
+  __atomic_fetch_add(ptr, 1U, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void
+zix_atomic_decrement(uint32_t* const ptr)
+{
+#if defined(_MSC_VER)
+  _InterlockedDecrement((volatile long*)ptr);
+#else
+  __atomic_fetch_sub(ptr, 1U, __ATOMIC_RELEASE);
+#endif
+}
+
+/// Hint to the CPU that this is a spin loop
+static inline void
+zix_spin_pause(void)
+{
+#if defined(_MSC_VER)
+  _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+/// Return the read slot for a thread with a local variable at `local`
+static inline unsigned
+read_slot(const void* const local)
+{
+  // Ignore the offset within a page, then take the high bits of the product
+  const size_t page    = (size_t)(uintptr_t)local >> 12U;
+  const size_t product = page * slot_multiplier;
+
+  return (unsigned)(product >> ((sizeof(size_t) * 8U) - ZIX_READ_SLOT_BITS));
+}
+
+/// Allocate a zeroed table with the entries immediately after the header
+static ZixConcurrentHashTable*
+new_table(ZixAllocator* const allocator, const size_t n_entries)
+{
+  ZixConcurrentHashTable* const table = (ZixConcurrentHashTable*)zix_calloc(
+    allocator,
+    1U,
+    sizeof(ZixConcurrentHashTable) +
+      (n_entries * sizeof(ZixConcurrentHashEntry)));
+
+  if (table) {
+    table->mask      = n_entries - 1U;
+    table->n_entries = n_entries;
+    table->entries   = (ZixConcurrentHashEntry*)(table + 1U);
+  }
+
+  return table;
+}
+
+ZixConcurrentHash*
+zix_concurrent_hash_new(ZixAllocator* const   allocator,
+                        const ZixKeyFunc      key_func,
+                        const ZixHashFunc     hash_func,
+                        const ZixKeyEqualFunc equal_func)
+{
+  assert(key_func);
+  assert(hash_func);
+  assert(equal_func);
+
+  ZixConcurrentHash* const hash = (ZixConcurrentHash*)zix_aligned_alloc(
+    allocator, ZIX_CACHE_LINE_SIZE, sizeof(ZixConcurrentHash));
+
+  if (!hash) {
+    return NULL;
+  }
+
+  memset(hash, 0, sizeof(ZixConcurrentHash));
+  if (!(hash->table = new_table(allocator, min_n_entries))) {
+    zix_aligned_free(allocator, hash);
+    return NULL;
+  }
+
+  hash->allocator  = allocator;
+  hash->key_func   = key_func;
+  hash->hash_func  = hash_func;
+  hash->equal_func = equal_func;
+  return hash;
+}
+
+void
+zix_concurrent_hash_free(ZixConcurrentHash* const hash)
+{
+  if (hash) {
+    zix_free(hash->allocator, hash->table);
+    zix_aligned_free(hash->allocator, hash);
+  }
+}
+
+size_t
+zix_concurrent_hash_size(const ZixConcurrentHash* const hash)
+{
+  return zix_atomic_load_size(&hash->count);
+}
+
+unsigned
+zix_concurrent_hash_begin_read(ZixConcurrentHash* const hash)
+{
+  const unsigned slot   = read_slot(&hash);
+  const unsigned parity = zix_atomic_load_u32(&hash->epoch) & 1U;
+
+  zix_atomic_increment(&hash->slots[slot].readers[parity]);
+  return (slot << 1U) | parity;
+}
+
+void
+zix_concurrent_hash_end_read(ZixConcurrentHash* const hash,
+                             const unsigned           token)
+{
+  assert(token < 2U * ZIX_N_READ_SLOTS);
+
+  uint32_t* const readers = &hash->slots[token >> 1U].readers[token & 1U];
+
+  assert(zix_atomic_load_u32(readers));
+  zix_atomic_decrement(readers);
+}
+
+ZixHashRecord*
+zix_concurrent_hash_find(const ZixConcurrentHash* const hash,
+                         const ZixHashKey* const        key)
+{
+  const ZixConcurrentHashTable* const table =
+    zix_atomic_load_table(&hash->table);
+
+  const ZixHashCode code = hash->hash_func(key);
+  size_t            i    = code & table->mask;
+  for (size_t n = 0U; n < table->n_entries; ++n) {
+    const ZixConcurrentHashEntry* const entry = &table->entries[i];
+    ZixHashRecord* const value = zix_atomic_load_record(&entry->value);
+    if (!value) {
+      break;
+    }
+
+    if (value != ZIX_TOMBSTONE && zix_atomic_load_size(&entry->hash) == code &&
+        hash->equal_func(hash->key_func(value), key)) {
+      return value;
+    }
+
+    i = (i + 1U) & table->mask;
+  }
+
+  return NULL;
+}
+
+void
+zix_concurrent_hash_synchronize(ZixConcurrentHash* const hash)
+{
+  for (unsigned f = 0U; f < 2U; ++f) {
+    const uint32_t epoch = hash->epoch; // Only modified by the writer
+
+    zix_atomic_store_u32(&hash->epoch, epoch + 1U);
+    for (unsigned s = 0U; s < ZIX_N_READ_SLOTS; ++s) {
+      // Spin until all readers of the previous parity have left this slot
+      while (zix_atomic_load_u32(&hash->slots[s].readers[epoch & 1U])) {
+        zix_spin_pause();
+      }
+    }
+  }
+}
+
+/// Return the index of the first empty entry for `code` in a fresh table
+static size_t
+first_empty(const ZixConcurrentHashTable* const table, const ZixHashCode code)
+{
+  size_t i = code & table->mask;
+  while (table->entries[i].value) {
+    i = (i + 1U) & table->mask;
+  }
+
+  return i;
+}
+
+/// Replace the table with a new one, then free the old one when unused
+static ZixStatus
+resize(ZixConcurrentHash* const hash, const size_t n_entries)
+{
+  ZixConcurrentHashTable* const old  = hash->table;
+  ZixConcurrentHashTable* const next = new_table(hash->allocator, n_entries);
+  if (!next) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  // Copy records into the new table, which is still private to the writer
+  for (size_t i = 0U; i < old->n_entries; ++i) {
+    const ZixConcurrentHashEntry* const entry = &old->entries[i];
+    if (entry->value && entry->value != ZIX_TOMBSTONE) {
+      next->entries[first_empty(next, entry->hash)] = *entry;
+    }
+  }
+
+  // Publish the new table, then wait until nobody is reading the old one
+  zix_atomic_store_table(&hash->table, next);
+  hash->n_tombstones = 0U;
+  zix_concurrent_hash_synchronize(hash);
+  zix_free(hash->allocator, old);
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_concurrent_hash_insert(ZixConcurrentHash* const hash,
+                           ZixHashRecord* const     record)
+{
+  assert(record != ZIX_TOMBSTONE);
+
+  const ZixHashKey* const key  = hash->key_func(record);
+  const ZixHashCode       code = hash->hash_func(key);
+
+  // Search for an existing record and the first free entry
+  ZixConcurrentHashTable* table      = hash->table;
+  size_t                  i          = code & table->mask;
+  size_t                  free_index = SIZE_MAX;
+  for (ZixHashRecord* value = NULL; (value = table->entries[i].value);
+       i                    = (i + 1U) & table->mask) {
+    if (value == ZIX_TOMBSTONE) {
+      free_index = (free_index == SIZE_MAX) ? i : free_index;
+    } else if (table->entries[i].hash == code &&
+               hash->equal_func(hash->key_func(value), key)) {
+      return ZIX_STATUS_EXISTS;
+    }
+  }
+
+  const size_t n_used = hash->count + hash->n_tombstones + 1U;
+  if (free_index != SIZE_MAX) {
+    --hash->n_tombstones; // Reuse a tombstone
+  } else if (n_used < zix_hash_max_load(table->n_entries)) {
+    free_index = i; // Use the empty entry that ended the search
+  } else {
+    // Rehash, which either grows the table or just clears tombstones
+    const ZixStatus st =
+      resize(hash, zix_hash_fit_n_entries(min_n_entries, hash->count + 1U));
+    if (st) {
+      return st;
+    }
+
+    table      = hash->table;
+    free_index = first_empty(table, code);
+  }
+
+  // Write the hash code, then publish the record to readers
+  ZixConcurrentHashEntry* const entry = &table->entries[free_index];
+  zix_atomic_store_size(&entry->hash, code);
+  zix_atomic_store_record(&entry->value, record);
+  zix_atomic_store_size(&hash->count, hash->count + 1U);
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_concurrent_hash_remove(ZixConcurrentHash* const hash,
+                           const ZixHashKey* const  key,
+                           ZixHashRecord** const    removed)
+{
+  ZixConcurrentHashTable* const table = hash->table;
+  const ZixHashCode             code  = hash->hash_func(key);
+
+  *removed = NULL;
+
+  ZixHashRecord* value = NULL;
+  for (size_t i = code & table->mask; (value = table->entries[i].value);
+       i        = (i + 1U) & table->mask) {
+    ZixConcurrentHashEntry* const entry = &table->entries[i];
+    if (value != ZIX_TOMBSTONE && entry->hash == code &&
+        hash->equal_func(hash->key_func(value), key)) {
+      zix_atomic_store_record(&entry->value, ZIX_TOMBSTONE);
+      zix_atomic_store_size(&hash->count, hash->count - 1U);
+      ++hash->n_tombstones;
+      *removed = value;
+
+      // Shrink the table if it's sparse (failure here is harmless)
+      if (hash->count < table->n_entries / 4U &&
+          table->n_entries > min_n_entries) {
+        (void)resize(hash, zix_hash_fit_n_entries(min_n_entries, hash->count));
+      }
+
+      return ZIX_STATUS_SUCCESS;
+    }
+  }
+
+  return ZIX_STATUS_NOT_FOUND;
+}
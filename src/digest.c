@@ -1,4 +1,4 @@
-// Copyright 2012-2021 David Robillard <d@drobilla.net>
+// Copyright 2012-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #include <zix/digest.h>
@@ -201,6 +201,87 @@ zix_digest32_aligned(const uint32_t    seed,
   return mix32(h ^ (uint32_t)len);
 }
 
+/*
+  Keyed 64-bit hash: SipHash-2-4, implemented here from the paper by
+  Aumasson and Bernstein, reading input in little-endian order so the result
+  is the same on all platforms.
+*/
+
+static inline uint64_t
+rotl64(const uint64_t val, const uint64_t bits)
+{
+  return ((val << bits) | (val >> (64U - bits)));
+}
+
+static inline uint64_t
+load_le64(const uint8_t* const data, const size_t len)
+{
+  uint64_t v = 0U;
+  for (size_t i = 0U; i < len; ++i) {
+    v |= (uint64_t)data[i] << (8U * i);
+  }
+
+  return v;
+}
+
+static inline void
+sip_round(uint64_t* const v)
+{
+  v[0] += v[1];
+  v[1] = rotl64(v[1], 13U);
+  v[1] ^= v[0];
+  v[0] = rotl64(v[0], 32U);
+  v[2] += v[3];
+  v[3] = rotl64(v[3], 16U);
+  v[3] ^= v[2];
+  v[0] += v[3];
+  v[3] = rotl64(v[3], 21U);
+  v[3] ^= v[0];
+  v[2] += v[1];
+  v[1] = rotl64(v[1], 17U);
+  v[1] ^= v[2];
+  v[2] = rotl64(v[2], 32U);
+}
+
+static inline void
+sip_compress(uint64_t* const v, const uint64_t m)
+{
+  v[3] ^= m;
+  sip_round(v);
+  sip_round(v);
+  v[0] ^= m;
+}
+
+uint64_t
+zix_digest_keyed64(const ZixDigestKey* const key,
+                   const void* const         buf,
+                   const size_t              len)
+{
+  uint64_t v[4] = {key->k0 ^ 0x736F6D6570736575ULL,
+                   key->k1 ^ 0x646F72616E646F6DULL,
+                   key->k0 ^ 0x6C7967656E657261ULL,
+                   key->k1 ^ 0x7465646279746573ULL};
+
+  // Process as many 64-bit blocks as possible
+  const size_t         n_blocks   = len / sizeof(uint64_t);
+  const uint8_t*       data       = (const uint8_t*)buf;
+  const uint8_t* const blocks_end = data + (n_blocks * sizeof(uint64_t));
+  for (; data != blocks_end; data += sizeof(uint64_t)) {
+    sip_compress(v, load_le64(data, sizeof(uint64_t)));
+  }
+
+  // Process the trailing bytes and length in a final block
+  sip_compress(v, load_le64(data, len & 7U) | ((uint64_t)len << 56U));
+
+  // Finalize
+  v[2] ^= 0xFFU;
+  sip_round(v);
+  sip_round(v);
+  sip_round(v);
+  sip_round(v);
+  return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
 // Native word size wrapper
 
 size_t
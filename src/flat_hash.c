@@ -0,0 +1,329 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include <zix/flat_hash.h>
+
+#include "hash_sizing.h"
+
+#include <zix/allocator.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+struct ZixFlatHashImpl {
+  ZixAllocator*   allocator;    ///< User allocator
+  ZixKeyFunc      key_func;     ///< User key accessor
+  ZixHashFunc     hash_func;    ///< User hashing function
+  ZixKeyEqualFunc equal_func;   ///< User equality comparison function
+  size_t          record_size;  ///< Size of a record in bytes
+  size_t          stride;       ///< Size of a record rounded up to alignment
+  size_t          mask;         ///< Bit mask for fast modulo (n_entries - 1)
+  size_t          n_entries;    ///< Power of two table size
+  size_t          count;        ///< Number of records stored in the table
+  size_t          n_tombstones; ///< Number of erased entries
+  char*           records;      ///< Array of records, followed by tags
+  uint8_t*        tags;         ///< Array of entry tags
+};
+
+/// A type with the strictest alignment of any built-in type (in practice)
+typedef union {
+  long double ld;
+  long long   ll;
+  double      d;
+  void*       p;
+  void (*f)(void);
+} ZixFlatHashMaxAlign;
+
+/*
+  Entries are split into two arrays: the records, and a tag for each one which
+  is either empty, deleted (a tombstone), or the high bit set with 7 bits of
+  the hash code.  Searching checks the tags first, so keys are only compared
+  (and records touched) when the tag matches.  Erasing leaves a tombstone, and
+  the table is rehashed when the number of used entries (including
+  tombstones) reaches the maximum load.
+*/
+
+static const size_t  min_n_entries = 4U;
+static const uint8_t tag_empty     = 0x00U;
+static const uint8_t tag_deleted   = 0x01U;
+
+static inline bool
+is_full(const uint8_t tag)
+{
+  return tag & 0x80U;
+}
+
+static inline char*
+record_at(const ZixFlatHash* const hash, char* const records, const size_t i)
+{
+  return records + (i * hash->stride);
+}
+
+/// Allocate zeroed records and tags for a table with `n_entries` entries
+static char*
+new_records(const ZixFlatHash* const hash, const size_t n_entries)
+{
+  if (n_entries > SIZE_MAX / (hash->stride + 1U)) {
+    return NULL;
+  }
+
+  return (char*)zix_calloc(hash->allocator, n_entries, hash->stride + 1U);
+}
+
+/// Return the index of the first free entry for a code in a fresh table
+static size_t
+first_empty(const uint8_t* const tags, const size_t mask, const size_t code)
+{
+  size_t i = code & mask;
+  while (tags[i] != tag_empty) {
+    i = (i + 1U) & mask;
+  }
+
+  return i;
+}
+
+/// Move all records to a new array of a given size, clearing tombstones
+static ZixStatus
+rehash(ZixFlatHash* const hash, const size_t n_entries)
+{
+  char* const records = new_records(hash, n_entries);
+  if (!records) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  uint8_t* const tags = (uint8_t*)(records + (n_entries * hash->stride));
+  const size_t   mask = n_entries - 1U;
+  for (size_t i = 0U; i < hash->n_entries; ++i) {
+    if (is_full(hash->tags[i])) {
+      const char* const record = record_at(hash, hash->records, i);
+      const ZixHashCode code   = hash->hash_func(hash->key_func(record));
+      const size_t      j      = first_empty(tags, mask, code);
+
+      memcpy(record_at(hash, records, j), record, hash->record_size);
+      tags[j] = hash->tags[i];
+    }
+  }
+
+  zix_free(hash->allocator, hash->records);
+
+  hash->mask         = mask;
+  hash->n_entries    = n_entries;
+  hash->n_tombstones = 0U;
+  hash->records      = records;
+  hash->tags         = tags;
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixFlatHash*
+zix_flat_hash_new(ZixAllocator* const   allocator,
+                  const size_t          record_size,
+                  const size_t          record_align,
+                  const ZixKeyFunc      key_func,
+                  const ZixHashFunc     hash_func,
+                  const ZixKeyEqualFunc equal_func)
+{
+  typedef struct {
+    char                c;
+    ZixFlatHashMaxAlign u;
+  } Aligned;
+
+  assert(key_func);
+  assert(hash_func);
+  assert(equal_func);
+
+  if (!record_size || !record_align || (record_align & (record_align - 1U)) ||
+      record_align > offsetof(Aligned, u) ||
+      record_size > SIZE_MAX / 2U - record_align) {
+    return NULL;
+  }
+
+  ZixFlatHash* const hash =
+    (ZixFlatHash*)zix_calloc(allocator, 1U, sizeof(ZixFlatHash));
+
+  if (hash) {
+    hash->allocator   = allocator;
+    hash->key_func    = key_func;
+    hash->hash_func   = hash_func;
+    hash->equal_func  = equal_func;
+    hash->record_size = record_size;
+    hash->stride = (record_size + record_align - 1U) & ~(record_align - 1U);
+    hash->mask   = min_n_entries - 1U;
+    hash->n_entries = min_n_entries;
+
+    if (!(hash->records = new_records(hash, min_n_entries))) {
+      zix_free(allocator, hash);
+      return NULL;
+    }
+
+    hash->tags = (uint8_t*)(hash->records + (min_n_entries * hash->stride));
+  }
+
+  return hash;
+}
+
+void
+zix_flat_hash_free(ZixFlatHash* const hash)
+{
+  if (hash) {
+    zix_free(hash->allocator, hash->records);
+    zix_free(hash->allocator, hash);
+  }
+}
+
+size_t
+zix_flat_hash_size(const ZixFlatHash* const hash)
+{
+  return hash->count;
+}
+
+ZixFlatHashIter
+zix_flat_hash_begin(const ZixFlatHash* const hash)
+{
+  return is_full(hash->tags[0U]) ? 0U : zix_flat_hash_next(hash, 0U);
+}
+
+ZixFlatHashIter
+zix_flat_hash_end(const ZixFlatHash* const hash)
+{
+  return hash->n_entries;
+}
+
+ZixHashRecord*
+zix_flat_hash_get(const ZixFlatHash* const hash, const ZixFlatHashIter i)
+{
+  assert(i < hash->n_entries);
+
+  return is_full(hash->tags[i]) ? record_at(hash, hash->records, i) : NULL;
+}
+
+ZixFlatHashIter
+zix_flat_hash_next(const ZixFlatHash* const hash, ZixFlatHashIter i)
+{
+  do {
+    ++i;
+  } while (i < hash->n_entries && !is_full(hash->tags[i]));
+
+  return i;
+}
+
+/// Search for a key, returning the index of its entry or a free one
+static size_t
+search(const ZixFlatHash* const hash,
+       const ZixHashKey* const  key,
+       const ZixHashCode        code,
+       bool* const              found)
+{
+  const uint8_t tag        = zix_hash_tag(code);
+  size_t        free_index = SIZE_MAX;
+  size_t        i          = code & hash->mask;
+
+  for (; hash->tags[i] != tag_empty; i = (i + 1U) & hash->mask) {
+    if (hash->tags[i] == tag) {
+      const void* const record = record_at(hash, hash->records, i);
+      if (hash->equal_func(hash->key_func(record), key)) {
+        *found = true;
+        return i;
+      }
+    } else if (hash->tags[i] == tag_deleted && free_index == SIZE_MAX) {
+      free_index = i;
+    }
+  }
+
+  *found = false;
+  return (free_index == SIZE_MAX) ? i : free_index;
+}
+
+ZixStatus
+zix_flat_hash_insert(ZixFlatHash* const         hash,
+                     const ZixHashRecord* const record,
+                     ZixHashRecord** const      inserted)
+{
+  const ZixHashKey* const key   = hash->key_func(record);
+  const ZixHashCode       code  = hash->hash_func(key);
+  bool                    found = false;
+  size_t                  i     = search(hash, key, code, &found);
+
+  if (found) {
+    if (inserted) {
+      *inserted = record_at(hash, hash->records, i);
+    }
+
+    return ZIX_STATUS_EXISTS;
+  }
+
+  if (hash->tags[i] == tag_deleted) {
+    --hash->n_tombstones; // Reuse a tombstone
+  } else if (hash->count + hash->n_tombstones + 1U >=
+             zix_hash_max_load(hash->n_entries)) {
+    // Rehash, which either grows the table or just clears tombstones
+    const ZixStatus st =
+      rehash(hash, zix_hash_fit_n_entries(min_n_entries, hash->count + 1U));
+    if (st) {
+      return st;
+    }
+
+    i = first_empty(hash->tags, hash->mask, code);
+  }
+
+  char* const slot = record_at(hash, hash->records, i);
+  memcpy(slot, record, hash->record_size);
+  hash->tags[i] = zix_hash_tag(code);
+  ++hash->count;
+
+  if (inserted) {
+    *inserted = slot;
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_flat_hash_erase(ZixFlatHash* const hash, const ZixFlatHashIter i)
+{
+  if (i >= hash->n_entries || !is_full(hash->tags[i])) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  hash->tags[i] = tag_deleted;
+  ++hash->n_tombstones;
+  --hash->count;
+
+  // Shrink the table if it's sparse (failure here is harmless)
+  if (hash->count < hash->n_entries / 4U && hash->n_entries > min_n_entries) {
+    (void)rehash(hash, zix_hash_fit_n_entries(min_n_entries, hash->count));
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_flat_hash_remove(ZixFlatHash* const hash, const ZixHashKey* const key)
+{
+  const ZixFlatHashIter i = zix_flat_hash_find(hash, key);
+
+  return (i == hash->n_entries) ? ZIX_STATUS_NOT_FOUND
+                                : zix_flat_hash_erase(hash, i);
+}
+
+ZixFlatHashIter
+zix_flat_hash_find(const ZixFlatHash* const hash, const ZixHashKey* const key)
+{
+  bool         found = false;
+  const size_t i     = search(hash, key, hash->hash_func(key), &found);
+
+  return found ? i : hash->n_entries;
+}
+
+ZixHashRecord*
+zix_flat_hash_find_record(const ZixFlatHash* const hash,
+                          const ZixHashKey* const  key)
+{
+  const ZixFlatHashIter i = zix_flat_hash_find(hash, key);
+
+  return (i == hash->n_entries) ? NULL : record_at(hash, hash->records, i);
+}
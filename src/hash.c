@@ -1,60 +1,237 @@
-// Copyright 2011-2021 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
-#include <zix/hash.h>
+#include "hash_sizing.h"
+#include "system.h"
 
 #include <zix/allocator.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
 #include <zix/status.h>
 
+#ifdef ZIX_HASH_THREADS
+#  include <zix/thread.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define ZIX_HASH_SSE2 1
+#  include <emmintrin.h>
+#elif (defined(__aarch64__) && defined(__ARM_NEON)) || defined(_M_ARM64)
+#  define ZIX_HASH_NEON 1
+#  include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef MIN
+#  define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+
+#ifndef MAX
+#  define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
 
 typedef struct ZixHashEntry {
   ZixHashCode    hash;  ///< Non-folded hash value
   ZixHashRecord* value; ///< Pointer to user-owned record
 } ZixHashEntry;
 
+typedef struct {
+  size_t        mask;      ///< Bit mask for fast modulo (n_entries - 1)
+  size_t        n_entries; ///< Power of two table size
+  ZixHashEntry* entries;   ///< Pointer to dynamically allocated table
+  uint8_t*      tags;      ///< Entry tags (in entries) for grouped layout
+  void*         slots;     ///< Entry indices (in entries) for compact layout
+  size_t        slot_size; ///< Size of an index in bytes for compact layout
+  size_t        n_used;    ///< Number of entries used for compact layout
+} ZixHashTable;
+
 struct ZixHashImpl {
-  ZixAllocator*   allocator;  ///< User allocator
-  ZixKeyFunc      key_func;   ///< User key accessor
-  ZixHashFunc     hash_func;  ///< User hashing function
-  ZixKeyEqualFunc equal_func; ///< User equality comparison function
-  size_t          count;      ///< Number of records stored in the table
-  size_t          mask;       ///< Bit mask for fast modulo (n_entries - 1)
-  size_t          n_entries;  ///< Power of two table size
-  ZixHashEntry*   entries;    ///< Pointer to dynamically allocated table
+  ZixAllocator*     allocator;   ///< User allocator
+  ZixKeyFunc        key_func;    ///< User key accessor
+  ZixHashFunc       hash_func;   ///< User hashing function, or null
+  ZixSeededHashFunc seeded_func; ///< User seeded hashing function, or null
+  ZixKeyEqualFunc   equal_func;  ///< User equality comparison function
+  ZixDigestKey      seed;        ///< Secret seed passed to seeded_func
+  ZixHashLayout     layout;      ///< Layout of the internal arrays
+  bool              incremental; ///< True if resizing is done incrementally
+  unsigned          shrink_div;  ///< Shrink when count < n_entries / shrink_div
+  size_t            count;       ///< Number of records stored in the table
+  size_t            n_migrated;  ///< Number of old entries moved to the table
+  size_t            n_resizes;   ///< Number of times the table was resized
+  ZixHashTable      table;       ///< Current table
+  ZixHashTable      old;         ///< Old table being migrated, or empty
+#ifdef ZIX_HASH_COUNTERS
+  size_t* counters;  ///< Pointer to counts, which searches can modify
+  size_t  counts[2]; ///< Number of searches that missed and hit
+#endif
 };
 
-static const size_t min_n_entries = 4U;
-static const size_t tombstone     = 0xDEADU;
+/*
+  Lookup counters are only compiled in if ZIX_HASH_COUNTERS is defined, since
+  they add a store to every search.  Searches take a const table, but the
+  counters are diagnostic and not part of its logical state, so they're
+  modified through a non-const pointer to them.
+*/
+
+#ifdef ZIX_HASH_COUNTERS
+#  define ZIX_HASH_COUNT(hash, found) (++(hash)->counters[(found) ? 1U : 0U])
+#else
+#  define ZIX_HASH_COUNT(hash, found) ((void)(hash), (void)(found))
+#endif
+
+/*
+  The grouped layout has an array of 1-byte tags after the entries, where each
+  tag is either empty, deleted (a tombstone), or the high bit set with 7 bits
+  of the hash code.  The first group is mirrored after the end, so a group can
+  always be loaded as a contiguous block starting at any index.
+
+  When the table is resized, the current table becomes the "old" table, and
+  its entries are migrated to a new one in order, leaving tombstones behind so
+  the remaining ones can still be found.  This is normally done all at once,
+  but in incremental mode, only a few entries are migrated on every change.
+  Iterators span both: indices past the end of the current table refer to
+  entries in the old one.  Nothing is ever inserted into the old table, so it
+  is always searched like a linear table (without the Robin Hood early exit).
+
+  The compact layout instead has a dense array of entries in insertion order,
+  followed by an array of "slots" which are probed like a linear table.  Each
+  slot is either empty, deleted, or the index of an entry plus 2, and is as
+  small as possible for the size of the dense array, which only has room for
+  the maximum load.  Erasing leaves a hole in the dense array, so iterators
+  (which are indices into it) stay valid, and resizing appends the remaining
+  entries to a new table in order, all at once.  Erasing never frees a slot
+  or an entry, so there are at most as many non-empty slots as used entries,
+  and there is always an empty slot to end a search.
+*/
+
+#define ZIX_HASH_GROUP_SIZE 16U
+#define ZIX_HASH_BATCH_SIZE 16U
+
+static const size_t   min_n_entries  = 4U;
+static const size_t   migration_step = 32U;
+static const unsigned min_shrink_div = 4U; // Also the default
+static const size_t   tombstone      = 0xDEADU;
+static const uint8_t  tag_empty      = 0x00U;
+static const uint8_t  tag_deleted    = 0x01U;
+static const size_t   slot_empty     = 0x00U;
+static const size_t   slot_deleted   = 0x01U;
+static const size_t   slot_offset    = 0x02U;
+
+/// Return the hash code of a key, using the seed if the table has one
+static inline ZixHashCode
+hash_key(const ZixHash* const hash, const ZixHashKey* const key)
+{
+  return hash->hash_func ? hash->hash_func(key)
+                         : hash->seeded_func(key, &hash->seed);
+}
 
-ZixHash*
-zix_hash_new(ZixAllocator* const   allocator,
-             const ZixKeyFunc      key_func,
-             const ZixHashFunc     hash_func,
-             const ZixKeyEqualFunc equal_func)
+static inline size_t
+layout_min_n_entries(const ZixHashLayout layout)
+{
+  return layout == ZIX_HASH_GROUPED ? ZIX_HASH_GROUP_SIZE : min_n_entries;
+}
+
+/// Return the smallest table size that can hold some records without growing
+static size_t
+fit_n_entries(const ZixHash* const hash, const size_t n_records)
+{
+  return zix_hash_fit_n_entries(layout_min_n_entries(hash->layout), n_records);
+}
+
+/// Return the size of the slots for a compact table of a given size
+static inline size_t
+compact_slot_size(const size_t n_entries)
+{
+  const size_t max_slot = zix_hash_max_load(n_entries) + slot_offset;
+
+  return (max_slot <= UINT8_MAX)    ? sizeof(uint8_t)
+         : (max_slot <= UINT16_MAX) ? sizeof(uint16_t)
+         : (max_slot <= UINT32_MAX) ? sizeof(uint32_t)
+                                    : sizeof(uint64_t);
+}
+
+/// Allocate a zeroed table, with tags or slots after the entries if necessary
+static ZixStatus
+new_table(const ZixHash* const hash,
+          const size_t         n_entries,
+          ZixHashTable* const  table)
+{
+  const bool   compact   = hash->layout == ZIX_HASH_COMPACT;
+  const size_t n_records = compact ? zix_hash_max_load(n_entries) : n_entries;
+  const size_t slot_size = compact ? compact_slot_size(n_entries) : 0U;
+  const size_t n_tags    = (hash->layout == ZIX_HASH_GROUPED)
+                             ? n_entries + ZIX_HASH_GROUP_SIZE
+                             : 0U;
+
+  ZixHashEntry* const entries = (ZixHashEntry*)zix_calloc(
+    hash->allocator,
+    1U,
+    (n_records * sizeof(ZixHashEntry)) + n_tags + (n_entries * slot_size));
+
+  if (!entries) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  table->mask      = n_entries - 1U;
+  table->n_entries = n_entries;
+  table->entries   = entries;
+  table->tags      = n_tags ? (uint8_t*)(entries + n_entries) : NULL;
+  table->slots     = slot_size ? (void*)(entries + n_records) : NULL;
+  table->slot_size = slot_size;
+  table->n_used    = 0U;
+  return ZIX_STATUS_SUCCESS;
+}
+
+static ZixHash*
+new_hash(ZixAllocator* const     allocator,
+         const ZixHashLayout     layout,
+         const ZixKeyFunc        key_func,
+         const ZixHashFunc       hash_func,
+         const ZixSeededHashFunc seeded_func,
+         const ZixKeyEqualFunc   equal_func)
 {
   assert(key_func);
-  assert(hash_func);
+  assert(hash_func || seeded_func);
   assert(equal_func);
 
+  static const ZixHashTable no_table = {0U, 0U, NULL, NULL, NULL, 0U, 0U};
+  static const ZixDigestKey no_seed  = {0U, 0U};
+
   ZixHash* const hash = (ZixHash*)zix_malloc(allocator, sizeof(ZixHash));
   if (!hash) {
     return NULL;
   }
 
-  hash->allocator  = allocator;
-  hash->key_func   = key_func;
-  hash->hash_func  = hash_func;
-  hash->equal_func = equal_func;
-  hash->count      = 0U;
-  hash->n_entries  = min_n_entries;
-  hash->mask       = hash->n_entries - 1U;
-
-  hash->entries =
-    (ZixHashEntry*)zix_calloc(allocator, hash->n_entries, sizeof(ZixHashEntry));
-
-  if (!hash->entries) {
+  hash->allocator   = allocator;
+  hash->key_func    = key_func;
+  hash->hash_func   = hash_func;
+  hash->seeded_func = seeded_func;
+  hash->equal_func  = equal_func;
+  hash->seed        = no_seed;
+  hash->layout      = layout;
+  hash->incremental = false;
+  hash->shrink_div  = min_shrink_div;
+  hash->count       = 0U;
+  hash->n_migrated  = 0U;
+  hash->n_resizes   = 0U;
+  hash->old         = no_table;
+#ifdef ZIX_HASH_COUNTERS
+  hash->counters  = hash->counts;
+  hash->counts[0] = 0U;
+  hash->counts[1] = 0U;
+#endif
+
+  if ((seeded_func && zix_system_random(&hash->seed, sizeof(hash->seed))) ||
+      new_table(hash, layout_min_n_entries(layout), &hash->table)) {
     zix_free(allocator, hash);
     return NULL;
   }
@@ -62,47 +239,95 @@ zix_hash_new(ZixAllocator* const   allocator,
   return hash;
 }
 
+ZixHash*
+zix_hash_new_with_layout(ZixAllocator* const   allocator,
+                         const ZixHashLayout   layout,
+                         const ZixKeyFunc      key_func,
+                         const ZixHashFunc     hash_func,
+                         const ZixKeyEqualFunc equal_func)
+{
+  assert(hash_func);
+
+  return new_hash(allocator, layout, key_func, hash_func, NULL, equal_func);
+}
+
+ZixHash*
+zix_hash_new_seeded(ZixAllocator* const     allocator,
+                    const ZixHashLayout     layout,
+                    const ZixKeyFunc        key_func,
+                    const ZixSeededHashFunc hash_func,
+                    const ZixKeyEqualFunc   equal_func)
+{
+  assert(hash_func);
+
+  return new_hash(allocator, layout, key_func, NULL, hash_func, equal_func);
+}
+
+ZixHash*
+zix_hash_new(ZixAllocator* const   allocator,
+             const ZixKeyFunc      key_func,
+             const ZixHashFunc     hash_func,
+             const ZixKeyEqualFunc equal_func)
+{
+  return zix_hash_new_with_layout(
+    allocator, ZIX_HASH_LINEAR, key_func, hash_func, equal_func);
+}
+
 void
 zix_hash_free(ZixHash* const hash)
 {
   if (hash) {
-    zix_free(hash->allocator, hash->entries);
+    zix_free(hash->allocator, hash->old.entries);
+    zix_free(hash->allocator, hash->table.entries);
     zix_free(hash->allocator, hash);
   }
 }
 
+/// Return the entry at an iterator, which may be in the old table
+static inline ZixHashEntry*
+entry_at(const ZixHash* const hash, const ZixHashIter i)
+{
+  return (i < hash->table.n_entries)
+           ? &hash->table.entries[i]
+           : &hash->old.entries[i - hash->table.n_entries];
+}
+
 ZixHashIter
 zix_hash_begin(const ZixHash* const hash)
 {
   assert(hash);
-  return hash->entries[0U].value ? 0U : zix_hash_next(hash, 0U);
+  return hash->table.entries[0U].value ? 0U : zix_hash_next(hash, 0U);
 }
 
 ZixHashIter
 zix_hash_end(const ZixHash* const hash)
 {
   assert(hash);
-  return hash->n_entries;
+  return hash->table.n_entries + hash->old.n_entries;
 }
 
 ZixHashRecord*
 zix_hash_get(const ZixHash* hash, const ZixHashIter i)
 {
   assert(hash);
-  assert(i < hash->n_entries);
+  assert(i < zix_hash_end(hash));
 
-  return hash->entries[i].value;
+  return entry_at(hash, i)->value;
 }
 
 ZixHashIter
 zix_hash_next(const ZixHash* const hash, ZixHashIter i)
 {
   assert(hash);
+
+  // Only the used entries of a compact table need to be scanned
+  const ZixHashIter end  = zix_hash_end(hash);
+  const ZixHashIter last = hash->table.slots ? hash->table.n_used : end;
   do {
     ++i;
-  } while (i < hash->n_entries && !hash->entries[i].value);
+  } while (i < last && !entry_at(hash, i)->value);
 
-  return i;
+  return (i < last) ? i : end;
 }
 
 size_t
@@ -112,6 +337,13 @@ zix_hash_size(const ZixHash* const hash)
   return hash->count;
 }
 
+const ZixDigestKey*
+zix_hash_seed(const ZixHash* const hash)
+{
+  assert(hash);
+  return hash->seeded_func ? &hash->seed : NULL;
+}
+
 static inline size_t
 fold_hash(const ZixHashCode h_nomod, const size_t mask)
 {
@@ -125,270 +357,1634 @@ is_empty(const ZixHashEntry* const entry)
 }
 
 static inline bool
-is_match(const ZixHash* const hash,
-         const ZixHashCode    code,
-         const size_t         entry_index,
-         ZixKeyEqualFunc      predicate,
-         const void* const    user_data)
+is_match(const ZixHash* const      hash,
+         const ZixHashTable* const table,
+         const ZixHashCode         code,
+         const size_t              entry_index,
+         ZixKeyEqualFunc           predicate,
+         const void* const         user_data)
 {
-  const ZixHashEntry* const entry = &hash->entries[entry_index];
+  const ZixHashEntry* const entry = &table->entries[entry_index];
 
   return entry->value && entry->hash == code &&
          predicate(hash->key_func(entry->value), user_data);
 }
 
 static inline size_t
-next_index(const ZixHash* const hash, const size_t i)
+next_index(const ZixHashTable* const table, const size_t i)
 {
-  return (i == hash->mask) ? 0U : (i + 1U);
+  return (i == table->mask) ? 0U : (i + 1U);
 }
 
-static inline ZixHashIter
-find_entry(const ZixHash* const    hash,
-           const ZixHashKey* const key,
-           const size_t            h,
-           const ZixHashCode       code)
+static inline size_t
+prev_index(const ZixHashTable* const table, const size_t i)
+{
+  return (i == 0U) ? table->mask : (i - 1U);
+}
+
+/// Return the distance of an occupied entry from its ideal position
+static inline size_t
+displacement(const ZixHashTable* const table, const size_t i)
 {
-  size_t i = h;
+  return (i - fold_hash(table->entries[i].hash, table->mask)) & table->mask;
+}
 
-  while (!is_empty(&hash->entries[i]) &&
-         !is_match(hash, code, i, hash->equal_func, key)) {
-    i = next_index(hash, i);
+/// Set the tag of an entry, and its mirror if it's in the first group
+static inline void
+set_tag(ZixHashTable* const table, const size_t i, const uint8_t tag)
+{
+  table->tags[i] = tag;
+  if (i < ZIX_HASH_GROUP_SIZE) {
+    table->tags[table->n_entries + i] = tag;
   }
+}
 
-  return i;
+/// Replace an entry with a tombstone
+static inline void
+set_tombstone(ZixHashTable* const table, const size_t i)
+{
+  table->entries[i].hash  = tombstone;
+  table->entries[i].value = NULL;
+  if (table->tags) {
+    set_tag(table, i, tag_deleted);
+  }
 }
 
-static ZixStatus
-rehash(ZixHash* const hash, const size_t old_n_entries)
+/// Return the value of a slot in a compact table
+static inline size_t
+slot_get(const ZixHashTable* const table, const size_t i)
 {
-  ZixHashEntry* const old_entries   = hash->entries;
-  const size_t        new_n_entries = hash->n_entries;
+  switch (table->slot_size) {
+  case sizeof(uint8_t):
+    return ((const uint8_t*)table->slots)[i];
+  case sizeof(uint16_t):
+    return ((const uint16_t*)table->slots)[i];
+  case sizeof(uint32_t):
+    return ((const uint32_t*)table->slots)[i];
+  default:
+    break;
+  }
 
-  // Allocate a new entries array
-  ZixHashEntry* const new_entries = (ZixHashEntry*)zix_calloc(
-    hash->allocator, new_n_entries, sizeof(ZixHashEntry));
+  return (size_t)((const uint64_t*)table->slots)[i];
+}
 
-  if (!new_entries) {
-    return ZIX_STATUS_NO_MEM;
+/// Set the value of a slot in a compact table
+static inline void
+slot_set(ZixHashTable* const table, const size_t i, const size_t value)
+{
+  switch (table->slot_size) {
+  case sizeof(uint8_t):
+    ((uint8_t*)table->slots)[i] = (uint8_t)value;
+    break;
+  case sizeof(uint16_t):
+    ((uint16_t*)table->slots)[i] = (uint16_t)value;
+    break;
+  case sizeof(uint32_t):
+    ((uint32_t*)table->slots)[i] = (uint32_t)value;
+    break;
+  default:
+    ((uint64_t*)table->slots)[i] = (uint64_t)value;
+    break;
   }
+}
 
-  // Replace the array in the hash first so we can use find_entry() normally
-  hash->entries = new_entries;
-
-  // Reinsert every element into the new array
-  for (size_t i = 0U; i < old_n_entries; ++i) {
-    const ZixHashEntry* const entry = &old_entries[i];
+/// Return the first free (empty or deleted) slot for a hash code
+static inline size_t
+find_free_slot(const ZixHashTable* const table, const ZixHashCode code)
+{
+  size_t i = fold_hash(code, table->mask);
+  while (slot_get(table, i) >= slot_offset) {
+    i = next_index(table, i);
+  }
 
-    if (entry->value) {
-      assert(hash->mask == hash->n_entries - 1U);
-      const size_t new_h = fold_hash(entry->hash, hash->mask);
-      const size_t new_i = find_entry(hash, entry->value, new_h, entry->hash);
+  return i;
+}
 
-      hash->entries[new_i] = *entry;
-    }
+/// Return the slot that refers to the used entry at `index`
+static inline size_t
+find_slot(const ZixHashTable* const table, const size_t index)
+{
+  size_t i = fold_hash(table->entries[index].hash, table->mask);
+  while (slot_get(table, i) != index + slot_offset) {
+    i = next_index(table, i);
   }
 
-  zix_free(hash->allocator, old_entries);
-  return ZIX_STATUS_SUCCESS;
+  return i;
 }
 
-static ZixStatus
-grow(ZixHash* const hash)
+/// Return a mask with bit i set if the ith tag in a group equals `tag`
+static inline unsigned
+group_match(const uint8_t* const group, const uint8_t tag)
 {
-  const size_t old_n_entries = hash->n_entries;
-  const size_t old_mask      = hash->mask;
+#if defined(ZIX_HASH_SSE2)
+  const __m128i tags = _mm_loadu_si128((const __m128i*)(const void*)group);
 
-  hash->n_entries <<= 1U;
-  hash->mask = hash->n_entries - 1U;
+  return (unsigned)_mm_movemask_epi8(
+    _mm_cmpeq_epi8(tags, _mm_set1_epi8((char)tag)));
 
-  const ZixStatus st = rehash(hash, old_n_entries);
-  if (st) {
-    hash->n_entries = old_n_entries;
-    hash->mask      = old_mask;
+#elif defined(ZIX_HASH_NEON)
+  static const uint8_t bits[ZIX_HASH_GROUP_SIZE] = {
+    1U, 2U, 4U, 8U, 16U, 32U, 64U, 128U, 1U, 2U, 4U, 8U, 16U, 32U, 64U, 128U};
+
+  const uint8x16_t matches =
+    vandq_u8(vceqq_u8(vld1q_u8(group), vdupq_n_u8(tag)), vld1q_u8(bits));
+
+  return (unsigned)vaddv_u8(vget_low_u8(matches)) |
+         ((unsigned)vaddv_u8(vget_high_u8(matches)) << 8U);
+
+#else
+  unsigned mask = 0U;
+  for (unsigned i = 0U; i < ZIX_HASH_GROUP_SIZE; ++i) {
+    mask |= (unsigned)(group[i] == tag) << i;
   }
 
-  return st;
+  return mask;
+#endif
 }
 
-static ZixStatus
-shrink(ZixHash* const hash)
+/// Return a mask with bit i set if the ith entry in a group is free
+static inline unsigned
+group_match_free(const uint8_t* const group)
 {
-  if (hash->n_entries > min_n_entries) {
-    const size_t old_n_entries = hash->n_entries;
+#if defined(ZIX_HASH_SSE2)
+  const __m128i tags = _mm_loadu_si128((const __m128i*)(const void*)group);
+
+  return (unsigned)_mm_movemask_epi8(tags) ^ 0xFFFFU;
+
+#elif defined(ZIX_HASH_NEON)
+  static const uint8_t bits[ZIX_HASH_GROUP_SIZE] = {
+    1U, 2U, 4U, 8U, 16U, 32U, 64U, 128U, 1U, 2U, 4U, 8U, 16U, 32U, 64U, 128U};
+
+  const uint8x16_t matches =
+    vandq_u8(vcltq_u8(vld1q_u8(group), vdupq_n_u8(0x80U)), vld1q_u8(bits));
 
-    hash->n_entries >>= 1U;
-    hash->mask = hash->n_entries - 1U;
+  return (unsigned)vaddv_u8(vget_low_u8(matches)) |
+         ((unsigned)vaddv_u8(vget_high_u8(matches)) << 8U);
 
-    return rehash(hash, old_n_entries);
+#else
+  unsigned mask = 0U;
+  for (unsigned i = 0U; i < ZIX_HASH_GROUP_SIZE; ++i) {
+    mask |= (unsigned)(group[i] < 0x80U) << i;
   }
 
-  return ZIX_STATUS_SUCCESS;
+  return mask;
+#endif
 }
 
-ZixHashIter
-zix_hash_find(const ZixHash* const hash, const ZixHashKey* const key)
+/// Return the index of the lowest set bit in a non-zero group mask
+static inline unsigned
+lowest_bit(const unsigned mask)
 {
-  assert(hash);
-  assert(key);
+  assert(mask);
+
+#if defined(__GNUC__)
+  return (unsigned)__builtin_ctz(mask);
+#elif defined(_MSC_VER)
+  unsigned long i = 0U;
+  _BitScanForward(&i, mask);
+  return (unsigned)i;
+#else
+  unsigned i = 0U;
+  while (!(mask & (1U << i))) {
+    ++i;
+  }
 
-  const ZixHashCode h_nomod = hash->hash_func(key);
-  const size_t      h       = fold_hash(h_nomod, hash->mask);
-  const ZixHashIter i       = find_entry(hash, key, h, h_nomod);
+  return i;
+#endif
+}
 
-  return is_empty(&hash->entries[i]) ? hash->n_entries : i;
+/// Hint that some memory will be read soon
+static inline void
+prefetch(const void* const ptr)
+{
+#if defined(__GNUC__)
+  __builtin_prefetch(ptr);
+#elif defined(ZIX_HASH_SSE2)
+  _mm_prefetch((const char*)ptr, _MM_HINT_T0);
+#else
+  (void)ptr;
+#endif
 }
 
-ZixHashRecord*
-zix_hash_find_record(const ZixHash* const hash, const ZixHashKey* const key)
+/// Return the index of the group after the one that starts at `g`
+static inline size_t
+next_group(const ZixHashTable* const table, const size_t g)
 {
-  assert(hash);
-  assert(key);
+  return (g + ZIX_HASH_GROUP_SIZE) & table->mask;
+}
+
+/// Find a matching entry by probing entries, or return the end
+static inline size_t
+find_linear(const ZixHash* const      hash,
+            const ZixHashTable* const table,
+            const ZixHashCode         code,
+            const ZixKeyMatchFunc     predicate,
+            const void* const         user_data)
+{
+  const size_t start = fold_hash(code, table->mask);
+  size_t       i     = start;
+
+  while (!is_empty(&table->entries[i])) {
+    if (is_match(hash, table, code, i, predicate, user_data)) {
+      return i;
+    }
 
-  const ZixHashCode h_nomod = hash->hash_func(key);
-  const size_t      h       = fold_hash(h_nomod, hash->mask);
+    if ((i = next_index(table, i)) == start) {
+      break; // Rare edge case: entire table is full of entries/tombstones
+    }
+  }
 
-  return hash->entries[find_entry(hash, key, h, h_nomod)].value;
+  return table->n_entries;
 }
 
-ZixHashInsertPlan
-zix_hash_plan_insert_prehashed(const ZixHash* const  hash,
-                               const ZixHashCode     code,
-                               const ZixKeyMatchFunc predicate,
-                               const void* const     user_data)
+/// Find a matching entry by probing groups of tags, or return the end
+static inline size_t
+find_grouped(const ZixHash* const      hash,
+             const ZixHashTable* const table,
+             const ZixHashCode         code,
+             const ZixKeyMatchFunc     predicate,
+             const void* const         user_data)
 {
-  assert(hash);
-  assert(predicate);
+  const uint8_t tag = zix_hash_tag(code);
+  size_t        g   = fold_hash(code, table->mask);
 
-  // Calculate an ideal initial position
-  ZixHashInsertPlan pos = {code, fold_hash(code, hash->mask)};
+  for (size_t n = 0U; n < table->n_entries; n += ZIX_HASH_GROUP_SIZE) {
+    const uint8_t* const group = table->tags + g;
 
-  // Search for a free position starting at the ideal one
-  const size_t start_index     = pos.index;
-  size_t       first_tombstone = 0;
-  bool         found_tombstone = false;
-  while (!is_empty(&hash->entries[pos.index])) {
-    if (is_match(hash, code, pos.index, predicate, user_data)) {
-      return pos;
+    for (unsigned m = group_match(group, tag); m; m &= m - 1U) {
+      const size_t i = (g + lowest_bit(m)) & table->mask;
+      if (is_match(hash, table, code, i, predicate, user_data)) {
+        return i;
+      }
     }
 
-    if (!found_tombstone && !hash->entries[pos.index].value) {
-      assert(hash->entries[pos.index].hash == tombstone);
-      first_tombstone = pos.index; // Remember the first/best free index
-      found_tombstone = true;
+    if (group_match(group, tag_empty)) {
+      break; // Reached a group with an empty entry, so the key isn't here
     }
 
-    pos.index = next_index(hash, pos.index);
-    if (pos.index == start_index) {
-      break; // Rare edge case: entire table is full of entries/tombstones
+    g = next_group(table, g);
+  }
+
+  return table->n_entries;
+}
+
+/// Find a matching entry by probing displacement-ordered entries
+static inline size_t
+find_robin_hood(const ZixHash* const      hash,
+                const ZixHashTable* const table,
+                const ZixHashCode         code,
+                const ZixKeyMatchFunc     predicate,
+                const void* const         user_data)
+{
+  size_t i = fold_hash(code, table->mask);
+
+  for (size_t d = 0U; table->entries[i].value; ++d) {
+    if (displacement(table, i) < d) {
+      break; // Reached an entry closer to home, so the key isn't here
+    }
+
+    if (is_match(hash, table, code, i, predicate, user_data)) {
+      return i;
     }
+
+    i = next_index(table, i);
   }
 
-  // If we found a tombstone before an empty slot, place the new element there
-  if (found_tombstone) {
-    pos.index = first_tombstone;
+  return table->n_entries;
+}
+
+/// Find a matching entry by probing slots, or return the end
+static inline size_t
+find_compact(const ZixHash* const      hash,
+             const ZixHashTable* const table,
+             const ZixHashCode         code,
+             const ZixKeyMatchFunc     predicate,
+             const void* const         user_data)
+{
+  size_t i    = fold_hash(code, table->mask);
+  size_t slot = slot_empty;
+
+  while ((slot = slot_get(table, i)) != slot_empty) {
+    if (slot >= slot_offset &&
+        is_match(hash, table, code, slot - slot_offset, predicate, user_data)) {
+      return slot - slot_offset;
+    }
+
+    i = next_index(table, i);
   }
 
-  assert(!hash->entries[pos.index].value);
-  return pos;
+  return table->n_entries;
 }
 
-ZixHashInsertPlan
-zix_hash_plan_insert(const ZixHash* const hash, const ZixHashKey* const key)
+/// Find a matching entry in the current table, or return its end
+static inline size_t
+find_current(const ZixHash* const  hash,
+             const ZixHashCode     code,
+             const ZixKeyMatchFunc predicate,
+             const void* const     user_data)
 {
-  assert(hash);
-  assert(key);
+  switch (hash->layout) {
+  case ZIX_HASH_LINEAR:
+    break;
+  case ZIX_HASH_GROUPED:
+    return find_grouped(hash, &hash->table, code, predicate, user_data);
+  case ZIX_HASH_ROBIN_HOOD:
+    return find_robin_hood(hash, &hash->table, code, predicate, user_data);
+  case ZIX_HASH_COMPACT:
+    return find_compact(hash, &hash->table, code, predicate, user_data);
+  }
 
-  return zix_hash_plan_insert_prehashed(
-    hash, hash->hash_func(key), hash->equal_func, key);
+  return find_linear(hash, &hash->table, code, predicate, user_data);
 }
 
-ZixHashRecord*
-zix_hash_record_at(const ZixHash* const hash, const ZixHashInsertPlan position)
+/// Find a matching entry in the old table, or return its end
+static size_t
+find_old(const ZixHash* const  hash,
+         const ZixHashCode     code,
+         const ZixKeyMatchFunc predicate,
+         const void* const     user_data)
 {
-  assert(hash);
-  return hash->entries[position.index].value;
+  return (hash->layout == ZIX_HASH_GROUPED)
+           ? find_grouped(hash, &hash->old, code, predicate, user_data)
+           : find_linear(hash, &hash->old, code, predicate, user_data);
 }
 
-ZixStatus
-zix_hash_insert_at(ZixHash* const          hash,
-                   const ZixHashInsertPlan position,
-                   ZixHashRecord* const    record)
+static inline ZixHashIter
+find_entry(const ZixHash* const  hash,
+           const ZixHashCode     code,
+           const ZixKeyMatchFunc predicate,
+           const void* const     user_data)
 {
-  assert(hash);
-  assert(record);
+  const size_t i = find_current(hash, code, predicate, user_data);
+  if (i < hash->table.n_entries || !hash->old.entries) {
+    ZIX_HASH_COUNT(hash, i < hash->table.n_entries);
+    return i;
+  }
 
-  if (hash->entries[position.index].value) {
-    return ZIX_STATUS_EXISTS;
+  const size_t old_i = find_old(hash, code, predicate, user_data);
+
+  ZIX_HASH_COUNT(hash, old_i < hash->old.n_entries);
+  return hash->table.n_entries + old_i;
+}
+
+/// Return the index of the first free entry for a new hash code
+static size_t
+find_free_entry(const ZixHash* const      hash,
+                const ZixHashTable* const table,
+                const ZixHashCode         code)
+{
+  if (hash->layout == ZIX_HASH_GROUPED) {
+    size_t   g         = fold_hash(code, table->mask);
+    unsigned free_mask = 0U;
+    while (!(free_mask = group_match_free(table->tags + g))) {
+      g = next_group(table, g);
+    }
+
+    return (g + lowest_bit(free_mask)) & table->mask;
   }
 
-  // Set entry to new value
-  ZixHashEntry* const entry      = &hash->entries[position.index];
-  const ZixHashEntry  orig_entry = *entry;
-  assert(!entry->value);
-  entry->hash  = position.code;
-  entry->value = record;
+  size_t i = fold_hash(code, table->mask);
+  if (hash->layout == ZIX_HASH_ROBIN_HOOD) {
+    // Skip entries that are at least as far from home as this one would be
+    for (size_t d = 0U; table->entries[i].value; ++d) {
+      if (displacement(table, i) < d) {
+        break;
+      }
 
-  // Update size and rehash if we exceeded the maximum load
-  const size_t max_load  = hash->n_entries / 2U + hash->n_entries / 8U;
-  const size_t new_count = hash->count + 1U;
-  if (new_count >= max_load) {
-    const ZixStatus st = grow(hash);
-    if (st) {
-      *entry = orig_entry;
-      return st;
+      i = next_index(table, i);
     }
+
+    return i;
   }
 
-  hash->count = new_count;
-  return ZIX_STATUS_SUCCESS;
+  while (table->entries[i].value) {
+    i = next_index(table, i);
+  }
+
+  return i;
 }
 
-ZixStatus
-zix_hash_insert(ZixHash* const hash, ZixHashRecord* const record)
+/// Shift the run of entries starting at `i` forward to clear the entry at `i`
+static void
+shift_forward(ZixHashTable* const table, const size_t i)
 {
-  assert(hash);
-  assert(record);
+  size_t j = i;
+  while (table->entries[j].value) {
+    j = next_index(table, j);
+  }
 
-  const ZixHashKey* const key      = hash->key_func(record);
-  const ZixHashInsertPlan position = zix_hash_plan_insert(hash, key);
+  while (j != i) {
+    const size_t prev = prev_index(table, j);
 
-  return zix_hash_insert_at(hash, position, record);
+    table->entries[j] = table->entries[prev];
+    j                 = prev;
+  }
+
+  table->entries[i].hash  = 0U;
+  table->entries[i].value = NULL;
 }
 
-ZixStatus
-zix_hash_erase(ZixHash* const        hash,
-               const ZixHashIter     i,
-               ZixHashRecord** const removed)
+/// Shift entries after `i` back until one is at home, overwriting `i`
+static void
+shift_backward(ZixHashTable* const table, size_t i)
 {
-  assert(hash);
-  assert(removed);
+  for (size_t j = next_index(table, i);
+       table->entries[j].value && displacement(table, j);
+       j = next_index(table, j)) {
+    table->entries[i] = table->entries[j];
+    i                 = j;
+  }
 
-  // Replace entry with a tombstone
-  *removed               = hash->entries[i].value;
-  hash->entries[i].hash  = tombstone;
-  hash->entries[i].value = NULL;
+  table->entries[i].hash  = 0U;
+  table->entries[i].value = NULL;
+}
 
-  // Decrease element count and rehash if necessary
-  --hash->count;
-  if (hash->count < hash->n_entries / 4U) {
-    return shrink(hash);
+/// Move up to `n` entries from the old table to the current one
+static void
+migrate(ZixHash* const hash, const size_t n)
+{
+  ZixHashTable* const old   = &hash->old;
+  ZixHashTable* const table = &hash->table;
+  if (!old->entries) {
+    return;
   }
 
-  return ZIX_STATUS_SUCCESS;
+  if (old->slots) {
+    // Append every record in order, which removes holes, all at once
+    for (size_t i = 0U; i < old->n_used; ++i) {
+      const ZixHashEntry entry = old->entries[i];
+
+      if (entry.value) {
+        const size_t new_i = table->n_used++;
+
+        table->entries[new_i] = entry;
+        slot_set(table, find_free_slot(table, entry.hash), new_i + slot_offset);
+      }
+    }
+
+    hash->n_migrated = old->n_entries;
+  }
+
+  const size_t n_left = old->n_entries - hash->n_migrated;
+  const size_t end    = hash->n_migrated + MIN(n, n_left);
+  for (size_t i = hash->n_migrated; i < end; ++i) {
+    const ZixHashEntry entry = old->entries[i];
+
+    if (entry.value) {
+      const size_t new_i = find_free_entry(hash, table, entry.hash);
+      if (hash->layout == ZIX_HASH_ROBIN_HOOD) {
+        shift_forward(table, new_i);
+      }
+
+      table->entries[new_i] = entry;
+      if (table->tags) {
+        set_tag(table, new_i, zix_hash_tag(entry.hash));
+      }
+
+      set_tombstone(old, i);
+    }
+  }
+
+  hash->n_migrated = end;
+  if (end == old->n_entries) {
+    static const ZixHashTable no_table = {0U, 0U, NULL, NULL, NULL, 0U, 0U};
+
+    zix_free(hash->allocator, old->entries);
+    *old             = no_table;
+    hash->n_migrated = 0U;
+  }
 }
 
-ZixStatus
-zix_hash_remove(ZixHash* const          hash,
-                const ZixHashKey* const key,
-                ZixHashRecord** const   removed)
+/// Replace the table with a new one of the given size and start migrating
+static ZixStatus
+resize(ZixHash* const hash, const size_t n_entries)
 {
-  assert(hash);
-  assert(key);
-  assert(removed);
-
+  // Allocate the new table first so that nothing changes on failure
+  ZixHashTable    table = {0U, 0U, NULL, NULL, NULL, 0U, 0U};
+  const ZixStatus st    = new_table(hash, n_entries, &table);
+  if (st) {
+    return st;
+  }
+
+  // Finish any ongoing migration so there is only ever one old table
+  migrate(hash, SIZE_MAX);
+
+  // Make the current table the old one and migrate entries to the new one
+  hash->old        = hash->table;
+  hash->table      = table;
+  hash->n_migrated = 0U;
+  ++hash->n_resizes;
+  if (!hash->incremental || hash->layout == ZIX_HASH_COMPACT) {
+    migrate(hash, SIZE_MAX);
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+void
+zix_hash_set_incremental(ZixHash* const hash, const bool incremental)
+{
+  assert(hash);
+
+  hash->incremental = incremental;
+  if (!incremental) {
+    migrate(hash, SIZE_MAX);
+  }
+}
+
+ZixStatus
+zix_hash_set_shrink_divisor(ZixHash* const hash, const unsigned divisor)
+{
+  assert(hash);
+
+  if (divisor && divisor < min_shrink_div) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  hash->shrink_div = divisor;
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_hash_reserve(ZixHash* const hash, const size_t n_records)
+{
+  assert(hash);
+
+  if (n_records > SIZE_MAX / (8U * sizeof(ZixHashEntry))) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  const size_t n_entries = fit_n_entries(hash, n_records);
+
+  return (n_entries > hash->table.n_entries) ? resize(hash, n_entries)
+                                             : ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_hash_shrink_to_fit(ZixHash* const hash)
+{
+  assert(hash);
+
+  const size_t    n_entries = fit_n_entries(hash, hash->count);
+  const ZixStatus st        = (n_entries < hash->table.n_entries)
+                                ? resize(hash, n_entries)
+                                : ZIX_STATUS_SUCCESS;
+
+  migrate(hash, SIZE_MAX);
+  return st;
+}
+
+ZixHashIter
+zix_hash_find(const ZixHash* const hash, const ZixHashKey* const key)
+{
+  assert(hash);
+  assert(key);
+
+  return find_entry(hash, hash_key(hash, key), hash->equal_func, key);
+}
+
+ZixHashIter
+zix_hash_find_prehashed(const ZixHash* const  hash,
+                        const ZixHashCode     code,
+                        const ZixKeyMatchFunc predicate,
+                        const void* const     user_data)
+{
+  assert(hash);
+  assert(predicate);
+
+  return find_entry(hash, code, predicate, user_data);
+}
+
+ZixHashRecord*
+zix_hash_find_record(const ZixHash* const hash, const ZixHashKey* const key)
+{
+  assert(hash);
+  assert(key);
+
+  const ZixHashIter i =
+    find_entry(hash, hash_key(hash, key), hash->equal_func, key);
+
+  return (i < zix_hash_end(hash)) ? entry_at(hash, i)->value : NULL;
+}
+
+size_t
+zix_hash_find_batch(const ZixHash* const           hash,
+                    const size_t                   n_keys,
+                    const ZixHashKey* const* const keys,
+                    const ZixHashCode* const       codes,
+                    ZixHashRecord** const          records)
+{
+  assert(hash);
+  assert(!n_keys || (keys && records));
+
+  const ZixHashTable* const table   = &hash->table;
+  const ZixHashIter         end     = zix_hash_end(hash);
+  size_t                    n_found = 0U;
+
+  for (size_t b = 0U; b < n_keys; b += ZIX_HASH_BATCH_SIZE) {
+    const size_t n = MIN(ZIX_HASH_BATCH_SIZE, n_keys - b);
+    ZixHashCode  batch_codes[ZIX_HASH_BATCH_SIZE];
+
+    // Hash every key and prefetch its home position to overlap cache misses
+    for (size_t i = 0U; i < n; ++i) {
+      const ZixHashCode code =
+        codes ? codes[b + i] : hash_key(hash, keys[b + i]);
+
+      const size_t home = fold_hash(code, table->mask);
+
+      batch_codes[i] = code;
+      if (table->slots) {
+        prefetch((const uint8_t*)table->slots + (home * table->slot_size));
+      } else {
+        prefetch(&table->entries[home]);
+      }
+
+      if (table->tags) {
+        prefetch(&table->tags[home]);
+      }
+    }
+
+    // Search for every key, hopefully with the home positions now in cache
+    for (size_t i = 0U; i < n; ++i) {
+      const ZixHashIter j =
+        find_entry(hash, batch_codes[i], hash->equal_func, keys[b + i]);
+
+      records[b + i] = (j < end) ? entry_at(hash, j)->value : NULL;
+      n_found += (j < end);
+    }
+  }
+
+  return n_found;
+}
+
+static ZixHashInsertPlan
+plan_insert_linear(const ZixHash* const  hash,
+                   const ZixHashCode     code,
+                   const ZixKeyMatchFunc predicate,
+                   const void* const     user_data)
+{
+  const ZixHashTable* const table = &hash->table;
+
+  // Calculate an ideal initial position
+  ZixHashInsertPlan pos = {code, fold_hash(code, table->mask)};
+
+  // Search for a free position starting at the ideal one
+  const size_t start_index     = pos.index;
+  size_t       first_tombstone = 0;
+  bool         found_tombstone = false;
+  while (!is_empty(&table->entries[pos.index])) {
+    if (is_match(hash, table, code, pos.index, predicate, user_data)) {
+      return pos;
+    }
+
+    if (!found_tombstone && !table->entries[pos.index].value) {
+      assert(table->entries[pos.index].hash == tombstone);
+      first_tombstone = pos.index; // Remember the first/best free index
+      found_tombstone = true;
+    }
+
+    pos.index = next_index(table, pos.index);
+    if (pos.index == start_index) {
+      break; // Rare edge case: entire table is full of entries/tombstones
+    }
+  }
+
+  // If we found a tombstone before an empty slot, place the new element there
+  if (found_tombstone) {
+    pos.index = first_tombstone;
+  }
+
+  assert(!table->entries[pos.index].value);
+  return pos;
+}
+
+static ZixHashInsertPlan
+plan_insert_grouped(const ZixHash* const  hash,
+                    const ZixHashCode     code,
+                    const ZixKeyMatchFunc predicate,
+                    const void* const     user_data)
+{
+  const ZixHashTable* const table = &hash->table;
+
+  const uint8_t     tag = zix_hash_tag(code);
+  size_t            g   = fold_hash(code, table->mask);
+  ZixHashInsertPlan pos = {code, table->n_entries};
+
+  for (size_t n = 0U; n < table->n_entries; n += ZIX_HASH_GROUP_SIZE) {
+    const uint8_t* const group = table->tags + g;
+
+    // Return the position of an existing matching record if there is one
+    for (unsigned m = group_match(group, tag); m; m &= m - 1U) {
+      const size_t i = (g + lowest_bit(m)) & table->mask;
+      if (is_match(hash, table, code, i, predicate, user_data)) {
+        pos.index = i;
+        return pos;
+      }
+    }
+
+    // Remember the first free (empty or deleted) entry
+    const unsigned free_mask = group_match_free(group);
+    if (pos.index == table->n_entries && free_mask) {
+      pos.index = (g + lowest_bit(free_mask)) & table->mask;
+    }
+
+    if (group_match(group, tag_empty)) {
+      break; // Reached a group with an empty entry, so the key isn't here
+    }
+
+    g = next_group(table, g);
+  }
+
+  assert(pos.index < table->n_entries);
+  assert(!table->entries[pos.index].value);
+  return pos;
+}
+
+static ZixHashInsertPlan
+plan_insert_robin_hood(const ZixHash* const  hash,
+                       const ZixHashCode     code,
+                       const ZixKeyMatchFunc predicate,
+                       const void* const     user_data)
+{
+  /* Search like find_robin_hood(), but return where the search stopped if
+     there's no match.  That entry may be occupied by a record that is closer
+     to home, which will be shifted forward to make room, but its hash code
+     will never equal `code` since it has a different ideal position. */
+
+  const ZixHashTable* const table = &hash->table;
+
+  ZixHashInsertPlan pos = {code, fold_hash(code, table->mask)};
+
+  for (size_t d = 0U; table->entries[pos.index].value; ++d) {
+    if (displacement(table, pos.index) < d ||
+        is_match(hash, table, code, pos.index, predicate, user_data)) {
+      break;
+    }
+
+    pos.index = next_index(table, pos.index);
+  }
+
+  return pos;
+}
+
+static ZixHashInsertPlan
+plan_insert_compact(const ZixHash* const  hash,
+                    const ZixHashCode     code,
+                    const ZixKeyMatchFunc predicate,
+                    const void* const     user_data)
+{
+  /* Return the slot that refers to an existing matching record, or the first
+     free slot, since the record will be appended to the dense entries. */
+
+  const ZixHashTable* const table = &hash->table;
+
+  ZixHashInsertPlan pos  = {code, table->n_entries};
+  size_t            i    = fold_hash(code, table->mask);
+  size_t            slot = slot_empty;
+
+  while ((slot = slot_get(table, i)) != slot_empty) {
+    if (slot == slot_deleted) {
+      if (pos.index == table->n_entries) {
+        pos.index = i; // Remember the first/best free slot
+      }
+    } else if (is_match(
+                 hash, table, code, slot - slot_offset, predicate, user_data)) {
+      pos.index = i;
+      return pos;
+    }
+
+    i = next_index(table, i);
+  }
+
+  if (pos.index == table->n_entries) {
+    pos.index = i;
+  }
+
+  return pos;
+}
+
+ZixHashInsertPlan
+zix_hash_plan_insert_prehashed(const ZixHash* const  hash,
+                               const ZixHashCode     code,
+                               const ZixKeyMatchFunc predicate,
+                               const void* const     user_data)
+{
+  assert(hash);
+  assert(predicate);
+
+  ZixHashInsertPlan pos = {code, 0U};
+  switch (hash->layout) {
+  case ZIX_HASH_LINEAR:
+    pos = plan_insert_linear(hash, code, predicate, user_data);
+    break;
+  case ZIX_HASH_GROUPED:
+    pos = plan_insert_grouped(hash, code, predicate, user_data);
+    break;
+  case ZIX_HASH_ROBIN_HOOD:
+    pos = plan_insert_robin_hood(hash, code, predicate, user_data);
+    break;
+  case ZIX_HASH_COMPACT:
+    pos = plan_insert_compact(hash, code, predicate, user_data);
+    break;
+  }
+
+  // If there's no match in the current table, there may be one in the old
+  if (hash->old.entries && !zix_hash_record_at(hash, pos)) {
+    const size_t i = find_old(hash, code, predicate, user_data);
+    if (i < hash->old.n_entries) {
+      pos.index = hash->table.n_entries + i;
+    }
+  }
+
+  return pos;
+}
+
+ZixHashInsertPlan
+zix_hash_plan_insert(const ZixHash* const hash, const ZixHashKey* const key)
+{
+  assert(hash);
+  assert(key);
+
+  return zix_hash_plan_insert_prehashed(
+    hash, hash_key(hash, key), hash->equal_func, key);
+}
+
+ZixHashRecord*
+zix_hash_record_at(const ZixHash* const hash, const ZixHashInsertPlan position)
+{
+  assert(hash);
+
+  if (hash->table.slots) {
+    // The index is a slot, which may refer to an entry
+    const size_t slot = slot_get(&hash->table, position.index);
+
+    return (slot >= slot_offset)
+             ? hash->table.entries[slot - slot_offset].value
+             : NULL;
+  }
+
+  const ZixHashEntry* const entry = entry_at(hash, position.index);
+
+  return (entry->value && (hash->layout != ZIX_HASH_ROBIN_HOOD ||
+                           entry->hash == position.code))
+           ? entry->value
+           : NULL;
+}
+
+/// Append an entry to a compact table and set a free slot to refer to it
+static ZixStatus
+insert_compact(ZixHash* const          hash,
+               const ZixHashInsertPlan position,
+               ZixHashRecord* const    record)
+{
+  ZixHashTable* const table = &hash->table;
+  size_t              slot  = position.index;
+
+  // Rebuild the table to remove holes if the dense entries are full
+  if (table->n_used == zix_hash_max_load(table->n_entries)) {
+    const ZixStatus st = resize(hash, table->n_entries);
+    if (st) {
+      return st;
+    }
+
+    slot = find_free_slot(table, position.code);
+  }
+
+  // Append the new entry and refer to it from the slot
+  const size_t i         = table->n_used++;
+  const size_t orig_slot = slot_get(table, slot);
+
+  assert(orig_slot < slot_offset);
+  table->entries[i].hash  = position.code;
+  table->entries[i].value = record;
+  slot_set(table, slot, i + slot_offset);
+
+  // Update size and rehash if we exceeded the maximum load
+  const size_t new_count = hash->count + 1U;
+  if (new_count >= zix_hash_max_load(table->n_entries)) {
+    const ZixStatus st = resize(hash, table->n_entries << 1U);
+    if (st) {
+      slot_set(table, slot, orig_slot);
+      table->entries[i].hash  = 0U;
+      table->entries[i].value = NULL;
+      --table->n_used;
+      return st;
+    }
+  }
+
+  hash->count = new_count;
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_hash_insert_at(ZixHash* const          hash,
+                   const ZixHashInsertPlan position,
+                   ZixHashRecord* const    record)
+{
+  assert(hash);
+  assert(record);
+
+  if (zix_hash_record_at(hash, position)) {
+    return ZIX_STATUS_EXISTS;
+  }
+
+  ZixHashTable* const table = &hash->table;
+  assert(position.index < table->n_entries);
+
+  if (table->slots) {
+    return insert_compact(hash, position, record);
+  }
+
+  // Make room for the new entry if necessary
+  if (hash->layout == ZIX_HASH_ROBIN_HOOD) {
+    shift_forward(table, position.index);
+  }
+
+  // Set entry to new value
+  ZixHashEntry* const entry      = &table->entries[position.index];
+  const ZixHashEntry  orig_entry = *entry;
+  const uint8_t       orig_tag =
+    table->tags ? table->tags[position.index] : tag_empty;
+
+  assert(!entry->value);
+  entry->hash  = position.code;
+  entry->value = record;
+  if (table->tags) {
+    set_tag(table, position.index, zix_hash_tag(position.code));
+  }
+
+  // Update size and rehash if we exceeded the maximum load
+  const size_t new_count = hash->count + 1U;
+  if (new_count >= zix_hash_max_load(table->n_entries)) {
+    const ZixStatus st = resize(hash, table->n_entries << 1U);
+    if (st) {
+      if (hash->layout == ZIX_HASH_ROBIN_HOOD) {
+        shift_backward(table, position.index);
+      } else {
+        *entry = orig_entry;
+        if (table->tags) {
+          set_tag(table, position.index, orig_tag);
+        }
+      }
+
+      return st;
+    }
+  }
+
+  hash->count = new_count;
+  migrate(hash, migration_step);
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_hash_insert(ZixHash* const hash, ZixHashRecord* const record)
+{
+  assert(hash);
+  assert(record);
+
+  const ZixHashKey* const key      = hash->key_func(record);
+  const ZixHashInsertPlan position = zix_hash_plan_insert(hash, key);
+
+  return zix_hash_insert_at(hash, position, record);
+}
+
+/*
+  Building a table from an array is done in phases, each of which is split
+  between several workers (which run in threads if they are available):
+
+  1. Hash every record, and count the records that fall into each partition
+     (a range of home positions) of the new table.
+  2. Scatter the indices of records into an array ordered by partition.
+  3. Fill each partition by placing its records within its range, and set
+     aside any that don't fit without probing past the end.
+  4. Insert the set aside records one at a time as usual.
+
+  Records from different partitions never touch the same entries until the
+  last phase, so partitions can be filled concurrently.  The result is a
+  valid table for the layout, but records aren't necessarily in the same
+  positions as if they had been inserted one at a time.
+*/
+
+static const size_t min_build_part_size = 4096U; // Entries per partition
+
+#ifdef ZIX_HASH_THREADS
+
+#  define ZIX_HASH_MAX_BUILD_WORKERS 64U
+
+static const size_t min_build_worker_size = 4096U; // Records per worker
+static const size_t build_stack_size      = 1U << 20U;
+
+#endif
+
+typedef struct ZixHashBuilderImpl ZixHashBuilder;
+
+/// A function that does one worker's share of a build phase
+typedef void (*ZixHashBuildPhase)(ZixHashBuilder* builder, unsigned worker);
+
+struct ZixHashBuilderImpl {
+  ZixHash*              hash;       ///< Table being built
+  ZixHashTable          table;      ///< New table being filled
+  ZixHashRecord* const* records;    ///< Records to insert
+  size_t                n_records;  ///< Number of records
+  ZixHashCode*          codes;      ///< Hash code for every record
+  size_t*               order;      ///< Record indices ordered by partition
+  size_t*               offsets;    ///< Offset for every worker and partition
+  size_t*               starts;     ///< Start of every partition in order
+  size_t*               n_placed;   ///< Records placed in every partition
+  size_t*               n_left;     ///< Records set aside in every partition
+  size_t*               n_dups;     ///< Duplicates found in every partition
+  size_t                n_parts;    ///< Number of partitions
+  unsigned              part_shift; ///< Partition of a home is home >> this
+  unsigned              n_workers;  ///< Number of workers
+  ZixHashBuildPhase     phase;      ///< Current phase
+};
+
+typedef struct {
+  ZixHashBuilder* builder; ///< Builder for the build in progress
+  unsigned        worker;  ///< Index of this worker
+} ZixHashBuildWorker;
+
+/// Return the start of a worker's share of `n` items
+static inline size_t
+worker_start(const size_t n, const unsigned n_workers, const unsigned worker)
+{
+  return ((n / n_workers) * worker) + MIN(worker, n % n_workers);
+}
+
+/// Return the partition of the home position of a hash code
+static inline size_t
+build_part(const ZixHashBuilder* const builder, const ZixHashCode code)
+{
+  return fold_hash(code, builder->table.mask) >> builder->part_shift;
+}
+
+/// Phase 1: Hash records and count the records in each partition
+static void
+build_hash_phase(ZixHashBuilder* const builder, const unsigned worker)
+{
+  const ZixHash* const hash    = builder->hash;
+  size_t* const        offsets = builder->offsets + (worker * builder->n_parts);
+  const size_t         n       = builder->n_records;
+  const size_t         end = worker_start(n, builder->n_workers, worker + 1U);
+
+  for (size_t i = worker_start(n, builder->n_workers, worker); i < end; ++i) {
+    const ZixHashCode code =
+      hash_key(hash, hash->key_func(builder->records[i]));
+
+    builder->codes[i] = code;
+    ++offsets[build_part(builder, code)];
+  }
+}
+
+/// Phase 2: Scatter record indices into their partitions
+static void
+build_scatter_phase(ZixHashBuilder* const builder, const unsigned worker)
+{
+  size_t* const offsets = builder->offsets + (worker * builder->n_parts);
+  const size_t  n       = builder->n_records;
+  const size_t  end     = worker_start(n, builder->n_workers, worker + 1U);
+
+  for (size_t i = worker_start(n, builder->n_workers, worker); i < end; ++i) {
+    builder->order[offsets[build_part(builder, builder->codes[i])]++] = i;
+  }
+}
+
+/**
+   Place a record in an entry between its home and `end`.
+
+   @return #ZIX_STATUS_SUCCESS if the record was placed, #ZIX_STATUS_EXISTS if
+   an equal record was found, or #ZIX_STATUS_NOT_FOUND if there is no free
+   entry before `end`.
+*/
+static ZixStatus
+build_place(const ZixHash* const   hash,
+            ZixHashTable* const    table,
+            const size_t           end,
+            const ZixHashCode      code,
+            ZixHashRecord* const   record)
+{
+  const ZixHashKey* const key  = hash->key_func(record);
+  const size_t            home = fold_hash(code, table->mask);
+  ZixHashEntry* const     entries = table->entries;
+
+  if (hash->layout == ZIX_HASH_GROUPED) {
+    const uint8_t tag = zix_hash_tag(code);
+    for (size_t g = home; g + ZIX_HASH_GROUP_SIZE <= end;
+         g += ZIX_HASH_GROUP_SIZE) {
+      const uint8_t* const group = table->tags + g;
+
+      for (unsigned m = group_match(group, tag); m; m &= m - 1U) {
+        if (is_match(hash, table, code, g + lowest_bit(m), hash->equal_func,
+                     key)) {
+          return ZIX_STATUS_EXISTS;
+        }
+      }
+
+      const unsigned free_mask = group_match_free(group);
+      if (free_mask) {
+        const size_t i = g + lowest_bit(free_mask);
+
+        entries[i].hash  = code;
+        entries[i].value = record;
+        set_tag(table, i, tag);
+        return ZIX_STATUS_SUCCESS;
+      }
+    }
+
+    return ZIX_STATUS_NOT_FOUND;
+  }
+
+  // Skip entries that are at least as far from home (all for linear layout)
+  size_t i = home;
+  for (; i < end && entries[i].value; ++i) {
+    if (hash->layout == ZIX_HASH_ROBIN_HOOD &&
+        displacement(table, i) < i - home) {
+      break;
+    }
+
+    if (is_match(hash, table, code, i, hash->equal_func, key)) {
+      return ZIX_STATUS_EXISTS;
+    }
+  }
+
+  // Find the end of the run and shift it forward to make room if necessary
+  size_t j = i;
+  while (j < end && entries[j].value) {
+    ++j;
+  }
+
+  if (j == end) {
+    return ZIX_STATUS_NOT_FOUND;
+  }
+
+  for (; j > i; --j) {
+    entries[j] = entries[j - 1U];
+  }
+
+  entries[i].hash  = code;
+  entries[i].value = record;
+  return ZIX_STATUS_SUCCESS;
+}
+
+/// Phase 3: Fill partitions and set aside any records that don't fit
+static void
+build_fill_phase(ZixHashBuilder* const builder, const unsigned worker)
+{
+  const size_t   n_parts   = builder->n_parts;
+  const unsigned n_workers = builder->n_workers;
+  const size_t   part_size = (size_t)1U << builder->part_shift;
+  const size_t   end_part  = worker_start(n_parts, n_workers, worker + 1U);
+
+  for (size_t p = worker_start(n_parts, n_workers, worker); p < end_part; ++p) {
+    const size_t first  = builder->starts[p];
+    const size_t last   = builder->starts[p + 1U];
+    size_t       n_left = 0U;
+
+    for (size_t k = first; k < last; ++k) {
+      const size_t    i  = builder->order[k];
+      const ZixStatus st = build_place(builder->hash,
+                                       &builder->table,
+                                       (p + 1U) * part_size,
+                                       builder->codes[i],
+                                       builder->records[i]);
+
+      if (!st) {
+        ++builder->n_placed[p];
+      } else if (st == ZIX_STATUS_EXISTS) {
+        ++builder->n_dups[p];
+      } else {
+        builder->order[first + n_left++] = i;
+      }
+    }
+
+    builder->n_left[p] = n_left;
+  }
+}
+
+#ifdef ZIX_HASH_THREADS
+
+static ZixThreadResult ZIX_THREAD_FUNC
+build_worker_thread(void* const arg)
+{
+  const ZixHashBuildWorker* const worker = (const ZixHashBuildWorker*)arg;
+
+  worker->builder->phase(worker->builder, worker->worker);
+  return ZIX_THREAD_RESULT;
+}
+
+#endif
+
+/// Run every worker's share of a phase and wait for them to finish
+static void
+build_run_phase(ZixHashBuilder* const builder, const ZixHashBuildPhase phase)
+{
+  builder->phase = phase;
+
+#ifdef ZIX_HASH_THREADS
+  ZixHashBuildWorker workers[ZIX_HASH_MAX_BUILD_WORKERS];
+  ZixThread          threads[ZIX_HASH_MAX_BUILD_WORKERS];
+  bool               launched[ZIX_HASH_MAX_BUILD_WORKERS] = {false};
+
+  // Launch threads for every worker but the first, or run them here on error
+  for (unsigned w = 1U; w < builder->n_workers; ++w) {
+    workers[w].builder = builder;
+    workers[w].worker  = w;
+    launched[w]        = !zix_thread_create(
+      &threads[w], build_stack_size, build_worker_thread, &workers[w]);
+
+    if (!launched[w]) {
+      phase(builder, w);
+    }
+  }
+
+  phase(builder, 0U);
+
+  for (unsigned w = 1U; w < builder->n_workers; ++w) {
+    if (launched[w]) {
+      zix_thread_join(threads[w]);
+    }
+  }
+#else
+  for (unsigned w = 0U; w < builder->n_workers; ++w) {
+    phase(builder, w);
+  }
+#endif
+}
+
+/// Reserve space then insert records one at a time
+static ZixStatus
+build_serial(ZixHash* const              hash,
+             const size_t                n_records,
+             ZixHashRecord* const* const records)
+{
+  ZixStatus st = zix_hash_reserve(hash, hash->count + n_records);
+  if (!st && hash->table.n_used > hash->count) {
+    st = resize(hash, hash->table.n_entries); // Remove compact table holes
+  }
+
+  if (st) {
+    return st;
+  }
+
+  // Insertion can't fail after reserving, except for existing records
+  bool exists = false;
+  for (size_t i = 0U; i < n_records; ++i) {
+    exists = zix_hash_insert(hash, records[i]) || exists;
+  }
+
+  return exists ? ZIX_STATUS_EXISTS : ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_hash_build(ZixHash* const              hash,
+               const size_t                n_records,
+               ZixHashRecord* const* const records,
+               const unsigned              n_threads)
+{
+  assert(hash);
+  assert(!n_records || records);
+
+  if (n_records > SIZE_MAX / (8U * sizeof(ZixHashEntry))) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  if (!n_records) {
+    return ZIX_STATUS_SUCCESS;
+  }
+
+  if (hash->count || hash->layout == ZIX_HASH_COMPACT) {
+    return build_serial(hash, n_records, records);
+  }
+
+  ZixHashBuilder builder = {hash,
+                            {0U, 0U, NULL, NULL, NULL, 0U, 0U},
+                            records,
+                            n_records,
+                            NULL,
+                            NULL,
+                            NULL,
+                            NULL,
+                            NULL,
+                            NULL,
+                            NULL,
+                            1U,
+                            0U,
+                            1U,
+                            NULL};
+
+#ifdef ZIX_HASH_THREADS
+  // Use the requested number of workers, if each will have enough to do
+  const unsigned max_n_workers = MIN(n_threads, ZIX_HASH_MAX_BUILD_WORKERS);
+  while (builder.n_workers < max_n_workers &&
+         (builder.n_workers + 1U) * min_build_worker_size <= n_records) {
+    ++builder.n_workers;
+  }
+#else
+  (void)n_threads;
+#endif
+
+  // Allocate a new table large enough for every record
+  const size_t n_entries =
+    MAX(fit_n_entries(hash, n_records), hash->table.n_entries);
+
+  ZixStatus st = new_table(hash, n_entries, &builder.table);
+  if (st) {
+    return st;
+  }
+
+  // Use several partitions per worker, if they aren't too small
+  builder.part_shift = 0U;
+  while (((size_t)1U << (builder.part_shift + 1U)) <= n_entries) {
+    ++builder.part_shift;
+  }
+
+  while (builder.n_parts < 4U * builder.n_workers &&
+         ((size_t)1U << (builder.part_shift - 1U)) >= min_build_part_size) {
+    builder.n_parts *= 2U;
+    --builder.part_shift;
+  }
+
+  // Allocate scratch space for codes, order, offsets, and partition counts
+  const size_t n_offsets = builder.n_workers * builder.n_parts;
+  const size_t n_scratch =
+    (2U * n_records) + n_offsets + (4U * builder.n_parts) + 1U;
+
+  size_t* const scratch =
+    (size_t*)zix_calloc(hash->allocator, n_scratch, sizeof(size_t));
+
+  if (!scratch) {
+    zix_free(hash->allocator, builder.table.entries);
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  builder.codes    = scratch;
+  builder.order    = builder.codes + n_records;
+  builder.offsets  = builder.order + n_records;
+  builder.starts   = builder.offsets + n_offsets;
+  builder.n_placed = builder.starts + builder.n_parts + 1U;
+  builder.n_left   = builder.n_placed + builder.n_parts;
+  builder.n_dups   = builder.n_left + builder.n_parts;
+
+  // Hash records and count the records from each worker in each partition
+  build_run_phase(&builder, build_hash_phase);
+
+  // Convert counts to offsets where each worker scatters into each partition
+  size_t offset = 0U;
+  for (size_t p = 0U; p < builder.n_parts; ++p) {
+    builder.starts[p] = offset;
+    for (unsigned w = 0U; w < builder.n_workers; ++w) {
+      size_t* const count = &builder.offsets[(w * builder.n_parts) + p];
+      const size_t  n     = *count;
+
+      *count = offset;
+      offset += n;
+    }
+  }
+
+  builder.starts[builder.n_parts] = offset;
+
+  // Scatter records into partitions, then fill them
+  build_run_phase(&builder, build_scatter_phase);
+  build_run_phase(&builder, build_fill_phase);
+
+  // Replace the (empty) tables with the new one
+  size_t n_placed = 0U;
+  size_t n_dups   = 0U;
+  for (size_t p = 0U; p < builder.n_parts; ++p) {
+    n_placed += builder.n_placed[p];
+    n_dups += builder.n_dups[p];
+  }
+
+  static const ZixHashTable no_table = {0U, 0U, NULL, NULL, NULL, 0U, 0U};
+
+  zix_free(hash->allocator, hash->old.entries);
+  zix_free(hash->allocator, hash->table.entries);
+  hash->table      = builder.table;
+  hash->old        = no_table;
+  hash->n_migrated = 0U;
+  hash->count      = n_placed;
+  ++hash->n_resizes;
+
+  // Insert the records that were set aside, which can't grow the table
+  for (size_t p = 0U; p < builder.n_parts; ++p) {
+    const size_t first = builder.starts[p];
+    for (size_t k = first; k < first + builder.n_left[p]; ++k) {
+      const size_t            i   = builder.order[k];
+      const ZixHashKey* const key = hash->key_func(records[i]);
+      const ZixHashInsertPlan position = zix_hash_plan_insert_prehashed(
+        hash, builder.codes[i], hash->equal_func, key);
+
+      if (zix_hash_insert_at(hash, position, records[i])) {
+        ++n_dups;
+      }
+    }
+  }
+
+  zix_free(hash->allocator, scratch);
+  return n_dups ? ZIX_STATUS_EXISTS : ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_hash_erase(ZixHash* const        hash,
+               const ZixHashIter     i,
+               ZixHashRecord** const removed)
+{
+  assert(hash);
+  assert(removed);
+
+  ZixHashTable* const table = &hash->table;
+
+  *removed = entry_at(hash, i)->value;
+
+  if (i >= table->n_entries) {
+    // Replace old entry with a tombstone (the old table is never shifted)
+    set_tombstone(&hash->old, i - table->n_entries);
+  } else if (hash->layout == ZIX_HASH_ROBIN_HOOD) {
+    // Shift following entries back to fill the gap
+    shift_backward(table, i);
+  } else if (table->slots) {
+    // Mark the slot as deleted and leave a hole in the entries
+    slot_set(table, find_slot(table, i), slot_deleted);
+    table->entries[i].hash  = 0U;
+    table->entries[i].value = NULL;
+  } else {
+    // Replace entry with a tombstone
+    set_tombstone(table, i);
+  }
+
+  // Decrease element count and rehash if necessary
+  ZixStatus st = ZIX_STATUS_SUCCESS;
+  --hash->count;
+  if (hash->shrink_div && hash->count < table->n_entries / hash->shrink_div &&
+      table->n_entries > layout_min_n_entries(hash->layout)) {
+    st = resize(hash, table->n_entries >> 1U);
+  }
+
+  migrate(hash, migration_step);
+  return st;
+}
+
+ZixStatus
+zix_hash_remove(ZixHash* const          hash,
+                const ZixHashKey* const key,
+                ZixHashRecord** const   removed)
+{
+  assert(hash);
+  assert(key);
+  assert(removed);
+
   const ZixHashIter i = zix_hash_find(hash, key);
 
-  return i == hash->n_entries ? ZIX_STATUS_NOT_FOUND
-                              : zix_hash_erase(hash, i, removed);
+  return i == zix_hash_end(hash) ? ZIX_STATUS_NOT_FOUND
+                                 : zix_hash_erase(hash, i, removed);
+}
+
+/// Return true if an entry terminates a search (is empty, not a tombstone)
+static inline bool
+ends_search(const ZixHashTable* const table, const size_t i)
+{
+  return table->slots  ? slot_get(table, i) == slot_empty
+         : table->tags ? table->tags[i] == tag_empty
+                       : is_empty(&table->entries[i]);
+}
+
+/// Return the entry probed at position `i`, or null if there is none
+static inline const ZixHashEntry*
+probed_entry(const ZixHashTable* const table, const size_t i)
+{
+  if (table->slots) {
+    const size_t slot = slot_get(table, i);
+
+    return (slot >= slot_offset) ? &table->entries[slot - slot_offset] : NULL;
+  }
+
+  return table->entries[i].value ? &table->entries[i] : NULL;
+}
+
+/// Return the number of steps to probe `distance` entries past home
+static inline size_t
+probe_length(const ZixHash* const hash, const size_t distance)
+{
+  return (hash->layout == ZIX_HASH_GROUPED)
+           ? (distance / ZIX_HASH_GROUP_SIZE) + 1U
+           : distance + 1U;
+}
+
+/// Return the size of the memory allocated for a table in bytes
+static inline size_t
+table_size(const ZixHashTable* const table)
+{
+  const size_t n_records =
+    table->slots ? zix_hash_max_load(table->n_entries) : table->n_entries;
+
+  return (n_records * sizeof(ZixHashEntry)) +
+         (table->tags ? table->n_entries + ZIX_HASH_GROUP_SIZE : 0U) +
+         (table->n_entries * table->slot_size);
+}
+
+/// Count tombstones, probe lengths, and displacements of records in a table
+static void
+count_hits(const ZixHash* const      hash,
+           const ZixHashTable* const table,
+           ZixHashStats* const       stats,
+           size_t* const             total_probe_length,
+           size_t* const             total_displacement)
+{
+  for (size_t i = 0U; i < table->n_entries; ++i) {
+    const ZixHashEntry* const entry = probed_entry(table, i);
+    if (entry) {
+      const size_t home     = fold_hash(entry->hash, table->mask);
+      const size_t distance = (i - home) & table->mask;
+      const size_t length   = probe_length(hash, distance);
+      const size_t bin      = MIN(length, ZIX_HASH_N_PROBE_LENGTHS) - 1U;
+
+      *total_probe_length += length;
+      *total_displacement += distance;
+      stats->max_probe_length = MAX(stats->max_probe_length, length);
+      stats->max_displacement = MAX(stats->max_displacement, distance);
+      ++stats->probe_lengths[bin];
+    } else if (!ends_search(table, i)) {
+      ++stats->n_tombstones;
+    }
+  }
+}
+
+ZixHashStats
+zix_hash_stats(const ZixHash* const hash)
+{
+  assert(hash);
+
+  const ZixHashTable* const table = &hash->table;
+
+  ZixHashStats stats;
+  size_t       total_probe_length = 0U;
+  size_t       total_displacement = 0U;
+  size_t       total_miss_length  = 0U;
+
+  memset(&stats, 0, sizeof(stats));
+  stats.n_entries   = zix_hash_end(hash);
+  stats.load_factor = (double)hash->count / (double)stats.n_entries;
+  stats.n_resizes   = hash->n_resizes;
+  stats.n_bytes = sizeof(ZixHash) + table_size(table) + table_size(&hash->old);
+
+#ifdef ZIX_HASH_COUNTERS
+  stats.n_lookups = hash->counts[0] + hash->counts[1];
+  stats.n_hits    = hash->counts[1];
+  stats.n_misses  = hash->counts[0];
+#endif
+
+  // Count tombstones and probe lengths to find every present record
+  count_hits(hash, table, &stats, &total_probe_length, &total_displacement);
+  count_hits(
+    hash, &hash->old, &stats, &total_probe_length, &total_displacement);
+
+  // Count the probe lengths of a failed search starting at every entry
+  if (hash->layout == ZIX_HASH_ROBIN_HOOD) {
+    for (size_t h = 0U; h < table->n_entries; ++h) {
+      size_t i = h;
+      size_t d = 0U;
+      while (table->entries[i].value && displacement(table, i) >= d) {
+        i = next_index(table, i);
+        ++d;
+      }
+
+      total_miss_length += d + 1U;
+      stats.max_miss_length = MAX(stats.max_miss_length, d + 1U);
+    }
+  } else {
+    // Find an empty entry, then walk backwards tracking the distance to it
+    size_t e = 0U;
+    while (e < table->n_entries && !ends_search(table, e)) {
+      ++e;
+    }
+
+    if (e == table->n_entries) {
+      // No empty entries, so every failed search probes the whole table
+      stats.max_miss_length = probe_length(hash, table->n_entries - 1U);
+      total_miss_length     = stats.max_miss_length * table->n_entries;
+    } else {
+      size_t distance = 0U;
+      for (size_t n = 0U; n < table->n_entries; ++n) {
+        const size_t i = (e - n) & table->mask;
+
+        distance = ends_search(table, i) ? 0U : distance + 1U;
+
+        const size_t length = probe_length(hash, distance);
+
+        total_miss_length += length;
+        stats.max_miss_length = MAX(stats.max_miss_length, length);
+      }
+    }
+  }
+
+  stats.mean_probe_length =
+    hash->count ? (double)total_probe_length / (double)hash->count : 0.0;
+
+  stats.mean_displacement =
+    hash->count ? (double)total_displacement / (double)hash->count : 0.0;
+
+  stats.mean_miss_length =
+    (double)total_miss_length / (double)table->n_entries;
+
+  return stats;
 }
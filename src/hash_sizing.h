@@ -0,0 +1,45 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef ZIX_HASH_SIZING_H
+#define ZIX_HASH_SIZING_H
+
+#include <zix/hash.h>
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+  The growth policy and tags shared by the open addressing hash tables.  Note
+  that ZIX_HASH_DEFINE in the public hash_define.h can't include this, so
+  has its own copy of the load factor which must be kept in sync.
+*/
+
+/// Return the number of used entries that makes a table of a given size grow
+static inline size_t
+zix_hash_max_load(const size_t n_entries)
+{
+  return n_entries / 2U + n_entries / 8U;
+}
+
+/// Return the smallest table size that can hold some records without growing
+static inline size_t
+zix_hash_fit_n_entries(const size_t min_n_entries, const size_t n_records)
+{
+  size_t n_entries = min_n_entries;
+  while (zix_hash_max_load(n_entries) <= n_records) {
+    n_entries <<= 1U;
+  }
+
+  return n_entries;
+}
+
+/// Return the tag for a full entry, which has the high bits of the hash code
+static inline uint8_t
+zix_hash_tag(const ZixHashCode code)
+{
+  return (uint8_t)(0x80U | (code >> ((sizeof(ZixHashCode) * CHAR_BIT) - 7U)));
+}
+
+#endif // ZIX_HASH_SIZING_H
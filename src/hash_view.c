@@ -0,0 +1,290 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include "errno_status.h"
+#include "system.h"
+
+#include <zix/allocator.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/hash_view.h>
+#include <zix/status.h>
+#include <zix/string_view.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+  A snapshot is a header, followed by an array of slots that each contain the
+  offset of an entry from the start of the snapshot (or zero if empty),
+  followed by the entries.  Each entry is a fixed-size description, followed
+  by the key and value strings with null terminators, padded to 8 bytes.
+  Slots are indexed by the low bits of the 64-bit digest of the key, using
+  linear probing, and the full digest is stored in the entry so that keys are
+  only compared when they are very likely to match.
+*/
+
+static const char     hash_view_magic[]    = "ZixHView";
+static const uint32_t hash_view_version    = 1U;
+static const uint32_t hash_view_byte_order = 0x01020304U;
+static const uint64_t hash_view_seed       = 0U;
+
+typedef struct {
+  char     magic[8];   ///< "ZixHView" without a terminator
+  uint32_t version;    ///< Format version, currently 1
+  uint32_t byte_order; ///< Byte order mark in the native byte order
+  uint64_t n_entries;  ///< Number of entries
+  uint64_t n_slots;    ///< Power of two number of slots
+  uint64_t size;       ///< Total size of snapshot in bytes
+} ZixHashViewHeader;
+
+typedef struct {
+  uint64_t code;         ///< Digest of key
+  uint64_t key_length;   ///< Length of key in bytes, excluding terminator
+  uint64_t value_length; ///< Length of value in bytes, excluding terminator
+} ZixHashViewEntryHeader;
+
+struct ZixHashViewImpl {
+  ZixAllocator*   allocator; ///< User allocator
+  const char*     data;      ///< Start of snapshot
+  size_t          size;      ///< Size of snapshot in bytes
+  const uint64_t* slots;     ///< Array of entry offsets
+  uint64_t        mask;      ///< Bit mask for fast modulo (n_slots - 1)
+  size_t          n_entries; ///< Number of entries
+  bool            mapped;    ///< True if data is a mapped file
+};
+
+/// Return the size of an entry in a snapshot, including padding
+static uint64_t
+entry_size(const ZixHashViewEntry entry)
+{
+  const uint64_t size = sizeof(ZixHashViewEntryHeader) + entry.key.length +
+                        entry.value.length + 2U;
+
+  return (size + 7U) & ~(uint64_t)7U;
+}
+
+/// Return the status for a failed write, which should be set in errno
+static ZixStatus
+write_error(void)
+{
+  const ZixStatus st = zix_errno_status(errno);
+
+  return st ? st : ZIX_STATUS_ERROR;
+}
+
+static bool
+write_string(const ZixStringView string, FILE* const fd)
+{
+  return (!string.length || fwrite(string.data, string.length, 1U, fd) == 1U) &&
+         fputc('\0', fd) == 0;
+}
+
+static ZixStatus
+write_snapshot(const ZixHash* const       hash,
+               const ZixHashViewEntryFunc entry_func,
+               void* const                user_data,
+               const ZixHashViewHeader*   header,
+               const uint64_t* const      slots,
+               FILE* const                fd)
+{
+  static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+  if (fwrite(header, sizeof(*header), 1U, fd) != 1U ||
+      fwrite(slots, sizeof(uint64_t), header->n_slots, fd) != header->n_slots) {
+    return write_error();
+  }
+
+  for (ZixHashIter i = zix_hash_begin(hash); i != zix_hash_end(hash);
+       i = zix_hash_next(hash, i)) {
+    const ZixHashViewEntry entry = entry_func(zix_hash_get(hash, i), user_data);
+
+    const ZixHashViewEntryHeader entry_header = {
+      zix_digest64(hash_view_seed, entry.key.data, entry.key.length),
+      entry.key.length,
+      entry.value.length};
+
+    const size_t n_padding =
+      (size_t)(entry_size(entry) - sizeof(entry_header) - entry.key.length -
+               entry.value.length - 2U);
+
+    if (fwrite(&entry_header, sizeof(entry_header), 1U, fd) != 1U ||
+        !write_string(entry.key, fd) || !write_string(entry.value, fd) ||
+        (n_padding && fwrite(padding, n_padding, 1U, fd) != 1U)) {
+      return write_error();
+    }
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+ZixStatus
+zix_hash_view_write(ZixAllocator* const        allocator,
+                    const ZixHash* const       hash,
+                    const ZixHashViewEntryFunc entry_func,
+                    void* const                user_data,
+                    const char* const          path)
+{
+  // Choose a number of slots that keeps the load factor below 3/4
+  const size_t n_entries = zix_hash_size(hash);
+  size_t       n_slots   = 4U;
+  while (n_slots - (n_slots / 4U) <= n_entries) {
+    n_slots <<= 1U;
+  }
+
+  uint64_t* const slots =
+    (uint64_t*)zix_calloc(allocator, n_slots, sizeof(uint64_t));
+  if (!slots) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  // Calculate the offset of every entry and insert it into the slots
+  const uint64_t mask   = n_slots - 1U;
+  uint64_t       offset = sizeof(ZixHashViewHeader) + (n_slots * 8U);
+  for (ZixHashIter i = zix_hash_begin(hash); i != zix_hash_end(hash);
+       i = zix_hash_next(hash, i)) {
+    const ZixHashViewEntry entry = entry_func(zix_hash_get(hash, i), user_data);
+    const uint64_t         code =
+      zix_digest64(hash_view_seed, entry.key.data, entry.key.length);
+
+    uint64_t s = code & mask;
+    while (slots[s]) {
+      s = (s + 1U) & mask;
+    }
+
+    slots[s] = offset;
+    offset += entry_size(entry);
+  }
+
+  ZixHashViewHeader header = {
+    {0}, hash_view_version, hash_view_byte_order, n_entries, n_slots, offset};
+
+  memcpy(header.magic, hash_view_magic, sizeof(header.magic));
+
+  // Write everything to the file
+  FILE* const fd = fopen(path, "wb");
+  ZixStatus   st = fd ? write_snapshot(
+                        hash, entry_func, user_data, &header, slots, fd)
+                      : zix_errno_status(errno);
+
+  if (fd && fclose(fd) && !st) {
+    st = write_error();
+  }
+
+  zix_free(allocator, slots);
+  return st;
+}
+
+ZixHashView*
+zix_hash_view_new(ZixAllocator* const allocator,
+                  const void* const   data,
+                  const size_t        size)
+{
+  static const uint64_t slot_size = sizeof(uint64_t);
+
+  // Check that the header is present, valid, and consistent with the size
+  const ZixHashViewHeader* const header = (const ZixHashViewHeader*)data;
+  if (!data || ((uintptr_t)data & 7U) || size < sizeof(ZixHashViewHeader) ||
+      memcmp(header->magic, hash_view_magic, sizeof(header->magic)) ||
+      header->version != hash_view_version ||
+      header->byte_order != hash_view_byte_order || header->size != size ||
+      !header->n_slots || (header->n_slots & (header->n_slots - 1U)) ||
+      header->n_slots > (size - sizeof(ZixHashViewHeader)) / slot_size ||
+      header->n_entries >= header->n_slots) {
+    return NULL;
+  }
+
+  ZixHashView* const view =
+    (ZixHashView*)zix_calloc(allocator, 1U, sizeof(ZixHashView));
+
+  if (view) {
+    view->allocator = allocator;
+    view->data      = (const char*)data;
+    view->size      = size;
+    view->slots     = (const uint64_t*)(view->data + sizeof(ZixHashViewHeader));
+    view->mask      = header->n_slots - 1U;
+    view->n_entries = (size_t)header->n_entries;
+  }
+
+  return view;
+}
+
+ZixHashView*
+zix_hash_view_open(ZixAllocator* const allocator, const char* const path)
+{
+  const void* data = NULL;
+  size_t      size = 0U;
+  if (zix_system_map_file(path, &data, &size)) {
+    return NULL;
+  }
+
+  ZixHashView* const view = zix_hash_view_new(allocator, data, size);
+  if (!view) {
+    zix_system_unmap_file(data, size);
+    return NULL;
+  }
+
+  view->mapped = true;
+  return view;
+}
+
+void
+zix_hash_view_free(ZixHashView* const view)
+{
+  if (view) {
+    if (view->mapped) {
+      zix_system_unmap_file(view->data, view->size);
+    }
+
+    zix_free(view->allocator, view);
+  }
+}
+
+size_t
+zix_hash_view_size(const ZixHashView* const view)
+{
+  return view->n_entries;
+}
+
+ZixStatus
+zix_hash_view_find(const ZixHashView* const view,
+                   const ZixStringView      key,
+                   ZixStringView* const     value)
+{
+  static const size_t entry_header_size = sizeof(ZixHashViewEntryHeader);
+
+  const uint64_t code = zix_digest64(hash_view_seed, key.data, key.length);
+
+  // Probe at most every slot, and stop at anything out of bounds
+  uint64_t s = code & view->mask;
+  for (uint64_t n = 0U; n <= view->mask; ++n, s = (s + 1U) & view->mask) {
+    const uint64_t offset = view->slots[s];
+    if (!offset || (offset & 7U) || offset > view->size - entry_header_size) {
+      break;
+    }
+
+    const ZixHashViewEntryHeader* const entry =
+      (const ZixHashViewEntryHeader*)(view->data + offset);
+
+    if (entry->code == code && entry->key_length == key.length) {
+      const uint64_t    available = view->size - offset - entry_header_size;
+      const char* const entry_key = (const char*)(entry + 1U);
+      if (entry->key_length >= available ||
+          entry->value_length >= available - entry->key_length - 1U) {
+        break;
+      }
+
+      if (!memcmp(entry_key, key.data, key.length)) {
+        value->data   = entry_key + key.length + 1U;
+        value->length = (size_t)entry->value_length;
+        return ZIX_STATUS_SUCCESS;
+      }
+    }
+  }
+
+  return ZIX_STATUS_NOT_FOUND;
+}
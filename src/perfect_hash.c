@@ -0,0 +1,405 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include <zix/perfect_hash.h>
+
+#include <zix/allocator.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+#include <zix/string_view.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+  Keys are hashed to 64-bit codes, and the high 32 bits choose a bucket.
+  Buckets are skewed so that 60% of keys go to the first 30% of buckets,
+  which are placed first, while the table is still mostly empty.  The
+  position of a key in the slot array is a function of its code and its
+  bucket's pilot.  When building, buckets are placed in decreasing order of
+  size by trying each pilot until every key in the bucket lands in a free
+  slot.  There are about 1% more slots than keys so that the last buckets can
+  be placed quickly, and slots past the number of keys are remapped to free
+  indices with a small array.
+
+  Building rarely fails, unless two keys are identical, in which case it's
+  retried with a new seed.
+*/
+
+#define ZIX_PERFECT_HASH_MAX_ATTEMPTS 8U
+
+static const uint64_t mul         = 0x9E3779B97F4A7C15ULL;
+static const uint32_t dense_split = 2576980377U; // 0.6 * 2^32
+static const uint32_t max_n_keys  = 0x7FFFFFFFU;
+static const uint32_t bucket_size = 5U; // Average keys per bucket
+
+struct ZixPerfectHashImpl {
+  ZixAllocator*         allocator;     ///< User allocator
+  ZixPerfectHashKeyFunc key_func;      ///< Record key accessor, or null
+  void*                 user_data;     ///< User data for key_func
+  uint64_t              seed;          ///< Seed for zix_digest64()
+  uint64_t              dense_factor;  ///< Scale for dense bucket indices
+  uint64_t              sparse_factor; ///< Scale for sparse bucket indices
+  uint32_t              n_keys;        ///< Number of keys
+  uint32_t              n_slots;       ///< Number of slots, at least n_keys
+  uint32_t              n_dense;       ///< Number of dense buckets
+  uint32_t              n_buckets;     ///< Total number of buckets
+  uint16_t*             pilots;        ///< Pilot for each bucket
+  uint32_t*             remap;         ///< Index for each slot past n_keys
+  ZixHashRecord**       records;       ///< Record at each index, or null
+};
+
+typedef struct {
+  uint64_t* codes;   ///< Code of each key, sorted by bucket
+  uint32_t* starts;  ///< Start of each bucket in codes
+  uint32_t* order;   ///< Bucket indices sorted by decreasing size
+  uint64_t* taken;   ///< Bit set of taken slots
+  uint32_t* slots;   ///< Slots for the keys in the current bucket
+  uint32_t* counts;  ///< Number of buckets of each size
+  size_t    n_sizes; ///< Maximum bucket size plus one
+} ZixPerfectHashBuilder;
+
+static inline uint32_t
+bucket_index(const ZixPerfectHash* const hash, const uint64_t code)
+{
+  const uint32_t hi = (uint32_t)(code >> 32U);
+  if (hi < dense_split) {
+    return (uint32_t)((hi * hash->dense_factor) >> 32U);
+  }
+
+  const uint64_t sparse_hi = hi - dense_split;
+
+  return hash->n_dense + (uint32_t)((sparse_hi * hash->sparse_factor) >> 32U);
+}
+
+static inline uint32_t
+slot_index(const ZixPerfectHash* const hash,
+           const uint64_t              code,
+           const uint32_t              pilot)
+{
+  const uint64_t mixed = (code ^ ((pilot + 1ULL) * mul)) * mul;
+
+  return (uint32_t)(((mixed >> 32U) * hash->n_slots) >> 32U);
+}
+
+static inline bool
+is_taken(const uint64_t* const taken, const uint32_t slot)
+{
+  return (taken[slot / 64U] >> (slot % 64U)) & 1U;
+}
+
+static inline void
+flip_taken(uint64_t* const taken, const uint32_t slot)
+{
+  taken[slot / 64U] ^= (uint64_t)1U << (slot % 64U);
+}
+
+static void
+free_builder(ZixAllocator* const allocator, ZixPerfectHashBuilder* const b)
+{
+  zix_free(allocator, b->counts);
+  zix_free(allocator, b->slots);
+  zix_free(allocator, b->taken);
+  zix_free(allocator, b->order);
+  zix_free(allocator, b->starts);
+  zix_free(allocator, b->codes);
+}
+
+/// Hash keys into buckets, and sort the codes and buckets for placement
+static ZixStatus
+bucket_keys(ZixAllocator* const          allocator,
+            const ZixPerfectHash* const  hash,
+            const ZixStringView* const   keys,
+            ZixPerfectHashBuilder* const b)
+{
+  const uint32_t n_buckets = hash->n_buckets;
+
+  // Count the keys in each bucket
+  for (uint32_t i = 0U; i < hash->n_keys; ++i) {
+    const uint64_t code =
+      zix_digest64(hash->seed, keys[i].data, keys[i].length);
+
+    ++b->starts[bucket_index(hash, code) + 1U];
+  }
+
+  // Count the buckets of each size, and convert counts to start indices
+  size_t max_size = 0U;
+  for (uint32_t i = 1U; i <= n_buckets; ++i) {
+    max_size = (b->starts[i] > max_size) ? b->starts[i] : max_size;
+  }
+
+  b->n_sizes = max_size + 1U;
+  b->counts  = (uint32_t*)zix_calloc(allocator, b->n_sizes, sizeof(uint32_t));
+  b->slots   = (uint32_t*)zix_calloc(allocator, b->n_sizes, sizeof(uint32_t));
+  if (!b->counts || !b->slots) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  for (uint32_t i = 1U; i <= n_buckets; ++i) {
+    ++b->counts[b->starts[i]];
+    b->starts[i] += b->starts[i - 1U];
+  }
+
+  // Sort codes by bucket, using order to count the keys added to each bucket
+  for (uint32_t i = 0U; i < hash->n_keys; ++i) {
+    const uint64_t code =
+      zix_digest64(hash->seed, keys[i].data, keys[i].length);
+
+    const uint32_t bucket = bucket_index(hash, code);
+
+    b->codes[b->starts[bucket] + b->order[bucket]++] = code;
+  }
+
+  // Sort buckets by decreasing size, with counts as the start of each size
+  uint32_t offset = 0U;
+  for (size_t s = b->n_sizes; s-- > 0U;) {
+    const uint32_t count = b->counts[s];
+    b->counts[s]         = offset;
+    offset += count;
+  }
+
+  for (uint32_t i = 0U; i < n_buckets; ++i) {
+    const uint32_t size          = b->starts[i + 1U] - b->starts[i];
+    b->order[b->counts[size]++] = i;
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+/// Choose a pilot for every bucket, returning an error if that's impossible
+static ZixStatus
+place_buckets(ZixPerfectHash* const hash, ZixPerfectHashBuilder* const b)
+{
+  for (uint32_t i = 0U; i < hash->n_buckets; ++i) {
+    const uint32_t        bucket = b->order[i];
+    const uint64_t* const codes  = b->codes + b->starts[bucket];
+    const uint32_t        size   = b->starts[bucket + 1U] - b->starts[bucket];
+    if (!size) {
+      break; // All remaining buckets are empty
+    }
+
+    // Keys with equal codes can never be separated (and are likely equal)
+    for (uint32_t j = 0U; j < size; ++j) {
+      for (uint32_t k = j + 1U; k < size; ++k) {
+        if (codes[j] == codes[k]) {
+          return ZIX_STATUS_EXISTS;
+        }
+      }
+    }
+
+    // Find a pilot that puts every key in a free slot
+    uint32_t pilot = 0U;
+    for (; pilot <= UINT16_MAX; ++pilot) {
+      uint32_t k = 0U;
+      for (; k < size; ++k) {
+        const uint32_t slot = slot_index(hash, codes[k], pilot);
+        if (is_taken(b->taken, slot)) {
+          break;
+        }
+
+        flip_taken(b->taken, slot);
+        b->slots[k] = slot;
+      }
+
+      if (k == size) {
+        break;
+      }
+
+      while (k-- > 0U) {
+        flip_taken(b->taken, b->slots[k]);
+      }
+    }
+
+    if (pilot > UINT16_MAX) {
+      return ZIX_STATUS_OVERFLOW;
+    }
+
+    hash->pilots[bucket] = (uint16_t)pilot;
+  }
+
+  // Map each taken slot past the end to a free one before the end
+  uint32_t free_slot = 0U;
+  for (uint32_t s = hash->n_keys; s < hash->n_slots; ++s) {
+    if (is_taken(b->taken, s)) {
+      while (is_taken(b->taken, free_slot)) {
+        ++free_slot;
+      }
+
+      hash->remap[s - hash->n_keys] = free_slot++;
+    }
+  }
+
+  return ZIX_STATUS_SUCCESS;
+}
+
+/// Try to build with the current seed
+static ZixStatus
+build(ZixPerfectHash* const hash, const ZixStringView* const keys)
+{
+  ZixAllocator* const   allocator = hash->allocator;
+  const size_t          n_words   = (hash->n_slots + 63U) / 64U;
+  ZixPerfectHashBuilder b         = {
+    (uint64_t*)zix_calloc(allocator, hash->n_keys + 1U, sizeof(uint64_t)),
+    (uint32_t*)zix_calloc(allocator, hash->n_buckets + 1U, sizeof(uint32_t)),
+    (uint32_t*)zix_calloc(allocator, hash->n_buckets, sizeof(uint32_t)),
+    (uint64_t*)zix_calloc(allocator, n_words, sizeof(uint64_t)),
+    NULL,
+    NULL,
+    0U};
+
+  ZixStatus st = ZIX_STATUS_NO_MEM;
+  if (b.codes && b.starts && b.order && b.taken &&
+      !(st = bucket_keys(allocator, hash, keys, &b))) {
+    st = place_buckets(hash, &b);
+  }
+
+  free_builder(allocator, &b);
+  return st;
+}
+
+ZixPerfectHash*
+zix_perfect_hash_new(ZixAllocator* const        allocator,
+                     const size_t               n_keys,
+                     const ZixStringView* const keys)
+{
+  if (n_keys > max_n_keys || (n_keys && !keys)) {
+    return NULL;
+  }
+
+  ZixPerfectHash* const hash =
+    (ZixPerfectHash*)zix_calloc(allocator, 1U, sizeof(ZixPerfectHash));
+  if (!hash) {
+    return NULL;
+  }
+
+  const uint32_t n_buckets = (uint32_t)(n_keys / bucket_size) + 1U;
+  const uint32_t n_dense   = (uint32_t)(((uint64_t)n_buckets * 3U) / 10U);
+
+  hash->allocator     = allocator;
+  hash->dense_factor  = ((uint64_t)n_dense << 32U) / dense_split;
+  hash->sparse_factor = ((uint64_t)(n_buckets - n_dense) << 32U) /
+                        ((1ULL << 32U) - dense_split);
+
+  hash->n_keys    = (uint32_t)n_keys;
+  hash->n_slots   = (uint32_t)(n_keys + (n_keys / 99U) + 1U);
+  hash->n_dense   = n_dense;
+  hash->n_buckets = n_buckets;
+
+  const size_t n_remapped = hash->n_slots - hash->n_keys;
+
+  hash->pilots = (uint16_t*)zix_calloc(allocator, n_buckets, sizeof(uint16_t));
+  hash->remap  = (uint32_t*)zix_calloc(allocator, n_remapped, sizeof(uint32_t));
+
+  ZixStatus st = ZIX_STATUS_NO_MEM;
+  if (hash->pilots && hash->remap) {
+    // Try a few seeds, in case some keys have the same code
+    do {
+      st = build(hash, keys);
+    } while (st && st != ZIX_STATUS_NO_MEM &&
+             ++hash->seed < ZIX_PERFECT_HASH_MAX_ATTEMPTS);
+  }
+
+  if (st) {
+    zix_perfect_hash_free(hash);
+    return NULL;
+  }
+
+  return hash;
+}
+
+ZixPerfectHash*
+zix_perfect_hash_new_from_hash(ZixAllocator* const         allocator,
+                               const ZixHash* const        hash,
+                               const ZixPerfectHashKeyFunc key_func,
+                               void* const                 user_data)
+{
+  const size_t n_records = zix_hash_size(hash);
+
+  ZixHashRecord** const records = (ZixHashRecord**)zix_calloc(
+    allocator, n_records + 1U, sizeof(ZixHashRecord*));
+  ZixStringView* const keys = (ZixStringView*)zix_calloc(
+    allocator, n_records + 1U, sizeof(ZixStringView));
+
+  ZixPerfectHash* result = NULL;
+  if (records && keys) {
+    // Gather the keys
+    size_t n = 0U;
+    for (ZixHashIter i = zix_hash_begin(hash); i != zix_hash_end(hash);
+         i = zix_hash_next(hash, i)) {
+      keys[n++] = key_func(zix_hash_get(hash, i), user_data);
+    }
+
+    // Build the perfect hash, then store each record at the index of its key
+    if ((result = zix_perfect_hash_new(allocator, n_records, keys))) {
+      for (ZixHashIter i = zix_hash_begin(hash); i != zix_hash_end(hash);
+           i = zix_hash_next(hash, i)) {
+        ZixHashRecord* const record = zix_hash_get(hash, i);
+        const ZixStringView  key    = key_func(record, user_data);
+
+        records[zix_perfect_hash_index(result, key)] = record;
+      }
+
+      result->key_func  = key_func;
+      result->user_data = user_data;
+      result->records   = records;
+    }
+  }
+
+  if (!result) {
+    zix_free(allocator, records);
+  }
+
+  zix_free(allocator, keys);
+  return result;
+}
+
+void
+zix_perfect_hash_free(ZixPerfectHash* const hash)
+{
+  if (hash) {
+    zix_free(hash->allocator, hash->records);
+    zix_free(hash->allocator, hash->remap);
+    zix_free(hash->allocator, hash->pilots);
+    zix_free(hash->allocator, hash);
+  }
+}
+
+size_t
+zix_perfect_hash_size(const ZixPerfectHash* const hash)
+{
+  return hash->n_keys;
+}
+
+size_t
+zix_perfect_hash_index(const ZixPerfectHash* const hash,
+                       const ZixStringView         key)
+{
+  const uint64_t code  = zix_digest64(hash->seed, key.data, key.length);
+  const uint32_t pilot = hash->pilots[bucket_index(hash, code)];
+  const uint32_t slot  = slot_index(hash, code, pilot);
+
+  return (slot < hash->n_keys) ? slot : hash->remap[slot - hash->n_keys];
+}
+
+ZixHashRecord*
+zix_perfect_hash_get(const ZixPerfectHash* const hash, const size_t index)
+{
+  return (hash->records && index < hash->n_keys) ? hash->records[index] : NULL;
+}
+
+ZixHashRecord*
+zix_perfect_hash_find_record(const ZixPerfectHash* const hash,
+                             const ZixStringView         key)
+{
+  if (!hash->records || !hash->n_keys) {
+    return NULL;
+  }
+
+  const size_t         index      = zix_perfect_hash_index(hash, key);
+  ZixHashRecord* const record     = hash->records[index];
+  const ZixStringView  record_key = hash->key_func(record, hash->user_data);
+
+  return zix_string_view_equals(key, record_key) ? record : NULL;
+}
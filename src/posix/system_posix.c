@@ -1,11 +1,19 @@
-// Copyright 2007-2022 David Robillard <d@drobilla.net>
+// Copyright 2007-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "../errno_status.h"
 #include "../system.h"
 #include "../zix_config.h"
 
+#include <zix/status.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include <errno.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #if defined(PAGE_SIZE)
@@ -24,3 +32,42 @@ zix_system_page_size(void)
   return (uint32_t)ZIX_DEFAULT_PAGE_SIZE;
 #endif
 }
+
+ZixStatus
+zix_system_map_file(const char* const  path,
+                    const void** const data,
+                    size_t* const      size)
+{
+  *data = NULL;
+  *size = 0U;
+
+  const int fd = zix_system_open_fd(path, O_RDONLY, 0);
+  if (fd < 0) {
+    return zix_errno_status(errno);
+  }
+
+  struct stat st;
+  ZixStatus   status = zix_errno_status_if(fstat(fd, &st));
+  if (!status && st.st_size > 0) {
+    void* const map =
+      mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED) {
+      status = zix_errno_status(errno);
+    } else {
+      *data = map;
+      *size = (size_t)st.st_size;
+    }
+  }
+
+  close(fd);
+  return status;
+}
+
+void
+zix_system_unmap_file(const void* const data, const size_t size)
+{
+  if (data) {
+    munmap((void*)(uintptr_t)data, size);
+  }
+}
@@ -0,0 +1,238 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#include <zix/sharded_hash.h>
+
+#include <zix/allocator.h>
+#include <zix/hash.h>
+#include <zix/sem.h>
+#include <zix/status.h>
+
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ZIX_CACHE_LINE_SIZE 64U
+
+typedef struct {
+  ZixSem   lock; ///< Lock for this shard
+  ZixHash* hash; ///< Table of records in this shard
+  char     pad[ZIX_CACHE_LINE_SIZE];
+} ZixHashShard;
+
+struct ZixShardedHashImpl {
+  ZixAllocator*   allocator;  ///< User allocator
+  ZixKeyFunc      key_func;   ///< User key accessor
+  ZixHashFunc     hash_func;  ///< User hashing function
+  ZixKeyEqualFunc equal_func; ///< User equality comparison function
+  unsigned        n_shards;   ///< Power of two number of shards
+  unsigned        shift;      ///< Right shift to get a shard index
+  ZixHashShard*   shards;     ///< Array of shards (allocated after this)
+};
+
+/// Search data for finding an equal key with a precalculated hash code
+typedef struct {
+  ZixKeyEqualFunc   equal_func;
+  const ZixHashKey* key;
+} ZixShardSearch;
+
+/*
+  The shard index is the high bits of the hash code multiplied by a large odd
+  constant (Fibonacci hashing), so it depends on every bit of the hash code,
+  and is mostly independent of the low bits that index into the shard itself.
+*/
+
+#if SIZE_MAX > UINT32_MAX
+static const size_t shard_multiplier = (size_t)0x9E3779B97F4A7C15ULL;
+#else
+static const size_t shard_multiplier = (size_t)0x9E3779B9UL;
+#endif
+
+static inline ZixHashShard*
+shard_for(const ZixShardedHash* const hash, const ZixHashCode code)
+{
+  // Shift by one first, so a single shard (shift by the width) is defined
+  const size_t product = code * shard_multiplier;
+
+  return &hash->shards[(product >> 1U) >> (hash->shift - 1U)];
+}
+
+static bool
+shard_search_match(const ZixHashKey* const        key,
+                   const ZixHashSearchData* const user_data)
+{
+  const ZixShardSearch* const search = (const ZixShardSearch*)user_data;
+
+  return search->equal_func(key, search->key);
+}
+
+static void
+free_shards(ZixShardedHash* const hash, const unsigned n_shards)
+{
+  for (unsigned i = 0U; i < n_shards; ++i) {
+    zix_sem_destroy(&hash->shards[i].lock);
+    zix_hash_free(hash->shards[i].hash);
+  }
+}
+
+ZixShardedHash*
+zix_sharded_hash_new(ZixAllocator* const   allocator,
+                     const unsigned        n_shards,
+                     const ZixKeyFunc      key_func,
+                     const ZixHashFunc     hash_func,
+                     const ZixKeyEqualFunc equal_func)
+{
+  assert(key_func);
+  assert(hash_func);
+  assert(equal_func);
+
+  // Round the number of shards up to a power of two
+  unsigned bits = 0U;
+  while (bits < 16U && (1U << bits) < n_shards) {
+    ++bits;
+  }
+
+  const unsigned n = 1U << bits;
+
+  ZixShardedHash* const hash = (ZixShardedHash*)zix_calloc(
+    allocator, 1U, sizeof(ZixShardedHash) + (n * sizeof(ZixHashShard)));
+
+  if (!hash) {
+    return NULL;
+  }
+
+  hash->allocator  = allocator;
+  hash->key_func   = key_func;
+  hash->hash_func  = hash_func;
+  hash->equal_func = equal_func;
+  hash->n_shards   = n;
+  hash->shift      = (unsigned)(sizeof(size_t) * CHAR_BIT) - bits;
+  hash->shards     = (ZixHashShard*)(hash + 1U);
+
+  for (unsigned i = 0U; i < n; ++i) {
+    ZixHashShard* const shard = &hash->shards[i];
+
+    shard->hash = zix_hash_new(allocator, key_func, hash_func, equal_func);
+    if (!shard->hash || zix_sem_init(&shard->lock, 1U)) {
+      zix_hash_free(shard->hash);
+      free_shards(hash, i);
+      zix_free(allocator, hash);
+      return NULL;
+    }
+  }
+
+  return hash;
+}
+
+void
+zix_sharded_hash_free(ZixShardedHash* const hash)
+{
+  if (hash) {
+    free_shards(hash, hash->n_shards);
+    zix_free(hash->allocator, hash);
+  }
+}
+
+unsigned
+zix_sharded_hash_n_shards(const ZixShardedHash* const hash)
+{
+  return hash->n_shards;
+}
+
+size_t
+zix_sharded_hash_size(ZixShardedHash* const hash)
+{
+  size_t size = 0U;
+  for (unsigned i = 0U; i < hash->n_shards; ++i) {
+    ZixHashShard* const shard = &hash->shards[i];
+
+    zix_sem_wait(&shard->lock);
+    size += zix_hash_size(shard->hash);
+    zix_sem_post(&shard->lock);
+  }
+
+  return size;
+}
+
+ZixHash*
+zix_sharded_hash_lock_shard(ZixShardedHash* const hash, const ZixHashCode code)
+{
+  ZixHashShard* const shard = shard_for(hash, code);
+
+  zix_sem_wait(&shard->lock);
+  return shard->hash;
+}
+
+void
+zix_sharded_hash_unlock_shard(ZixShardedHash* const hash,
+                              const ZixHashCode     code)
+{
+  zix_sem_post(&shard_for(hash, code)->lock);
+}
+
+ZixStatus
+zix_sharded_hash_insert(ZixShardedHash* const hash,
+                        ZixHashRecord* const  record)
+{
+  const ZixHashKey* const key    = hash->key_func(record);
+  const ZixHashCode       code   = hash->hash_func(key);
+  const ZixShardSearch    search = {hash->equal_func, key};
+  ZixHashShard* const     shard  = shard_for(hash, code);
+
+  zix_sem_wait(&shard->lock);
+
+  const ZixHashInsertPlan plan = zix_hash_plan_insert_prehashed(
+    shard->hash, code, shard_search_match, &search);
+
+  const ZixStatus st = zix_hash_record_at(shard->hash, plan)
+                         ? ZIX_STATUS_EXISTS
+                         : zix_hash_insert_at(shard->hash, plan, record);
+
+  zix_sem_post(&shard->lock);
+  return st;
+}
+
+ZixStatus
+zix_sharded_hash_remove(ZixShardedHash* const   hash,
+                        const ZixHashKey* const key,
+                        ZixHashRecord** const   removed)
+{
+  const ZixHashCode    code   = hash->hash_func(key);
+  const ZixShardSearch search = {hash->equal_func, key};
+  ZixHashShard* const  shard  = shard_for(hash, code);
+
+  zix_sem_wait(&shard->lock);
+
+  const ZixHashIter i =
+    zix_hash_find_prehashed(shard->hash, code, shard_search_match, &search);
+
+  ZixStatus st = ZIX_STATUS_NOT_FOUND;
+  *removed     = NULL;
+  if (i != zix_hash_end(shard->hash)) {
+    st = zix_hash_erase(shard->hash, i, removed);
+  }
+
+  zix_sem_post(&shard->lock);
+  return st;
+}
+
+ZixHashRecord*
+zix_sharded_hash_find_record(ZixShardedHash* const   hash,
+                             const ZixHashKey* const key)
+{
+  const ZixHashCode    code   = hash->hash_func(key);
+  const ZixShardSearch search = {hash->equal_func, key};
+  ZixHashShard* const  shard  = shard_for(hash, code);
+
+  zix_sem_wait(&shard->lock);
+
+  const ZixHashInsertPlan plan = zix_hash_plan_insert_prehashed(
+    shard->hash, code, shard_search_match, &search);
+
+  ZixHashRecord* const record = zix_hash_record_at(shard->hash, plan);
+
+  zix_sem_post(&shard->lock);
+  return record;
+}
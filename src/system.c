@@ -1,9 +1,15 @@
-// Copyright 2007-2022 David Robillard <d@drobilla.net>
+// Copyright 2007-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+// Enable rand_s(), which must be defined before stdlib.h is included
+#ifdef _WIN32
+#  define _CRT_RAND_S
+#endif
+
 #include "system.h"
 
 #include "errno_status.h"
+#include "zix_config.h"
 
 #include <zix/status.h>
 
@@ -13,8 +19,16 @@
 #  include <unistd.h>
 #endif
 
+#if USE_GETENTROPY
+#  include <sys/random.h>
+#endif
+
 #include <errno.h>
 #include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 int
 zix_system_open_fd(const char* const path, const int flags, const mode_t mode)
@@ -39,3 +53,56 @@ zix_system_close_fds(const int fd1, const int fd2)
 
   return st0 ? st0 : st1 ? st1 : st2;
 }
+
+ZixStatus
+zix_system_random(void* const buf, const size_t size)
+{
+  uint8_t* const bytes = (uint8_t*)buf;
+
+#if defined(_WIN32)
+  for (size_t offset = 0U; offset < size; offset += sizeof(unsigned)) {
+    unsigned value = 0U;
+    if (rand_s(&value)) {
+      return ZIX_STATUS_ERROR;
+    }
+
+    const size_t n = size - offset;
+    memcpy(bytes + offset, &value, n < sizeof(value) ? n : sizeof(value));
+  }
+
+  return ZIX_STATUS_SUCCESS;
+
+#elif USE_GETENTROPY
+  // Fill in chunks of at most 256 bytes, the most getentropy() allows
+  for (size_t offset = 0U; offset < size; offset += 256U) {
+    const size_t n = (size - offset < 256U) ? size - offset : 256U;
+    if (getentropy(bytes + offset, n)) {
+      return zix_errno_status(errno);
+    }
+  }
+
+  return ZIX_STATUS_SUCCESS;
+
+#else
+  const int fd = zix_system_open_fd("/dev/urandom", O_RDONLY, 0);
+  if (fd < 0) {
+    return zix_errno_status(errno);
+  }
+
+  ZixStatus st     = ZIX_STATUS_SUCCESS;
+  size_t    offset = 0U;
+  while (!st && offset < size) {
+    const ZixSystemCountReturn r = read(fd, bytes + offset, size - offset);
+    if (r > 0) {
+      offset += (size_t)r;
+    } else if (!r) {
+      st = ZIX_STATUS_ERROR;
+    } else if (errno != EINTR) {
+      st = zix_errno_status(errno);
+    }
+  }
+
+  close(fd);
+  return st;
+#endif
+}
@@ -6,6 +6,7 @@
 
 #include <zix/status.h>
 
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/types.h>
 
@@ -27,4 +28,16 @@ zix_system_open_fd(const char* path, int flags, mode_t mode);
 ZixStatus
 zix_system_close_fds(int fd1, int fd2);
 
+/// Fill a buffer with random bytes from the system's secure random source
+ZixStatus
+zix_system_random(void* buf, size_t size);
+
+/// Map an entire file into memory for reading, or set `data` to null if empty
+ZixStatus
+zix_system_map_file(const char* path, const void** data, size_t* size);
+
+/// Unmap a file mapped with zix_system_map_file()
+void
+zix_system_unmap_file(const void* data, size_t size);
+
 #endif // ZIX_SYSTEM_H
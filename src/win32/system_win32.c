@@ -1,11 +1,15 @@
-// Copyright 2007-2022 David Robillard <d@drobilla.net>
+// Copyright 2007-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #include "../system.h"
+#include "win32_util.h"
+
+#include <zix/status.h>
 
 #include <windows.h>
 
 #include <limits.h>
+#include <stddef.h>
 #include <stdint.h>
 
 uint32_t
@@ -18,3 +22,68 @@ zix_system_page_size(void)
            ? (uint32_t)info.dwPageSize
            : 512U;
 }
+
+ZixStatus
+zix_system_map_file(const char* const  path,
+                    const void** const data,
+                    size_t* const      size)
+{
+  *data = NULL;
+  *size = 0U;
+
+  ArgPathChar* const wpath = arg_path_new(NULL, path);
+  if (!wpath) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  const HANDLE file = CreateFile(wpath,
+                                 GENERIC_READ,
+                                 FILE_SHARE_READ,
+                                 NULL,
+                                 OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL,
+                                 NULL);
+
+  arg_path_free(NULL, wpath);
+  if (file == INVALID_HANDLE_VALUE) {
+    return ZIX_STATUS_NOT_FOUND;
+  }
+
+  LARGE_INTEGER file_size;
+  ZixStatus     st = ZIX_STATUS_SUCCESS;
+  if (!GetFileSizeEx(file, &file_size) ||
+      (uint64_t)file_size.QuadPart > SIZE_MAX) {
+    st = ZIX_STATUS_ERROR;
+  } else if (file_size.QuadPart > 0) {
+    // The view keeps the mapping alive, so both handles can be closed
+    const HANDLE mapping =
+      CreateFileMapping(file, NULL, PAGE_READONLY, 0U, 0U, NULL);
+
+    const void* const map =
+      mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0U, 0U, 0U) : NULL;
+
+    if (!map) {
+      st = ZIX_STATUS_ERROR;
+    } else {
+      *data = map;
+      *size = (size_t)file_size.QuadPart;
+    }
+
+    if (mapping) {
+      CloseHandle(mapping);
+    }
+  }
+
+  CloseHandle(file);
+  return st;
+}
+
+void
+zix_system_unmap_file(const void* const data, const size_t size)
+{
+  (void)size;
+
+  if (data) {
+    UnmapViewOfFile(data);
+  }
+}
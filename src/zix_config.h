@@ -121,6 +121,15 @@
 #    endif
 #  endif
 
+// OpenBSD 5.6, FreeBSD 12, and glibc 2.25: getentropy()
+#  ifndef HAVE_GETENTROPY
+#    if defined(__OpenBSD__) || (defined(__FreeBSD__) && __FreeBSD__ >= 12) || \
+      (defined(__GLIBC__) &&                                                \
+       (__GLIBC__ > 2 || __GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+#      define HAVE_GETENTROPY 1
+#    endif
+#  endif
+
 // Windows Vista (Desktop, UWP): GetFinalPathNameByHandle()
 #  ifndef HAVE_GETFINALPATHNAMEBYHANDLE
 #    if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0600
@@ -242,6 +251,12 @@
 #  define USE_FLOCK 0
 #endif
 
+#if defined(HAVE_GETENTROPY) && HAVE_GETENTROPY
+#  define USE_GETENTROPY 1
+#else
+#  define USE_GETENTROPY 0
+#endif
+
 #if defined(HAVE_GETFINALPATHNAMEBYHANDLE) && HAVE_GETFINALPATHNAMEBYHANDLE
 #  define USE_GETFINALPATHNAMEBYHANDLE 1
 #else
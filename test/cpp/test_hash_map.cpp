@@ -0,0 +1,238 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/hash_map.hpp>
+#include <zix/status.h>
+
+extern "C" {
+#include "../failing_allocator.h"
+}
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+struct Item {
+  size_t key;
+  size_t value;
+};
+
+struct ItemKey {
+  size_t operator()(const Item& item) const noexcept { return item.key; }
+};
+
+struct StringKey {
+  std::string_view operator()(const char& str) const noexcept
+  {
+    return std::string_view{&str};
+  }
+};
+
+struct StringHash {
+  ZixHashCode operator()(const std::string_view str) const noexcept
+  {
+    return zix_digest(0U, str.data(), str.size());
+  }
+};
+
+/// Hash function that puts every key in the same place to test probing
+struct TerribleHash {
+  ZixHashCode operator()(const size_t) const noexcept { return 1U; }
+};
+
+using ItemMap   = zix::HashMap<size_t, Item, ItemKey>;
+using StringMap =
+  zix::HashMap<std::string_view, const char, StringKey, StringHash>;
+
+void
+test_empty()
+{
+  const ItemMap map{};
+
+  assert(map.empty());
+  assert(!map.size());
+  assert(map.begin() == map.end());
+  assert(map.find(1U) == map.end());
+  assert(!map.find_record(1U));
+  assert(std::distance(map.begin(), map.end()) == 0);
+}
+
+template<class Map>
+void
+test_items()
+{
+  static constexpr size_t n_items = 1024U;
+
+  Item items[n_items] = {};
+  for (size_t i = 0U; i < n_items; ++i) {
+    items[i] = Item{i * 3U, i};
+  }
+
+  Map map{};
+
+  // Insert every item, where inserting an equal key again fails
+  for (auto& item : items) {
+    assert(!map.insert(&item));
+    assert(map.insert(&item) == ZIX_STATUS_EXISTS);
+  }
+
+  assert(map.size() == n_items);
+  assert(!map.empty());
+
+  // Find every item, but no missing keys
+  for (const auto& item : items) {
+    assert(map.find_record(item.key) == &item);
+    assert(*map.find(item.key) == &item);
+    assert(map.find(item.key + 1U) == map.end());
+  }
+
+  // Iteration visits every item exactly once
+  size_t sum = 0U;
+  for (const Item* const item : map) {
+    sum += item->value;
+  }
+
+  assert(sum == n_items * (n_items - 1U) / 2U);
+  assert(static_cast<size_t>(std::distance(map.begin(), map.end())) ==
+         n_items);
+
+  // Remove every other item, which leaves tombstones behind
+  for (size_t i = 0U; i < n_items; i += 2U) {
+    Item* removed = nullptr;
+    assert(!map.remove(items[i].key, &removed));
+    assert(removed == &items[i]);
+    assert(map.remove(items[i].key, &removed) == ZIX_STATUS_NOT_FOUND);
+  }
+
+  assert(map.size() == n_items / 2U);
+  for (size_t i = 0U; i < n_items; ++i) {
+    assert(map.find_record(items[i].key) == ((i % 2U) ? &items[i] : nullptr));
+  }
+
+  assert(std::all_of(map.begin(), map.end(), [](const Item* const item) {
+    return item->value % 2U;
+  }));
+
+  // Erase the rest by iterator, which shrinks the table as it goes
+  while (!map.empty()) {
+    Item* removed = nullptr;
+    assert(!map.erase(map.begin(), &removed));
+    assert(removed);
+    assert(!map.find_record(removed->key));
+  }
+
+  assert(map.begin() == map.end());
+
+  // Reinsert everything after reserving space, then move the table
+  assert(!map.reserve(n_items));
+  assert(map.reserve(SIZE_MAX) == ZIX_STATUS_NO_MEM);
+  for (auto& item : items) {
+    assert(!map.insert(&item));
+  }
+
+  const Map moved{std::move(map)};
+  assert(moved.size() == n_items);
+  assert(map.empty());
+  assert(map.begin() == map.end());
+  for (const auto& item : items) {
+    assert(moved.find_record(item.key) == &item);
+  }
+}
+
+void
+test_strings()
+{
+  static const char* const strings[] = {"apple", "banana", "cherry", "date"};
+
+  StringMap map{};
+  for (const char* const string : strings) {
+    assert(!map.insert(string));
+  }
+
+  // Keys are found by value, not by pointer
+  char copy[8] = {};
+  std::snprintf(copy, sizeof(copy), "%s", "banana");
+  assert(copy != strings[1]);
+  assert(map.find_record(copy) == strings[1]);
+  assert(map.insert(copy) == ZIX_STATUS_EXISTS);
+  assert(!map.find_record("elderberry"));
+
+  StringMap other{};
+  other = std::move(map);
+  assert(other.size() == 4U);
+  assert(other.find_record("cherry") == strings[2]);
+}
+
+void
+test_default_hash()
+{
+  static constexpr size_t n_keys = 1024U;
+
+  // Keys that only differ in high bits still differ in the low bits used
+  const zix::DigestHash<size_t> hash{};
+  bool                          seen[n_keys]{};
+  size_t                        n_distinct = 0U;
+  for (size_t i = 0U; i < n_keys; ++i) {
+    const size_t slot = hash(i * n_keys) & (n_keys - 1U);
+    n_distinct += !seen[slot];
+    seen[slot] = true;
+  }
+
+  assert(n_distinct > n_keys / 2U);
+}
+
+void
+test_failed_alloc()
+{
+  ZixFailingAllocator allocator = zix_failing_allocator();
+
+  Item items[4] = {{1U, 1U}, {2U, 2U}, {3U, 3U}, {4U, 4U}};
+  ItemMap map{&allocator.base};
+
+  // Failing to allocate the initial table leaves the map empty
+  zix_failing_allocator_reset(&allocator, 0U);
+  assert(map.insert(&items[0]) == ZIX_STATUS_NO_MEM);
+  assert(map.empty());
+
+  // Failing to grow leaves the map unchanged
+  zix_failing_allocator_reset(&allocator, 1U);
+  assert(!map.insert(&items[0]));
+  assert(map.insert(&items[1]) == ZIX_STATUS_NO_MEM);
+  assert(map.size() == 1U);
+  assert(map.find_record(1U) == &items[0]);
+  assert(!map.find_record(2U));
+
+  // Failing to shrink still removes the record
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  assert(!map.reserve(64U));
+  zix_failing_allocator_reset(&allocator, 0U);
+  Item* removed = nullptr;
+  assert(map.remove(1U, &removed) == ZIX_STATUS_NO_MEM);
+  assert(removed == &items[0]);
+  assert(map.empty());
+}
+
+} // namespace
+
+int
+main()
+{
+  test_empty();
+  test_items<ItemMap>();
+  test_items<zix::HashMap<size_t, Item, ItemKey, TerribleHash>>();
+  test_strings();
+  test_default_hash();
+  test_failed_alloc();
+  return 0;
+}
@@ -5,22 +5,29 @@
 #  define WIN32_LEAN_AND_MEAN
 #endif
 
-#include <zix/allocator.h>      // IWYU pragma: keep
-#include <zix/attributes.h>     // IWYU pragma: keep
-#include <zix/btree.h>          // IWYU pragma: keep
-#include <zix/bump_allocator.h> // IWYU pragma: keep
-#include <zix/digest.h>         // IWYU pragma: keep
-#include <zix/environment.h>    // IWYU pragma: keep
-#include <zix/filesystem.h>     // IWYU pragma: keep
-#include <zix/hash.h>           // IWYU pragma: keep
-#include <zix/path.h>           // IWYU pragma: keep
-#include <zix/ring.h>           // IWYU pragma: keep
-#include <zix/sem.h>            // IWYU pragma: keep
-#include <zix/status.h>         // IWYU pragma: keep
-#include <zix/string_view.h>    // IWYU pragma: keep
-#include <zix/thread.h>         // IWYU pragma: keep
-#include <zix/tree.h>           // IWYU pragma: keep
-#include <zix/zix.h>            // IWYU pragma: keep
+#include <zix/allocator.h>       // IWYU pragma: keep
+#include <zix/attributes.h>      // IWYU pragma: keep
+#include <zix/btree.h>           // IWYU pragma: keep
+#include <zix/bump_allocator.h>  // IWYU pragma: keep
+#include <zix/concurrent_hash.h> // IWYU pragma: keep
+#include <zix/digest.h>          // IWYU pragma: keep
+#include <zix/environment.h>     // IWYU pragma: keep
+#include <zix/filesystem.h>      // IWYU pragma: keep
+#include <zix/flat_hash.h>       // IWYU pragma: keep
+#include <zix/hash.h>            // IWYU pragma: keep
+#include <zix/hash_define.h>     // IWYU pragma: keep
+#include <zix/hash_map.hpp>      // IWYU pragma: keep
+#include <zix/hash_view.h>       // IWYU pragma: keep
+#include <zix/path.h>            // IWYU pragma: keep
+#include <zix/perfect_hash.h>    // IWYU pragma: keep
+#include <zix/ring.h>            // IWYU pragma: keep
+#include <zix/sem.h>             // IWYU pragma: keep
+#include <zix/sharded_hash.h>    // IWYU pragma: keep
+#include <zix/status.h>          // IWYU pragma: keep
+#include <zix/string_view.h>     // IWYU pragma: keep
+#include <zix/thread.h>          // IWYU pragma: keep
+#include <zix/tree.h>            // IWYU pragma: keep
+#include <zix/zix.h>             // IWYU pragma: keep
 
 #if defined(__GNUC__)
 __attribute__((const))
@@ -1,4 +1,4 @@
-// Copyright 2011-2023 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #undef NDEBUG
@@ -16,8 +16,12 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 ZIX_PURE_FUNC static int
 int_cmp(const void* a, const void* b, const void* ZIX_UNUSED(user_data))
@@ -176,6 +180,30 @@ test_iter_comparison(void)
   assert(zix_btree_iter_equals(end, j));
   assert(zix_btree_iter_equals(j, end));
 
+  // Check that reverse begin and end work sensibly
+  const ZixBTreeIter rbegin = zix_btree_rbegin(t);
+  const ZixBTreeIter rend   = zix_btree_rend(t);
+  assert(!zix_btree_iter_is_end(rbegin));
+  assert(zix_btree_iter_is_end(rend));
+  assert((uintptr_t)zix_btree_get(rbegin) == n_elems - 1U);
+  assert(zix_btree_iter_equals(rend, end));
+
+  // Move back to the beginning, checking that next undoes prev
+  j = rbegin;
+  for (size_t r = n_elems - 1U; r > 1U; --r) {
+    assert((uintptr_t)zix_btree_get(j) == r);
+
+    const ZixBTreeIter prev = zix_btree_iter_prev(j);
+    assert(zix_btree_iter_equals(zix_btree_iter_next(prev), j));
+    j = prev;
+  }
+
+  // Move back past the beginning to the end
+  assert(zix_btree_iter_equals(begin, j));
+  assert(zix_btree_iter_decrement(&j) == ZIX_STATUS_REACHED_END);
+  assert(zix_btree_iter_is_end(j));
+  assert(zix_btree_iter_equals(rend, j));
+
   zix_btree_free(t, NULL, NULL);
 }
 
@@ -236,6 +264,870 @@ test_remove_cases(void)
   zix_btree_free(t, NULL, NULL);
 }
 
+typedef struct {
+  uintptr_t next;
+  uintptr_t end;
+} PullRange;
+
+static bool
+pull_range(void* const data, void** const value)
+{
+  PullRange* const range = (PullRange*)data;
+  if (range->next >= range->end) {
+    return false;
+  }
+
+  *value = (void*)range->next;
+  range->next += 2U;
+  return true;
+}
+
+static void
+check_loaded(ZixBTree* const t, const size_t n_elems)
+{
+  // Every loaded value is found and iterated over in order
+  assert(zix_btree_size(t) == n_elems);
+  ZixBTreeIter iter = zix_btree_begin(t);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const uintptr_t value = 1U + (2U * i);
+    ZixBTreeIter    found = zix_btree_end_iter;
+
+    assert(!zix_btree_iter_is_end(iter));
+    assert((uintptr_t)zix_btree_get(iter) == value);
+    assert(!zix_btree_find(t, (void*)value, &found));
+    assert(zix_btree_iter_equals(found, iter));
+    assert(zix_btree_find(t, (void*)(value + 1U), &found));
+    if (i) {
+      const void* const key = (void*)(value - 1U);
+      assert(!zix_btree_lower_bound(t, NULL, NULL, key, &found));
+      assert(zix_btree_iter_equals(found, iter));
+    }
+
+    zix_btree_iter_increment(&iter);
+  }
+
+  assert(zix_btree_iter_is_end(iter));
+
+  // Inserting between the loaded values works as usual
+  for (size_t i = 0U; i < n_elems; i += 7U) {
+    assert(!zix_btree_insert(t, (void*)(2U + (2U * i))));
+  }
+
+  // Remove everything, which checks that every node is valid
+  for (size_t i = 0U; i < 2U * n_elems; ++i) {
+    const uintptr_t value   = 1U + unique_rand(i) % (2U * n_elems);
+    void*           removed = NULL;
+    ZixBTreeIter    next    = zix_btree_end_iter;
+
+    zix_btree_remove(t, (void*)value, &removed, &next);
+  }
+
+  for (uintptr_t r = 1U; r <= 2U * n_elems; ++r) {
+    void*        removed = NULL;
+    ZixBTreeIter next    = zix_btree_end_iter;
+
+    zix_btree_remove(t, (void*)r, &removed, &next);
+  }
+
+  assert(!zix_btree_size(t));
+}
+
+static void
+test_bulk_load(void)
+{
+  static const size_t   sizes[] = {0U, 1U, 2U, 254U, 255U, 256U, 510U, 511U,
+                                   512U, 765U, 766U, 767U, 1021U, 65281U,
+                                   65535U, 130305U};
+  static const unsigned fills[] = {0U, 50U, 75U, 100U, 200U};
+
+  const size_t max_n_elems = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1U];
+  void** const values      = (void**)calloc(max_n_elems, sizeof(void*));
+  assert(values);
+  for (size_t i = 0U; i < max_n_elems; ++i) {
+    values[i] = (void*)(1U + (2U * i));
+  }
+
+  ZixBTree* const t = zix_btree_new(NULL, int_cmp, NULL);
+  for (size_t s = 0U; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    for (size_t f = 0U; f < sizeof(fills) / sizeof(fills[0]); ++f) {
+      const size_t n_elems = sizes[s];
+
+      assert(!zix_btree_bulk_load(t, n_elems, values, fills[f]));
+      check_loaded(t, n_elems);
+
+      PullRange range = {1U, 1U + (2U * n_elems)};
+      assert(!zix_btree_bulk_load_from(t, pull_range, &range, fills[f]));
+      check_loaded(t, n_elems);
+    }
+  }
+
+  // Loading into a non-empty tree fails
+  assert(!zix_btree_insert(t, (void*)2U));
+  assert(zix_btree_bulk_load(t, 4U, values, 100U) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_size(t) == 1U);
+  zix_btree_clear(t, NULL, NULL);
+
+  // Loading values that aren't strictly increasing fails and clears the tree
+  values[4096U] = values[4095U];
+  assert(zix_btree_bulk_load(t, 8192U, values, 100U) == ZIX_STATUS_BAD_ARG);
+  assert(!zix_btree_size(t));
+  assert(zix_btree_iter_is_end(zix_btree_begin(t)));
+  values[4096U] = values[4095U - 1U];
+  assert(zix_btree_bulk_load(t, 8192U, values, 100U) == ZIX_STATUS_BAD_ARG);
+  assert(!zix_btree_size(t));
+
+  zix_btree_free(t, NULL, NULL);
+  free(values);
+}
+
+static void
+test_remove_from_full(void)
+{
+  static const size_t n_elems = 300000U;
+
+  void** const values  = (void**)calloc(n_elems, sizeof(void*));
+  bool* const  present = (bool*)calloc(n_elems, sizeof(bool));
+  assert(values);
+  assert(present);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    values[i]  = (void*)(1U + i);
+    present[i] = true;
+  }
+
+  // Load completely full nodes, so removals merge under full internal nodes
+  ZixBTree* const t = zix_btree_new(NULL, int_cmp, NULL);
+  assert(!zix_btree_bulk_load(t, n_elems, values, 100U));
+
+  size_t n_present = n_elems;
+  for (size_t i = 0U; i < 2U * n_elems; ++i) {
+    const size_t index   = unique_rand(i) % n_elems;
+    void*        removed = NULL;
+    ZixBTreeIter next    = zix_btree_end_iter;
+
+    const ZixStatus st = zix_btree_remove(t, values[index], &removed, &next);
+
+    if (present[index]) {
+      assert(!st);
+      assert(removed == values[index]);
+      present[index] = false;
+      --n_present;
+    } else {
+      assert(st == ZIX_STATUS_NOT_FOUND);
+    }
+  }
+
+  assert(zix_btree_size(t) == n_present);
+  zix_btree_free(t, NULL, NULL);
+  free(present);
+  free(values);
+}
+
+/// Check rank and select for a sample of positions, and counting between them
+static void
+check_order_statistics(const ZixBTree* const t, const size_t stride)
+{
+  const size_t n_elems   = zix_btree_size(t);
+  size_t       index     = 0U;
+  uintptr_t    last      = 0U;
+  size_t       last_rank = 0U;
+
+  for (ZixBTreeIter i = zix_btree_begin(t); !zix_btree_iter_is_end(i);
+       zix_btree_iter_increment(&i)) {
+    const uintptr_t value = (uintptr_t)zix_btree_get(i);
+
+    if (index % stride == 0U || index + 1U == n_elems) {
+      ZixBTreeIter selected = zix_btree_end_iter;
+
+      assert(zix_btree_rank(t, (void*)value) == index);
+      assert(zix_btree_rank(t, (void*)(value + 1U)) == index + 1U);
+      assert(!zix_btree_select(t, index, &selected));
+      assert(zix_btree_iter_equals(selected, i));
+
+      if (last) {
+        const size_t n = index - last_rank;
+        assert(zix_btree_count_range(t, (void*)last, (void*)value) == n);
+        assert(zix_btree_count_range(t, (void*)last, (void*)(value + 1U)) ==
+               n + 1U);
+        assert(!zix_btree_count_range(t, (void*)value, (void*)last));
+      }
+
+      last      = value;
+      last_rank = index;
+    }
+
+    ++index;
+  }
+
+  ZixBTreeIter end = zix_btree_begin(t);
+  assert(index == n_elems);
+  assert(zix_btree_select(t, n_elems, &end) == ZIX_STATUS_NOT_FOUND);
+  assert(zix_btree_iter_is_end(end));
+  assert(zix_btree_rank(t, (void*)UINTPTR_MAX) == n_elems);
+}
+
+static void
+test_order_statistics(void)
+{
+  static const size_t n_elems = 1U << 17U;
+  static const size_t stride  = 4093U;
+
+  ZixBTree* const t = zix_btree_new(NULL, int_cmp, NULL);
+  check_order_statistics(t, 1U);
+
+  // Insert values in pseudo-random order, checking a few as the tree grows
+  for (size_t i = 0U; i < n_elems; ++i) {
+    assert(!zix_btree_insert(t, (void*)(1U + unique_rand(i))));
+    if (i % 32768U == 0U) {
+      check_order_statistics(t, stride);
+    }
+  }
+
+  check_order_statistics(t, stride);
+
+  // Remove in a different order, which merges and rotates nodes everywhere
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const uintptr_t value   = 1U + unique_rand(n_elems - 1U - i);
+    void*           removed = NULL;
+    ZixBTreeIter    next    = zix_btree_end_iter;
+
+    assert(!zix_btree_remove(t, (void*)value, &removed, &next));
+    assert((uintptr_t)removed == value);
+    if (i % 32768U == 0U) {
+      check_order_statistics(t, stride);
+    } else if (n_elems - i < 1024U && i % 32U == 0U) {
+      check_order_statistics(t, 1U);
+    }
+  }
+
+  check_order_statistics(t, 1U);
+
+  // Bulk load, which counts everything at once
+  void** const values = (void**)calloc(n_elems, sizeof(void*));
+  assert(values);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    values[i] = (void*)(1U + (2U * i));
+  }
+
+  assert(!zix_btree_bulk_load(t, n_elems, values, 75U));
+  check_order_statistics(t, stride);
+
+  zix_btree_free(t, NULL, NULL);
+  free(values);
+}
+
+static void
+test_insert_hint(void)
+{
+  static const size_t n_elems = 1U << 16U;
+  static const size_t stride  = 4093U;
+
+  ZixBTree* const t = zix_btree_new(NULL, int_cmp, NULL);
+
+  // Append increasing values, which always go into the last leaf
+  for (uintptr_t r = 1U; r <= n_elems; ++r) {
+    assert(!zix_btree_insert(t, (void*)(r * 4U)));
+    assert(zix_btree_insert(t, (void*)(r * 4U)) == ZIX_STATUS_EXISTS);
+  }
+
+  check_order_statistics(t, stride);
+
+  // Insert nearly sorted values, which are usually in the same leaf
+  for (uintptr_t r = 0U; r < n_elems; ++r) {
+    assert(!zix_btree_insert(t, (void*)((((r ^ 1U) + 1U) * 4U) + 1U)));
+  }
+
+  check_order_statistics(t, stride);
+
+  // Insert values just before existing ones, with the iterator as a hint
+  for (uintptr_t r = n_elems; r > 0U; --r) {
+    ZixBTreeIter hint = zix_btree_end_iter;
+    assert(!zix_btree_find(t, (void*)(r * 4U), &hint));
+    assert(!zix_btree_insert_hint(t, hint, (void*)((r * 4U) - 1U)));
+    assert(zix_btree_insert_hint(t, hint, (void*)(r * 4U)) ==
+           ZIX_STATUS_EXISTS);
+  }
+
+  check_order_statistics(t, stride);
+
+  // Hints far from the inserted value still work
+  const ZixBTreeIter begin = zix_btree_begin(t);
+  assert(!zix_btree_insert_hint(t, begin, (void*)((n_elems * 4U) + 2U)));
+  assert(!zix_btree_insert_hint(t, zix_btree_end_iter, (void*)2U));
+  check_order_statistics(t, stride);
+
+  // Every value is in the tree
+  for (uintptr_t r = 1U; r <= n_elems; ++r) {
+    ZixBTreeIter ti = zix_btree_end_iter;
+    assert(!zix_btree_find(t, (void*)((r * 4U) - 1U), &ti));
+    assert(!zix_btree_find(t, (void*)(r * 4U), &ti));
+    assert(!zix_btree_find(t, (void*)((r * 4U) + 1U), &ti));
+  }
+
+  // Removing forgets the last leaf, so prepending after it still works
+  void*        removed = NULL;
+  ZixBTreeIter next    = zix_btree_end_iter;
+  assert(!zix_btree_remove(t, (void*)4U, &removed, &next));
+  assert(!zix_btree_insert(t, (void*)4U));
+  assert(!zix_btree_insert(t, (void*)1U));
+  check_order_statistics(t, stride);
+
+  zix_btree_free(t, NULL, NULL);
+}
+
+static void
+test_integer_keys(void)
+{
+  static const size_t    n_elems = 65536U;
+  static const uintptr_t step    = UINTPTR_MAX / 65536U;
+
+  ZixBTree* const t = zix_btree_new(NULL, NULL, NULL);
+
+  // Insert values spread over the whole range, including zero and the maximum
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const uintptr_t r = (i * 40503U) % n_elems; // Permutation of [0, n)
+
+    assert(!zix_btree_insert(t, (void*)(r * step)));
+    assert(zix_btree_insert(t, (void*)(r * step)) == ZIX_STATUS_EXISTS);
+  }
+
+  assert(!zix_btree_insert(t, (void*)UINTPTR_MAX));
+  assert(zix_btree_size(t) == n_elems + 1U);
+
+  // Values are in unsigned order, regardless of the high bit
+  uintptr_t    expected = 0U;
+  ZixBTreeIter i        = zix_btree_begin(t);
+  for (; expected < n_elems * step; expected += step) {
+    assert((uintptr_t)zix_btree_get(i) == expected);
+    zix_btree_iter_increment(&i);
+  }
+
+  assert((uintptr_t)zix_btree_get(i) == UINTPTR_MAX);
+  zix_btree_iter_increment(&i);
+  assert(zix_btree_iter_is_end(i));
+
+  // Every value is found, and the lower bound of a missing key is the next
+  for (uintptr_t v = 0U; v < n_elems * step; v += step) {
+    ZixBTreeIter found = zix_btree_end_iter;
+    ZixBTreeIter bound = zix_btree_end_iter;
+
+    assert(!zix_btree_find(t, (void*)v, &found));
+    assert((uintptr_t)zix_btree_get(found) == v);
+    assert(zix_btree_find(t, (void*)(v + 1U), &found));
+    assert(!zix_btree_lower_bound(t, NULL, NULL, (void*)(v + 1U), &bound));
+    assert((uintptr_t)zix_btree_get(bound) == v + step ||
+           (uintptr_t)zix_btree_get(bound) == UINTPTR_MAX);
+  }
+
+  zix_btree_free(t, NULL, NULL);
+}
+
+static int
+str_cmp(const void* a, const void* b, const void* ZIX_UNUSED(user_data))
+{
+  return strcmp((const char*)a, (const char*)b);
+}
+
+ZIX_PURE_FUNC static uint64_t
+str_prefix(const void* const value)
+{
+  const char* const str    = (const char*)value;
+  uint64_t          prefix = 0U;
+  unsigned          i      = 0U;
+
+  // Load up to the first 8 characters as a big-endian integer
+  for (; i < 8U && str[i]; ++i) {
+    prefix = (prefix << 8U) | (uint8_t)str[i];
+  }
+
+  return i ? (prefix << (8U * (8U - i))) : 0U;
+}
+
+/// Compare a key with a null pattern that matches every URI
+static int
+uri_pattern_cmp(const void* a, const void* b, const void* ZIX_UNUSED(user_data))
+{
+  assert(!b);
+  return strncmp((const char*)a, "http://", 7U) ? -1 : 0;
+}
+
+static void
+check_prefixed_keys(const ZixBTree* const t,
+                    const char (*const keys)[32],
+                    const size_t n_keys,
+                    const size_t n_removed)
+{
+  assert(zix_btree_size(t) == n_keys - n_removed);
+
+  // Values are in string order
+  const char* prev = NULL;
+  for (ZixBTreeIter i = zix_btree_begin(t); !zix_btree_iter_is_end(i);
+       zix_btree_iter_increment(&i)) {
+    const char* const key = (const char*)zix_btree_get(i);
+    assert(!prev || strcmp(prev, key) < 0);
+    prev = key;
+  }
+
+  // Every remaining key is found, even when searching with a copy
+  for (size_t i = n_removed; i < n_keys; ++i) {
+    char copy[32] = {0};
+    memcpy(copy, keys[i], sizeof(copy));
+
+    ZixBTreeIter found = zix_btree_end_iter;
+    ZixBTreeIter bound = zix_btree_end_iter;
+    assert(!zix_btree_find(t, copy, &found));
+    assert(zix_btree_get(found) == keys[i]);
+    assert(!zix_btree_lower_bound(t, NULL, NULL, copy, &bound));
+    assert(zix_btree_get(bound) == keys[i]);
+
+    // A longer key isn't found, and its lower bound is greater
+    copy[strlen(copy)] = '!';
+    assert(zix_btree_find(t, copy, &found) == ZIX_STATUS_NOT_FOUND);
+    assert(!zix_btree_lower_bound(t, NULL, NULL, copy, &bound));
+    assert(zix_btree_iter_is_end(bound) ||
+           strcmp((const char*)zix_btree_get(bound), copy) > 0);
+  }
+}
+
+static void
+test_prefixed_keys(void)
+{
+  static const size_t n_keys = 8192U;
+
+  char (*const keys)[32] = (char (*)[32])calloc(n_keys, sizeof(*keys));
+  void** const sorted    = (void**)calloc(n_keys, sizeof(void*));
+  assert(keys);
+  assert(sorted);
+
+  // Half of the keys have distinct prefixes, and half have the same prefix
+  for (size_t i = 0U; i < n_keys; ++i) {
+    const unsigned r = (unsigned)((i * 40503U) % n_keys);
+    if (r & 1U) {
+      snprintf(keys[i], sizeof(keys[i]), "%05u", r);
+    } else {
+      snprintf(keys[i], sizeof(keys[i]), "http://example.org/%05u", r);
+    }
+  }
+
+  ZixBTree* const t = zix_btree_new_prefixed(NULL, str_cmp, NULL, str_prefix);
+  for (size_t i = 0U; i < n_keys; ++i) {
+    assert(!zix_btree_insert(t, keys[i]));
+    assert(zix_btree_insert(t, keys[i]) == ZIX_STATUS_EXISTS);
+  }
+
+  check_prefixed_keys(t, (const char (*)[32])keys, n_keys, 0U);
+
+  // Searching with a custom comparator doesn't get the prefix of the pattern
+  ZixBTreeIter uri = zix_btree_end_iter;
+  assert(!zix_btree_lower_bound(t, uri_pattern_cmp, NULL, NULL, &uri));
+  assert(!strcmp((const char*)zix_btree_get(uri), "http://example.org/00000"));
+
+  // Bulk load the same keys in order into another tree
+  size_t n_sorted = 0U;
+  for (ZixBTreeIter i = zix_btree_begin(t); !zix_btree_iter_is_end(i);
+       zix_btree_iter_increment(&i)) {
+    sorted[n_sorted++] = zix_btree_get(i);
+  }
+
+  ZixBTree* const u = zix_btree_new_prefixed(NULL, str_cmp, NULL, str_prefix);
+  assert(!zix_btree_bulk_load(u, n_sorted, sorted, 75U));
+  check_prefixed_keys(u, (const char (*)[32])keys, n_keys, 0U);
+  zix_btree_free(u, NULL, NULL);
+
+  // Remove every key, checking the tree along the way
+  for (size_t i = 0U; i < n_keys; ++i) {
+    void*        out  = NULL;
+    ZixBTreeIter next = zix_btree_end_iter;
+    assert(!zix_btree_remove(t, keys[i], &out, &next));
+    assert(out == keys[i]);
+
+    if (i % 2048U == 0U) {
+      check_prefixed_keys(t, (const char (*)[32])keys, n_keys, i + 1U);
+    }
+  }
+
+  assert(!zix_btree_size(t));
+  zix_btree_free(t, NULL, NULL);
+  free(sorted);
+  free(keys);
+}
+
+typedef struct {
+  char*  strings;   ///< Storage for interned strings, 32 bytes each
+  size_t n_strings; ///< Number of strings created so far
+  bool   fail;      ///< Fail instead of creating a string
+} Interner;
+
+static ZixStatus
+intern_string(void* const data, const void* const key, void** const element)
+{
+  Interner* const interner = (Interner*)data;
+  if (interner->fail) {
+    return ZIX_STATUS_BAD_ARG;
+  }
+
+  char* const string = interner->strings + (32U * interner->n_strings++);
+  memcpy(string, key, strlen((const char*)key) + 1U);
+  *element = string;
+  return ZIX_STATUS_SUCCESS;
+}
+
+static void
+test_find_or_insert(void)
+{
+  static const size_t n_keys    = 4096U;
+  static const size_t n_lookups = 4U * n_keys;
+
+  Interner interner = {(char*)calloc(n_keys, 32U), 0U, false};
+  assert(interner.strings);
+
+  ZixBTree* const t = zix_btree_new_prefixed(NULL, str_cmp, NULL, str_prefix);
+
+  // Intern keys in pseudo-random order, so each is seen several times
+  for (size_t i = 0U; i < n_lookups; ++i) {
+    char key[32] = {0};
+    snprintf(key, sizeof(key), "key%05u", (unsigned)((i * 40503U) % n_keys));
+
+    const size_t    n_before = interner.n_strings;
+    ZixBTreeIter    ti       = zix_btree_end_iter;
+    const ZixStatus st =
+      zix_btree_find_or_insert(t, key, intern_string, &interner, &ti);
+
+    const char* const interned = (const char*)zix_btree_get(ti);
+    assert(interned != key);
+    assert(!strcmp(interned, key));
+    if (i < n_keys) {
+      assert(!st);
+      assert(interned == interner.strings + (32U * n_before));
+      assert(interner.n_strings == n_before + 1U);
+    } else {
+      assert(st == ZIX_STATUS_EXISTS);
+      assert(interner.n_strings == n_before);
+    }
+  }
+
+  // Every key is in the tree once, in order
+  const char* prev = NULL;
+  for (ZixBTreeIter i = zix_btree_begin(t); !zix_btree_iter_is_end(i);
+       zix_btree_iter_increment(&i)) {
+    const char* const key = (const char*)zix_btree_get(i);
+    assert(!prev || strcmp(prev, key) < 0);
+    prev = key;
+  }
+
+  assert(zix_btree_size(t) == n_keys);
+
+  // Errors from creating an element are returned and nothing is inserted
+  ZixBTreeIter ti = zix_btree_begin(t);
+  interner.fail   = true;
+  assert(zix_btree_find_or_insert(t, "new", intern_string, &interner, &ti) ==
+         ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_iter_is_end(ti));
+  assert(zix_btree_size(t) == n_keys);
+
+  // Existing keys are still found without creating anything
+  assert(zix_btree_find_or_insert(t, "key00000", intern_string, &interner,
+                                  &ti) == ZIX_STATUS_EXISTS);
+  assert(zix_btree_get(ti) == zix_btree_get(zix_btree_begin(t)));
+
+  zix_btree_free(t, NULL, NULL);
+  free(interner.strings);
+}
+
+/// Check that `t` contains exactly the values `1 + 2i` where `present[i]`
+static void
+check_present(const ZixBTree* const t,
+              const bool* const     present,
+              const size_t          n_elems)
+{
+  ZixBTreeIter iter   = zix_btree_begin(t);
+  size_t       n_seen = 0U;
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const uintptr_t value = 1U + (2U * i);
+    ZixBTreeIter    found = zix_btree_end_iter;
+
+    if (present[i]) {
+      assert(!zix_btree_iter_is_end(iter));
+      assert((uintptr_t)zix_btree_get(iter) == value);
+      assert(!zix_btree_find(t, (void*)value, &found));
+      assert(zix_btree_iter_equals(found, iter));
+      zix_btree_iter_increment(&iter);
+      ++n_seen;
+    } else if (i % 61U == 0U) {
+      assert(zix_btree_find(t, (void*)value, &found) == ZIX_STATUS_NOT_FOUND);
+    }
+  }
+
+  assert(zix_btree_iter_is_end(iter));
+  assert(zix_btree_size(t) == n_seen);
+  check_order_statistics(t, 997U);
+}
+
+static void
+destroy_erased(void* const ptr, const void* const user_data)
+{
+  (void)user_data;
+  assert(ptr);
+  ++n_destroy_calls;
+}
+
+static void
+test_erase_range(void)
+{
+  static const size_t    n_elems    = 1U << 16U;
+  static const uintptr_t ranges[][2] = {
+    {200U, 100U},      // Empty (reversed)
+    {2U, 3U},          // Empty (between values)
+    {101U, 121U},      // Within a leaf
+    {1U, 9U},          // Start
+    {1001U, 40001U},   // Across many nodes
+    {40001U, 40003U},  // Single value next to a previous range
+    {99999U, 131073U}, // End
+    {1U, UINTPTR_MAX}, // Everything remaining
+  };
+
+  void** const values  = (void**)calloc(n_elems, sizeof(void*));
+  bool* const  present = (bool*)calloc(n_elems, sizeof(bool));
+  assert(values);
+  assert(present);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    values[i]  = (void*)(1U + (2U * i));
+    present[i] = true;
+  }
+
+  ZixBTree* const t = zix_btree_new(NULL, int_cmp, NULL);
+  assert(!zix_btree_erase_range(t, (void*)1U, (void*)9U, NULL, NULL));
+  assert(!zix_btree_bulk_load(t, n_elems, values, 100U));
+
+  for (size_t r = 0U; r < sizeof(ranges) / sizeof(ranges[0]); ++r) {
+    const uintptr_t lo         = ranges[r][0];
+    const uintptr_t hi         = ranges[r][1];
+    size_t          n_expected = 0U;
+    for (size_t i = 0U; i < n_elems; ++i) {
+      const uintptr_t value = 1U + (2U * i);
+      if (present[i] && value >= lo && value < hi) {
+        present[i] = false;
+        ++n_expected;
+      }
+    }
+
+    // Exactly the values in the range are destroyed and removed
+    n_destroy_calls = 0U;
+    assert(
+      !zix_btree_erase_range(t, (void*)lo, (void*)hi, destroy_erased, NULL));
+    assert(n_destroy_calls == n_expected);
+    check_present(t, present, n_elems);
+  }
+
+  // The tree is still usable after erasing everything
+  assert(!zix_btree_size(t));
+  for (size_t i = 0U; i < 4096U; ++i) {
+    assert(!zix_btree_insert(t, values[i]));
+    present[i] = true;
+  }
+
+  check_present(t, present, n_elems);
+  zix_btree_free(t, NULL, NULL);
+  free(present);
+  free(values);
+}
+
+static void
+test_split_join(void)
+{
+  static const size_t    n_elems = 1U << 16U;
+  static const uintptr_t keys[]  = {1U,      2U,      9U,      777U,
+                                    778U,    65537U,  131053U, 131071U,
+                                    131072U, UINTPTR_MAX};
+
+  void** const values  = (void**)calloc(n_elems, sizeof(void*));
+  bool* const  present = (bool*)calloc(n_elems, sizeof(bool));
+  bool* const  left    = (bool*)calloc(n_elems, sizeof(bool));
+  bool* const  right   = (bool*)calloc(n_elems, sizeof(bool));
+  assert(values);
+  assert(present);
+  assert(left);
+  assert(right);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    values[i]  = (void*)(1U + (2U * i));
+    present[i] = true;
+  }
+
+  ZixBTree* const t   = zix_btree_new(NULL, int_cmp, NULL);
+  ZixBTree* const rhs = zix_btree_new(NULL, int_cmp, NULL);
+  assert(!zix_btree_bulk_load(t, n_elems, values, 75U));
+
+  for (size_t k = 0U; k < sizeof(keys) / sizeof(keys[0]); ++k) {
+    const uintptr_t key = keys[k];
+    for (size_t i = 0U; i < n_elems; ++i) {
+      left[i]  = 1U + (2U * i) < key;
+      right[i] = !left[i];
+    }
+
+    // Splitting moves every value not less than the key into the RHS
+    assert(!zix_btree_split(t, (void*)key, rhs));
+    check_present(t, left, n_elems);
+    check_present(rhs, right, n_elems);
+
+    // Joining them back together restores the original tree
+    assert(!zix_btree_join(t, rhs));
+    assert(!zix_btree_size(rhs));
+    assert(zix_btree_iter_is_end(zix_btree_begin(rhs)));
+    check_present(t, present, n_elems);
+  }
+
+  // Join trees of very different heights in both directions
+  assert(!zix_btree_split(t, (void*)10U, rhs));
+  assert(!zix_btree_erase_range(t, (void*)3U, (void*)9U, NULL, NULL));
+  assert(!zix_btree_join(t, rhs));
+  present[1U] = present[2U] = present[3U] = false;
+  check_present(t, present, n_elems);
+
+  assert(!zix_btree_split(t, (void*)131060U, rhs));
+  assert(
+    !zix_btree_erase_range(rhs, (void*)131061U, (void*)131071U, NULL, NULL));
+  assert(!zix_btree_join(t, rhs));
+  for (size_t i = 65530U; i < n_elems - 1U; ++i) {
+    present[i] = false;
+  }
+
+  check_present(t, present, n_elems);
+
+  // Splitting into a non-empty tree or itself fails
+  assert(!zix_btree_insert(rhs, (void*)UINTPTR_MAX));
+  assert(zix_btree_split(t, (void*)100U, rhs) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_split(t, (void*)100U, t) == ZIX_STATUS_BAD_ARG);
+  check_present(t, present, n_elems);
+
+  // Joining overlapping trees fails and leaves both unchanged
+  assert(!zix_btree_insert(rhs, (void*)1000U));
+  assert(zix_btree_join(t, rhs) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_join(rhs, t) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_join(t, t) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_size(rhs) == 2U);
+  check_present(t, present, n_elems);
+  zix_btree_clear(rhs, NULL, NULL);
+
+  // Joining trees with different orderings fails
+  ZixBTree* const other = zix_btree_new(NULL, int_cmp, &n_destroy_calls);
+  assert(zix_btree_split(t, (void*)100U, other) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_join(t, other) == ZIX_STATUS_BAD_ARG);
+  zix_btree_free(other, NULL, NULL);
+
+  zix_btree_free(rhs, NULL, NULL);
+  zix_btree_free(t, NULL, NULL);
+  free(right);
+  free(left);
+  free(present);
+  free(values);
+}
+
+static void
+test_set_operations(void)
+{
+  static const size_t n_elems = 1U << 16U;
+
+  void** const values   = (void**)calloc(n_elems, sizeof(void*));
+  bool* const  expected = (bool*)calloc(n_elems, sizeof(bool));
+  assert(values);
+  assert(expected);
+
+  // Load multiples of 2 into A and multiples of 3 into B (by index)
+  ZixBTree* const a = zix_btree_new(NULL, int_cmp, NULL);
+  ZixBTree* const b = zix_btree_new(NULL, int_cmp, NULL);
+  ZixBTree* const t = zix_btree_new(NULL, int_cmp, NULL);
+  size_t          n = 0U;
+  for (size_t i = 0U; i < n_elems; i += 2U) {
+    values[n++] = (void*)(1U + (2U * i));
+  }
+
+  assert(!zix_btree_bulk_load(a, n, values, 75U));
+  n = 0U;
+  for (size_t i = 0U; i < n_elems; i += 3U) {
+    values[n++] = (void*)(1U + (2U * i));
+  }
+
+  assert(!zix_btree_bulk_load(b, n, values, 75U));
+
+  // Every operation loads exactly the expected values in order
+  for (size_t i = 0U; i < n_elems; ++i) {
+    expected[i] = i % 2U == 0U || i % 3U == 0U;
+  }
+
+  assert(!zix_btree_union(t, a, b, 100U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+  assert(!zix_btree_union(t, b, a, 100U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+
+  for (size_t i = 0U; i < n_elems; ++i) {
+    expected[i] = i % 6U == 0U;
+  }
+
+  assert(!zix_btree_intersection(t, a, b, 100U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+  assert(!zix_btree_intersection(t, b, a, 50U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+
+  for (size_t i = 0U; i < n_elems; ++i) {
+    expected[i] = i % 2U == 0U && i % 3U != 0U;
+  }
+
+  assert(!zix_btree_difference(t, a, b, 100U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+
+  for (size_t i = 0U; i < n_elems; ++i) {
+    expected[i] = i % 3U == 0U && i % 2U != 0U;
+  }
+
+  assert(!zix_btree_difference(t, b, a, 100U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+
+  // Operations with an empty tree copy one tree or produce nothing
+  ZixBTree* const empty = zix_btree_new(NULL, int_cmp, NULL);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    expected[i] = i % 2U == 0U;
+  }
+
+  assert(!zix_btree_union(t, empty, a, 100U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+  assert(!zix_btree_difference(t, a, empty, 100U));
+  check_present(t, expected, n_elems);
+  zix_btree_clear(t, NULL, NULL);
+  assert(!zix_btree_intersection(t, a, empty, 100U));
+  assert(!zix_btree_size(t));
+  assert(!zix_btree_difference(t, empty, a, 100U));
+  assert(!zix_btree_size(t));
+  assert(!zix_btree_difference(t, a, a, 100U));
+  assert(!zix_btree_size(t));
+
+  // Loading into a non-empty tree, an input, or a different order fails
+  assert(!zix_btree_insert(t, (void*)2U));
+  assert(zix_btree_union(t, a, b, 100U) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_size(t) == 1U);
+  assert(zix_btree_union(empty, empty, a, 100U) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_intersection(empty, a, empty, 100U) == ZIX_STATUS_BAD_ARG);
+
+  ZixBTree* const other = zix_btree_new(NULL, int_cmp, &n_destroy_calls);
+  assert(zix_btree_difference(other, a, b, 100U) == ZIX_STATUS_BAD_ARG);
+  assert(zix_btree_difference(empty, a, other, 100U) == ZIX_STATUS_BAD_ARG);
+  assert(!zix_btree_size(other));
+  assert(!zix_btree_size(empty));
+
+  zix_btree_free(other, NULL, NULL);
+  zix_btree_free(empty, NULL, NULL);
+  zix_btree_free(t, NULL, NULL);
+  zix_btree_free(b, NULL, NULL);
+  zix_btree_free(a, NULL, NULL);
+  free(expected);
+  free(values);
+}
+
 static int
 stress(ZixAllocator* const allocator,
        const unsigned      test_num,
@@ -243,8 +1135,11 @@ stress(ZixAllocator* const allocator,
 {
   assert(n_elems > 0U);
 
+  // Use a comparator for the first few tests, and integer keys for the rest
+  const ZixBTreeCompareFunc cmp = (test_num < 3U) ? int_cmp : NULL;
+
   uintptr_t r  = 0;
-  ZixBTree* t  = zix_btree_new(allocator, int_cmp, NULL);
+  ZixBTree* t  = zix_btree_new(allocator, cmp, NULL);
   ZixStatus st = ZIX_STATUS_SUCCESS;
 
   ENSURE(t, t, "Failed to allocate tree\n");
@@ -301,7 +1196,7 @@ stress(ZixAllocator* const allocator,
   for (size_t i = 0; i < n_elems; ++i) {
     r = ith_elem(test_num, n_elems, i);
     ENSUREV(t,
-            !zix_btree_lower_bound(t, int_cmp, NULL, (void*)r, &ti),
+            !zix_btree_lower_bound(t, cmp, NULL, (void*)r, &ti),
             "Lower bound %" PRIuPTR " @ %" PRIuPTR " failed\n",
             r,
             i);
@@ -350,6 +1245,27 @@ stress(ZixAllocator* const allocator,
           i,
           n_elems);
 
+  // Iterate over all elements in reverse
+  i    = 0;
+  last = UINTPTR_MAX;
+  for (ti = zix_btree_rbegin(t); !zix_btree_iter_is_end(ti);
+       zix_btree_iter_decrement(&ti), ++i) {
+    const uintptr_t iter_data = (uintptr_t)zix_btree_get(ti);
+    ENSUREV(t,
+            iter_data <= last,
+            "Reverse iter @ %" PRIuPTR " corrupt (%" PRIuPTR ")\n",
+            i,
+            iter_data);
+
+    last = iter_data;
+  }
+
+  ENSUREV(t,
+          i == n_elems,
+          "Reverse iteration stopped at %" PRIuPTR "/%" PRIuPTR "\n",
+          i,
+          n_elems);
+
   // Insert n_elems elements again, ensuring duplicates fail
   for (i = 0; i < n_elems; ++i) {
     r = ith_elem(test_num, n_elems, i);
@@ -566,6 +1482,106 @@ test_failed_alloc(void)
     zix_failing_allocator_reset(&allocator, i);
     assert(stress(&allocator.base, 0, 4096));
   }
+
+  // Successfully bulk load a tree to count the number of allocations
+  static const size_t n_values = 65536U;
+
+  void** const values = (void**)calloc(n_values, sizeof(void*));
+  assert(values);
+  for (size_t i = 0U; i < n_values; ++i) {
+    values[i] = (void*)(1U + (2U * i));
+  }
+
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  ZixBTree* const t = zix_btree_new(&allocator.base, int_cmp, NULL);
+  assert(t);
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  assert(!zix_btree_bulk_load(t, n_values, values, 100U));
+  zix_btree_clear(t, NULL, NULL);
+
+  // Test that each allocation failing leaves the tree empty
+  const size_t n_load_allocs = zix_failing_allocator_reset(&allocator, 0);
+  for (size_t i = 0U; i < n_load_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    assert(zix_btree_bulk_load(t, n_values, values, 100U) ==
+           ZIX_STATUS_NO_MEM);
+    assert(!zix_btree_size(t));
+    assert(zix_btree_iter_is_end(zix_btree_begin(t)));
+  }
+
+  // Test that each allocation failing leaves split trees unchanged
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  ZixBTree* const rhs = zix_btree_new(&allocator.base, int_cmp, NULL);
+  assert(rhs);
+  assert(!zix_btree_bulk_load(t, n_values, values, 100U));
+  for (size_t i = 0U;; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    const ZixStatus st = zix_btree_split(t, (void*)1001U, rhs);
+    if (st != ZIX_STATUS_NO_MEM) {
+      assert(!st);
+      break;
+    }
+
+    assert(zix_btree_size(t) == n_values);
+    assert(!zix_btree_size(rhs));
+  }
+
+  assert(zix_btree_size(t) == 500U);
+
+  // Test that each allocation failing leaves joined trees unchanged
+  for (size_t i = 0U;; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    const ZixStatus st = zix_btree_join(t, rhs);
+    if (st != ZIX_STATUS_NO_MEM) {
+      assert(!st);
+      break;
+    }
+
+    assert(zix_btree_size(t) == 500U);
+    assert(zix_btree_size(rhs) == n_values - 500U);
+  }
+
+  assert(zix_btree_size(t) == n_values);
+
+  // Test that each allocation failing leaves the tree unchanged when erasing
+  for (size_t i = 0U;; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    const ZixStatus st =
+      zix_btree_erase_range(t, (void*)1001U, (void*)9001U, NULL, NULL);
+    if (st != ZIX_STATUS_NO_MEM) {
+      assert(!st);
+      break;
+    }
+
+    assert(zix_btree_size(t) == n_values);
+  }
+
+  assert(zix_btree_size(t) == n_values - 4000U);
+
+  // Test that each allocation failing leaves the result of a union empty
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  assert(!zix_btree_split(t, (void*)(2U * n_values / 3U), rhs));
+  ZixBTree* const merged = zix_btree_new(&allocator.base, int_cmp, NULL);
+  assert(merged);
+  for (size_t i = 0U;; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    const ZixStatus st = zix_btree_union(merged, rhs, t, 100U);
+    if (st != ZIX_STATUS_NO_MEM) {
+      assert(!st);
+      break;
+    }
+
+    assert(!zix_btree_size(merged));
+    assert(zix_btree_iter_is_end(zix_btree_begin(merged)));
+  }
+
+  assert(zix_btree_size(merged) == n_values - 4000U);
+
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  zix_btree_free(merged, NULL, NULL);
+  zix_btree_free(rhs, NULL, NULL);
+  zix_btree_free(t, NULL, NULL);
+  free(values);
 }
 
 int
@@ -581,9 +1597,19 @@ main(int argc, char** argv)
   test_iter_comparison();
   test_insert_split_value();
   test_remove_cases();
+  test_bulk_load();
+  test_remove_from_full();
+  test_order_statistics();
+  test_insert_hint();
+  test_integer_keys();
+  test_prefixed_keys();
+  test_find_or_insert();
+  test_erase_range();
+  test_split_join();
+  test_set_operations();
   test_failed_alloc();
 
-  const unsigned n_tests  = 3U;
+  const unsigned n_tests  = 6U;
   const char*    size_arg = (argc > 1) ? argv[1] : "65536";
   const size_t   n_elems  = zix_test_size_arg(size_arg, 4U, 1U << 20U);
 
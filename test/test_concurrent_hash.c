@@ -0,0 +1,267 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#define ZIX_HASH_KEY_TYPE size_t
+#define ZIX_HASH_RECORD_TYPE size_t
+
+#include "failing_allocator.h"
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/concurrent_hash.h>
+#include <zix/digest.h>
+#include <zix/status.h>
+#include <zix/thread.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define N_READERS 4U
+
+static const size_t n_stable = 256U;  // Keys that are always present
+static const size_t n_churn  = 2048U; // Keys that the writer adds and removes
+static const size_t n_rounds = 16U;   // Rounds of churn done by the writer
+static const size_t n_reads  = 256U;  // Read sections entered by each reader
+
+typedef struct {
+  ZixConcurrentHash* hash;
+  bool               failed;
+} ReaderState;
+
+ZIX_CONST_FUNC static const size_t*
+identity(const size_t* const record)
+{
+  return record;
+}
+
+ZIX_PURE_FUNC static size_t
+decent_hash(const size_t* const key)
+{
+  return zix_digest(0U, key, sizeof(size_t));
+}
+
+/// Terrible hash function that collides for many keys, including zero
+ZIX_PURE_FUNC static size_t
+terrible_hash(const size_t* const key)
+{
+  return *key / 8U;
+}
+
+ZIX_PURE_FUNC static bool
+size_equal(const size_t* const a, const size_t* const b)
+{
+  return *a == *b;
+}
+
+static ZixStatus
+stress(ZixAllocator* const allocator, const ZixHashFunc hash_func)
+{
+  static const size_t n_elems = 1024U;
+
+  ZixConcurrentHash* const hash =
+    zix_concurrent_hash_new(allocator, identity, hash_func, size_equal);
+  if (!hash) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  size_t* const records = (size_t*)calloc(n_elems, sizeof(size_t));
+  assert(records);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    records[i] = i;
+  }
+
+  // Insert every record
+  ZixStatus st = ZIX_STATUS_SUCCESS;
+  for (size_t i = 0U; !st && i < n_elems; ++i) {
+    st = zix_concurrent_hash_insert(hash, &records[i]);
+    if (!st) {
+      assert(zix_concurrent_hash_size(hash) == i + 1U);
+    }
+  }
+
+  if (st) {
+    assert(st == ZIX_STATUS_NO_MEM);
+    zix_concurrent_hash_free(hash);
+    free(records);
+    return st;
+  }
+
+  // Check that every record can be found within a read section
+  const unsigned token = zix_concurrent_hash_begin_read(hash);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const size_t key = i;
+    assert(zix_concurrent_hash_find(hash, &key) == &records[i]);
+  }
+
+  const size_t missing = n_elems;
+  assert(!zix_concurrent_hash_find(hash, &missing));
+  zix_concurrent_hash_end_read(hash, token);
+
+  // Check that no record can be inserted again
+  for (size_t i = 0U; i < n_elems; ++i) {
+    assert(zix_concurrent_hash_insert(hash, &records[i]) == ZIX_STATUS_EXISTS);
+  }
+
+  // Remove every other record and check that only the others remain
+  for (size_t i = 0U; i < n_elems; i += 2U) {
+    size_t* removed = NULL;
+    assert(!zix_concurrent_hash_remove(hash, &records[i], &removed));
+    assert(removed == &records[i]);
+    assert(zix_concurrent_hash_remove(hash, &records[i], &removed) ==
+           ZIX_STATUS_NOT_FOUND);
+    assert(!removed);
+  }
+
+  assert(zix_concurrent_hash_size(hash) == n_elems / 2U);
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const size_t* const match = zix_concurrent_hash_find(hash, &records[i]);
+    assert(match == ((i % 2U) ? &records[i] : NULL));
+  }
+
+  // Reinsert the removed records (into tombstones, or after a rehash)
+  for (size_t i = 0U; !st && i < n_elems; i += 2U) {
+    st = zix_concurrent_hash_insert(hash, &records[i]);
+  }
+
+  if (!st) {
+    assert(zix_concurrent_hash_size(hash) == n_elems);
+
+    // Remove everything, which shrinks the table
+    for (size_t i = 0U; i < n_elems; ++i) {
+      size_t* removed = NULL;
+      assert(!zix_concurrent_hash_remove(hash, &records[i], &removed));
+      assert(removed == &records[i]);
+      assert(!zix_concurrent_hash_find(hash, &records[i]));
+    }
+
+    assert(!zix_concurrent_hash_size(hash));
+  }
+
+  zix_concurrent_hash_synchronize(hash);
+  zix_concurrent_hash_free(hash);
+  free(records);
+  return st;
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+reader(void* const arg)
+{
+  ReaderState* const state = (ReaderState*)arg;
+
+  for (size_t r = 0U; r < n_reads; ++r) {
+    const unsigned token = zix_concurrent_hash_begin_read(state->hash);
+
+    // Stable keys must always be found
+    for (size_t i = 0U; i < n_stable; ++i) {
+      const size_t* const match = zix_concurrent_hash_find(state->hash, &i);
+      state->failed = state->failed || !match || *match != i;
+    }
+
+    // Churned keys may or may not be found, but must match if they are
+    for (size_t i = n_stable; i < n_stable + n_churn; i += 7U) {
+      const size_t* const match = zix_concurrent_hash_find(state->hash, &i);
+      state->failed = state->failed || (match && *match != i);
+    }
+
+    zix_concurrent_hash_end_read(state->hash, token);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static void
+test_concurrent(void)
+{
+  ZixConcurrentHash* const hash =
+    zix_concurrent_hash_new(NULL, identity, decent_hash, size_equal);
+  assert(hash);
+
+  size_t* const stable = (size_t*)calloc(n_stable, sizeof(size_t));
+  assert(stable);
+  for (size_t i = 0U; i < n_stable; ++i) {
+    stable[i] = i;
+    assert(!zix_concurrent_hash_insert(hash, &stable[i]));
+  }
+
+  ReaderState states[N_READERS];
+  ZixThread   threads[N_READERS];
+  for (unsigned t = 0U; t < N_READERS; ++t) {
+    states[t].hash   = hash;
+    states[t].failed = false;
+    assert(!zix_thread_create(&threads[t], 1U << 16U, reader, &states[t]));
+  }
+
+  /* Repeatedly grow and shrink the table with dynamically allocated records,
+     which are only freed after synchronizing, so any reader still accessing
+     one will be caught by tools like valgrind or the address sanitizer. */
+  for (size_t r = 0U; r < n_rounds; ++r) {
+    for (size_t i = n_stable; i < n_stable + n_churn; ++i) {
+      size_t* const record = (size_t*)malloc(sizeof(size_t));
+      assert(record);
+      *record = i;
+      assert(!zix_concurrent_hash_insert(hash, record));
+    }
+
+    assert(zix_concurrent_hash_size(hash) == n_stable + n_churn);
+
+    size_t** const removed = (size_t**)calloc(n_churn, sizeof(size_t*));
+    assert(removed);
+    for (size_t i = 0U; i < n_churn; ++i) {
+      const size_t key = n_stable + i;
+      assert(!zix_concurrent_hash_remove(hash, &key, &removed[i]));
+      assert(removed[i] && *removed[i] == key);
+    }
+
+    zix_concurrent_hash_synchronize(hash);
+    for (size_t i = 0U; i < n_churn; ++i) {
+      free(removed[i]);
+    }
+
+    free(removed);
+    assert(zix_concurrent_hash_size(hash) == n_stable);
+  }
+
+  for (unsigned t = 0U; t < N_READERS; ++t) {
+    assert(!zix_thread_join(threads[t]));
+    assert(!states[t].failed);
+  }
+
+  zix_concurrent_hash_free(hash);
+  free(stable);
+}
+
+static void
+test_failed_alloc(void)
+{
+  ZixFailingAllocator allocator = zix_failing_allocator();
+
+  // Successfully stress test the table to count the number of allocations
+  assert(!stress(&allocator.base, decent_hash));
+
+  // Test that each allocation failing is handled gracefully
+  const size_t n_new_allocs = zix_failing_allocator_reset(&allocator, 0);
+  for (size_t i = 0U; i < n_new_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+
+    // Failing to shrink isn't an error, so only some of these fail
+    const ZixStatus st = stress(&allocator.base, decent_hash);
+    assert(!st || st == ZIX_STATUS_NO_MEM);
+  }
+}
+
+int
+main(void)
+{
+  zix_concurrent_hash_free(NULL);
+
+  assert(!stress(NULL, decent_hash));
+  assert(!stress(NULL, terrible_hash));
+  test_failed_alloc();
+  test_concurrent();
+
+  return 0;
+}
@@ -1,4 +1,4 @@
-// Copyright 2020-2021 David Robillard <d@drobilla.net>
+// Copyright 2020-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #undef NDEBUG
@@ -116,6 +116,37 @@ test_digest_aligned(void)
   }
 }
 
+static void
+test_digest_keyed64(void)
+{
+  // Test vectors from the SipHash reference implementation
+  static const ZixDigestKey key = {0x0706050403020100ULL,
+                                   0x0F0E0D0C0B0A0908ULL};
+
+  uint8_t data[16] = {0};
+  for (uint8_t i = 0U; i < 16U; ++i) {
+    data[i] = i;
+  }
+
+  assert(zix_digest_keyed64(&key, data, 0U) == 0x726FDB47DD0E0E31ULL);
+  assert(zix_digest_keyed64(&key, data, 1U) == 0x74F839C593DC67FDULL);
+  assert(zix_digest_keyed64(&key, data, 15U) == 0xA129CA6149BE45E5ULL);
+
+  // Every length and alignment gives a different result
+  uint64_t last = 0U;
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t len = 0U; offset + len <= 16U; ++len) {
+      const uint64_t h = zix_digest_keyed64(&key, &data[offset], len);
+      assert(h != last);
+      last = h;
+    }
+  }
+
+  // A different key gives a different result
+  static const ZixDigestKey other_key = {0x0706050403020100ULL, 0U};
+  assert(zix_digest_keyed64(&other_key, data, 15U) != 0xA129CA6149BE45E5ULL);
+}
+
 ZIX_PURE_FUNC int
 main(void)
 {
@@ -127,5 +158,7 @@ main(void)
   test_digest64_aligned();
   test_digest_aligned();
 
+  test_digest_keyed64();
+
   return 0;
 }
@@ -0,0 +1,288 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "failing_allocator.h"
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/flat_hash.h>
+#include <zix/hash.h>
+#include <zix/status.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+  uint32_t key;
+  uint16_t value;
+} TestRecord;
+
+ZIX_CONST_FUNC static const void*
+test_key(const void* const record)
+{
+  return &((const TestRecord*)record)->key;
+}
+
+ZIX_PURE_FUNC static size_t
+decent_hash(const void* const key)
+{
+  return zix_digest(0U, key, sizeof(uint32_t));
+}
+
+ZIX_CONST_FUNC static size_t
+terrible_hash(const void* const key)
+{
+  (void)key;
+  return 42U;
+}
+
+ZIX_PURE_FUNC static bool
+key_equal(const void* const a, const void* const b)
+{
+  return *(const uint32_t*)a == *(const uint32_t*)b;
+}
+
+static TestRecord
+make_record(const size_t i)
+{
+  const TestRecord record = {(uint32_t)i, (uint16_t)(i * 3U)};
+  return record;
+}
+
+static ZixFlatHash*
+new_table(ZixAllocator* const allocator, const ZixHashFunc hash_func)
+{
+  return zix_flat_hash_new(allocator,
+                           sizeof(TestRecord),
+                           sizeof(uint32_t),
+                           test_key,
+                           hash_func,
+                           key_equal);
+}
+
+static void
+test_layout(void)
+{
+  // Zero size or alignment
+  assert(!zix_flat_hash_new(NULL, 0U, 1U, test_key, decent_hash, key_equal));
+  assert(!zix_flat_hash_new(NULL, 4U, 0U, test_key, decent_hash, key_equal));
+
+  // Alignment that isn't a power of 2
+  assert(!zix_flat_hash_new(NULL, 6U, 3U, test_key, decent_hash, key_equal));
+
+  // Alignment that is larger than any built-in type
+  assert(
+    !zix_flat_hash_new(NULL, 256U, 256U, test_key, decent_hash, key_equal));
+
+  // Records are copied and aligned, even with a size that isn't a multiple
+  ZixFlatHash* const hash = zix_flat_hash_new(NULL,
+                                              sizeof(uint32_t) + 1U,
+                                              sizeof(uint32_t),
+                                              test_key,
+                                              decent_hash,
+                                              key_equal);
+
+  assert(hash);
+  for (uint32_t i = 0U; i < 64U; ++i) {
+    unsigned char record[5] = {0U, 0U, 0U, 0U, (unsigned char)i};
+    memcpy(record, &i, sizeof(i));
+
+    ZixHashRecord* inserted = NULL;
+    assert(!zix_flat_hash_insert(hash, record, &inserted));
+    assert(inserted != (ZixHashRecord*)record);
+    assert(!((uintptr_t)inserted % sizeof(uint32_t)));
+    assert(!memcmp(inserted, record, sizeof(record)));
+  }
+
+  for (uint32_t i = 0U; i < 64U; ++i) {
+    const unsigned char* const found =
+      (const unsigned char*)zix_flat_hash_find_record(hash, &i);
+
+    assert(found);
+    assert(found[4] == i);
+  }
+
+  zix_flat_hash_free(hash);
+}
+
+static ZixStatus
+stress(ZixAllocator* const allocator,
+       const ZixHashFunc   hash_func,
+       const size_t        n_elems)
+{
+  ZixFlatHash* const hash = new_table(allocator, hash_func);
+  if (!hash) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  assert(zix_flat_hash_begin(hash) == zix_flat_hash_end(hash));
+
+  // Insert each record
+  for (size_t i = 0U; i < n_elems; ++i) {
+    const TestRecord record   = make_record(i);
+    ZixHashRecord*   inserted = NULL;
+    const ZixStatus  st       = zix_flat_hash_insert(hash, &record, &inserted);
+    if (st) {
+      assert(st == ZIX_STATUS_NO_MEM);
+      zix_flat_hash_free(hash);
+      return st;
+    }
+
+    assert(inserted);
+    assert(!memcmp(inserted, &record, sizeof(record)));
+  }
+
+  assert(zix_flat_hash_size(hash) == n_elems);
+
+  // Check that inserting a duplicate fails and returns the existing record
+  for (size_t i = 0U; i < n_elems; ++i) {
+    TestRecord record = make_record(i);
+    record.value      = 0U;
+
+    ZixHashRecord* inserted = NULL;
+    assert(zix_flat_hash_insert(hash, &record, &inserted) == ZIX_STATUS_EXISTS);
+    assert(((const TestRecord*)inserted)->value == (uint16_t)(i * 3U));
+    assert(zix_flat_hash_insert(hash, &record, NULL) == ZIX_STATUS_EXISTS);
+  }
+
+  // Search for each record
+  for (uint32_t i = 0U; i < n_elems; ++i) {
+    const TestRecord* const match =
+      (const TestRecord*)zix_flat_hash_find_record(hash, &i);
+
+    assert(match);
+    assert(match->key == i);
+    assert(match->value == (uint16_t)(i * 3U));
+  }
+
+  // Search for non-existent records
+  for (uint32_t i = (uint32_t)n_elems; i < 2U * n_elems; ++i) {
+    assert(!zix_flat_hash_find_record(hash, &i));
+    assert(zix_flat_hash_find(hash, &i) == zix_flat_hash_end(hash));
+  }
+
+  // Iterate over all records
+  size_t n_checked = 0U;
+  for (ZixFlatHashIter i = zix_flat_hash_begin(hash);
+       i != zix_flat_hash_end(hash);
+       i = zix_flat_hash_next(hash, i)) {
+    const TestRecord* const record =
+      (const TestRecord*)zix_flat_hash_get(hash, i);
+
+    assert(record);
+    assert(record->key < n_elems);
+    assert(record->value == (uint16_t)(record->key * 3U));
+    ++n_checked;
+  }
+  assert(n_checked == n_elems);
+
+  // Remove odd records by key, and check that they're gone
+  for (uint32_t i = 1U; i < n_elems; i += 2U) {
+    assert(!zix_flat_hash_remove(hash, &i));
+    assert(zix_flat_hash_remove(hash, &i) == ZIX_STATUS_NOT_FOUND);
+    assert(!zix_flat_hash_find_record(hash, &i));
+  }
+
+  // Check that even records are still found after removals
+  for (uint32_t i = 0U; i < n_elems; i += 2U) {
+    const ZixFlatHashIter found = zix_flat_hash_find(hash, &i);
+    assert(found != zix_flat_hash_end(hash));
+    assert(((const TestRecord*)zix_flat_hash_get(hash, found))->key == i);
+  }
+
+  // Reinsert odd records into a table with tombstones
+  for (size_t i = 1U; i < n_elems; i += 2U) {
+    const TestRecord record = make_record(i);
+    const ZixStatus  st     = zix_flat_hash_insert(hash, &record, NULL);
+    if (st) {
+      assert(st == ZIX_STATUS_NO_MEM);
+      zix_flat_hash_free(hash);
+      return st;
+    }
+  }
+
+  assert(zix_flat_hash_size(hash) == n_elems);
+
+  // Erase every record with an iterator
+  for (uint32_t i = 0U; i < n_elems; ++i) {
+    const ZixFlatHashIter found = zix_flat_hash_find(hash, &i);
+    assert(found != zix_flat_hash_end(hash));
+    assert(!zix_flat_hash_erase(hash, found));
+    assert(!zix_flat_hash_find_record(hash, &i));
+  }
+
+  assert(!zix_flat_hash_size(hash));
+  assert(zix_flat_hash_begin(hash) == zix_flat_hash_end(hash));
+  assert(zix_flat_hash_erase(hash, 0U) == ZIX_STATUS_BAD_ARG);
+  assert(zix_flat_hash_erase(hash, zix_flat_hash_end(hash)) ==
+         ZIX_STATUS_BAD_ARG);
+
+  zix_flat_hash_free(hash);
+  return ZIX_STATUS_SUCCESS;
+}
+
+static void
+test_churn(void)
+{
+  static const size_t n_live = 16U;
+
+  ZixFlatHash* const hash = new_table(NULL, decent_hash);
+  assert(hash);
+
+  // Insert and remove many keys with a fixed number live, leaving tombstones
+  for (size_t i = 0U; i < 4096U; ++i) {
+    const TestRecord record = make_record(i);
+    assert(!zix_flat_hash_insert(hash, &record, NULL));
+    if (i >= n_live) {
+      const uint32_t old = (uint32_t)(i - n_live);
+      assert(!zix_flat_hash_remove(hash, &old));
+    }
+
+    assert(zix_flat_hash_size(hash) == (i < n_live ? i + 1U : n_live));
+  }
+
+  // The table shouldn't have grown, since tombstones are cleared
+  assert(zix_flat_hash_end(hash) <= 4U * n_live);
+
+  zix_flat_hash_free(hash);
+}
+
+static void
+test_failed_alloc(void)
+{
+  ZixFailingAllocator allocator = zix_failing_allocator();
+
+  // Successfully stress test the table to count the number of allocations
+  assert(!stress(&allocator.base, decent_hash, 256U));
+
+  // Test that each allocation failing is handled gracefully (shrinking is
+  // optional, so a failure there doesn't make the stress test fail)
+  const size_t n_new_allocs = zix_failing_allocator_reset(&allocator, 0);
+  for (size_t i = 0U; i < n_new_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+
+    const ZixStatus st = stress(&allocator.base, decent_hash, 256U);
+    assert(!st || st == ZIX_STATUS_NO_MEM);
+  }
+}
+
+int
+main(void)
+{
+  zix_flat_hash_free(NULL);
+
+  test_layout();
+  test_churn();
+  test_failed_alloc();
+
+  assert(!stress(NULL, decent_hash, 4096U));
+  assert(!stress(NULL, terrible_hash, 256U));
+
+  return 0;
+}
@@ -1,4 +1,4 @@
-// Copyright 2011-2023 David Robillard <d@drobilla.net>
+// Copyright 2011-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #undef NDEBUG
@@ -74,6 +74,13 @@ terrible_string_hash(const char* str)
   return hash;
 }
 
+/// Hash function that puts every string at the end of a 4096-entry block
+ZIX_PURE_FUNC static size_t
+clustered_string_hash(const char* const str)
+{
+  return decent_string_hash(str) | 0xFFFU;
+}
+
 ZIX_PURE_FUNC static size_t
 string_hash_aligned(const char* const str)
 {
@@ -117,21 +124,39 @@ string_hash64_aligned(const char* const str)
 
 #endif
 
+ZIX_PURE_FUNC static size_t
+keyed_string_hash(const char* const str, const ZixDigestKey* const seed)
+{
+  return (size_t)zix_digest_keyed64(seed, str, strlen(str));
+}
+
 static bool
 string_equal(const char* const a, const char* const b)
 {
   return !strcmp(a, b);
 }
 
+static bool
+string_match(const char* const key, const void* const user_data)
+{
+  return !strcmp(key, (const char*)user_data);
+}
+
 static int
 stress_with(ZixAllocator* const allocator,
+            const ZixHashLayout layout,
+            const bool          incremental,
             const ZixHashFunc   hash_func,
             const size_t        n_elems)
 {
-  ZixHash*  hash  = zix_hash_new(allocator, identity, hash_func, string_equal);
+  ZixHash* hash = zix_hash_new_with_layout(
+    allocator, layout, identity, hash_func, string_equal);
+
   TestState state = {hash, NULL, NULL};
   ENSURE(&state, hash, "Failed to allocate hash\n");
 
+  zix_hash_set_incremental(hash, incremental);
+
   static const size_t string_length = 15;
 
   char* const  buffer  = (char*)calloc(1, n_elems * (string_length + 1));
@@ -269,19 +294,22 @@ stress_with(ZixAllocator* const allocator,
 }
 
 static int
-stress(ZixAllocator* const allocator, const size_t n_elems)
+stress_layout(ZixAllocator* const allocator,
+              const ZixHashLayout layout,
+              const bool          inc,
+              const size_t        n_elems)
 {
-  if (stress_with(allocator, decent_string_hash, n_elems) ||
-      stress_with(allocator, terrible_string_hash, n_elems / 4) ||
-      stress_with(allocator, string_hash_aligned, n_elems / 4) ||
-      stress_with(allocator, string_hash32, n_elems / 4) ||
-      stress_with(allocator, string_hash64, n_elems / 4) ||
-      stress_with(allocator, string_hash32_aligned, n_elems / 4)) {
+  if (stress_with(allocator, layout, inc, decent_string_hash, n_elems) ||
+      stress_with(allocator, layout, inc, terrible_string_hash, n_elems / 4) ||
+      stress_with(allocator, layout, inc, string_hash_aligned, n_elems / 4) ||
+      stress_with(allocator, layout, inc, string_hash32, n_elems / 4) ||
+      stress_with(allocator, layout, inc, string_hash64, n_elems / 4) ||
+      stress_with(allocator, layout, inc, string_hash32_aligned, n_elems / 4)) {
     return 1;
   }
 
 #if UINTPTR_MAX >= UINT64_MAX
-  if (stress_with(allocator, string_hash64_aligned, n_elems / 4)) {
+  if (stress_with(allocator, layout, inc, string_hash64_aligned, n_elems / 4)) {
     return 1;
   }
 #endif
@@ -289,6 +317,22 @@ stress(ZixAllocator* const allocator, const size_t n_elems)
   return 0;
 }
 
+static int
+stress(ZixAllocator* const allocator, const size_t n_elems)
+{
+  static const ZixHashLayout layouts[] = {
+    ZIX_HASH_LINEAR, ZIX_HASH_GROUPED, ZIX_HASH_ROBIN_HOOD, ZIX_HASH_COMPACT};
+
+  for (size_t i = 0U; i < sizeof(layouts) / sizeof(layouts[0]); ++i) {
+    if (stress_layout(allocator, layouts[i], false, n_elems) ||
+        stress_layout(allocator, layouts[i], true, n_elems)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
 /// Identity hash function for numeric strings for explicitly hitting cases
 ZIX_PURE_FUNC static size_t
 identity_index_hash(const char* const str)
@@ -297,7 +341,7 @@ identity_index_hash(const char* const str)
 }
 
 static void
-test_all_tombstones(void)
+test_all_tombstones(const ZixHashLayout layout, const unsigned n_strings)
 {
   /* This tests an edge case where a minimum-sized table can be entirely full
      of tombstones.  If the search loop is not written carefully, then this can
@@ -306,28 +350,23 @@ test_all_tombstones(void)
      degenerate index hashing function to explicitly place elements exactly
      where we want to hit this case. */
 
-#define N_STRINGS 4
+#define MAX_N_STRINGS 16U
 
-  static const char* original_strings[N_STRINGS] = {
-    "0 a",
-    "1 a",
-    "2 a",
-    "3 a",
-  };
+  char original_strings[MAX_N_STRINGS][8]  = {{0}};
+  char collision_strings[MAX_N_STRINGS][8] = {{0}};
 
-  static const char* collision_strings[N_STRINGS] = {
-    "0 b",
-    "1 b",
-    "2 b",
-    "3 b",
-  };
+  assert(n_strings <= MAX_N_STRINGS);
+  for (unsigned i = 0U; i < n_strings; ++i) {
+    snprintf(original_strings[i], sizeof(original_strings[i]), "%u a", i);
+    snprintf(collision_strings[i], sizeof(collision_strings[i]), "%u b", i);
+  }
 
-  ZixStatus st = ZIX_STATUS_SUCCESS;
-  ZixHash*  hash =
-    zix_hash_new(NULL, identity, identity_index_hash, string_equal);
+  ZixStatus st   = ZIX_STATUS_SUCCESS;
+  ZixHash*  hash = zix_hash_new_with_layout(
+    NULL, layout, identity, identity_index_hash, string_equal);
 
   // Insert each element then immediately remove it
-  for (unsigned i = 0U; i < N_STRINGS; ++i) {
+  for (unsigned i = 0U; i < n_strings; ++i) {
     const char* removed = NULL;
 
     assert(!zix_hash_insert(hash, original_strings[i]));
@@ -336,16 +375,542 @@ test_all_tombstones(void)
 
   // Now the table should be "empty" but contain tombstones
   assert(zix_hash_size(hash) == 0);
+  assert(!zix_hash_find_record(hash, original_strings[0]));
 
   // Insert clashing elements which should hit the "all tombstones" case
-  for (unsigned i = 0U; i < N_STRINGS; ++i) {
+  for (unsigned i = 0U; i < n_strings; ++i) {
     assert(!zix_hash_insert(hash, collision_strings[i]));
     assert(!st);
   }
 
   zix_hash_free(hash);
 
-#undef N_STRINGS
+#undef MAX_N_STRINGS
+}
+
+static void
+test_stats(const ZixHashLayout layout)
+{
+  static const size_t n_strings = 256U;
+
+  char strings[256U][8] = {{0}};
+  for (size_t i = 0U; i < n_strings; ++i) {
+    snprintf(strings[i], sizeof(strings[i]), "s%zu", i);
+  }
+
+  ZixHash* const hash = zix_hash_new_with_layout(
+    NULL, layout, identity, decent_string_hash, string_equal);
+
+  // An empty table has no records and short misses
+  ZixHashStats stats = zix_hash_stats(hash);
+  assert(stats.n_entries == zix_hash_end(hash));
+  assert(!stats.n_tombstones);
+  assert(stats.mean_probe_length == 0.0);
+  assert(!stats.max_probe_length);
+  assert(stats.mean_miss_length == 1.0);
+  assert(stats.max_miss_length == 1U);
+  assert(stats.mean_displacement == 0.0);
+  assert(!stats.max_displacement);
+  assert(stats.load_factor == 0.0);
+  assert(!stats.n_resizes);
+  assert(stats.n_bytes > stats.n_entries);
+  assert(stats.n_lookups == stats.n_hits + stats.n_misses);
+  for (unsigned i = 0U; i < ZIX_HASH_N_PROBE_LENGTHS; ++i) {
+    assert(!stats.probe_lengths[i]);
+  }
+
+  // Insert every string
+  for (size_t i = 0U; i < n_strings; ++i) {
+    assert(!zix_hash_insert(hash, strings[i]));
+  }
+
+  stats = zix_hash_stats(hash);
+  assert(stats.n_entries == zix_hash_end(hash));
+  assert(!stats.n_tombstones);
+  assert(stats.mean_probe_length >= 1.0);
+  assert(stats.mean_probe_length <= (double)stats.max_probe_length);
+  assert(stats.mean_miss_length >= 1.0);
+  assert(stats.mean_miss_length <= (double)stats.max_miss_length);
+  assert(stats.mean_displacement <= (double)stats.max_displacement);
+  assert(stats.load_factor == (double)n_strings / (double)zix_hash_end(hash));
+  assert(stats.load_factor < 1.0);
+  assert(stats.n_resizes > 0U);
+  assert(stats.n_bytes > stats.n_entries * sizeof(void*));
+  if (layout != ZIX_HASH_GROUPED) {
+    assert(stats.max_probe_length == stats.max_displacement + 1U);
+  }
+
+  // Check that the histogram accounts for every record
+  size_t n_probed = 0U;
+  for (unsigned i = 0U; i < ZIX_HASH_N_PROBE_LENGTHS; ++i) {
+    assert(!stats.probe_lengths[i] || i < stats.max_probe_length);
+    n_probed += stats.probe_lengths[i];
+  }
+
+  assert(n_probed == n_strings);
+
+  // Search for every string and one missing string
+  for (size_t i = 0U; i < n_strings; ++i) {
+    assert(zix_hash_find_record(hash, strings[i]) == strings[i]);
+  }
+
+  assert(!zix_hash_find_record(hash, "missing"));
+
+  // Check the lookup counters, which are zero if they're disabled
+  const ZixHashStats counted = zix_hash_stats(hash);
+  assert(counted.n_lookups == counted.n_hits + counted.n_misses);
+  assert(!counted.n_lookups || counted.n_hits == stats.n_hits + n_strings);
+  assert(!counted.n_lookups || counted.n_misses == stats.n_misses + 1U);
+
+  // Remove every other string, which leaves tombstones in some layouts
+  for (size_t i = 0U; i < n_strings; i += 2U) {
+    const char* removed = NULL;
+    assert(!zix_hash_remove(hash, strings[i], &removed));
+    assert(removed == strings[i]);
+  }
+
+  stats = zix_hash_stats(hash);
+  assert(stats.n_entries == zix_hash_end(hash));
+  assert((layout == ZIX_HASH_ROBIN_HOOD) == !stats.n_tombstones);
+  assert(stats.mean_probe_length <= (double)stats.max_probe_length);
+  assert(stats.mean_miss_length <= (double)stats.max_miss_length);
+
+  zix_hash_free(hash);
+}
+
+static void
+test_reserve(const ZixHashLayout layout)
+{
+  static const size_t n_strings = 256U;
+  static const size_t n_kept    = 8U;
+
+  char strings[256U][8] = {{0}};
+  for (size_t i = 0U; i < n_strings; ++i) {
+    snprintf(strings[i], sizeof(strings[i]), "s%zu", i);
+  }
+
+  ZixFailingAllocator allocator = zix_failing_allocator();
+  ZixHash* const      hash      = zix_hash_new_with_layout(
+    &allocator.base, layout, identity, decent_string_hash, string_equal);
+
+  // Reserving space for every record grows the table once
+  assert(!zix_hash_reserve(hash, n_strings));
+  const ZixHashIter reserved_end = zix_hash_end(hash);
+  assert(reserved_end > n_strings);
+  assert(!zix_hash_reserve(hash, n_strings / 2U));
+  assert(zix_hash_end(hash) == reserved_end);
+
+  // Inserting the reserved number of records doesn't grow the table
+  for (size_t i = 0U; i < n_strings; ++i) {
+    assert(!zix_hash_insert(hash, strings[i]));
+  }
+  assert(zix_hash_end(hash) == reserved_end);
+
+  // Impossible reservations fail without changing anything
+  assert(zix_hash_reserve(hash, SIZE_MAX) == ZIX_STATUS_NO_MEM);
+  zix_failing_allocator_reset(&allocator, 0U);
+  assert(zix_hash_reserve(hash, n_strings * 4U) == ZIX_STATUS_NO_MEM);
+  assert(zix_hash_end(hash) == reserved_end);
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+
+  // With automatic shrinking disabled, removing records doesn't shrink
+  assert(zix_hash_set_shrink_divisor(hash, 3U) == ZIX_STATUS_BAD_ARG);
+  assert(!zix_hash_set_shrink_divisor(hash, 0U));
+  for (size_t i = n_kept; i < n_strings; ++i) {
+    const char* removed = NULL;
+    assert(!zix_hash_remove(hash, strings[i], &removed));
+  }
+  assert(zix_hash_end(hash) == reserved_end);
+
+  // Shrinking to fit makes the table as small as possible
+  zix_failing_allocator_reset(&allocator, 0U);
+  assert(zix_hash_shrink_to_fit(hash) == ZIX_STATUS_NO_MEM);
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  assert(!zix_hash_shrink_to_fit(hash));
+  assert(zix_hash_end(hash) < reserved_end);
+  assert(zix_hash_end(hash) >= n_kept);
+  for (size_t i = 0U; i < n_kept; ++i) {
+    assert(zix_hash_find_record(hash, strings[i]) == strings[i]);
+  }
+
+  // With a wider hysteresis, the table stays large for longer
+  assert(!zix_hash_set_shrink_divisor(hash, 16U));
+  for (size_t i = n_kept; i < n_strings; ++i) {
+    assert(!zix_hash_insert(hash, strings[i]));
+  }
+
+  const ZixHashIter full_end = zix_hash_end(hash);
+  for (size_t i = n_kept; i < n_strings; ++i) {
+    const char* removed = NULL;
+    assert(!zix_hash_remove(hash, strings[i], &removed));
+    if (zix_hash_size(hash) >= full_end / 16U) {
+      assert(zix_hash_end(hash) == full_end);
+    }
+  }
+  assert(zix_hash_end(hash) < full_end);
+
+  zix_hash_free(hash);
+}
+
+static void
+test_find_batch(const ZixHashLayout layout, const bool incremental)
+{
+  static const size_t n_strings = 80U;
+
+  char         strings[80U][8] = {{0}};
+  const char*  keys[80U]       = {NULL};
+  ZixHashCode  codes[80U]      = {0U};
+  const char*  records[80U]    = {NULL};
+  const size_t n_present       = n_strings / 2U;
+
+  for (size_t i = 0U; i < n_strings; ++i) {
+    snprintf(strings[i], sizeof(strings[i]), "s%zu", i);
+    keys[i]  = strings[i];
+    codes[i] = decent_string_hash(strings[i]);
+  }
+
+  ZixHash* const hash = zix_hash_new_with_layout(
+    NULL, layout, identity, decent_string_hash, string_equal);
+
+  zix_hash_set_incremental(hash, incremental);
+
+  // Insert every other string, where the last insertion grows the table
+  for (size_t i = 0U; i < n_strings; i += 2U) {
+    assert(!zix_hash_insert(hash, strings[i]));
+  }
+
+  // In incremental mode, the old entries have only partially been migrated
+  const bool migrating = incremental && layout != ZIX_HASH_COMPACT;
+  assert(zix_hash_end(hash) == (migrating ? 192U : 128U));
+
+  // Find every string, with and without precomputed hash codes
+  for (unsigned c = 0U; c < 2U; ++c) {
+    const size_t n_found = zix_hash_find_batch(
+      hash, n_strings, keys, c ? codes : NULL, (ZixHashRecord**)records);
+
+    assert(n_found == n_present);
+    for (size_t i = 0U; i < n_strings; ++i) {
+      assert(records[i] == zix_hash_find_record(hash, strings[i]));
+      assert(records[i] == ((i % 2U) ? NULL : strings[i]));
+    }
+  }
+
+  // An empty batch finds nothing
+  assert(!zix_hash_find_batch(hash, 0U, NULL, NULL, NULL));
+
+  // Prehashed searches find the same positions, which can be erased
+  for (size_t i = 0U; i < n_strings; ++i) {
+    const ZixHashIter found =
+      zix_hash_find_prehashed(hash, codes[i], string_match, keys[i]);
+
+    assert(found == zix_hash_find(hash, keys[i]));
+    if (found != zix_hash_end(hash)) {
+      const char* removed = NULL;
+      assert(!zix_hash_erase(hash, found, &removed));
+      assert(removed == strings[i]);
+    }
+  }
+
+  assert(!zix_hash_size(hash));
+
+  zix_hash_free(hash);
+}
+
+static void
+test_seeded(const ZixHashLayout layout)
+{
+  static const size_t n_strings = 200U;
+
+  char        strings[200U][8] = {{0}};
+  const char* keys[200U]       = {NULL};
+  ZixHashCode codes[200U]      = {0U};
+  const char* records[200U]    = {NULL};
+
+  // Tables without a seed don't have one
+  ZixHash* const unseeded = zix_hash_new_with_layout(
+    NULL, layout, identity, decent_string_hash, string_equal);
+  assert(!zix_hash_seed(unseeded));
+  zix_hash_free(unseeded);
+
+  // Every seeded table gets its own random seed
+  ZixHash* const hash = zix_hash_new_seeded(
+    NULL, layout, identity, keyed_string_hash, string_equal);
+  ZixHash* const other = zix_hash_new_seeded(
+    NULL, layout, identity, keyed_string_hash, string_equal);
+
+  const ZixDigestKey* const seed = zix_hash_seed(hash);
+  assert(seed);
+  assert(zix_hash_seed(other));
+  assert(memcmp(seed, zix_hash_seed(other), sizeof(ZixDigestKey)));
+  zix_hash_free(other);
+
+  // Insert every other string, and find them by key or precomputed code
+  for (size_t i = 0U; i < n_strings; ++i) {
+    snprintf(strings[i], sizeof(strings[i]), "s%zu", i);
+    keys[i]  = strings[i];
+    codes[i] = keyed_string_hash(strings[i], seed);
+    if (!(i % 2U)) {
+      assert(!zix_hash_insert(hash, strings[i]));
+      assert(zix_hash_insert(hash, strings[i]) == ZIX_STATUS_EXISTS);
+    }
+  }
+
+  for (unsigned c = 0U; c < 2U; ++c) {
+    const size_t n_found = zix_hash_find_batch(
+      hash, n_strings, keys, c ? codes : NULL, (ZixHashRecord**)records);
+
+    assert(n_found == n_strings / 2U);
+    for (size_t i = 0U; i < n_strings; ++i) {
+      assert(records[i] == ((i % 2U) ? NULL : strings[i]));
+      assert(records[i] == zix_hash_find_record(hash, strings[i]));
+    }
+  }
+
+  // Remove everything
+  for (size_t i = 0U; i < n_strings; i += 2U) {
+    const char* removed = NULL;
+    assert(!zix_hash_remove(hash, strings[i], &removed));
+    assert(removed == strings[i]);
+  }
+
+  assert(!zix_hash_size(hash));
+  zix_hash_free(hash);
+
+  // Failing to allocate a seeded table is handled gracefully
+  ZixFailingAllocator allocator = zix_failing_allocator();
+  for (size_t i = 0U; i < 2U; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    assert(!zix_hash_new_seeded(
+      &allocator.base, layout, identity, keyed_string_hash, string_equal));
+  }
+}
+
+static void
+test_build(const ZixHashLayout layout,
+           const ZixHashFunc   hash_func,
+           const size_t        n_strings,
+           const unsigned      n_threads)
+{
+  static const size_t string_size = 16U;
+
+  // Make an array of strings where every 8th is a copy of the previous one
+  char* const        buffer  = (char*)calloc(n_strings, string_size);
+  const char** const records = (const char**)calloc(n_strings, sizeof(char*));
+  size_t             n_unique = 0U;
+  assert(buffer);
+  assert(records);
+
+  for (size_t i = 0U; i < n_strings; ++i) {
+    char* const str = buffer + (i * string_size);
+    if (i % 8U == 7U) {
+      snprintf(str, string_size, "s%zu", n_unique - 1U);
+    } else {
+      snprintf(str, string_size, "s%zu", n_unique++);
+    }
+
+    records[i] = str;
+  }
+
+  ZixHash* const hash =
+    zix_hash_new_with_layout(NULL, layout, identity, hash_func, string_equal);
+
+  // Build a table where only the first of any duplicates is inserted
+  const ZixStatus st = zix_hash_build(hash, n_strings, records, n_threads);
+  assert(st == (n_strings >= 8U ? ZIX_STATUS_EXISTS : ZIX_STATUS_SUCCESS));
+  assert(zix_hash_size(hash) == n_unique);
+
+  for (size_t i = 0U; i < n_strings; ++i) {
+    const char* const first = (i % 8U == 7U) ? records[i - 1U] : records[i];
+    assert(zix_hash_find_record(hash, records[i]) == first);
+  }
+
+  // Check that iteration and statistics see every record exactly once
+  size_t n_visited = 0U;
+  for (ZixHashIter i = zix_hash_begin(hash); i != zix_hash_end(hash);
+       i             = zix_hash_next(hash, i)) {
+    assert(zix_hash_get(hash, i));
+    ++n_visited;
+  }
+
+  const ZixHashStats stats    = zix_hash_stats(hash);
+  size_t             n_probed = 0U;
+  for (unsigned i = 0U; i < ZIX_HASH_N_PROBE_LENGTHS; ++i) {
+    n_probed += stats.probe_lengths[i];
+  }
+
+  assert(n_visited == n_unique);
+  assert(n_probed == n_unique);
+  assert(!stats.n_tombstones);
+
+  // Remove every record, which should work as with any other table
+  for (size_t i = 0U; i < n_strings; ++i) {
+    const char* removed = NULL;
+    if (i % 8U != 7U) {
+      assert(!zix_hash_remove(hash, records[i], &removed));
+      assert(removed == records[i]);
+    }
+  }
+
+  assert(!zix_hash_size(hash));
+
+  // Building into a non-empty table works like inserting records in order
+  if (n_strings) {
+    assert(!zix_hash_insert(hash, records[0U]));
+    assert(zix_hash_build(hash, n_strings, records, n_threads) ==
+           ZIX_STATUS_EXISTS);
+    assert(zix_hash_size(hash) == n_unique);
+    for (size_t i = 0U; i < n_strings; ++i) {
+      if (i % 8U != 7U) {
+        assert(zix_hash_find_record(hash, records[i]) == records[i]);
+      }
+    }
+  }
+
+  zix_hash_free(hash);
+  free(records);
+  free(buffer);
+}
+
+/// Check that iterating over a table visits the given records in order
+static void
+check_order(const ZixHash* const     hash,
+            const size_t             n_records,
+            const char* const* const records)
+{
+  size_t n_visited = 0U;
+  for (ZixHashIter i = zix_hash_begin(hash); i != zix_hash_end(hash);
+       i             = zix_hash_next(hash, i)) {
+    assert(n_visited < n_records);
+    assert(zix_hash_get(hash, i) == records[n_visited]);
+    ++n_visited;
+  }
+
+  assert(n_visited == n_records);
+}
+
+static void
+test_compact_order(void)
+{
+  static const size_t n_strings = 64U;
+
+  char         strings[64U][8] = {{0}};
+  const char*  expected[64U]   = {NULL};
+  size_t       n_expected      = 0U;
+  const char*  removed         = NULL;
+  for (size_t i = 0U; i < n_strings; ++i) {
+    snprintf(strings[i], sizeof(strings[i]), "s%zu", i);
+  }
+
+  ZixFailingAllocator allocator = zix_failing_allocator();
+  ZixHash* const      hash      = zix_hash_new_with_layout(&allocator.base,
+                                                           ZIX_HASH_COMPACT,
+                                                           identity,
+                                                           decent_string_hash,
+                                                           string_equal);
+
+  ZixHash* const linear = zix_hash_new_with_layout(
+    NULL, ZIX_HASH_LINEAR, identity, decent_string_hash, string_equal);
+
+  // An empty table has no records to visit
+  check_order(hash, 0U, expected);
+
+  // Iteration visits records in the order they were inserted
+  for (size_t i = 0U; i < n_strings; ++i) {
+    assert(!zix_hash_insert(hash, strings[i]));
+    assert(!zix_hash_insert(linear, strings[i]));
+    expected[n_expected++] = strings[i];
+  }
+
+  check_order(hash, n_expected, expected);
+
+  // The index and dense entries are smaller than a linear table of entries
+  const ZixHashStats stats = zix_hash_stats(hash);
+  assert(stats.n_entries == zix_hash_end(linear));
+  assert(stats.n_bytes < zix_hash_stats(linear).n_bytes);
+  assert(!stats.n_tombstones);
+
+  // Removing records leaves holes that iteration skips, without reordering
+  assert(!zix_hash_set_shrink_divisor(hash, 0U));
+  n_expected = 0U;
+  for (size_t i = 0U; i < n_strings; ++i) {
+    if (i % 3U) {
+      expected[n_expected++] = strings[i];
+    } else {
+      assert(!zix_hash_remove(hash, strings[i], &removed));
+      assert(removed == strings[i]);
+    }
+  }
+
+  check_order(hash, n_expected, expected);
+  assert(zix_hash_stats(hash).n_tombstones == n_strings - n_expected);
+
+  // Reinserted records are appended, until the entries must be compacted
+  size_t n_failed = 0U;
+  for (size_t i = 0U; i < n_strings; i += 3U) {
+    zix_failing_allocator_reset(&allocator, 0U);
+    const ZixStatus st = zix_hash_insert(hash, strings[i]);
+    if (st) {
+      // Compacting failed, so nothing should have changed
+      assert(st == ZIX_STATUS_NO_MEM);
+      check_order(hash, n_expected, expected);
+      zix_failing_allocator_reset(&allocator, SIZE_MAX);
+      assert(!zix_hash_insert(hash, strings[i]));
+      ++n_failed;
+    }
+
+    expected[n_expected++] = strings[i];
+    check_order(hash, n_expected, expected);
+  }
+
+  assert(n_failed == 1U);
+  assert(!zix_hash_stats(hash).n_tombstones);
+  for (size_t i = 0U; i < n_strings; ++i) {
+    assert(zix_hash_find_record(hash, strings[i]) == strings[i]);
+  }
+
+  zix_hash_free(linear);
+  zix_hash_free(hash);
+}
+
+static void
+test_build_failed_alloc(const ZixHashLayout layout)
+{
+  static const size_t n_strings = 256U;
+
+  char        strings[256U][8] = {{0}};
+  const char* records[256U]    = {NULL};
+  for (size_t i = 0U; i < n_strings; ++i) {
+    snprintf(strings[i], sizeof(strings[i]), "s%zu", i);
+    records[i] = strings[i];
+  }
+
+  ZixFailingAllocator allocator = zix_failing_allocator();
+  ZixHash* const      hash      = zix_hash_new_with_layout(
+    &allocator.base, layout, identity, decent_string_hash, string_equal);
+
+  // Failing to allocate the table or scratch space leaves the table unchanged
+  // (compact tables are built serially, so only allocate the new table)
+  const ZixHashIter end      = zix_hash_end(hash);
+  const size_t      n_allocs = (layout == ZIX_HASH_COMPACT) ? 1U : 2U;
+  for (size_t i = 0U; i < n_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    assert(zix_hash_build(hash, n_strings, records, 4U) == ZIX_STATUS_NO_MEM);
+    assert(!zix_hash_size(hash));
+    assert(zix_hash_end(hash) == end);
+  }
+
+  // Impossibly large arrays fail without accessing anything
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  assert(zix_hash_build(hash, SIZE_MAX, records, 1U) == ZIX_STATUS_NO_MEM);
+
+  // Building an empty array does nothing
+  assert(!zix_hash_build(hash, 0U, NULL, 4U));
+  assert(zix_hash_end(hash) == end);
+
+  assert(!zix_hash_build(hash, n_strings, records, 4U));
+  assert(zix_hash_size(hash) == n_strings);
+
+  zix_hash_free(hash);
 }
 
 static void
@@ -369,7 +934,45 @@ main(void)
 {
   zix_hash_free(NULL);
 
-  test_all_tombstones();
+  test_all_tombstones(ZIX_HASH_LINEAR, 4U);
+  test_all_tombstones(ZIX_HASH_GROUPED, 16U);
+  test_all_tombstones(ZIX_HASH_ROBIN_HOOD, 4U);
+  test_all_tombstones(ZIX_HASH_COMPACT, 4U);
+  test_stats(ZIX_HASH_LINEAR);
+  test_stats(ZIX_HASH_GROUPED);
+  test_stats(ZIX_HASH_ROBIN_HOOD);
+  test_stats(ZIX_HASH_COMPACT);
+  test_reserve(ZIX_HASH_LINEAR);
+  test_reserve(ZIX_HASH_GROUPED);
+  test_reserve(ZIX_HASH_ROBIN_HOOD);
+  test_reserve(ZIX_HASH_COMPACT);
+  test_find_batch(ZIX_HASH_LINEAR, false);
+  test_find_batch(ZIX_HASH_GROUPED, false);
+  test_find_batch(ZIX_HASH_ROBIN_HOOD, false);
+  test_find_batch(ZIX_HASH_COMPACT, false);
+  test_find_batch(ZIX_HASH_LINEAR, true);
+  test_find_batch(ZIX_HASH_GROUPED, true);
+  test_find_batch(ZIX_HASH_ROBIN_HOOD, true);
+  test_find_batch(ZIX_HASH_COMPACT, true);
+  test_compact_order();
+  test_seeded(ZIX_HASH_LINEAR);
+  test_seeded(ZIX_HASH_GROUPED);
+  test_seeded(ZIX_HASH_ROBIN_HOOD);
+  test_seeded(ZIX_HASH_COMPACT);
+  test_build(ZIX_HASH_LINEAR, decent_string_hash, 0U, 4U);
+  test_build(ZIX_HASH_LINEAR, decent_string_hash, 100U, 1U);
+  test_build(ZIX_HASH_LINEAR, decent_string_hash, 100000U, 1U);
+  test_build(ZIX_HASH_LINEAR, decent_string_hash, 100000U, 4U);
+  test_build(ZIX_HASH_GROUPED, decent_string_hash, 100000U, 4U);
+  test_build(ZIX_HASH_ROBIN_HOOD, decent_string_hash, 100000U, 4U);
+  test_build(ZIX_HASH_COMPACT, decent_string_hash, 100000U, 4U);
+  test_build(ZIX_HASH_LINEAR, clustered_string_hash, 20000U, 4U);
+  test_build(ZIX_HASH_GROUPED, clustered_string_hash, 20000U, 4U);
+  test_build(ZIX_HASH_ROBIN_HOOD, clustered_string_hash, 20000U, 4U);
+  test_build(ZIX_HASH_COMPACT, clustered_string_hash, 20000U, 4U);
+  test_build_failed_alloc(ZIX_HASH_LINEAR);
+  test_build_failed_alloc(ZIX_HASH_GROUPED);
+  test_build_failed_alloc(ZIX_HASH_COMPACT);
   test_failed_alloc();
 
   static const size_t n_elems = 1024U;
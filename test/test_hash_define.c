@@ -0,0 +1,269 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "failing_allocator.h"
+
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/hash_define.h>
+#include <zix/status.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+  uint32_t value;
+  uint16_t flags;
+} TestRecord;
+
+typedef const char* String;
+
+ZIX_CONST_FUNC static size_t
+int_hash(const uint32_t key)
+{
+  return zix_digest32(0U, &key, sizeof(key));
+}
+
+ZIX_CONST_FUNC static size_t
+terrible_hash(const uint32_t key)
+{
+  (void)key;
+  return 42U;
+}
+
+ZIX_CONST_FUNC static bool
+int_equal(const uint32_t a, const uint32_t b)
+{
+  return a == b;
+}
+
+ZIX_PURE_FUNC static size_t
+string_hash(const String key)
+{
+  return zix_digest(0U, key, strlen(key));
+}
+
+ZIX_PURE_FUNC static bool
+string_equal(const String a, const String b)
+{
+  return !strcmp(a, b);
+}
+
+#define POINTER_HASH(key) ((size_t)(uintptr_t)(key) * 0x9E3779B1U)
+#define POINTER_EQUAL(a, b) ((a) == (b))
+
+ZIX_HASH_DEFINE(IntTable, uint32_t, TestRecord, int_hash, int_equal)
+ZIX_HASH_DEFINE(BadTable, uint32_t, TestRecord, terrible_hash, int_equal)
+ZIX_HASH_DEFINE(PtrTable, String, size_t, POINTER_HASH, POINTER_EQUAL)
+ZIX_HASH_DEFINE(StrTable, String, size_t, string_hash, string_equal)
+
+#define STRESS(Table, n_elems)                                               \
+  do {                                                                       \
+    Table* const table = Table##_new(NULL);                                  \
+    assert(table);                                                           \
+    assert(!Table##_size(table));                                            \
+    assert(Table##_begin(table) == Table##_end(table));                      \
+    assert(!Table##_find_record(table, 1U));                                 \
+    assert(Table##_remove(table, 1U, NULL) == ZIX_STATUS_NOT_FOUND);         \
+                                                                             \
+    /* Insert every key, where inserting an equal key again fails */         \
+    for (uint32_t i = 0U; i < (n_elems); ++i) {                              \
+      const TestRecord record = {i * 3U, (uint16_t)i};                       \
+      assert(!Table##_insert(table, i, record));                             \
+      assert(Table##_insert(table, i, record) == ZIX_STATUS_EXISTS);         \
+    }                                                                        \
+                                                                             \
+    assert(Table##_size(table) == (n_elems));                                \
+                                                                             \
+    /* Find every record stored inline, but no missing keys */               \
+    for (uint32_t i = 0U; i < (n_elems); ++i) {                              \
+      const TestRecord* const record = Table##_find_record(table, i);        \
+      assert(record);                                                        \
+      assert(record->value == i * 3U);                                       \
+      assert(record->flags == (uint16_t)i);                                  \
+      assert(*Table##_key(table, Table##_find(table, i)) == i);              \
+    }                                                                        \
+                                                                             \
+    assert(!Table##_find_record(table, (n_elems)));                          \
+    assert(Table##_find(table, (n_elems)) == Table##_end(table));            \
+                                                                             \
+    /* Iteration visits every record exactly once */                         \
+    size_t n_visited = 0U;                                                   \
+    size_t sum       = 0U;                                                   \
+    for (ZixHashIter i = Table##_begin(table); i != Table##_end(table);      \
+         i             = Table##_next(table, i)) {                           \
+      assert(Table##_get(table, i)->value == *Table##_key(table, i) * 3U);   \
+      sum += *Table##_key(table, i);                                         \
+      ++n_visited;                                                           \
+    }                                                                        \
+                                                                             \
+    assert(n_visited == (n_elems));                                          \
+    assert(sum == (size_t)(n_elems) * ((n_elems) - 1U) / 2U);                \
+                                                                             \
+    /* Remove every other record, which leaves tombstones behind */          \
+    for (uint32_t i = 0U; i < (n_elems); i += 2U) {                          \
+      TestRecord removed = {0U, 0U};                                         \
+      assert(!Table##_remove(table, i, &removed));                           \
+      assert(removed.value == i * 3U);                                       \
+      assert(Table##_remove(table, i, &removed) == ZIX_STATUS_NOT_FOUND);    \
+    }                                                                        \
+                                                                             \
+    assert(Table##_size(table) == (n_elems) / 2U);                           \
+    for (uint32_t i = 0U; i < (n_elems); ++i) {                              \
+      assert(!Table##_find_record(table, i) == !(i % 2U));                   \
+    }                                                                        \
+                                                                             \
+    /* Reinserting reuses tombstones */                                      \
+    for (uint32_t i = 0U; i < (n_elems); i += 2U) {                          \
+      const TestRecord record = {i * 3U, (uint16_t)i};                       \
+      assert(!Table##_insert(table, i, record));                             \
+    }                                                                        \
+                                                                             \
+    assert(Table##_size(table) == (n_elems));                                \
+                                                                             \
+    /* Erase everything by iterator, which shrinks the table as it goes */   \
+    while (Table##_size(table)) {                                            \
+      const ZixHashIter i   = Table##_begin(table);                          \
+      const uint32_t    key = *Table##_key(table, i);                        \
+      assert(!Table##_erase(table, i));                                      \
+      assert(!Table##_find_record(table, key));                              \
+    }                                                                        \
+                                                                             \
+    assert(Table##_begin(table) == Table##_end(table));                      \
+    assert(table->n_entries == ZIX_HASH_DEFINE_MIN_N_ENTRIES);               \
+                                                                             \
+    /* Reserving space prevents growth while inserting */                    \
+    assert(!Table##_reserve(table, (n_elems)));                              \
+    assert(Table##_reserve(table, SIZE_MAX) == ZIX_STATUS_NO_MEM);           \
+    const size_t n_entries = table->n_entries;                               \
+    for (uint32_t i = 0U; i < (n_elems); ++i) {                              \
+      const TestRecord record = {i * 3U, (uint16_t)i};                       \
+      assert(!Table##_insert(table, i, record));                             \
+    }                                                                        \
+                                                                             \
+    assert(table->n_entries == n_entries);                                   \
+    Table##_free(table);                                                     \
+  } while (0)
+
+static void
+test_int_keys(void)
+{
+  STRESS(IntTable, 4096U);
+  STRESS(BadTable, 256U);
+
+  IntTable_free(NULL);
+}
+
+static void
+test_pointer_keys(void)
+{
+  static const char* const strings[] = {"apple", "banana", "cherry", "date"};
+  static const size_t      n_strings = sizeof(strings) / sizeof(strings[0]);
+
+  char copy[8] = {0};
+  memcpy(copy, "banana", 7U);
+
+  // Pointer keys are compared by address
+  PtrTable* const ptrs = PtrTable_new(NULL);
+  assert(ptrs);
+  for (size_t i = 0U; i < n_strings; ++i) {
+    assert(!PtrTable_insert(ptrs, strings[i], i));
+  }
+
+  assert(PtrTable_size(ptrs) == n_strings);
+  assert(*PtrTable_find_record(ptrs, strings[1]) == 1U);
+  assert(!PtrTable_find_record(ptrs, copy));
+  assert(!PtrTable_insert(ptrs, copy, 4U));
+  assert(PtrTable_size(ptrs) == n_strings + 1U);
+  PtrTable_free(ptrs);
+
+  // String keys are compared by value
+  StrTable* const strs = StrTable_new(NULL);
+  assert(strs);
+  for (size_t i = 0U; i < n_strings; ++i) {
+    assert(!StrTable_insert(strs, strings[i], i));
+  }
+
+  assert(*StrTable_find_record(strs, copy) == 1U);
+  assert(StrTable_insert(strs, copy, 4U) == ZIX_STATUS_EXISTS);
+  assert(*StrTable_key(strs, StrTable_find(strs, copy)) == strings[1]);
+  assert(!StrTable_find_record(strs, "elderberry"));
+
+  // Records are modifiable in place
+  *StrTable_find_record(strs, "cherry") = 42U;
+  assert(*StrTable_get(strs, StrTable_find(strs, "cherry")) == 42U);
+
+  size_t removed = 0U;
+  assert(!StrTable_remove(strs, "cherry", &removed));
+  assert(removed == 42U);
+  assert(StrTable_size(strs) == n_strings - 1U);
+  StrTable_free(strs);
+}
+
+static void
+test_failed_alloc(void)
+{
+  ZixFailingAllocator allocator = zix_failing_allocator();
+
+  // Successfully allocate a table to count the number of allocations
+  IntTable* table = IntTable_new(&allocator.base);
+  assert(table);
+  for (uint32_t i = 0U; i < 16U; ++i) {
+    const TestRecord record = {i, 0U};
+    assert(!IntTable_insert(table, i, record));
+  }
+  IntTable_free(table);
+
+  // Test that failing at each allocation is handled gracefully
+  const size_t n_new_allocs = allocator.n_allocations;
+  for (size_t i = 0U; i < n_new_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+
+    if ((table = IntTable_new(&allocator.base))) {
+      ZixStatus st = ZIX_STATUS_SUCCESS;
+      for (uint32_t j = 0U; j < 16U && !st; ++j) {
+        const TestRecord record = {j, 0U};
+        st                      = IntTable_insert(table, j, record);
+        assert(!st || st == ZIX_STATUS_NO_MEM);
+
+        // Failing to grow leaves the table unchanged
+        assert(IntTable_size(table) == j + !st);
+        assert(!IntTable_find_record(table, j) == !!st);
+      }
+
+      assert(st == ZIX_STATUS_NO_MEM);
+      IntTable_free(table);
+    }
+  }
+
+  // Failing to shrink still removes the record
+  zix_failing_allocator_reset(&allocator, SIZE_MAX);
+  table = IntTable_new(&allocator.base);
+  assert(table);
+  assert(!IntTable_reserve(table, 64U));
+  const TestRecord record = {1U, 2U};
+  assert(!IntTable_insert(table, 1U, record));
+
+  zix_failing_allocator_reset(&allocator, 0U);
+  TestRecord removed = {0U, 0U};
+  assert(IntTable_remove(table, 1U, &removed) == ZIX_STATUS_NO_MEM);
+  assert(removed.value == 1U);
+  assert(!IntTable_size(table));
+  assert(!IntTable_find_record(table, 1U));
+  IntTable_free(table);
+}
+
+int
+main(void)
+{
+  test_int_keys();
+  test_pointer_keys();
+  test_failed_alloc();
+  return 0;
+}
@@ -0,0 +1,269 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "failing_allocator.h"
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/filesystem.h>
+#include <zix/hash.h>
+#include <zix/hash_view.h>
+#include <zix/path.h>
+#include <zix/status.h>
+#include <zix/string_view.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N_RECORDS 1024U
+
+typedef struct {
+  char key[16];
+  char value[24];
+} TestRecord;
+
+ZIX_CONST_FUNC static const void*
+test_key(const void* const record)
+{
+  return ((const TestRecord*)record)->key;
+}
+
+ZIX_PURE_FUNC static size_t
+test_hash(const void* const key)
+{
+  const char* const str = (const char*)key;
+
+  return zix_digest(0U, str, strlen(str));
+}
+
+ZIX_PURE_FUNC static bool
+test_equal(const void* const a, const void* const b)
+{
+  return !strcmp((const char*)a, (const char*)b);
+}
+
+ZIX_PURE_FUNC static ZixHashViewEntry
+test_entry(const void* const record, void* const user_data)
+{
+  const TestRecord* const r = (const TestRecord*)record;
+
+  (void)user_data;
+
+  const ZixHashViewEntry entry = {zix_string(r->key), zix_string(r->value)};
+  return entry;
+}
+
+static void
+make_record(TestRecord* const record, const unsigned i)
+{
+  snprintf(record->key, sizeof(record->key), "key%u", i);
+
+  // Vary the value length so entries need different amounts of padding
+  memset(record->value, 0, sizeof(record->value));
+  memset(record->value, 'a' + (int)(i % 26U), i % 16U);
+}
+
+static ZixHash*
+new_hash(TestRecord* const records, const unsigned n_records)
+{
+  ZixHash* const hash = zix_hash_new(NULL, test_key, test_hash, test_equal);
+  assert(hash);
+
+  for (unsigned i = 0U; i < n_records; ++i) {
+    make_record(&records[i], i);
+    assert(!zix_hash_insert(hash, &records[i]));
+  }
+
+  return hash;
+}
+
+static void
+check_view(const ZixHashView* const view, const unsigned n_records)
+{
+  assert(zix_hash_view_size(view) == n_records);
+
+  for (unsigned i = 0U; i < n_records; ++i) {
+    TestRecord record;
+    make_record(&record, i);
+
+    ZixStringView value = zix_empty_string();
+    assert(!zix_hash_view_find(view, zix_string(record.key), &value));
+    assert(value.length == strlen(record.value));
+    assert(!strcmp(value.data, record.value));
+  }
+
+  ZixStringView value = zix_empty_string();
+  assert(zix_hash_view_find(view, zix_string("missing"), &value) ==
+         ZIX_STATUS_NOT_FOUND);
+  assert(zix_hash_view_find(view, zix_string(""), &value) ==
+         ZIX_STATUS_NOT_FOUND);
+  assert(zix_hash_view_find(view, zix_string("key"), &value) ==
+         ZIX_STATUS_NOT_FOUND);
+}
+
+/// Read an entire file into a buffer aligned to 8 bytes
+static uint64_t*
+read_file(const char* const path, size_t* const size)
+{
+  FILE* const fd = fopen(path, "rb");
+  assert(fd);
+  assert(!fseek(fd, 0, SEEK_END));
+
+  const long end = ftell(fd);
+  assert(end > 0);
+  assert(!fseek(fd, 0, SEEK_SET));
+
+  *size = (size_t)end;
+
+  uint64_t* const buf = (uint64_t*)calloc((*size + 7U) / 8U, 8U);
+  assert(buf);
+  assert(fread(buf, 1U, *size, fd) == *size);
+  fclose(fd);
+  return buf;
+}
+
+static void
+test_round_trip(const char* const path, const unsigned n_records)
+{
+  TestRecord* const records =
+    (TestRecord*)calloc(n_records + 1U, sizeof(TestRecord));
+
+  ZixHash* const hash = new_hash(records, n_records);
+
+  assert(!zix_hash_view_write(NULL, hash, test_entry, NULL, path));
+
+  // Open the file directly
+  ZixHashView* const view = zix_hash_view_open(NULL, path);
+  assert(view);
+  check_view(view, n_records);
+  zix_hash_view_free(view);
+
+  // Use a copy of the file in memory
+  size_t          size = 0U;
+  uint64_t* const buf  = read_file(path, &size);
+
+  ZixHashView* const mem_view = zix_hash_view_new(NULL, buf, size);
+  assert(mem_view);
+  check_view(mem_view, n_records);
+  zix_hash_view_free(mem_view);
+
+  free(buf);
+  zix_hash_free(hash);
+  free(records);
+}
+
+static void
+test_invalid(const char* const path)
+{
+  TestRecord     records[8];
+  ZixHash* const hash = new_hash(records, 8U);
+
+  assert(!zix_hash_view_write(NULL, hash, test_entry, NULL, path));
+  zix_hash_free(hash);
+
+  size_t          size = 0U;
+  uint64_t* const buf  = read_file(path, &size);
+  char* const     data = (char*)buf;
+
+  // Missing, truncated, or misaligned data
+  assert(!zix_hash_view_new(NULL, NULL, 0U));
+  assert(!zix_hash_view_new(NULL, buf, 8U));
+  assert(!zix_hash_view_new(NULL, buf, size - 1U));
+  assert(!zix_hash_view_new(NULL, data + 1U, size - 1U));
+
+  // Corrupt header fields
+  for (size_t i = 0U; i < 40U; i += 4U) {
+    data[i] = (char)(data[i] ^ 0x40);
+    assert(!zix_hash_view_new(NULL, buf, size));
+    data[i] = (char)(data[i] ^ 0x40);
+  }
+
+  // Out of bounds entry offsets are treated as missing entries
+  ZixHashView* const view = zix_hash_view_new(NULL, buf, size);
+  assert(view);
+  for (size_t i = 0U; i < 16U; ++i) {
+    if (buf[5U + i]) {
+      buf[5U + i] = (uint64_t)size;
+    }
+  }
+
+  ZixStringView value = zix_empty_string();
+  for (unsigned i = 0U; i < 8U; ++i) {
+    assert(zix_hash_view_find(view, zix_string(records[i].key), &value) ==
+           ZIX_STATUS_NOT_FOUND);
+  }
+
+  zix_hash_view_free(view);
+  free(buf);
+
+  // Empty and nonexistent files
+  FILE* const fd = fopen(path, "wb");
+  assert(fd);
+  fclose(fd);
+  assert(!zix_hash_view_open(NULL, path));
+  assert(!zix_remove(path));
+  assert(!zix_hash_view_open(NULL, path));
+}
+
+static void
+test_failed_alloc(const char* const path)
+{
+  ZixFailingAllocator allocator = zix_failing_allocator();
+  TestRecord          records[8];
+  ZixHash* const      hash = new_hash(records, 8U);
+
+  // Successfully write and open a view to count the number of allocations
+  assert(!zix_hash_view_write(&allocator.base, hash, test_entry, NULL, path));
+  ZixHashView* view = zix_hash_view_open(&allocator.base, path);
+  assert(view);
+  zix_hash_view_free(view);
+
+  // Test that each allocation failing is handled gracefully
+  const size_t n_new_allocs = zix_failing_allocator_reset(&allocator, 0);
+  for (size_t i = 0U; i < n_new_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+
+    const ZixStatus st =
+      zix_hash_view_write(&allocator.base, hash, test_entry, NULL, path);
+
+    view = st ? NULL : zix_hash_view_open(&allocator.base, path);
+    assert(st == ZIX_STATUS_NO_MEM || !view);
+  }
+
+  zix_hash_free(hash);
+}
+
+int
+main(void)
+{
+  zix_hash_view_free(NULL);
+
+  char* const temp      = zix_temp_directory_path(NULL);
+  char* const pattern   = zix_path_join(NULL, temp, "zixXXXXXX");
+  char* const temp_dir  = zix_create_temporary_directory(NULL, pattern);
+  char* const file_path = zix_path_join(NULL, temp_dir, "zix_hash_view");
+  assert(temp_dir);
+  assert(file_path);
+
+  test_round_trip(file_path, 0U);
+  test_round_trip(file_path, 1U);
+  test_round_trip(file_path, N_RECORDS);
+  test_invalid(file_path);
+  test_failed_alloc(file_path);
+
+  assert(!zix_remove(file_path));
+  assert(!zix_remove(temp_dir));
+
+  zix_free(NULL, file_path);
+  zix_free(NULL, temp_dir);
+  zix_free(NULL, pattern);
+  zix_free(NULL, temp);
+  return 0;
+}
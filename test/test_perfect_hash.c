@@ -0,0 +1,207 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "failing_allocator.h"
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/perfect_hash.h>
+#include <zix/string_view.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  char key[24];
+} TestRecord;
+
+ZIX_CONST_FUNC static const void*
+test_key(const void* const record)
+{
+  return ((const TestRecord*)record)->key;
+}
+
+ZIX_PURE_FUNC static size_t
+test_hash(const void* const key)
+{
+  const char* const str = (const char*)key;
+
+  return zix_digest(0U, str, strlen(str));
+}
+
+ZIX_PURE_FUNC static bool
+test_equal(const void* const a, const void* const b)
+{
+  return !strcmp((const char*)a, (const char*)b);
+}
+
+ZIX_PURE_FUNC static ZixStringView
+test_string(const void* const record, void* const user_data)
+{
+  (void)user_data;
+
+  return zix_string(((const TestRecord*)record)->key);
+}
+
+static TestRecord*
+new_records(const size_t n_records)
+{
+  TestRecord* const records =
+    (TestRecord*)calloc(n_records + 1U, sizeof(TestRecord));
+
+  assert(records);
+  for (size_t i = 0U; i < n_records; ++i) {
+    snprintf(records[i].key, sizeof(records[i].key), "key%zu", i);
+  }
+
+  return records;
+}
+
+static void
+test_keys(const size_t n_keys)
+{
+  TestRecord* const    records = new_records(n_keys);
+  ZixStringView* const keys =
+    (ZixStringView*)calloc(n_keys + 1U, sizeof(ZixStringView));
+  bool* const seen = (bool*)calloc(n_keys + 1U, sizeof(bool));
+
+  assert(keys);
+  assert(seen);
+  for (size_t i = 0U; i < n_keys; ++i) {
+    keys[i] = zix_string(records[i].key);
+  }
+
+  ZixPerfectHash* const hash = zix_perfect_hash_new(NULL, n_keys, keys);
+  assert(hash);
+  assert(zix_perfect_hash_size(hash) == n_keys);
+  assert(!zix_perfect_hash_get(hash, 0U));
+  assert(!zix_perfect_hash_find_record(hash, keys[0]));
+
+  // Check that every key maps to a unique index
+  for (size_t i = 0U; i < n_keys; ++i) {
+    const size_t index = zix_perfect_hash_index(hash, keys[i]);
+    assert(index < n_keys);
+    assert(!seen[index]);
+    seen[index] = true;
+  }
+
+  // Check that other keys map to some index
+  assert(zix_perfect_hash_index(hash, zix_string("missing")) <= n_keys);
+
+  zix_perfect_hash_free(hash);
+  free(seen);
+  free(keys);
+  free(records);
+}
+
+static void
+test_hash_records(const size_t n_records)
+{
+  TestRecord* const records = new_records(n_records);
+  ZixHash* const    hash = zix_hash_new(NULL, test_key, test_hash, test_equal);
+  assert(hash);
+
+  for (size_t i = 0U; i < n_records; ++i) {
+    assert(!zix_hash_insert(hash, &records[i]));
+  }
+
+  ZixPerfectHash* const perfect =
+    zix_perfect_hash_new_from_hash(NULL, hash, test_string, NULL);
+
+  assert(perfect);
+  assert(zix_perfect_hash_size(perfect) == n_records);
+
+  // The table can be freed since the perfect hash only refers to the records
+  zix_hash_free(hash);
+
+  // Check that each record is found, and is at the index of its key
+  for (size_t i = 0U; i < n_records; ++i) {
+    const ZixStringView key   = zix_string(records[i].key);
+    const size_t        index = zix_perfect_hash_index(perfect, key);
+
+    assert(zix_perfect_hash_find_record(perfect, key) == &records[i]);
+    assert(zix_perfect_hash_get(perfect, index) == &records[i]);
+  }
+
+  assert(!zix_perfect_hash_get(perfect, n_records));
+
+  // Check that other keys aren't found
+  char key[24];
+  for (size_t i = n_records; i < 2U * n_records + 4U; ++i) {
+    snprintf(key, sizeof(key), "key%zu", i);
+    assert(!zix_perfect_hash_find_record(perfect, zix_string(key)));
+  }
+
+  zix_perfect_hash_free(perfect);
+  free(records);
+}
+
+static void
+test_duplicates(void)
+{
+  const ZixStringView keys[] = {
+    zix_string("a"), zix_string("b"), zix_string("c"), zix_string("a")};
+
+  assert(!zix_perfect_hash_new(NULL, 4U, keys));
+  assert(!zix_perfect_hash_new(NULL, 1U, NULL));
+}
+
+static void
+test_failed_alloc(void)
+{
+  static const size_t n_records = 256U;
+
+  ZixFailingAllocator allocator = zix_failing_allocator();
+  TestRecord* const   records   = new_records(n_records);
+  ZixHash* const hash = zix_hash_new(NULL, test_key, test_hash, test_equal);
+  assert(hash);
+
+  for (size_t i = 0U; i < n_records; ++i) {
+    assert(!zix_hash_insert(hash, &records[i]));
+  }
+
+  // Successfully build a perfect hash to count the number of allocations
+  ZixPerfectHash* perfect =
+    zix_perfect_hash_new_from_hash(&allocator.base, hash, test_string, NULL);
+  assert(perfect);
+  zix_perfect_hash_free(perfect);
+
+  // Test that each allocation failing is handled gracefully
+  const size_t n_new_allocs = zix_failing_allocator_reset(&allocator, 0);
+  for (size_t i = 0U; i < n_new_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    assert(!zix_perfect_hash_new_from_hash(
+      &allocator.base, hash, test_string, NULL));
+  }
+
+  zix_hash_free(hash);
+  free(records);
+}
+
+int
+main(void)
+{
+  zix_perfect_hash_free(NULL);
+
+  test_keys(0U);
+  test_keys(1U);
+  test_keys(2U);
+  test_keys(100U);
+  test_keys(100000U);
+  test_hash_records(0U);
+  test_hash_records(1U);
+  test_hash_records(1000U);
+  test_duplicates();
+  test_failed_alloc();
+
+  return 0;
+}
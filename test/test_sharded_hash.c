@@ -0,0 +1,244 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include "failing_allocator.h"
+
+#include <zix/allocator.h>
+#include <zix/attributes.h>
+#include <zix/digest.h>
+#include <zix/hash.h>
+#include <zix/sharded_hash.h>
+#include <zix/status.h>
+#include <zix/thread.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define N_THREADS 4U
+
+static const size_t n_per_thread = 4096U;
+
+typedef struct {
+  ZixShardedHash* hash;
+  size_t          first;
+} ThreadState;
+
+ZIX_CONST_FUNC static const void*
+identity(const void* const record)
+{
+  return record;
+}
+
+static size_t
+int_hash(const void* const key)
+{
+  const uintptr_t i = (uintptr_t)key;
+
+  return zix_digest(0U, &i, sizeof(i));
+}
+
+ZIX_CONST_FUNC static bool
+int_equal(const void* const a, const void* const b)
+{
+  return a == b;
+}
+
+ZIX_CONST_FUNC static bool
+int_match(const void* const key, const void* const user_data)
+{
+  return key == user_data;
+}
+
+/// Record for an integer key, which is never zero (null)
+static void*
+int_record(const size_t i)
+{
+  return (void*)(uintptr_t)(i + 1U);
+}
+
+/// Insert with the two-phase protocol by using a shard directly
+static ZixStatus
+insert_planned(ZixShardedHash* const hash, void* const record)
+{
+  const ZixHashCode code  = int_hash(record);
+  ZixHash* const    shard = zix_sharded_hash_lock_shard(hash, code);
+
+  const ZixHashInsertPlan plan =
+    zix_hash_plan_insert_prehashed(shard, code, int_match, record);
+
+  const ZixStatus st = zix_hash_record_at(shard, plan)
+                         ? ZIX_STATUS_EXISTS
+                         : zix_hash_insert_at(shard, plan, record);
+
+  zix_sharded_hash_unlock_shard(hash, code);
+  return st;
+}
+
+static void
+test_n_shards(void)
+{
+  static const unsigned requested[] = {0U, 1U, 3U, 64U, 100000U};
+  static const unsigned expected[]  = {1U, 1U, 4U, 64U, 65536U};
+
+  for (unsigned i = 0U; i < sizeof(requested) / sizeof(unsigned); ++i) {
+    ZixShardedHash* const hash =
+      zix_sharded_hash_new(NULL, requested[i], identity, int_hash, int_equal);
+
+    assert(hash);
+    assert(zix_sharded_hash_n_shards(hash) == expected[i]);
+    assert(!zix_sharded_hash_size(hash));
+
+    // Records are found regardless of the number of shards
+    assert(!zix_sharded_hash_insert(hash, int_record(i)));
+    assert(zix_sharded_hash_find_record(hash, int_record(i)) == int_record(i));
+    zix_sharded_hash_free(hash);
+  }
+}
+
+static ZixStatus
+stress(ZixAllocator* const allocator, const size_t n_elems)
+{
+  ZixShardedHash* const hash =
+    zix_sharded_hash_new(allocator, 4U, identity, int_hash, int_equal);
+  if (!hash) {
+    return ZIX_STATUS_NO_MEM;
+  }
+
+  // Insert records alternately with each method
+  ZixStatus st = ZIX_STATUS_SUCCESS;
+  for (size_t i = 0U; !st && i < n_elems; ++i) {
+    st = (i % 2U) ? insert_planned(hash, int_record(i))
+                  : zix_sharded_hash_insert(hash, int_record(i));
+  }
+
+  if (!st) {
+    assert(zix_sharded_hash_size(hash) == n_elems);
+
+    for (size_t i = 0U; i < n_elems; ++i) {
+      void* const record = int_record(i);
+      assert(zix_sharded_hash_find_record(hash, record) == record);
+      assert(zix_sharded_hash_insert(hash, record) == ZIX_STATUS_EXISTS);
+      assert(insert_planned(hash, record) == ZIX_STATUS_EXISTS);
+    }
+
+    assert(!zix_sharded_hash_find_record(hash, int_record(n_elems)));
+
+    // Remove every record
+    for (size_t i = 0U; !st && i < n_elems; ++i) {
+      void* removed = NULL;
+      st = zix_sharded_hash_remove(hash, int_record(i), &removed);
+      assert(removed == int_record(i));
+      assert(!zix_sharded_hash_find_record(hash, int_record(i)));
+      assert(zix_sharded_hash_remove(hash, int_record(i), &removed) ==
+             ZIX_STATUS_NOT_FOUND);
+      assert(!removed);
+    }
+  }
+
+  zix_sharded_hash_free(hash);
+  return st;
+}
+
+static void
+test_failed_alloc(void)
+{
+  ZixFailingAllocator allocator = zix_failing_allocator();
+
+  // Successfully stress test the table to count the number of allocations
+  assert(!stress(&allocator.base, 256U));
+
+  // Test that each allocation failing is handled gracefully
+  const size_t n_new_allocs = zix_failing_allocator_reset(&allocator, 0);
+  for (size_t i = 0U; i < n_new_allocs; ++i) {
+    zix_failing_allocator_reset(&allocator, i);
+    assert(stress(&allocator.base, 256U) == ZIX_STATUS_NO_MEM);
+  }
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+insert_range(void* const arg)
+{
+  const ThreadState* const state = (const ThreadState*)arg;
+
+  for (size_t i = state->first; i < state->first + n_per_thread; ++i) {
+    void* const     record = int_record(i);
+    const ZixStatus st =
+      (i % 2U) ? insert_planned(state->hash, record)
+               : zix_sharded_hash_insert(state->hash, record);
+
+    assert(!st);
+    assert(zix_sharded_hash_find_record(state->hash, record) == record);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+remove_range(void* const arg)
+{
+  const ThreadState* const state = (const ThreadState*)arg;
+
+  for (size_t i = state->first; i < state->first + n_per_thread; ++i) {
+    void* removed = NULL;
+    assert(!zix_sharded_hash_remove(state->hash, int_record(i), &removed));
+    assert(removed == int_record(i));
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static void
+run_threads(ThreadState* const states, const ZixThreadFunc func)
+{
+  ZixThread threads[N_THREADS];
+  for (unsigned t = 0U; t < N_THREADS; ++t) {
+    assert(!zix_thread_create(&threads[t], 1U << 16U, func, &states[t]));
+  }
+
+  for (unsigned t = 0U; t < N_THREADS; ++t) {
+    assert(!zix_thread_join(threads[t]));
+  }
+}
+
+static void
+test_threads(void)
+{
+  ZixShardedHash* const hash =
+    zix_sharded_hash_new(NULL, 16U, identity, int_hash, int_equal);
+  assert(hash);
+
+  ThreadState states[N_THREADS];
+  for (unsigned t = 0U; t < N_THREADS; ++t) {
+    states[t].hash  = hash;
+    states[t].first = t * n_per_thread;
+  }
+
+  // Insert disjoint ranges of keys concurrently
+  run_threads(states, insert_range);
+  assert(zix_sharded_hash_size(hash) == N_THREADS * n_per_thread);
+  for (size_t i = 0U; i < N_THREADS * n_per_thread; ++i) {
+    assert(zix_sharded_hash_find_record(hash, int_record(i)) == int_record(i));
+  }
+
+  // Remove them all concurrently
+  run_threads(states, remove_range);
+  assert(!zix_sharded_hash_size(hash));
+
+  zix_sharded_hash_free(hash);
+}
+
+int
+main(void)
+{
+  zix_sharded_hash_free(NULL);
+
+  test_n_shards();
+  test_failed_alloc();
+  test_threads();
+
+  return stress(NULL, 4096U);
+}